@@ -128,7 +128,7 @@ namespace cli
             bool DoSoar(const char pOp = 0, const std::string* pArg1 = 0, const std::string* pArg2 = 0, const std::string* pArg3 = 0);
             bool DoSP(const std::string& production);
             bool DoSRand(uint32_t* pSeed = 0);
-            bool DoStats(const StatsBitset& options, int sort = 0);
+            bool DoStats(const StatsBitset& options, int sort = 0, const std::string* pTimelineFile = 0);
             bool DoSVS(const std::vector<std::string>& args);
             bool DoTrace(const WatchBitset& options, const WatchBitset& settings, const int wmeSetting, const int learnSetting, bool fromWatch);
             bool DoVisualize(const std::string* pArg = 0, const std::string* pArg2 = 0, const std::string* pArg3 = 0);
@@ -209,10 +209,12 @@ namespace cli
             bool DoPbreak(const char& mode, const std::string& production);
             bool DoPredict();
             bool DoProductionFind(const ProductionFindBitset& options, const std::string& pattern);
+            bool DoProfile(const char& mode, int n = 0);
             bool DoPWatch(bool query = true, const std::string* pProduction = 0, bool setting = false);
             bool DoRemoveWME(uint64_t timetag);
             bool DoReplayInput(eReplayInputMode mode, std::string* pathname);
             bool DoReteNet(bool save, std::string filename);
+            bool DoReteNetClone(const std::string& agentName);
             bool DoSelect(const std::string* pOp = 0);
             bool DoSource(std::string filename, SourceBitset* pOptions = 0);
             bool DoTime(std::vector<std::string>& argv);
@@ -230,6 +232,7 @@ namespace cli
             bool ParseMultiAttributes(std::vector< std::string >& argv);
             bool ParsePBreak(std::vector< std::string >& argv);
             bool ParsePFind(std::vector< std::string >& argv);
+            bool ParseProfile(std::vector< std::string >& argv);
             bool ParsePWatch(std::vector< std::string >& argv);
             bool ParseReplayInput(std::vector< std::string >& argv);
             bool ParseSource(std::vector< std::string >& argv);
@@ -281,6 +284,7 @@ namespace cli
             void GetSystemStats(); // for stats
             void GetMemoryStats(); // for stats
             void GetMaxStats(); // for stats
+            void GetLatencyStats(); // for stats
             void GetReteStats(); // for stats
             void GetAgentStats(); // for stats
 
@@ -127,7 +127,7 @@ namespace cli
             }
             virtual const char* GetSyntax() const
             {
-                return "Syntax: debug [ allocate | internal-symbols | port | time | ? ] [arguments*]";
+                return "Syntax: debug [ allocate | base-level | internal-symbols | port | symbol-tables | time | ? ] [arguments*]";
             }
 
             virtual bool Parse(std::vector< std::string >& argv)
@@ -1293,6 +1293,7 @@ namespace cli
                     {'g', "get",        OPTARG_NONE},
                     {'h', "history",    OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'i', "init",       OPTARG_NONE},
+                    {'I', "import",     OPTARG_NONE},
                     {'q', "query",      OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'r', "remove",     OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'s', "set",        OPTARG_NONE},
@@ -1350,6 +1351,15 @@ namespace cli
 
                         return cli.DoSMem(option, &(argv[2]));
 
+                    case 'I':
+                        // case: import requires one non-option argument
+                        if (!opt.CheckNumNonOptArgs(1, 1))
+                        {
+                            return cli.SetError(opt.GetError().c_str());
+                        }
+
+                        return cli.DoSMem(option, &(argv[2]));
+
                     case 'g':
                     {
                         // case: get requires one non-option argument
@@ -1556,6 +1566,7 @@ namespace cli
                     {'l', "learning",   OPTARG_NONE},
                     {'m', "memory",     OPTARG_NONE},
                     {'M', "max",        OPTARG_NONE},
+                    {'p', "percentiles", OPTARG_NONE},
                     {'r', "rete",       OPTARG_NONE},
                     {'s', "system",     OPTARG_NONE},
                     {'R', "reset",      OPTARG_NONE},
@@ -1565,11 +1576,13 @@ namespace cli
                     {'C', "cycle-csv",  OPTARG_NONE},
                     {'S', "sort",       OPTARG_REQUIRED},
                     {'a', "agent",      OPTARG_NONE},
+                    {'L', "timeline",   OPTARG_REQUIRED},
                     {0, 0, OPTARG_NONE}
                 };
 
                 cli::StatsBitset options(0);
                 int sort = 0;
+                std::string timelineFile;
 
                 for (;;)
                 {
@@ -1597,6 +1610,9 @@ namespace cli
                         case 'M':
                             options.set(cli::STATS_MAX);
                             break;
+                        case 'p':
+                            options.set(cli::STATS_LATENCY);
+                            break;
                         case 'r':
                             options.set(cli::STATS_RETE);
                             break;
@@ -1628,6 +1644,10 @@ namespace cli
                         case 'a':
                             options.set(cli::STATS_AGENT);
                             break;
+                        case 'L':
+                            options.set(cli::STATS_TIMELINE);
+                            timelineFile = opt.GetOptionArgument();
+                            break;
                     }
                 }
 
@@ -1637,7 +1657,7 @@ namespace cli
                     return cli.SetError(GetSyntax());
                 }
 
-                return cli.DoStats(options, sort);
+                return cli.DoStats(options, sort, options.test(cli::STATS_TIMELINE) ? &timelineFile : 0);
             }
 
         private:
@@ -19,10 +19,13 @@
 #include "misc.h"
 #include "output_manager.h"
 #include "output_settings.h"
+#include "production.h"
+#include "rete.h"
 #include "semantic_memory.h"
 #include "sml_Names.h"
 #include "sml_AgentSML.h"
 #include "soar_instance.h"
+#include "symbol_table.h"
 
 #include <time.h>
 
@@ -109,6 +112,66 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
                 return true;
             }
         }
+        else if (sub_command[0] == 's')
+        {
+            int num_items = 0;
+            if (!from_string(num_items, argv->at(1)) || (num_items < 1))
+            {
+                return SetError("Expected a positive integer (number of keys).");
+            }
+            benchmark_symbol_tables(thisAgent, num_items);
+            return true;
+        }
+        else if (sub_command[0] == 'b')
+        {
+            int num_ltis = 0;
+            if (!from_string(num_ltis, argv->at(1)) || (num_ltis < 1))
+            {
+                return SetError("Expected a positive integer (number of ltms).");
+            }
+            thisAgent->SMem->benchmark_base_level(num_ltis);
+            return true;
+        }
+        else if (sub_command[0] == 'r')
+        {
+            /* Sourcing the file replaces every production, so make sure it
+             * can be read first, and keep the current net to put back if
+             * sourcing it fails part way */
+            FILE* lSource = fopen(argv->at(1).c_str(), "rb");
+            if (!lSource)
+            {
+                return SetError("Failed to open file for reading: " + argv->at(1));
+            }
+            fclose(lSource);
+
+            excise_all_productions_of_type(thisAgent, JUSTIFICATION_PRODUCTION_TYPE, false);
+            FILE* lSaved = tmpfile();
+            if (!lSaved || !save_rete_net(thisAgent, lSaved, RETE_NET_FORMAT_VERSION))
+            {
+                if (lSaved)
+                {
+                    fclose(lSaved);
+                }
+                return SetError("Could not save the current productions, so they were left in place.");
+            }
+
+            soar_timer lTimer;
+            excise_all_productions(thisAgent, false);
+            lTimer.start();
+            bool lSourced = DoSource(argv->at(1));
+            lTimer.stop();
+            if (!lSourced)
+            {
+                rewind(lSaved);
+                load_rete_net(thisAgent, lSaved);
+                fclose(lSaved);
+                return false;
+            }
+            fclose(lSaved);
+
+            benchmark_rete_net(thisAgent, lTimer.get_usec());
+            return true;
+        }
     }
     else if (numArgs == 2)
     {
@@ -133,10 +196,12 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
             std::string table_name = argv->at(2);
             if (database_name[0] == 'e')
             {
+                epmem_flush_writes(thisAgent);
                 thisAgent->EpMem->epmem_db->print_table(table_name.c_str());
             }
             else if (database_name[0] == 's')
             {
+                thisAgent->SMem->ltm_cache_flush();
                 thisAgent->SMem->DB->print_table(table_name.c_str());
             }
             else
@@ -169,6 +234,21 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
             thisAgent->symbolManager->print_internal_symbols();
             return true;
         }
+        else if (sub_command[0] == 's')
+        {
+            benchmark_symbol_tables(thisAgent, 100000);
+            return true;
+        }
+        else if (sub_command[0] == 'b')
+        {
+            thisAgent->SMem->benchmark_base_level(1000000);
+            return true;
+        }
+        else if (sub_command[0] == 'r')
+        {
+            benchmark_rete_net(thisAgent, 0);
+            return true;
+        }
         else if (sub_command[0] == 'p')
         {
 
@@ -190,8 +270,11 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
             PrintCLIMessage_Header("Debug Commands and Settings", 70);
 //            PrintCLIMessage_Section("Commands", 70);
             PrintCLIMessage_Justify("allocate [pool blocks]", "Allocates extra memory to a memory pool", 70);
+            PrintCLIMessage_Justify("base-level [ltms]", "Benchmarks smem base-level activation", 70);
             PrintCLIMessage_Justify("internal-symbols", "Prints symbol table", 70);
             PrintCLIMessage_Justify("port", "Prints listening port", 70);
+            PrintCLIMessage_Justify("rete-net [file]", "Benchmarks saving, loading and cloning rules", 70);
+            PrintCLIMessage_Justify("symbol-tables [keys]", "Benchmarks symbol table lookups", 70);
             PrintCLIMessage_Justify("time <command> [args]", "Executes command and prints time spent", 70);
     //        PrintCLIMessage_Section("Debug Database Storage", 60);
     //        PrintCLIMessage_Item("database:", l_OutputManager->m_params->database, 60);
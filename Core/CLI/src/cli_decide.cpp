@@ -741,16 +741,17 @@ bool CommandLineInterface::DoSelect(const std::string* pOp)
 
 bool CommandLineInterface::DoSRand(uint32_t* pSeed)
 {
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
     std::ostringstream lFeedback;
     if (pSeed)
     {
-        SoarSeedRNG(*pSeed);
+        SoarSeedRNG(thisAgent, *pSeed);
         lFeedback << "Random number generator seed set to " << (*pSeed);
 
     }
     else
     {
-        SoarSeedRNG();
+        SoarSeedRNG(thisAgent);
         lFeedback << "Random number generator seed set to new random value.";
     }
 
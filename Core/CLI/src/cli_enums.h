@@ -183,6 +183,8 @@ namespace cli
         STATS_DECISION,
         STATS_AGENT,
         STATS_EBC,
+        STATS_TIMELINE,
+        STATS_LATENCY,
         STATS_NUM_OPTIONS, // must be last
     };
     typedef std::bitset<STATS_NUM_OPTIONS> StatsBitset;
@@ -41,6 +41,13 @@ bool CommandLineInterface::DoEpMem(const char pOp, const std::string* pAttr, con
         PrintCLIMessage_Item("append:", thisAgent->EpMem->epmem_params->append_db, 40);
         PrintCLIMessage_Item("path:", thisAgent->EpMem->epmem_params->path, 40);
         PrintCLIMessage_Item("lazy-commit:", thisAgent->EpMem->epmem_params->lazy_commit, 40);
+        PrintCLIMessage_Item("write-behind:", thisAgent->EpMem->epmem_params->write_behind, 40);
+        PrintCLIMessage_Item("backend:", thisAgent->EpMem->epmem_params->backend, 40);
+        PrintCLIMessage_Section("Retention", 40);
+        PrintCLIMessage_Item("retention:", thisAgent->EpMem->epmem_params->retention, 40);
+        PrintCLIMessage_Item("retention-recent:", thisAgent->EpMem->epmem_params->retention_recent, 40);
+        PrintCLIMessage_Item("retention-stride:", thisAgent->EpMem->epmem_params->retention_stride, 40);
+        PrintCLIMessage_Item("retention-batch:", thisAgent->EpMem->epmem_params->retention_batch, 40);
         PrintCLIMessage_Section("Retrieval", 40);
         PrintCLIMessage_Item("balance:", thisAgent->EpMem->epmem_params->balance, 40);
         PrintCLIMessage_Item("graph-match:", thisAgent->EpMem->epmem_params->graph_match, 40);
@@ -49,6 +56,10 @@ bool CommandLineInterface::DoEpMem(const char pOp, const std::string* pAttr, con
         PrintCLIMessage_Item("page-size:", thisAgent->EpMem->epmem_params->page_size, 40);
         PrintCLIMessage_Item("cache-size:", thisAgent->EpMem->epmem_params->cache_size, 40);
         PrintCLIMessage_Item("optimization:", thisAgent->EpMem->epmem_params->opt, 40);
+        PrintCLIMessage_Item("interval-index:", thisAgent->EpMem->epmem_params->interval_index, 40);
+        PrintCLIMessage_Item("summaries:", thisAgent->EpMem->epmem_params->summaries, 40);
+        PrintCLIMessage_Item("summary-block:", thisAgent->EpMem->epmem_params->summary_block, 40);
+        PrintCLIMessage_Item("query-threads:", thisAgent->EpMem->epmem_params->query_threads, 40);
         PrintCLIMessage_Item("timers:", thisAgent->EpMem->epmem_params->timers, 40);
         PrintCLIMessage_Section("Experimental", 40);
         PrintCLIMessage_Item("merge:", thisAgent->EpMem->epmem_params->merge, 40);
@@ -222,6 +233,14 @@ bool CommandLineInterface::DoEpMem(const char pOp, const std::string* pAttr, con
             PrintCLIMessage_Item("Last Query Retrieved:", thisAgent->EpMem->epmem_stats->qry_ret, 40);
             PrintCLIMessage_Item("Last Query Cardinality:", thisAgent->EpMem->epmem_stats->qry_card, 40);
             PrintCLIMessage_Item("Last Query Literals:", thisAgent->EpMem->epmem_stats->qry_lits, 40);
+            PrintCLIMessage_Item("Last Query Index Intervals:", thisAgent->EpMem->epmem_stats->qry_index, 40);
+            PrintCLIMessage_Item("Last Query Threads:", thisAgent->EpMem->epmem_stats->qry_threads, 40);
+            PrintCLIMessage_Item("Last Query Pruned Blocks:", thisAgent->EpMem->epmem_stats->qry_pruned, 40);
+            PrintCLIMessage_Item("Compacted Through:", thisAgent->EpMem->epmem_stats->retention_through, 40);
+            PrintCLIMessage_Item("Episodes Dropped:", thisAgent->EpMem->epmem_stats->retention_dropped, 40);
+            PrintCLIMessage_Item("Bytes Reclaimed:", thisAgent->EpMem->epmem_stats->retention_reclaimed, 40);
+            PrintCLIMessage_Item("Log Flushes:", thisAgent->EpMem->epmem_stats->log_flushes, 40);
+            PrintCLIMessage_Item("Log Writes Superseded:", thisAgent->EpMem->epmem_stats->log_superseded, 40);
         }
         else
         {
@@ -456,8 +456,11 @@ void initdocstrings()
 		"                       Debug Commands and Settings\n"
 		"  ======================================================================\n"
 		"  allocate [pool blocks]         Allocates extra memory to a memory pool\n"
+		"  base-level [ltms]                Benchmarks smem base-level activation\n"
 		"  internal-symbols                                   Prints symbol table\n"
 		"  port                                             Prints listening port\n"
+		"  rete-net [file]           Benchmarks saving, loading and cloning rules\n"
+		"  symbol-tables [keys]                   Benchmarks symbol table lookups\n"
 		"  time <command> [args]           Executes command and prints time spent\n"
 		"\n"
 		"Sub-Commands\n"
@@ -482,6 +485,19 @@ void initdocstrings()
 		"Memory pool block size in this context is approximately 32 kilobytes, the exact\n"
 		"size determined during agent initialization.\n"
 		"\n"
+		"base-level\n"
+		"\n"
+		"  debug base-level [ltms]\n"
+		"\n"
+		"The base-level command builds a semantic memory of the given number of LTMs\n"
+		"(1000000 by default) with synthetic access histories in a scratch in-memory\n"
+		"database, then times computing all of their base-level activations one LTM\n"
+		"at a time through SQL, loading the in-memory history store, and the batched\n"
+		"kernel used by base-history-store, with and without base-fast-math. It also\n"
+		"reports how many exact batched results differ from the SQL path (there should\n"
+		"be none) and the largest error of the fast math. The agent's own semantic\n"
+		"memory is not affected.\n"
+		"\n"
 		"internal-symbols\n"
 		"\n"
 		"The internal-symbols command prints information about the Soar symbol table.\n"
@@ -492,6 +508,27 @@ void initdocstrings()
 		"\n"
 		"The port command prints the port the kernel instance is listening on.\n"
 		"\n"
+		"rete-net\n"
+		"\n"
+		"  debug rete-net [file]\n"
+		"\n"
+		"The rete-net command times saving the agent's rules with save rete-network and\n"
+		"loading them back, in both the old (version 4) and current (version 5) formats,\n"
+		"and cloning them into an agent with load rete-network --clone. If a file is\n"
+		"given, all rules are excised and the file is sourced first, and the time spent\n"
+		"sourcing it is shown for comparison. If the file can't be read the rules are\n"
+		"left alone, and if sourcing it fails the rules the agent had are put back.\n"
+		"Working memory is reinitialized.\n"
+		"\n"		"symbol-tables\n"
+		"\n"
+		"  debug symbol-tables [keys]\n"
+		"\n"
+		"The symbol-tables command times inserting, finding and removing the given\n"
+		"number of string and integer keys (100000 by default) in the open-addressing\n"
+		"tables Soar uses for its symbols, and in the older chained hash tables, so the\n"
+		"two can be compared on the current machine. The agent's own symbols are not\n"
+		"affected.\n"
+		"\n"
 		"time\n"
 		"\n"
 		"  debug time command [arguments]\n"
@@ -635,7 +672,9 @@ void initdocstrings()
 		"\n"
 		"Seeds the random number generator with the passed seed. Calling srand without\n"
 		"providing a seed will seed the generator based on the contents of /dev/urandom\n"
-		"(if available) or else based on time() and clock() values.\n"
+		"(if available) or else based on time() and clock() values. Each agent has its\n"
+		"own generator, so this only seeds the current agent's, and a seeded agent makes\n"
+		"the same random choices however other agents are run alongside it.\n"
 		"\n"
 		"srand example\n"
 		"\n"
@@ -733,6 +772,7 @@ void initdocstrings()
 		"           Controls whether database is\n"
 		"append     overwritten or appended when       on, off               off\n"
 		"           opening or re-initializing\n"
+		"backend    How new episodes are stored    sqlite, log           sqlite\n"
 		"           Linear weight of match cardinality\n"
 		"balance    (1) vs. working memory activation  [0, 1]                1\n"
 		"           (0) used in calculating match\n"
@@ -760,6 +800,8 @@ void initdocstrings()
 		"graph-match          Graph matching enabled   on, off              on\n"
 		"graph-match-ordering Ordering of identifiers  undefined, dfs, mcv  undefined\n"
 		"                     during graph match\n"
+		"interval-index       Keep wme intervals in    on, off              off\n"
+		"                     memory for retrievals\n"
 		"                     Delay writing semantic\n"
 		"lazy-commit          store changes to file    on, off              on\n"
 		"                     until agent exits\n"
@@ -767,7 +809,23 @@ void initdocstrings()
 		"                     data to disk\n"
 		"page-size            Size of each memory page 1k, 2k, 4k, 8k, 16k, 8k\n"
 		"                     used in the SQLite cache 32k, 64k\n"
+		"query-threads        Threads used for graph   1, 2, ...            1\n"
+		"                     match during retrievals\n"
+		"retention            Compact episodes older   on, off              off\n"
+		"                     than retention-recent\n"
+		"retention-batch      Old episodes compacted   1, 2, ...            100\n"
+		"                     per decision cycle\n"
+		"retention-recent     Number of most recent    1, 2, ...            10000\n"
+		"                     episodes kept in full\n"
+		"retention-stride     Keep every Nth older     0, 1, 2, ...         10\n"
+		"                     episode (0 keeps none)\n"
+		"summaries            Keep a filter of wmes    on, off              off\n"
+		"                     per block of episodes\n"
+		"summary-block        Episodes per summary     1, 2, ...            1024\n"
+		"                     block\n"
 		"timers               Timer granularity        off, one, two, three off\n"
+		"write-behind         Store episodes on a      on, off              off\n"
+		"                     background thread\n"
 		"\n"
 		"The learning parameter turns the episodic memory module on or off. When\n"
 		"learning is set to off, no new episodes are encoded and no commands put on the\n"
@@ -817,6 +875,52 @@ void initdocstrings()
 		"another SQLite process such as SQLiteMan. The lock can be relinquished by\n"
 		"setting the database to memory or another database and issuing init-soar/epmem\n"
 		"--init or by shutting down the Soar kernel.\n"
+		"When write-behind is on, the database writes that record each new episode are\n"
+		"handed to a background thread, so the agent can continue with the decision\n"
+		"cycle while they are stored. Unless lazy-commit is on, each episode is written\n"
+		"in its own transaction. Episodic memory waits for pending episodes to be\n"
+		"stored before it next uses the database (to record an episode, answer a\n"
+		"command, print or back up), so retrievals always see every recorded episode.\n"
+		"Changes take effect after the next database initialization.\n"
+		"When backend is log, new episodes are appended to a log in memory instead of\n"
+		"being written to the database as they are recorded. The log is indexed by\n"
+		"wme, so a wme that enters and leaves working memory before the log is stored\n"
+		"never has its now row written, and only the latest of a wme's last-episode\n"
+		"updates is kept. The log is stored in one transaction when episodic memory\n"
+		"next uses the database (to answer a command, print, back up, compact or close)\n"
+		"or when it grows large, so retrievals always see every recorded episode and\n"
+		"the database ends up the same as with the sqlite backend. Episodes still in\n"
+		"the log are lost if the process crashes, even with lazy-commit off. Changes\n"
+		"take effect after the next database initialization.\n"
+		"When interval-index is on, episodic memory keeps a copy of every stored wme\n"
+		"interval in memory and uses it, instead of SQL queries over the interval\n"
+		"tables, to find when cue wmes were in working memory during a retrieval. The\n"
+		"index is rebuilt from the database when it is opened, so it costs memory\n"
+		"proportional to the number of stored intervals and some time at startup.\n"
+		"Changes take effect after the next database initialization.\n"
+		"When query-threads is above 1, graph match binds the first few cue wmes on\n"
+		"the agent's thread and shares out the partial matches between that many\n"
+		"threads to complete. The threads are started the first time a retrieval\n"
+		"needs them and then wait for the next one. Retrievals return the same\n"
+		"episode, with the same mapping, as they do on one thread.\n"
+		"The retention parameter bounds how much history the episodic store keeps.\n"
+		"The most recent retention-recent episodes are always kept. Older episodes are\n"
+		"subsampled: only those whose id is a multiple of retention-stride survive, and\n"
+		"a stride of 0 drops them all. Old episodes are compacted retention-batch at a\n"
+		"time, in the decision cycle that the last of them becomes old, so the cost is\n"
+		"spread over the run and episodes held by the log backend or write-behind are\n"
+		"flushed once per batch. Kept episodes reconstruct exactly as before, and\n"
+		"cue-based retrievals only ever return kept episodes. Freed database pages are\n"
+		"reused by later storage, but the database file does not shrink on disk.\n"
+		"When summaries is on, episodic memory splits the episodes into blocks of\n"
+		"summary-block episodes and keeps a small Bloom filter per block of the\n"
+		"attribute/value pairs that were in working memory during it. Cue-based\n"
+		"retrievals use the filters to skip cue wmes that never occur in the episodes\n"
+		"they search, and stop early once no older block could hold a better match.\n"
+		"Retrievals return the same episode as without summaries. The filters are\n"
+		"rebuilt from the database when it is opened; changes take effect after the\n"
+		"next database initialization. Filters of blocks with many distinct wmes\n"
+		"become less selective, which makes them prune less but never wrongly.\n"
 		"The balance parameter sets the linear weight of match cardinality vs. cue\n"
 		"activation. As a performance optimization, when the value is 1 (default),\n"
 		"activation is not computed. If this value is not 1 (even close, such as 0.99),\n"
@@ -870,6 +974,25 @@ void initdocstrings()
 		"                                      retrieval\n"
 		"qry-lits       Last Query Literals    Number of literals in the DNF graph of\n"
 		"                                      last cue-based retrieval\n"
+		"qry-index      Last Query Index       Number of intervals the last cue-based\n"
+		"               Intervals              retrieval read from the interval index\n"
+		"                                      instead of the database\n"
+		"qry-threads    Last Query Threads     Number of threads that graph matched\n"
+		"                                      part of the last cue-based retrieval\n"
+		"qry-pruned     Last Query Pruned      Number of summary blocks the last\n"
+		"               Blocks                 cue-based retrieval ruled out without\n"
+		"                                      walking them\n"
+		"retention-through\n"
+		"               Compacted Through      Last old episode ID compacted by\n"
+		"                                      retention\n"
+		"retention-dropped\n"
+		"               Episodes Dropped       Number of episodes removed by retention\n"
+		"retention-reclaimed\n"
+		"               Bytes Reclaimed        Database bytes freed by retention\n"
+		"log-flushes    Log Flushes            Number of times the log backend has\n"
+		"                                      stored the episodes it held\n"
+		"log-superseded Log Writes Superseded  Number of writes the log backend dropped\n"
+		"                                      because a later episode replaced them\n"
 		"\n"
 		"Timers\n"
 		"\n"
@@ -896,6 +1019,7 @@ void initdocstrings()
 		"epmem_next          Determining next episode\n"
 		"epmem_prev          Determining previous episode\n"
 		"epmem_query         Cue-based query\n"
+		"epmem_retention     Compacting old episodes\n"
 		"epmem_storage       Encoding new episodes\n"
 		"epmem_trigger       Deciding whether new episodes should be encoded\n"
 		"epmem_wm_phase      Converting preference assertions to working memory changes\n"
@@ -1463,6 +1587,7 @@ void initdocstrings()
 		"  load library                    <filename> <args...>\n"
 		"  ------------------------------------------------------------\n"
 		"  load rete-network               --load <filename>\n"
+		"  load rete-network               --clone <agent>\n"
 		"  ------------------------------------------------------------\n"
 		"  load percepts                   --open <filename>\n"
 		"  load percepts                   --close\n"
@@ -1563,10 +1688,18 @@ void initdocstrings()
 		"automatically when it is saved and uncompressed when it is loaded. Compressed\n"
 		"files may not be portable to another platform if that platform does not support\n"
 		"the same uncompress utility.\n"
+		"Files saved by older versions of Soar (formats 3 and 4) can still be loaded.\n"
+		"\n"
+		"With --clone, the Rete net of another agent in the same kernel is copied into\n"
+		"this one without going through a file. The other agent keeps an in-memory image\n"
+		"of its net after the first clone, and every agent cloned from it shares that\n"
+		"image, so cloning many agents from the same rules is cheap until one of them\n"
+		"learns or excises a rule.\n"
 		"\n"
 		"Usage\n"
 		"\n"
 		"  load rete-network -l <filename>\n"
+		"  load rete-network -C <agent>\n"
 		"\n"
 		"load percepts\n"
 		"\n"
@@ -2138,6 +2271,9 @@ void initdocstrings()
 		"  ------------------------------------------------------------------\n"
 		"  production optimize-attribute [symbol [n]]\n"
 		"  ------------------------------------------------------------------\n"
+		"  production profile            [--enable --disable --clear]\n"
+		"  production profile            [n]\n"
+		"  ------------------------------------------------------------------\n"
 		"  production watch              [--disable --enable] <prod-name>\n"
 		"  ------------------------------------------------------------------\n"
 		"  For a detailed explanation of sub-commands:    help production\n"
@@ -2515,6 +2651,47 @@ void initdocstrings()
 		"\n"
 		"  production optimize-attribute thing 4\n"
 		"\n"
+		"profile\n"
+		"\n"
+		"Profile the match cost of each production.\n"
+		"\n"
+		"Synopsis\n"
+		"\n"
+		"  production profile [-e|d|c]\n"
+		"  production profile [number]\n"
+		"\n"
+		"Production Profile Options\n"
+		"\n"
+		"Option               Description\n"
+		"-e, --enable, --on   Start profiling the rete.\n"
+		"-d, --disable, --off Stop profiling the rete, keeping the profile so far.\n"
+		"-c, --clear          Throw away the profile so far.\n"
+		"number               Number of productions to print, most expensive first.\n"
+		"\n"
+		"Production Profile Description\n"
+		"\n"
+		"While the profiler is on, every addition to a beta node of the rete is\n"
+		"counted as a left or right activation of the node, along with the join\n"
+		"candidates it tests (token and wme pairs that pass the hash lookup and go on to\n"
+		"the join tests), the tokens it builds and the time spent in the node, not\n"
+		"counting the nodes below it. Removals are not profiled. The profiler is off by\n"
+		"default and costs next to nothing while off; while on, timing every activation\n"
+		"slows matching noticeably.\n"
+		"With no option, production profile prints the cost of every production that\n"
+		"has any, most expensive first, or only the first number of them. The cost of a\n"
+		"production is the cost of all of the nodes it uses, from its p-node up to the\n"
+		"top of the net and including its NCC subnetworks. A node shared by several\n"
+		"productions is split evenly among them, so counts may be fractional and the\n"
+		"costs of all productions add up to the cost of the whole net. Nodes that are\n"
+		"removed from the net, or merged or split as productions are added and excised,\n"
+		"lose their profile.\n"
+		"\n"
+		"Production Profile Example\n"
+		"\n"
+		"  production profile --enable\n"
+		"  run 100\n"
+		"  production profile 10\n"
+		"\n"
 		"watch\n"
 		"\n"
 		"Trace firings and retractions of specific productions.\n"
@@ -2936,6 +3113,7 @@ void initdocstrings()
 		"  smem --backup                                <filename>\n"
 		"  smem --clear\n"
 		"  smem --export                        <filename> [<LTI>]\n"
+		"  smem --import                                <filename>\n"
 		"  smem --init\n"
 		"  smem --query                           {(cue)* [<num>]}\n"
 		"  smem --remove                 { (id [^attr [value]])* }\n"
@@ -2949,12 +3127,20 @@ void initdocstrings()
 		"  base-decay                                          0.5\n"
 		"  base-update-policy                               stable\n"
 		"  base-incremental-threshes                            10\n"
+		"  base-history-store                                  off\n"
+		"  base-fast-math                                      off\n"
 		"  thresh                                              100\n"
+		"  spreading                                           off\n"
+		"  spreading-depth                                       2\n"
+		"  spreading-limit                                      20\n"
+		"  spreading-continue                                  0.9\n"
 		"  ------------- Database Optimization Settings ----------\n"
 		"  lazy-commit                                          on\n"
 		"  optimization                                performance\n"
 		"  cache-size                                        10000\n"
 		"  page-size                                            8k\n"
+		"  ltm-cache                                             0\n"
+		"  query-index                                         off\n"
 		"  ----------------- Timers and Statistics ---------------\n"
 		"  timers <detail>                                     off\n"
 		"  smem --timers                                 [<timer>]\n"
@@ -2964,8 +3150,10 @@ void initdocstrings()
 		"  Timers: smem_api, smem_hash, smem_init, smem_query,\n"
 		"          smem_ncb_retrieval, three_activation\n"
 		"          smem_storage, _total\n"
-		"  Stats:  act_updates, db-lib-version, edges, mem-usage,\n"
-		"          mem-high, nodes, queries, retrieves, stores\n"
+		"  Stats:  act_updates, db-lib-version, edges, ltm-cache-hits,\n"
+		"          ltm-cache-misses, ltm-cache-hit-rate, mem-usage,\n"
+		"          mem-high, nodes, queries, retrieves, spread-sources,\n"
+		"          spread-targets, stores\n"
 		"  -------------------------------------------------------\n"
 		"\n"
 		"  For a detailed explanation of these settings:             help smem\n"
@@ -2996,6 +3184,7 @@ void initdocstrings()
 		"-s, --set            Set parameter value\n"
 		"-c, --clear          Deletes all memories\n"
 		"-i, --init           Deletes all memories if append is off\n"
+		"-I, --import         Bulk loads a file of triples into semantic memory\n"
 		"-S, --stats          Print statistic summary or specific statistic\n"
 		"-t, --timers         Print timer summary or specific statistic\n"
 		"-a, --add            Add concepts to semantic memory\n"
@@ -3071,8 +3260,20 @@ void initdocstrings()
 		"base-incremental-  which base-level          1, 2, 3, ...              10\n"
 		"threshes           activation is re-computed\n"
 		"                   for old memories\n"
+		"base-history-store Keep activation histories on, off                   off\n"
+		"                   in memory\n"
+		"base-fast-math     Approximate pow/log in    on, off                   off\n"
+		"                   batched updates\n"
 		"thresh             Threshold for activation  0, 1, ...                 100\n"
 		"                   locality\n"
+		"spreading          Spread activation from    on, off                   off\n"
+		"                   LTMs in working memory\n"
+		"spreading-depth    Edges spread travels      1, 2, 3, ...              2\n"
+		"                   from a source\n"
+		"spreading-limit    Children of an LTM that   1, 2, 3, ...              20\n"
+		"                   receive spread\n"
+		"spreading-continue Fraction of spread passed [0, 1]                    0.9\n"
+		"                   on along each edge\n"
 		"\n"
 		"If activation-mode is base-level, three parameters control bias values. The\n"
 		"base-decay parameter sets the free decay parameter in the base-level model.\n"
@@ -3087,6 +3288,24 @@ void initdocstrings()
 		"updates a constant number of memories, those with last-access ages defined by\n"
 		"the base-incremental-threshes set.\n"
 		"\n"
+		"With base-history-store on, the access counts and histories of all LTMs are\n"
+		"loaded into memory the first time base-level activation is computed and kept\n"
+		"up to date alongside the database. Activation is then computed without reading\n"
+		"the history table, and the memories re-computed by the naive and incremental\n"
+		"policies are processed in a single batch, giving the same values as before.\n"
+		"Setting base-fast-math as well replaces pow and log in batched updates with\n"
+		"vectorized approximations that are faster and accurate to about 1e-9.\n"
+		"\n"
+		"With spreading on, every LTM instantiated in working memory spreads activation\n"
+		"to the LTMs it links to. A source gives each of its first spreading-limit LTM\n"
+		"children spreading-continue divided by its number of LTM children, and these\n"
+		"pass their share on in the same way, up to spreading-depth edges away. Queries\n"
+		"rank candidates by their activation plus the spread they receive. Sources are\n"
+		"tracked as working memory changes, and a query only walks out from the sources\n"
+		"that appeared since the last one (and withdraws the spread of those that left),\n"
+		"so its cost stays bounded however much of working memory comes from semantic\n"
+		"memory. Spreading parameters apply to sources as they appear.\n"
+		"\n"
 		"Performance Parameters\n"
 		"\n"
 		"Parameter    Description                  Possible values           Default\n"
@@ -3099,8 +3318,26 @@ void initdocstrings()
 		"             to disk\n"
 		"page-size    Size of each memory page     1k, 2k, 4k, 8k, 16k, 32k, 8k\n"
 		"             used in the SQLite cache     64k\n"
+		"ltm-cache    Number of LTMs kept in the   0, 1, 2, ...              0\n"
+		"             working-set cache\n"
+		"query-index  Answer queries from          on, off                   off\n"
+		"             in-memory posting lists\n"
 		"timers       Timer granularity            off, one, two, three      off\n"
 		"\n"
+		"When ltm-cache is above 0, semantic memory keeps the access counts, activation\n"
+		"history and augmentations of that many recently used LTMs in memory, evicting\n"
+		"with a CLOCK (second-chance) policy. Retrievals of cached LTMs skip the\n"
+		"database, and their activation changes are written back when semantic memory\n"
+		"commits, before a query or print reads them, and when they are evicted. The\n"
+		"ltm-cache-* statistics report how often lookups were served from the cache.\n"
+		"\n"
+		"When query-index is on, semantic memory keeps a posting list for every\n"
+		"attribute and attribute/value pair, ordered by activation, and answers queries\n"
+		"from it instead of from the database. The lists are built by the first query\n"
+		"and kept current as memories are stored and activated. Results are the same\n"
+		"as without the index; cues with many elements or with common attributes are\n"
+		"answered much faster, at the cost of memory for a copy of every edge.\n"
+		"\n"
 		"When the database is stored to disk, the lazy-commit and optimization\n"
 		"parameters control how often cached database changes are written to disk. These\n"
 		"parameters trade off safety in the case of a program crash with database\n"
@@ -3122,6 +3359,12 @@ void initdocstrings()
 		"                                  calculated\n"
 		"db-lib-version SQLite Version     SQLite library version\n"
 		"edges          Edges              Number of edges in the semantic store\n"
+		"ltm-cache-hits\n"
+		"               LTM Cache Hits     Number of LTM lookups served by ltm-cache\n"
+		"ltm-cache-misses\n"
+		"               LTM Cache Misses   Number of LTM lookups that read the database\n"
+		"ltm-cache-hit-rate\n"
+		"               LTM Cache Hit Rate Fraction of LTM lookups served by ltm-cache\n"
 		"mem-usage      Memory Usage       Current SQLite memory usage in bytes\n"
 		"mem-high       Memory Highwater   High SQLite memory usage watermark in bytes\n"
 		"nodes          Nodes              Number of nodes in the semantic store\n"
@@ -3129,6 +3372,9 @@ void initdocstrings()
 		"                                  issued\n"
 		"retrieves      Retrieves          Number of times the retrieve command has been\n"
 		"                                  issued\n"
+		"spread-sources Spread Sources     Number of LTMs in working memory spreading\n"
+		"                                  activation\n"
+		"spread-targets Spread Targets     Number of LTMs receiving spread\n"
 		"stores         Stores             Number of times the store command has been\n"
 		"                                  issued\n"
 		"\n"
@@ -3182,6 +3428,21 @@ void initdocstrings()
 		"children. Each child will be its own concept with two constant attribute/value\n"
 		"pairs.\n"
 		"\n"
+		"Large knowledge bases are better loaded with smem --import <filename>, which\n"
+		"reads one triple per line:\n"
+		"\n"
+		"  @1 ^name |grey heron|\n"
+		"  @1 ^isa @2\n"
+		"  @2 ^name bird\n"
+		"\n"
+		"The caret is optional, values can be constants or LTIs, and blank lines and\n"
+		"lines starting with # are ignored. LTIs are created with exactly the given\n"
+		"numbers if they do not exist yet, and edges already in the store are skipped.\n"
+		"The whole file is parsed before anything is stored, so an error leaves the\n"
+		"store unchanged. Edges are inserted with the store's indices dropped, and the\n"
+		"frequency counts used by queries are updated once at the end. As with --add,\n"
+		"imported memories are not activated.\n"
+		"\n"
 		"Manual Removal\n"
 		"\n"
 		"Part or all of the information in the semantic store of some LTI can be\n"
@@ -3282,9 +3543,11 @@ void initdocstrings()
 		"  max-memory-usage                      100000000    Threshold for memory\n"
 		"  warning\n"
 		"  max-gp                                    20000    Max rules gp can generate\n"
+		"  slow-dc-time                                  0    Log slow decisions\n"
 		"  stop-phase                                apply    Phase before which Soar\n"
 		"  stop\n"
 		"  tcl                                         off    Allow Tcl code in commands\n"
+		"  timeline                                    off    Record phase timings\n"
 		"  timers                                       on    Profile Soar\n"
 		"  wait-snc                                    off    Wait instead of impasse\n"
 		"  -----------------------------------------------\n"
@@ -3361,8 +3624,10 @@ void initdocstrings()
 		"max-memory-usage      > 0          100000000\n"
 		"max-nil-output-cycles > 0          15\n"
 		"o-support-mode        3 or 4       4\n"
+		"slow-dc-time          >= 0         0\n"
 		"stop-phase                         apply\n"
 		"tcl                   on or off    off\n"
+		"timeline              on or off    off\n"
 		"timers                on or off    on\n"
 		"wait-snc              >= 1         1\n"
 		"\n"
@@ -3435,6 +3700,14 @@ void initdocstrings()
 		"generate no output allowed when a run --out command is issued. After this limit\n"
 		"has been reached, Soar stops. The default initial setting of n is 15.\n"
 		"\n"
+		"slow-dc-time\n"
+		"\n"
+		"'slow-dc-time' sets a threshold, in microseconds, for logging slow decisions.\n"
+		"When a decision cycle takes at least this long, Soar notes the cycle, its time\n"
+		"and the phase that took the longest in it. Unlike max-dc-time, Soar keeps\n"
+		"running. stats --percentiles reports how many decisions were slow and lists\n"
+		"the most recent 16 of them. A value of 0, the default, logs nothing.\n"
+		"\n"
 		"stop-phase\n"
 		"\n"
 		"'stop-phase' allows the user to control which phase Soar stops in.\n"
@@ -3458,6 +3731,15 @@ void initdocstrings()
 		"that use tcl code.\n"
 		"Note that 'tcl off' is currently not supported due to memory issues.\n"
 		"\n"
+		"timeline\n"
+		"\n"
+		"'timeline' controls the decision cycle flight recorder. While it is on, each\n"
+		"agent keeps the begin and end times of its most recent 16384 phase and module\n"
+		"events (match, chunking, epmem, smem, wma, rl and client callbacks) in a\n"
+		"fixed-size ring, which holds roughly the last thousand decisions. Recording\n"
+		"costs a clock read per event, about a microsecond per decision, so it is off\n"
+		"by default. Use stats --timeline <file> to save the ring for a timeline viewer.\n"
+		"\n"
 		"timers\n"
 		"\n"
 		"This command is used to control the timers that collect internal profiling\n"
@@ -3637,6 +3919,8 @@ void initdocstrings()
 		"                 track in comma-separated form\n"
 		"-S, --sort N     sort the tracked cycle stats by column number N, see table\n"
 		"                 below\n"
+		"-p, --percentiles report the distribution of decision cycle and phase times\n"
+		"-L, --timeline F write the recent phase and module timeline to file F\n"
 		"\n"
 		"Tracked Cycle Stats Columns\n"
 		"\n"
@@ -3696,6 +3980,18 @@ void initdocstrings()
 		"--cycle, it may be sorted using the --sort argument and a column integer. Use\n"
 		"negative numbers for descending sort. Issue --stop-track to reset and clear\n"
 		"this data.\n"
+		"The --percentiles argument reports the mean, median, 90th, 99th and 99.9th\n"
+		"percentile and maximum of the wall clock and CPU time of each decision cycle\n"
+		"and of the wall clock time of each phase, in microseconds. Times are kept in\n"
+		"histograms accurate to within about 1.5%, are only collected while the soar\n"
+		"timers setting is on, and are cleared by --reset and init-soar. If soar slow-\n"
+		"dc-time is set, the slow decisions it logged are listed as well.\n"
+		"The --timeline argument writes the events recorded by the decision cycle\n"
+		"flight recorder (see soar timeline) to a file in the Chrome trace event JSON\n"
+		"format, which chrome://tracing, Perfetto and speedscope can display. Each\n"
+		"phase appears as a span with the module work done inside it nested below, and\n"
+		"every event carries the decision cycle it happened in, so an unusually long\n"
+		"decision can be found and broken down after the fact.\n"
 		"\n"
 		"A Note on Timers\n"
 		"\n"
@@ -4256,6 +4552,7 @@ void initdocstrings()
 		"                              decay-thresh  | forgetting\n"
 		"                              forget-wme    | max-pow-cache\n"
 		"                              petrov-approx | timers\n"
+		"                              decay-fast-math\n"
 		"  wm activation   --stats [<statistic>]\n"
 		"                     <statistic> = forgotten-wmes\n"
 		"  wm activation   --timers [<timer>]\n"
@@ -4350,6 +4647,7 @@ void initdocstrings()
 		"petrov-approx Enables the (Petrov 2006) long-tail       on, off         off\n"
 		"              approximation\n"
 		"timers        Timer granularity                         off, one        off\n"
+		"decay-fast-math Vectorize sums used for forgetting      on, off         off\n"
 		"\n"
 		"The decay-rate and decay-thresh parameters are entered as positive decimals,\n"
 		"but are internally converted to, and printed out as, negative.\n"
@@ -4374,6 +4672,12 @@ void initdocstrings()
 		"used by this cache. If max-pow-cache is much smaller than the result of the\n"
 		"equation above, you may experience somewhat degraded performance due to\n"
 		"relatively frequent system calls to pow.\n"
+		"With decay-fast-math on, forgetting (the check of whether a WME has fallen\n"
+		"below the threshold, and the search for the cycle it will) adds up each\n"
+		"history two entries at a time with SSE2. The terms are the same but are\n"
+		"summed in a different order, so a WME whose activation is within rounding of\n"
+		"the threshold may be forgotten a cycle early or late. Activation values\n"
+		"printed by print -i are always computed in the default order.\n"
 		"If forget-wme is lti and forgetting is on, only those WMEs whose id is a long-\n"
 		"term identifier at the decision of forgetting will be removed from working\n"
 		"memory. If, for instance, the id is stored to semantic memory after the\n"
@@ -342,6 +342,7 @@ bool CommandLineInterface::ParseReteLoad(std::vector< std::string >& argv)
     cli::Options opt;
     OptionsData optionsData[] =
     {
+        {'C', "clone",       OPTARG_REQUIRED},
         {'l', "load",        OPTARG_REQUIRED},
         {'r', "restore",    OPTARG_REQUIRED},
         {'s', "save",        OPTARG_REQUIRED},
@@ -350,6 +351,7 @@ bool CommandLineInterface::ParseReteLoad(std::vector< std::string >& argv)
 
     bool save = false;
     bool load = false;
+    bool clone = false;
     std::string filename;
 
     for (;;)
@@ -366,30 +368,39 @@ bool CommandLineInterface::ParseReteLoad(std::vector< std::string >& argv)
 
         switch (opt.GetOption())
         {
+            case 'C':
+                clone = true;
+                save = load = false;
+                filename = opt.GetOptionArgument();
+                break;
             case 'l':
             case 'r':
                 load = true;
-                save = false;
+                save = clone = false;
                 filename = opt.GetOptionArgument();
                 break;
             case 's':
                 save = true;
-                load = false;
+                load = clone = false;
                 filename = opt.GetOptionArgument();
                 break;
         }
     }
 
-    // Must have a save or load operation
-    if (!save && !load)
+    // Must have a save, load or clone operation
+    if (!save && !load && !clone)
     {
         return SetError("Invalid syntax for that command.");
     }
     if (opt.GetNonOptionArguments())
     {
-        return SetError("Please specify a file name.");
+        return SetError(clone ? "Please specify an agent name." : "Please specify a file name.");
     }
 
+    if (clone)
+    {
+        return DoReteNetClone(filename);
+    }
     return DoReteNet(save, filename);
 
 
@@ -585,7 +596,7 @@ bool CommandLineInterface::DoCaptureInput(eCaptureInputMode mode, bool autoflush
                 return SetError("File name required.");
             }
 
-            uint32_t seed = SoarRandInt();
+            uint32_t seed = SoarRandInt(m_pAgentSML->GetSoarAgent());
 
             if (!m_pAgentSML->StartCaptureInput(*pathname, autoflush, seed))
             {
@@ -621,9 +632,10 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
             return SetError("Open file failed.");
         }
 
-        if (! save_rete_net(thisAgent, file, true))
+        if (! save_rete_net(thisAgent, file))
         {
             // TODO: additional error information
+            fclose(file);
             return SetError("Rete save operation failed.");
         }
 
@@ -642,6 +654,7 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
         if (! load_rete_net(thisAgent, file))
         {
             // TODO: additional error information
+            fclose(file);
             return SetError("Rete load operation failed.");
         }
 
@@ -651,6 +664,23 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
     return true;
 }
 
+bool CommandLineInterface::DoReteNetClone(const std::string& agentName)
+{
+    AgentSML* pSourceAgentSML = m_pKernelSML->GetAgentSML(agentName.c_str());
+    if (!pSourceAgentSML)
+    {
+        return SetError("No agent named " + agentName + ".");
+    }
+
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    if (! clone_rete_net(thisAgent, pSourceAgentSML->GetSoarAgent()))
+    {
+        return SetError("Rete clone operation failed.");
+    }
+
+    return true;
+}
+
 bool CommandLineInterface::DoLoadLibrary(const std::string& libraryCommand)
 {
 
@@ -37,6 +37,7 @@ namespace cli
                 OptionsData optionsData[] =
                 {
                     {'c', "close", OPTARG_NONE},
+                    {'C', "clone", OPTARG_REQUIRED},
                     {'f', "flush", OPTARG_NONE},
                     {'o', "open", OPTARG_REQUIRED},
                     {'l', "load",        OPTARG_REQUIRED},
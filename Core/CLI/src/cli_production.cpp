@@ -76,6 +76,10 @@ bool CommandLineInterface::DoProduction(std::vector<std::string>& argv, const st
     {
         return ParseMultiAttributes(argv);
     }
+    else if (my_param == thisAgent->command_params->production_params->profile_cmd)
+    {
+        return ParseProfile(argv);
+    }
     else if (my_param == thisAgent->command_params->production_params->break_cmd)
     {
         return ParsePBreak(argv);
@@ -1948,3 +1952,127 @@ bool CommandLineInterface::ParseMemories(std::vector< std::string >& argv)
     // handle production/number cases
     return DoMemories(options, n);
 }
+
+bool CommandLineInterface::DoProfile(const char& mode, int n)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+
+    switch (mode)
+    {
+        case 'e':
+            set_rete_profiler(thisAgent, true);
+            return true;
+        case 'd':
+            set_rete_profiler(thisAgent, false);
+            return true;
+        case 'c':
+            clear_rete_profiler(thisAgent);
+            return true;
+    }
+
+    assert(mode == 'p');
+
+    std::vector< rete_production_profile > profiles;
+    get_rete_profile(thisAgent, profiles);
+
+    if (m_RawOutput)
+    {
+        m_Result << "Match cost profiler is " << (rete_profiler_enabled(thisAgent) ? "on" : "off") << ".";
+        if (profiles.empty())
+        {
+            m_Result << "  No match cost has been recorded.";
+            return true;
+        }
+        m_Result << "  Costs of shared nodes are split among their productions.\n\n";
+        m_Result << std::setw(12) << "Time (usec)" << std::setw(12) << "Left" << std::setw(12) << "Right"
+                 << std::setw(12) << "Candidates" << std::setw(12) << "Tokens" << "  Production\n";
+    }
+
+    int i = 0;
+    std::string temp;
+    std::streamsize oldPrecision = m_Result.precision();
+    for (std::vector< rete_production_profile >::iterator j = profiles.begin();
+            j != profiles.end() && (n == 0 || i < n);
+            ++j, ++i)
+    {
+        if (m_RawOutput)
+        {
+            m_Result << std::fixed << std::setprecision(1)
+                     << std::setw(12) << j->usec << std::setw(12) << j->left_activations << std::setw(12) << j->right_activations
+                     << std::setw(12) << j->join_candidates << std::setw(12) << j->tokens
+                     << "  " << j->prod->name->sc->name << "\n";
+        }
+        else
+        {
+            AppendArgTagFast(sml_Names::kParamName, sml_Names::kTypeString, j->prod->name->sc->name);
+            AppendArgTagFast(sml_Names::kParamProfileTime, sml_Names::kTypeDouble, to_string(j->usec, temp));
+            AppendArgTagFast(sml_Names::kParamProfileLeftActivations, sml_Names::kTypeDouble, to_string(j->left_activations, temp));
+            AppendArgTagFast(sml_Names::kParamProfileRightActivations, sml_Names::kTypeDouble, to_string(j->right_activations, temp));
+            AppendArgTagFast(sml_Names::kParamProfileJoinCandidates, sml_Names::kTypeDouble, to_string(j->join_candidates, temp));
+            AppendArgTagFast(sml_Names::kParamProfileTokens, sml_Names::kTypeDouble, to_string(j->tokens, temp));
+        }
+    }
+    m_Result.unsetf(std::ios_base::floatfield);
+    m_Result.precision(oldPrecision);
+    return true;
+}
+
+bool CommandLineInterface::ParseProfile(std::vector< std::string >& argv)
+{
+    cli::Options opt;
+    OptionsData optionsData[] =
+    {
+        {'c', "clear",      OPTARG_NONE},
+        {'d', "disable",    OPTARG_NONE},
+        {'e', "enable",     OPTARG_NONE},
+        {'d', "off",        OPTARG_NONE},
+        {'e', "on",         OPTARG_NONE},
+        {0, 0, OPTARG_NONE}
+    };
+
+    char mode = 'p';
+
+    for (;;)
+    {
+        if (!opt.ProcessOptions(argv, optionsData))
+        {
+            return SetError(opt.GetError().c_str());
+        }
+        ;
+        if (opt.GetOption() == -1)
+        {
+            break;
+        }
+
+        if (mode != 'p')
+        {
+            return SetError("Only one of --enable, --disable and --clear may be given.");
+        }
+        mode = static_cast<char>(opt.GetOption());
+    }
+
+    if (mode != 'p')
+    {
+        if (!opt.CheckNumNonOptArgs(1, 1))
+        {
+            return SetError("Invalid additional arguments.");
+        }
+        return DoProfile(mode);
+    }
+
+    // Max one additional argument, the number of productions to list
+    if (opt.GetNonOptionArguments() > 2)
+    {
+        return SetError("Syntax: production profile [--enable | --disable | --clear] [n]");
+    }
+
+    int n = 0;
+    if (opt.GetNonOptionArguments() == 2)
+    {
+        if (!from_string(n, argv[opt.GetArgument() - opt.GetNonOptionArguments() + 1]) || (n <= 0))
+        {
+            return SetError("Expected positive integer.");
+        }
+    }
+    return DoProfile(mode, n);
+}
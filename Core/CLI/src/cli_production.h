@@ -42,11 +42,15 @@ namespace cli
                     {'e', "clear",              OPTARG_NONE},
                     {'f', "count",              OPTARG_NONE},
                     {'d', "default",            OPTARG_NONE},
+                    {'D', "disable",            OPTARG_NONE},
+                    {'E', "enable",             OPTARG_NONE},
                     {'j', "justifications",     OPTARG_NONE},
                     {'l', "lhs",                OPTARG_NONE},
                     {'n', "names",              OPTARG_NONE},
                     {'o', "never-fired",        OPTARG_NONE},
                     {'q', "nochunks",           OPTARG_NONE},
+                    {'D', "off",                OPTARG_NONE},
+                    {'E', "on",                 OPTARG_NONE},
                     {'p', "print",              OPTARG_NONE},
                     {'r', "retractions",        OPTARG_NONE},
                     {'v', "rhs",                OPTARG_NONE},
@@ -145,6 +145,24 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pArg1, cons
         }
         return true;
     }
+    else if (pOp == 'I')
+    {
+        std::string err;
+        uint64_t num_imported = 0;
+        bool result = thisAgent->SMem->import_triples(pArg1->c_str(), &num_imported, &(err));
+
+        if (!result)
+        {
+            SetError("Error while importing knowledge: " + err);
+        }
+        else
+        {
+            tempString << "Imported " << num_imported << " new edges into semantic memory from " << pArg1->c_str();
+            PrintCLIMessage(&tempString);
+        }
+
+        return result;
+    }
     else if (pOp == 'h')
     {
         uint64_t lti_id = NIL;
@@ -310,6 +328,11 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pArg1, cons
             PrintCLIMessage_Item("Activation Updates:", thisAgent->SMem->statistics->act_updates, 40);
             PrintCLIMessage_Item("Nodes:", thisAgent->SMem->statistics->nodes, 40);
             PrintCLIMessage_Item("Edges:", thisAgent->SMem->statistics->edges, 40);
+            PrintCLIMessage_Item("LTM Cache Hits:", thisAgent->SMem->statistics->ltm_cache_hits, 40);
+            PrintCLIMessage_Item("LTM Cache Misses:", thisAgent->SMem->statistics->ltm_cache_misses, 40);
+            PrintCLIMessage_Item("LTM Cache Hit Rate:", thisAgent->SMem->statistics->ltm_cache_hit_rate, 40);
+            PrintCLIMessage_Item("Spread Sources:", thisAgent->SMem->statistics->spread_sources, 40);
+            PrintCLIMessage_Item("Spread Targets:", thisAgent->SMem->statistics->spread_targets, 40);
         }
         else
         {
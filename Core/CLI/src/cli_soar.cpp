@@ -26,6 +26,7 @@
 #include "explanation_memory.h"
 #include "output_manager.h"
 #include "print.h"
+#include "timeline.h"
 #include "xml.h"
 
 using namespace cli;
@@ -218,6 +219,12 @@ bool CommandLineInterface::DoSoar(const char pOp, const std::string* pArg1, cons
             thisAgent->outputManager->sprint_sf(tempString, "Timers are now %s.", thisAgent->timers_enabled ? "enabled" : "disabled");
             PrintCLIMessage(tempString.c_str());
         }
+        else if (my_param == thisAgent->Decider->params->timeline_enabled)
+        {
+            thisAgent->timeline->enabled = thisAgent->Decider->params->timeline_enabled->get_value();
+            thisAgent->outputManager->sprint_sf(tempString, "Timeline recording is now %s.", thisAgent->timeline->enabled ? "enabled" : "disabled");
+            PrintCLIMessage(tempString.c_str());
+        }
         else if (my_param == thisAgent->Decider->params->tcl_enabled)
         {
             if (thisAgent->Decider->params->tcl_enabled->get_value() == true)
@@ -265,6 +272,17 @@ bool CommandLineInterface::DoSoar(const char pOp, const std::string* pArg1, cons
                 PrintCLIMessage("Soar will no longer interrupt based on how how long a decision takes. (default)");
             }
         }
+        else if (my_param == thisAgent->Decider->params->slow_dc_time)
+        {
+            thisAgent->Decider->settings[DECIDER_SLOW_DC_TIME] = thisAgent->Decider->params->slow_dc_time->get_value();
+            if (thisAgent->Decider->settings[DECIDER_SLOW_DC_TIME] > 0)
+            {
+                thisAgent->outputManager->sprint_sf(tempString, "Soar will now log decisions that take %u microseconds or more.", thisAgent->Decider->settings[DECIDER_SLOW_DC_TIME]);
+                PrintCLIMessage(tempString.c_str());
+            } else {
+                PrintCLIMessage("Soar will no longer log slow decisions. (default)");
+            }
+        }
         else if (my_param == thisAgent->Decider->params->max_elaborations)
         {
             thisAgent->Decider->settings[DECIDER_MAX_ELABORATIONS] = thisAgent->Decider->params->max_elaborations->get_value();
@@ -16,11 +16,14 @@
 #include "sml_AgentSML.h"
 
 #include "agent.h"
+#include "decider.h"
 #include "explanation_memory.h"
+#include "output_manager.h"
 #include "print.h"
 #include "rete.h"
 #include "soar_db.h"
 #include "stats.h"
+#include "timeline.h"
 
 #include <iomanip>
 
@@ -29,7 +32,7 @@ extern const char* bnode_type_names[256];
 using namespace cli;
 using namespace sml;
 
-bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
+bool CommandLineInterface::DoStats(const StatsBitset& options, int sort, const std::string* pTimelineFile)
 {
 
     //soar_print_detailed_callback_stats();
@@ -41,6 +44,20 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
         return true;
     }
 
+    if (options.test(STATS_TIMELINE))
+    {
+        std::string err;
+        if (!thisAgent->timeline->dump(pTimelineFile->c_str(), err))
+        {
+            return SetError(err);
+        }
+
+        std::ostringstream tempString;
+        tempString << "Wrote " << thisAgent->timeline->size() << " timeline events to " << *pTimelineFile << ".";
+        PrintCLIMessage(&tempString);
+        return true;
+    }
+
     if (options.test(STATS_EBC))
     {
         thisAgent->explanationMemory->print_EBC_stats();
@@ -85,6 +102,10 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
     {
         GetMaxStats();
     }
+    if (options.test(STATS_LATENCY))
+    {
+        GetLatencyStats();
+    }
     if (options.test(STATS_RETE))
     {
         GetReteStats();
@@ -151,7 +172,7 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
         thisAgent->dc_stat_tracking = false;
     }
 
-    if ((!options.test(STATS_CYCLE) && !options.test(STATS_TRACK) && !options.test(STATS_STOP_TRACK) && !options.test(STATS_MEMORY) && !options.test(STATS_RETE) && !options.test(STATS_MAX) && !options.test(STATS_RESET))
+    if ((!options.test(STATS_CYCLE) && !options.test(STATS_TRACK) && !options.test(STATS_STOP_TRACK) && !options.test(STATS_MEMORY) && !options.test(STATS_RETE) && !options.test(STATS_MAX) && !options.test(STATS_LATENCY) && !options.test(STATS_RESET))
             || options.test(STATS_SYSTEM))
     {
         GetSystemStats();
@@ -231,6 +252,32 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleEpMemTimeValueSec,   sml_Names::kTypeDouble,    to_string(thisAgent->max_dc_epmem_time_sec, temp));
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleSMemTimeCycle,       sml_Names::kTypeInt,    to_string(thisAgent->max_dc_smem_time_cycle, temp));
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleSMemTimeValueSec,    sml_Names::kTypeDouble,    to_string(thisAgent->max_dc_smem_time_sec, temp));
+
+    decision_latency* latency = thisAgent->dc_latency;
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeCount,          sml_Names::kTypeInt,    to_string(latency->dc_wall.get_count(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeMeanUSec,       sml_Names::kTypeDouble, to_string(latency->dc_wall.get_mean(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeP50USec,        sml_Names::kTypeInt,    to_string(latency->dc_wall.get_percentile(50), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeP90USec,        sml_Names::kTypeInt,    to_string(latency->dc_wall.get_percentile(90), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeP99USec,        sml_Names::kTypeInt,    to_string(latency->dc_wall.get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeP999USec,       sml_Names::kTypeInt,    to_string(latency->dc_wall.get_percentile(99.9), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionTimeMaxUSec,        sml_Names::kTypeInt,    to_string(latency->dc_wall.get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionCPUTimeMeanUSec,    sml_Names::kTypeDouble, to_string(latency->dc_cpu.get_mean(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionCPUTimeP50USec,     sml_Names::kTypeInt,    to_string(latency->dc_cpu.get_percentile(50), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionCPUTimeP90USec,     sml_Names::kTypeInt,    to_string(latency->dc_cpu.get_percentile(90), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionCPUTimeP99USec,     sml_Names::kTypeInt,    to_string(latency->dc_cpu.get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionCPUTimeP999USec,    sml_Names::kTypeInt,    to_string(latency->dc_cpu.get_percentile(99.9), temp));
+    AppendArgTagFast(sml_Names::kParamStatsDecisionCPUTimeMaxUSec,     sml_Names::kTypeInt,    to_string(latency->dc_cpu.get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsP99TimeUSecInputPhase,      sml_Names::kTypeInt,    to_string(latency->phase_wall[INPUT_PHASE].get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsMaxTimeUSecInputPhase,      sml_Names::kTypeInt,    to_string(latency->phase_wall[INPUT_PHASE].get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsP99TimeUSecProposePhase,    sml_Names::kTypeInt,    to_string(latency->phase_wall[PROPOSE_PHASE].get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsMaxTimeUSecProposePhase,    sml_Names::kTypeInt,    to_string(latency->phase_wall[PROPOSE_PHASE].get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsP99TimeUSecDecisionPhase,   sml_Names::kTypeInt,    to_string(latency->phase_wall[DECISION_PHASE].get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsMaxTimeUSecDecisionPhase,   sml_Names::kTypeInt,    to_string(latency->phase_wall[DECISION_PHASE].get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsP99TimeUSecApplyPhase,      sml_Names::kTypeInt,    to_string(latency->phase_wall[APPLY_PHASE].get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsMaxTimeUSecApplyPhase,      sml_Names::kTypeInt,    to_string(latency->phase_wall[APPLY_PHASE].get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsP99TimeUSecOutputPhase,     sml_Names::kTypeInt,    to_string(latency->phase_wall[OUTPUT_PHASE].get_percentile(99), temp));
+    AppendArgTagFast(sml_Names::kParamStatsMaxTimeUSecOutputPhase,     sml_Names::kTypeInt,    to_string(latency->phase_wall[OUTPUT_PHASE].get_max(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsSlowDecisionCount,          sml_Names::kTypeInt,    to_string(latency->slow_count, temp));
 #endif // NO_TIMING_STUFF
 
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleWMChangesCycle,        sml_Names::kTypeInt,    to_string(thisAgent->max_dc_wm_changes_cycle, temp));
@@ -539,6 +586,78 @@ void CommandLineInterface::GetMaxStats()
 
 }
 
+void CommandLineInterface::GetLatencyStats()
+{
+#ifndef NO_TIMING_STUFF
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    decision_latency* latency = thisAgent->dc_latency;
+
+    m_Result << "Decision cycle time percentiles (usec) over " << latency->dc_wall.get_count() << " decisions:\n";
+    m_Result << "Time                  Mean        p50        p90        p99      p99.9        Max\n";
+    m_Result << "---------------- ---------- ---------- ---------- ---------- ---------- ----------\n";
+
+    latency_histogram* rows[NUM_PHASE_TYPES + 2];
+    const char* row_names[NUM_PHASE_TYPES + 2];
+    int num_rows = 0;
+
+    rows[num_rows] = &(latency->dc_wall);
+    row_names[num_rows++] = "Decision (wall)";
+    rows[num_rows] = &(latency->dc_cpu);
+    row_names[num_rows++] = "Decision (CPU)";
+
+    /* phases in decision cycle order; Soar 7 phases only if they ran */
+    top_level_phase phases[] = { INPUT_PHASE, PROPOSE_PHASE, PREFERENCE_PHASE, WM_PHASE, DECISION_PHASE, APPLY_PHASE, OUTPUT_PHASE };
+    for (int i = 0; i < NUM_PHASE_TYPES; i++)
+    {
+        if (latency->phase_wall[phases[i]].get_count() || ((phases[i] != PREFERENCE_PHASE) && (phases[i] != WM_PHASE)))
+        {
+            rows[num_rows] = &(latency->phase_wall[phases[i]]);
+            row_names[num_rows++] = thisAgent->outputManager->phase_to_string(phases[i]);
+        }
+    }
+
+    std::ios_base::fmtflags oldFlags = m_Result.flags();
+    std::streamsize oldPrecision = m_Result.precision();
+    for (int i = 0; i < num_rows; i++)
+    {
+        m_Result << std::setw(16) << std::left << row_names[i] << std::right
+                 << " " << std::setw(10) << std::fixed << std::setprecision(1) << rows[i]->get_mean()
+                 << " " << std::setw(10) << rows[i]->get_percentile(50)
+                 << " " << std::setw(10) << rows[i]->get_percentile(90)
+                 << " " << std::setw(10) << rows[i]->get_percentile(99)
+                 << " " << std::setw(10) << rows[i]->get_percentile(99.9)
+                 << " " << std::setw(10) << rows[i]->get_max() << "\n";
+    }
+    m_Result.flags(oldFlags);
+    m_Result.precision(oldPrecision);
+
+    if (thisAgent->Decider->settings[DECIDER_SLOW_DC_TIME] > 0)
+    {
+        m_Result << "\n" << latency->slow_count << " decisions took " << thisAgent->Decider->settings[DECIDER_SLOW_DC_TIME] << " usec or more";
+        if (latency->get_slow_count())
+        {
+            m_Result << ", most recent:\n";
+            m_Result << "Cycle       Time (usec) Slowest phase    Phase (usec)\n";
+            m_Result << "----------- ----------- ---------------- ------------\n";
+            for (uint64_t i = 0; i < latency->get_slow_count(); i++)
+            {
+                slow_decision* slow = latency->get_slow(i);
+                m_Result << std::setw(11) << std::left << slow->d_cycle << std::right
+                         << " " << std::setw(11) << slow->wall_usec
+                         << " " << std::setw(16) << std::left << thisAgent->outputManager->phase_to_string(slow->phase) << std::right
+                         << " " << std::setw(12) << slow->phase_usec << "\n";
+            }
+        }
+        else
+        {
+            m_Result << ".\n";
+        }
+    }
+#else
+    m_Result << "Decision cycle time percentiles are not available when Soar is built with NO_TIMING_STUFF.\n";
+#endif // NO_TIMING_STUFF
+}
+
 void CommandLineInterface::GetMemoryStats()
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
@@ -554,6 +673,7 @@ void CommandLineInterface::GetMemoryStats()
     m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[HASH_TABLE_MEM_USAGE] << " bytes for hash tables\n";
     m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[POOL_MEM_USAGE] << " bytes for various memory pools\n";
     m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[MISCELLANEOUS_MEM_USAGE] << " bytes for miscellaneous other things\n";
+    m_Result << std::setw(8) << Memory_Manager::Get_MPM().memory_for_usage[POOL_MEM_USAGE] << " bytes for container pools shared by all agents\n";
 
     GetMemoryPoolStatistics();
 }
@@ -653,6 +773,34 @@ void CommandLineInterface::GetReteStats()
              << thisAgent->num_null_right_activations << " null), "
              << thisAgent->num_left_activations << " left ("
              << thisAgent->num_null_left_activations << " null)\n";
+
+    /* --- token and right memory hash table occupancy --- */
+    rete_hash_table_stats ht_stats;
+    std::ios_base::fmtflags oldFlags = m_Result.flags();
+    std::streamsize oldPrecision = m_Result.precision();
+
+    m_Result << "\n Hash Table         Entries     Buckets   Used   Avg Chain   Max Chain   Resizes\n";
+    m_Result << "-----------------  ----------  ----------  -----  ----------  ----------  --------\n";
+    for (i = 0; i < 2; i++)
+    {
+        get_rete_hash_table_stats(thisAgent, (i == 0), &ht_stats);
+        m_Result << std::setw(17) << ((i == 0) ? "tokens (left)" : "right mems") << "  "
+                 << std::setw(10) << ht_stats.count << "  "
+                 << std::setw(10) << (ht_stats.size + ht_stats.old_size) << "  "
+                 << std::setw(4) << std::fixed << std::setprecision(0)
+                 << (100.0 * ht_stats.buckets_used / (ht_stats.size + ht_stats.old_size)) << "%  "
+                 << std::setw(10) << std::setprecision(2)
+                 << (ht_stats.buckets_used ? static_cast<double>(ht_stats.count) / ht_stats.buckets_used : 0.0) << "  "
+                 << std::setw(10) << ht_stats.longest_chain << "  "
+                 << std::setw(8) << ht_stats.num_resizes;
+        if (ht_stats.old_size)
+        {
+            m_Result << "  (resizing from " << ht_stats.old_size << " to " << ht_stats.size << " buckets)";
+        }
+        m_Result << "\n";
+    }
+    m_Result.flags(oldFlags);
+    m_Result.precision(oldPrecision);
 }
 
 
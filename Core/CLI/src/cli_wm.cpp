@@ -770,6 +770,18 @@ bool CommandLineInterface::DoWMA(const char pOp, const std::string* pAttr, const
         {
             AppendArgTagFast(sml_Names::kParamValue, sml_Names::kTypeString, temp.c_str());
         }
+        temp = "decay-fast-math: ";
+        temp2 = thisAgent->WM->wma_params->decay_fast_math->get_cstring();
+        temp += temp2;
+        delete temp2;
+        if (m_RawOutput)
+        {
+            m_Result << temp << "\n";
+        }
+        else
+        {
+            AppendArgTagFast(sml_Names::kParamValue, sml_Names::kTypeString, temp.c_str());
+        }
 
         //
 
@@ -1116,6 +1116,18 @@ bool Kernel::IsAgentValid(Agent* pAgent)
 *          kernel is destroyed.
 *************************************************************/
 Agent* Kernel::CreateAgent(char const* pAgentName)
+{
+    return CreateAgent(pAgentName, NULL) ;
+}
+
+/*************************************************************
+* @brief Creates a new Soar agent with the given name, whose
+*        productions are cloned from an existing agent.
+*
+* @returns A pointer to the new agent structure, or NULL if
+*          pRulesFromAgentName doesn't name an agent.
+*************************************************************/
+Agent* Kernel::CreateAgent(char const* pAgentName, char const* pRulesFromAgentName)
 {
     AnalyzeXML response ;
     Agent* agent = NULL ;
@@ -1132,7 +1144,17 @@ Agent* Kernel::CreateAgent(char const* pAgentName)
     }
 
     assert(GetConnection());
-    if (GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_CreateAgent, NULL, sml_Names::kParamName, pAgentName))
+    bool ok ;
+    if (pRulesFromAgentName)
+    {
+        ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_CreateAgent, NULL, sml_Names::kParamName, pAgentName, sml_Names::kParamRulesFrom, pRulesFromAgentName) ;
+    }
+    else
+    {
+        ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_CreateAgent, NULL, sml_Names::kParamName, pAgentName) ;
+    }
+
+    if (ok)
     {
         agent = MakeAgent(pAgentName) ;
     }
@@ -2410,6 +2432,31 @@ bool Kernel::SetInterruptCheckRate(int newRate)
     return ok ;
 }
 
+/*************************************************************
+* @brief Sets how many threads the kernel uses to step agents
+*        when several agents are run together.
+*
+* @param numThreads >= 1 (1 steps agents serially)
+*************************************************************/
+bool Kernel::SetAgentRunThreads(int numThreads)
+{
+    // Reject invalid thread counts
+    if (numThreads <= 0)
+    {
+        return false ;
+    }
+
+    AnalyzeXML response ;
+
+    // Convert int to a string
+    std::ostringstream ostr ;
+    ostr << numThreads ;
+
+    bool ok = GetConnection()->SendAgentCommand(&response, sml_Names::kCommand_SetAgentRunThreads, NULL, sml_Names::kParamValue, ostr.str().c_str()) ;
+
+    return ok ;
+}
+
 /*************************************************************
 * @brief The Soar kernel version is based on sending a request
 *        to the kernel asking for its version and returning the
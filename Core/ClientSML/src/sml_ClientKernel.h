@@ -439,6 +439,25 @@ namespace sml
             *************************************************************/
             Agent* CreateAgent(char const* pAgentName) ;
 
+            /*************************************************************
+            * @brief Creates a new Soar agent with the given name and the
+            *        same productions as the agent named pRulesFromAgentName,
+            *        without sourcing them again.
+            *
+            *        The productions are rebuilt from a saved image of the
+            *        other agent's rete net, which is kept and shared by every
+            *        agent created this way until one of them learns or
+            *        excises a rule.  Creating many agents from one rule base
+            *        this way only parses and saves the rules once.  Working
+            *        memory, settings and long-term memories are not copied.
+            *
+            * @returns A pointer to the agent, or NULL if pRulesFromAgentName
+            *          doesn't name an agent in this kernel or its productions
+            *          can't be copied (which is the case while it holds
+            *          justifications).  No agent is created in that case.
+            *************************************************************/
+            Agent* CreateAgent(char const* pAgentName, char const* pRulesFromAgentName) ;
+
             /*************************************************************
             * @brief Get the list of agents currently active in the kernel
             *        and create local Agent objects for each one (if we
@@ -754,6 +773,37 @@ namespace sml
             *************************************************************/
             bool SetInterruptCheckRate(int newRate) ;
 
+            /*************************************************************
+            * @brief Sets how many threads the kernel uses to step agents
+            *        when several agents are run together (e.g. RunAllAgents).
+            *
+            *        With one thread (the default) agents are stepped one after
+            *        another.  With more, agents are stepped concurrently
+            *        within each interleave step and the kernel then waits
+            *        for all of them before checking run counts and firing
+            *        the update world events, so the interleaving and
+            *        synchronization semantics are unchanged.
+            *
+            *        During a parallel run, agent event handlers (print, run,
+            *        output etc.) and client RHS functions are called on
+            *        whichever kernel thread is stepping that agent, not
+            *        necessarily the thread that called Run.  The kernel
+            *        passes them to clients one at a time, so two handlers
+            *        never run at once, but a handler that shares data with
+            *        other threads of the client must still lock it.  Kernel
+            *        wide events (system, update world) are still fired
+            *        between steps, on the same thread as in a serial run.
+            *
+            *        Each agent draws from its own random number generator,
+            *        so a seeded agent (srand) makes the same choices for any
+            *        number of threads.
+            *
+            *        This cannot be changed while agents are running.
+            *
+            * @param numThreads >= 1
+            *************************************************************/
+            bool SetAgentRunThreads(int numThreads) ;
+
             /*************************************************************
             * @brief Register a handler for a RHS (right hand side) function.
             *        This function can be called in the RHS of a production firing
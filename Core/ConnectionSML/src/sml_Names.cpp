@@ -236,6 +236,7 @@ char const* const sml_Names::kParamAgent            = "agent" ;
 char const* const sml_Names::kParamKernel           = "kernel" ;
 char const* const sml_Names::kParamThis             = "this" ;
 char const* const sml_Names::kParamName             = "name" ;
+char const* const sml_Names::kParamRulesFrom        = "rulesfrom" ;
 char const* const sml_Names::kParamFilename         = "filename" ;
 char const* const sml_Names::kParamLearning         = "learning" ;
 char const* const sml_Names::kParamOSupportMode     = "osupportmode" ;
@@ -381,6 +382,37 @@ char const* const sml_Names::kParamStatsMaxDecisionCycleSMemTimeCycle       = "s
 char const* const sml_Names::kParamStatsMaxDecisionCycleSMemTimeValueSec    = "statsmaxdecisioncyclesmemtimevaluesec" ;
 char const* const sml_Names::kParamStatsMaxDecisionCycleFireCountCycle      = "statsmaxdecisioncyclefirecountcycle" ;
 char const* const sml_Names::kParamStatsMaxDecisionCycleFireCountValue      = "statsmaxdecisioncyclefirecountvalue" ;
+char const* const sml_Names::kParamStatsDecisionTimeCount                   = "statsdecisiontimecount" ;
+char const* const sml_Names::kParamStatsDecisionTimeMeanUSec                = "statsdecisiontimemeanusec" ;
+char const* const sml_Names::kParamStatsDecisionTimeP50USec                 = "statsdecisiontimep50usec" ;
+char const* const sml_Names::kParamStatsDecisionTimeP90USec                 = "statsdecisiontimep90usec" ;
+char const* const sml_Names::kParamStatsDecisionTimeP99USec                 = "statsdecisiontimep99usec" ;
+char const* const sml_Names::kParamStatsDecisionTimeP999USec                = "statsdecisiontimep999usec" ;
+char const* const sml_Names::kParamStatsDecisionTimeMaxUSec                 = "statsdecisiontimemaxusec" ;
+char const* const sml_Names::kParamStatsDecisionCPUTimeMeanUSec             = "statsdecisioncputimemeanusec" ;
+char const* const sml_Names::kParamStatsDecisionCPUTimeP50USec              = "statsdecisioncputimep50usec" ;
+char const* const sml_Names::kParamStatsDecisionCPUTimeP90USec              = "statsdecisioncputimep90usec" ;
+char const* const sml_Names::kParamStatsDecisionCPUTimeP99USec              = "statsdecisioncputimep99usec" ;
+char const* const sml_Names::kParamStatsDecisionCPUTimeP999USec             = "statsdecisioncputimep999usec" ;
+char const* const sml_Names::kParamStatsDecisionCPUTimeMaxUSec              = "statsdecisioncputimemaxusec" ;
+char const* const sml_Names::kParamStatsP99TimeUSecInputPhase               = "statsp99timeusecinputphase" ;
+char const* const sml_Names::kParamStatsMaxTimeUSecInputPhase               = "statsmaxtimeusecinputphase" ;
+char const* const sml_Names::kParamStatsP99TimeUSecProposePhase             = "statsp99timeusecproposephase" ;
+char const* const sml_Names::kParamStatsMaxTimeUSecProposePhase             = "statsmaxtimeusecproposephase" ;
+char const* const sml_Names::kParamStatsP99TimeUSecDecisionPhase            = "statsp99timeusecdecisionphase" ;
+char const* const sml_Names::kParamStatsMaxTimeUSecDecisionPhase            = "statsmaxtimeusecdecisionphase" ;
+char const* const sml_Names::kParamStatsP99TimeUSecApplyPhase               = "statsp99timeusecapplyphase" ;
+char const* const sml_Names::kParamStatsMaxTimeUSecApplyPhase               = "statsmaxtimeusecapplyphase" ;
+char const* const sml_Names::kParamStatsP99TimeUSecOutputPhase              = "statsp99timeusecoutputphase" ;
+char const* const sml_Names::kParamStatsMaxTimeUSecOutputPhase              = "statsmaxtimeusecoutputphase" ;
+char const* const sml_Names::kParamStatsSlowDecisionCount                   = "statsslowdecisioncount" ;
+
+// Parameter names for production profile command
+char const* const sml_Names::kParamProfileTime                      = "profiletime";
+char const* const sml_Names::kParamProfileLeftActivations           = "profileleftactivations";
+char const* const sml_Names::kParamProfileRightActivations          = "profilerightactivations";
+char const* const sml_Names::kParamProfileJoinCandidates            = "profilejoincandidates";
+char const* const sml_Names::kParamProfileTokens                    = "profiletokens";
 
 // Parameter names for watch command
 char const* const sml_Names::kParamWatchDecisions                   = "watchdecisions";
@@ -425,6 +457,7 @@ char const* const sml_Names::kCommand_FireEvent             = "fire_event" ;
 char const* const sml_Names::kCommand_SuppressEvent         = "suppress_event" ;
 char const* const sml_Names::kCommand_CheckForIncomingCommands = "check_for_incoming_commands" ;
 char const* const sml_Names::kCommand_SetInterruptCheckRate = "set_interrupt_check_rate" ;
+char const* const sml_Names::kCommand_SetAgentRunThreads  = "set_agent_run_threads" ;
 char const* const sml_Names::kCommand_Shutdown              = "shutdown" ;
 char const* const sml_Names::kCommand_GetVersion            = "version" ;
 char const* const sml_Names::kCommand_IsSoarRunning         = "is_running" ;
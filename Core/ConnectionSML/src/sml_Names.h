@@ -234,6 +234,7 @@ namespace sml
             static char const* const kParamKernel ;
             static char const* const kParamThis ;
             static char const* const kParamName ;
+            static char const* const kParamRulesFrom ;
             static char const* const kParamFilename ;
             static char const* const kParamLearning ;
             static char const* const kParamOSupportMode ;
@@ -371,6 +372,37 @@ namespace sml
             static char const* const kParamStatsMaxDecisionCycleWMChangesValue;
             static char const* const kParamStatsMaxDecisionCycleFireCountCycle;
             static char const* const kParamStatsMaxDecisionCycleFireCountValue;
+            static char const* const kParamStatsDecisionTimeCount;
+            static char const* const kParamStatsDecisionTimeMeanUSec;
+            static char const* const kParamStatsDecisionTimeP50USec;
+            static char const* const kParamStatsDecisionTimeP90USec;
+            static char const* const kParamStatsDecisionTimeP99USec;
+            static char const* const kParamStatsDecisionTimeP999USec;
+            static char const* const kParamStatsDecisionTimeMaxUSec;
+            static char const* const kParamStatsDecisionCPUTimeMeanUSec;
+            static char const* const kParamStatsDecisionCPUTimeP50USec;
+            static char const* const kParamStatsDecisionCPUTimeP90USec;
+            static char const* const kParamStatsDecisionCPUTimeP99USec;
+            static char const* const kParamStatsDecisionCPUTimeP999USec;
+            static char const* const kParamStatsDecisionCPUTimeMaxUSec;
+            static char const* const kParamStatsP99TimeUSecInputPhase;
+            static char const* const kParamStatsMaxTimeUSecInputPhase;
+            static char const* const kParamStatsP99TimeUSecProposePhase;
+            static char const* const kParamStatsMaxTimeUSecProposePhase;
+            static char const* const kParamStatsP99TimeUSecDecisionPhase;
+            static char const* const kParamStatsMaxTimeUSecDecisionPhase;
+            static char const* const kParamStatsP99TimeUSecApplyPhase;
+            static char const* const kParamStatsMaxTimeUSecApplyPhase;
+            static char const* const kParamStatsP99TimeUSecOutputPhase;
+            static char const* const kParamStatsMaxTimeUSecOutputPhase;
+            static char const* const kParamStatsSlowDecisionCount;
+
+            // Parameter names for production profile command
+            static char const* const kParamProfileTime;
+            static char const* const kParamProfileLeftActivations;
+            static char const* const kParamProfileRightActivations;
+            static char const* const kParamProfileJoinCandidates;
+            static char const* const kParamProfileTokens;
 
             // Parameter names for watch command
             static char const* const kParamWatchDecisions;
@@ -415,6 +447,7 @@ namespace sml
             static char const* const kCommand_SuppressEvent ;
             static char const* const kCommand_CheckForIncomingCommands ;
             static char const* const kCommand_SetInterruptCheckRate ;
+            static char const* const kCommand_SetAgentRunThreads ;
             static char const* const kCommand_Shutdown ;
             static char const* const kCommand_GetVersion ;
             static char const* const kCommand_IsSoarRunning ;
@@ -1,6 +1,7 @@
 #include "src/KernelSMLInterface.cpp"
 #include "src/sml_AgentListener.cpp"
 #include "src/sml_AgentOutputFlusher.cpp"
+#include "src/sml_AgentRunThread.cpp"
 #include "src/sml_AgentSML.cpp"
 #include "src/sml_ConnectionManager.cpp"
 #include "src/sml_EventManager.cpp"
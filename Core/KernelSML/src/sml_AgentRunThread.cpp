@@ -0,0 +1,64 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// AgentRunThread class
+//
+// Used by the RunScheduler to step a share of the scheduled agents
+// on a worker thread.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_AgentRunThread.h"
+
+#include "sml_AgentSML.h"
+
+using namespace sml ;
+
+AgentRunThread::AgentRunThread()
+{
+    m_pAgents  = 0 ;
+    m_pResults = 0 ;
+    m_First    = 0 ;
+    m_Stride   = 1 ;
+    m_StepSize = sml_DECISION ;
+}
+
+void AgentRunThread::StartStep(std::vector<AgentSML*>* pAgents, std::vector<smlRunResult>* pResults, size_t first, size_t stride, smlRunStepSize stepSize)
+{
+    m_pAgents  = pAgents ;
+    m_pResults = pResults ;
+    m_First    = first ;
+    m_Stride   = stride ;
+    m_StepSize = stepSize ;
+
+    m_StepReady.TriggerEvent() ;
+}
+
+void AgentRunThread::WaitForStep()
+{
+    m_StepDone.WaitForEventForever() ;
+}
+
+void AgentRunThread::StepAgents(std::vector<AgentSML*>& agents, std::vector<smlRunResult>& results, size_t first, size_t stride, smlRunStepSize stepSize)
+{
+    for (size_t i = first ; i < agents.size() ; i += stride)
+    {
+        results[i] = agents[i]->StepInClientThread(stepSize) ;
+    }
+}
+
+void AgentRunThread::Run()
+{
+    while (!QuitNow())
+    {
+        // Wake up periodically so we notice a request to stop even if no more steps arrive
+        if (!m_StepReady.WaitForEvent(0, 100))
+        {
+            continue ;
+        }
+
+        StepAgents(*m_pAgents, *m_pResults, m_First, m_Stride, m_StepSize) ;
+
+        m_StepDone.TriggerEvent() ;
+    }
+}
@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////
+// AgentRunThread class
+//
+// Used by the RunScheduler to step a share of the scheduled agents
+// on a worker thread.  The scheduler hands each worker the same list
+// of agents and a stride, so worker k steps agents k, k + n, k + 2n...
+// and records each agent's result in the matching slot of the result list.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_AGENT_RUN_THREAD_H
+#define SML_AGENT_RUN_THREAD_H
+
+#include "thread_Thread.h"
+#include "thread_Event.h"
+#include "sml_Events.h"
+
+#include <vector>
+
+namespace sml
+{
+
+// Forward declarations
+    class AgentSML ;
+
+    class AgentRunThread : public soar_thread::Thread
+    {
+        protected:
+            // Signaled by the scheduler when there is a step to run
+            soar_thread::Event          m_StepReady ;
+
+            // Signaled by this thread when its share of the step is complete
+            soar_thread::Event          m_StepDone ;
+
+            std::vector<AgentSML*>*     m_pAgents ;
+            std::vector<smlRunResult>*  m_pResults ;
+            size_t                      m_First ;
+            size_t                      m_Stride ;
+            smlRunStepSize              m_StepSize ;
+
+            void Run() ;
+
+        public:
+            AgentRunThread() ;
+
+            /*************************************************************
+            * @brief    Asks this thread to step agents first, first + stride...
+            *           by stepSize.  Returns immediately; call WaitForStep()
+            *           before reading the results.
+            *************************************************************/
+            void StartStep(std::vector<AgentSML*>* pAgents, std::vector<smlRunResult>* pResults, size_t first, size_t stride, smlRunStepSize stepSize) ;
+
+            /*************************************************************
+            * @brief    Blocks until the step started by StartStep() is done.
+            *************************************************************/
+            void WaitForStep() ;
+
+            /*************************************************************
+            * @brief    Steps agents first, first + stride... on the calling thread.
+            *************************************************************/
+            static void StepAgents(std::vector<AgentSML*>& agents, std::vector<smlRunResult>& results, size_t first, size_t stride, smlRunStepSize stepSize) ;
+    } ;
+
+} // namespace
+
+#endif // SML_AGENT_RUN_THREAD_H
@@ -15,8 +15,15 @@
 
 #include "sml_AgentSML.h"
 
+#include <atomic>
+#include <mutex>
+
 using namespace sml ;
 
+static std::recursive_mutex s_EventDeliveryMutex ;
+// Read by every thread delivering an event, so the run scheduler can switch it while they step
+static std::atomic<bool> s_EventDeliveryConcurrent(false) ;
+
 /*
       soar_add_callback (GetSoarAgent(),static_cast<void*>(GetSoarAgent()),
                          static_cast<SOAR_CALLBACK_TYPE>(EnumRemappings::KernelRunEventType(eventId)),
@@ -33,3 +40,25 @@ void sml::flushPrintOnAgent(AgentSML* pFlushPrintOnThisAgent)
         pFlushPrintOnThisAgent->FlushPrintOutput();
     }
 }
+
+EventDeliveryLock::EventDeliveryLock()
+{
+    m_Locked = s_EventDeliveryConcurrent ;
+    if (m_Locked)
+    {
+        s_EventDeliveryMutex.lock() ;
+    }
+}
+
+EventDeliveryLock::~EventDeliveryLock()
+{
+    if (m_Locked)
+    {
+        s_EventDeliveryMutex.unlock() ;
+    }
+}
+
+void EventDeliveryLock::SetConcurrent(bool concurrent)
+{
+    s_EventDeliveryConcurrent = concurrent ;
+}
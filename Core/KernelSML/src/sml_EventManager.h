@@ -35,6 +35,22 @@ namespace sml
 // sml_AgentSML.h currently breaks things.
     void flushPrintOnAgent(AgentSML* pFlushPrintOnThisAgent);
     
+// While the run scheduler steps agents on several threads, events and RHS function calls
+// are still passed to clients one at a time, from whichever thread is stepping the agent.
+// An EventDeliveryLock holds the (recursive) lock for its lifetime, but only in that mode.
+    class EventDeliveryLock
+    {
+        public:
+            EventDeliveryLock() ;
+            ~EventDeliveryLock() ;
+            
+            // Set by the run scheduler while it has worker threads stepping agents
+            static void SetConcurrent(bool concurrent) ;
+            
+        private:
+            bool m_Locked ;
+    } ;
+    
     template<typename EventType> class EventManager : public KernelCallback
     {
         protected:
@@ -210,6 +226,7 @@ namespace sml
                 // must flush all print callbacks before pasing control to client in case
                 // handlers are expecting their text to be up to date (See bug 1100)
                 // this avoids using AgentSML in this file
+                EventDeliveryLock lock ;
                 flushPrintOnAgent(pFlushPrintOnThisAgent);
                 
                 ConnectionListIter connectionIter = begin ;
@@ -90,6 +90,8 @@ KernelSML::KernelSML(int portToListenOn)
     m_EchoCommands = false ;
     
     m_InterruptCheckRate = 10;
+    
+    m_AgentRunThreads = 1;
 }
 
 int KernelSML::GetListenerPort()
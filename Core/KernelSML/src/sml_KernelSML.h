@@ -138,6 +138,9 @@ namespace sml
             int             m_InterruptCheckRate;
             smlPhase        m_StopPoint ;
             
+            // Number of threads the run scheduler may use to step agents (1 means step them serially)
+            int             m_AgentRunThreads;
+            
         public:
             void SetStopPoint(bool forever, smlRunStepSize runStepSize, smlPhase m_StopBeforePhase);
             smlPhase GetStopPoint()
@@ -150,6 +153,11 @@ namespace sml
                 return m_InterruptCheckRate;
             }
             
+            int GetAgentRunThreads()
+            {
+                return m_AgentRunThreads;
+            }
+            
             /*************************************************************
             * @brief    Creates the singleton kernel object
             *           and starts listening for incoming commands on the
@@ -500,6 +508,7 @@ namespace sml
             bool HandleDestroyAgent(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleGetAgentList(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleSetInterruptCheckRate(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
+            bool HandleSetAgentRunThreads(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleFireEvent(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleSuppressEvent(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
             bool HandleGetVersion(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse) ;
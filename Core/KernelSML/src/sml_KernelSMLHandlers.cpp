@@ -32,6 +32,7 @@
 #include "debug.h"
 #include "io_link.h"
 #include "output_manager.h"
+#include "rete.h"
 #include "symbol.h"
 #include "symbol_manager.h"
 #include "working_memory.h"
@@ -79,6 +80,7 @@ void KernelSML::BuildCommandMap()
     m_CommandMap[sml_Names::kCommand_FireEvent]         = &sml::KernelSML::HandleFireEvent ;
     m_CommandMap[sml_Names::kCommand_SuppressEvent]     = &sml::KernelSML::HandleSuppressEvent ;
     m_CommandMap[sml_Names::kCommand_SetInterruptCheckRate] = &sml::KernelSML::HandleSetInterruptCheckRate ;
+    m_CommandMap[sml_Names::kCommand_SetAgentRunThreads]  = &sml::KernelSML::HandleSetAgentRunThreads ;
     m_CommandMap[sml_Names::kCommand_GetVersion]        = &sml::KernelSML::HandleGetVersion ;
     m_CommandMap[sml_Names::kCommand_Shutdown]          = &sml::KernelSML::HandleShutdown ;
     m_CommandMap[sml_Names::kCommand_IsSoarRunning]     = &sml::KernelSML::HandleIsSoarRunning ;
@@ -132,6 +134,26 @@ bool KernelSML::HandleCreateAgent(AgentSML* pAgentSML, char const* pCommandName,
         return InvalidArg(pConnection, pResponse, pCommandName, "Agent name missing") ;
     }
 
+    // Optionally, the agent whose productions the new agent starts with
+    char const* pRulesFrom = pIncoming->GetArgString(sml_Names::kParamRulesFrom) ;
+    AgentSML* pRulesFromAgentSML = NULL ;
+
+    if (pRulesFrom)
+    {
+        pRulesFromAgentSML = GetAgentSML(pRulesFrom) ;
+        if (!pRulesFromAgentSML)
+        {
+            return InvalidArg(pConnection, pResponse, pCommandName, "No agent to take productions from") ;
+        }
+
+        // Save that agent's net up front (it can't be saved while it holds
+        // justifications), so we fail before there is a new agent to clean up.
+        if (!take_rete_net_snapshot(pRulesFromAgentSML->GetSoarAgent()))
+        {
+            return InvalidArg(pConnection, pResponse, pCommandName, "Could not save the productions of the agent to take them from") ;
+        }
+    }
+
     agent* pSoarAgent = create_soar_agent(const_cast< char* >(pName));
 
     pAgentSML = new AgentSML(this, pSoarAgent) ;
@@ -144,6 +166,15 @@ bool KernelSML::HandleCreateAgent(AgentSML* pAgentSML, char const* pCommandName,
 
     pAgentSML->Init() ;
 
+    // Build the productions from the other agent's saved net, which is shared with
+    // every agent created from it.  An agent without the productions it asked for
+    // is of no use to the client, so if loading fails it is destroyed again.
+    if (pRulesFromAgentSML && !clone_rete_net(pSoarAgent, pRulesFromAgentSML->GetSoarAgent()))
+    {
+        pAgentSML->DeleteSelf() ;
+        return InvalidArg(pConnection, pResponse, pCommandName, "Could not load the productions of the agent to take them from") ;
+    }
+
     // Notify listeners that there is a new agent
     this->FireAgentEvent(pAgentSML, smlEVENT_AFTER_AGENT_CREATED) ;
 
@@ -752,6 +783,23 @@ bool KernelSML::HandleSetInterruptCheckRate(AgentSML* /*pAgentSML*/, char const*
     return true ;
 }
 
+// Controls how many threads the run scheduler uses to step agents
+bool KernelSML::HandleSetAgentRunThreads(AgentSML* /*pAgentSML*/, char const* /*pCommandName*/, Connection* /*pConnection*/, AnalyzeXML* pIncoming, soarxml::ElementXML* /*pResponse*/)
+{
+    // Get the parameters
+    int numThreads = pIncoming->GetArgInt(sml_Names::kParamValue, 1) ;
+
+    // The thread count is read when a run starts, so we can't change it part way through one.
+    if (numThreads < 1 || m_pRunScheduler->IsRunning())
+    {
+        return false ;
+    }
+
+    m_AgentRunThreads = numThreads;
+
+    return true ;
+}
+
 // Fire a particular event at the request of the client.
 bool KernelSML::HandleFireEvent(AgentSML* /*pAgentSML*/, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
 {
@@ -214,6 +214,9 @@ bool RhsListener::HandleFilterEvent(smlRhsEventId eventID, AgentSML* pAgent, cha
 bool RhsListener::HandleEvent(smlRhsEventId eventID, AgentSML* pAgent, bool commandLine, char const* pFunctionName, char const* pArgument,
                               int maxLengthReturnValue, char* pReturnValue)
 {
+    // Every agent shares the command line processor and the client connections
+    EventDeliveryLock lock ;
+    
     // If this should be handled by the command line processor do so now without going
     // out to the clients...we just handle this inside kernelSML.
     if (commandLine)
@@ -323,6 +326,7 @@ bool RhsListener::HandleEvent(smlRhsEventId eventID, AgentSML* pAgent, bool comm
 
 bool RhsListener::ExecuteRhsCommand(AgentSML* pAgentSML, smlRhsEventId eventID, std::string const& functionName, std::string const& arguments, std::string* pResultStr)
 {
+    EventDeliveryLock lock ;
     bool result = false ;
     
     // Get the list of connections (clients) who have registered to implement this right hand side (RHS) function.
@@ -17,8 +17,11 @@
 
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
+#include "sml_AgentRunThread.h"
 #include "sml_Events.h"
 
+#include "memory_manager.h"
+
 #include <assert.h>
 
 using namespace sml ;
@@ -31,6 +34,11 @@ RunScheduler::RunScheduler(KernelSML* pKernelSML)
     m_StopBeforePhase = sml_APPLY_PHASE ;
 }
 
+RunScheduler::~RunScheduler()
+{
+    StopRunThreads() ;
+}
+
 /*************************************************************
 * @brief    Each agent is set to either run or not when the
 *           next Run command is executed.
@@ -764,6 +772,15 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
     
     int interruptCheckRate = m_pKernelSML->GetInterruptCheckRate() ;
     
+    // Bring up (or take down) the worker threads used to step agents concurrently.
+    // While they're in use the memory manager shared by all agents has to lock,
+    // and events are delivered to clients one at a time.
+    StartRunThreads(m_pKernelSML->GetAgentRunThreads()) ;
+    Memory_Manager::Get_MPM().set_concurrent(!m_RunThreads.empty()) ;
+    EventDeliveryLock::SetConcurrent(!m_RunThreads.empty()) ;
+    std::vector<AgentSML*> stepAgents ;
+    std::vector<smlRunResult> stepResults ;
+    
     // If we need to synchronize agents, we'll set the synchAgent pointer.
     // Otherwise, we'll clear it to indicate no synch needed.
     // This only matters when interleaving by Phases, since SoarKernel methods
@@ -833,55 +850,48 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
             //    note that there is not a corresponding AFTER_AGENTS_RUN_STEP event...
             m_pKernelSML->FireSystemEvent(smlEVENT_BEFORE_AGENTS_RUN_STEP) ;
             
-            for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+            if (m_RunThreads.empty())
             {
-                AgentSML* pAgentSML = iter->second ;
-                
-                if (pAgentSML->IsAgentOnStepList())
+                for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
                 {
-                    // Run all agents one "interleaveStepSize".
-                    smlRunResult runResult = pAgentSML->StepInClientThread(interleaveStepSize) ;
-                    // ?? pAgentSML->IncrementLocalStepCounter();
-                    
-                    // halted and running agents will return an error from StepInClientThread
-                    //
+                    AgentSML* pAgentSML = iter->second ;
                     
-                    // if agent finished one runType, incr counter and remove from stepList
-                    if (pAgentSML->CompletedRunType(pAgentSML->GetRunCounter(runStepSize)) /* || pAgent->MaxNilOutputCyclesReached */)
-                    {
-                        pAgentSML->IncrementLocalRunCounter();
-                        pAgentSML->PutAgentOnStepList(false);
-                    }
-                    else
+                    if (pAgentSML->IsAgentOnStepList())
                     {
-                        runFinished = false;
-                    }
-                    
-                    // if agent finished count runTypes, remove from RunList, else runFinished = false;
-                    // can also return true if a gSKI_STOP_AFTER_DECISION_CYCLE interrupt occurred
-                    // or is pending on agents with RunType DECISION or FOREVER.
-                    bool agentFinishedRun = IsAgentFinished(pAgentSML, forever, runStepSize, count) ;
-                    
-                    // Have to test the run state to find out if we are still ok to keep running
-                    // (not sure if runResult provides this as well, but they're from different enums).
-                    smlRunState runState = pAgentSML->GetRunState() ;
-                    
-                    // An agent should return "stopped" if it's just pausing in the middle of a run
-                    // before we run it for the next phase.  Anything else means this agent is done running.
-                    if (runState != sml_RUNSTATE_STOPPED || agentFinishedRun)
-                    {
-                        pAgentSML->RemoveAgentFromRunList() ;
-                        pAgentSML->SetResultOfRun(runResult) ;
-                        // If we know we won't have to step to StopBefore phase
-                        // notify listeners that this agent is finished running
-                        if ((runStepSize != sml_DECISION) && !forever)
+                        // Run all agents one "interleaveStepSize".
+                        smlRunResult runResult = pAgentSML->StepInClientThread(interleaveStepSize) ;
+                        // ?? pAgentSML->IncrementLocalStepCounter();
+                        
+                        // halted and running agents will return an error from StepInClientThread
+                        //
+                        
+                        if (HandleAgentStepResult(pAgentSML, runResult, forever, runStepSize, count))
                         {
-                            pAgentSML->FireRunEvent(smlEVENT_AFTER_RUN_ENDS) ;
+                            runFinished = false ;
                         }
                     }
-                    else
+                }
+            }
+            else
+            {
+                // Step every agent on the step list one "interleaveStepSize" concurrently, then
+                // do the bookkeeping for each of them in the same order the serial loop would.
+                stepAgents.clear() ;
+                for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+                {
+                    if (iter->second->IsAgentOnStepList())
+                    {
+                        stepAgents.push_back(iter->second) ;
+                    }
+                }
+                stepResults.assign(stepAgents.size(), sml_RUN_COMPLETED) ;
+                
+                StepAgentsInParallel(stepAgents, stepResults, interleaveStepSize) ;
+                
+                for (size_t i = 0 ; i < stepAgents.size() ; i++)
+                {
+                    if (HandleAgentStepResult(stepAgents[i], stepResults[i], forever, runStepSize, count))
                     {
-                        // If at least one agent wants to keep running, we keep running.
                         runFinished = false ;
                     }
                 }
@@ -908,6 +918,8 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
     m_pKernelSML->FireSystemEvent(smlEVENT_SYSTEM_STOP) ;
     
     // clean up
+    Memory_Manager::Get_MPM().set_concurrent(false) ;
+    EventDeliveryLock::SetConcurrent(false) ;
     m_IsRunning = false ;
     
     // Clean up anything stored for update world events
@@ -920,3 +932,124 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
     
     return overallResult ;
 }
+
+/********************************************************************
+* @brief    Updates an agent's run counters and run list state after
+*           it has been stepped one interleave step.
+*
+* @return   true if the agent still needs to keep running.
+*********************************************************************/
+bool RunScheduler::HandleAgentStepResult(AgentSML* pAgentSML, smlRunResult runResult, bool forever, smlRunStepSize runStepSize, uint64_t count)
+{
+    bool keepRunning = false ;
+    
+    // if agent finished one runType, incr counter and remove from stepList
+    if (pAgentSML->CompletedRunType(pAgentSML->GetRunCounter(runStepSize)) /* || pAgent->MaxNilOutputCyclesReached */)
+    {
+        pAgentSML->IncrementLocalRunCounter();
+        pAgentSML->PutAgentOnStepList(false);
+    }
+    else
+    {
+        keepRunning = true ;
+    }
+    
+    // if agent finished count runTypes, remove from RunList, else runFinished = false;
+    // can also return true if a gSKI_STOP_AFTER_DECISION_CYCLE interrupt occurred
+    // or is pending on agents with RunType DECISION or FOREVER.
+    bool agentFinishedRun = IsAgentFinished(pAgentSML, forever, runStepSize, count) ;
+    
+    // Have to test the run state to find out if we are still ok to keep running
+    // (not sure if runResult provides this as well, but they're from different enums).
+    smlRunState runState = pAgentSML->GetRunState() ;
+    
+    // An agent should return "stopped" if it's just pausing in the middle of a run
+    // before we run it for the next phase.  Anything else means this agent is done running.
+    if (runState != sml_RUNSTATE_STOPPED || agentFinishedRun)
+    {
+        pAgentSML->RemoveAgentFromRunList() ;
+        pAgentSML->SetResultOfRun(runResult) ;
+        // If we know we won't have to step to StopBefore phase
+        // notify listeners that this agent is finished running
+        if ((runStepSize != sml_DECISION) && !forever)
+        {
+            pAgentSML->FireRunEvent(smlEVENT_AFTER_RUN_ENDS) ;
+        }
+    }
+    else
+    {
+        // If at least one agent wants to keep running, we keep running.
+        keepRunning = true ;
+    }
+    
+    return keepRunning ;
+}
+
+/********************************************************************
+* @brief    Makes sure there are numThreads - 1 worker threads available
+*           for stepping agents (this thread does a share of the work too).
+*           Threads are kept between runs, since environments often
+*           run agents one decision at a time.
+*********************************************************************/
+void RunScheduler::StartRunThreads(int numThreads)
+{
+    size_t numWorkers = (numThreads > 1) ? static_cast<size_t>(numThreads - 1) : 0 ;
+    
+    if (m_RunThreads.size() == numWorkers)
+    {
+        return ;
+    }
+    
+    StopRunThreads() ;
+    
+    for (size_t i = 0 ; i < numWorkers ; i++)
+    {
+        AgentRunThread* pThread = new AgentRunThread() ;
+        pThread->Start() ;
+        m_RunThreads.push_back(pThread) ;
+    }
+}
+
+void RunScheduler::StopRunThreads()
+{
+    for (size_t i = 0 ; i < m_RunThreads.size() ; i++)
+    {
+        m_RunThreads[i]->Stop(true) ;
+        delete m_RunThreads[i] ;
+    }
+    m_RunThreads.clear() ;
+}
+
+/********************************************************************
+* @brief    Steps each agent in the list by interleaveStepSize, sharing
+*           the agents out round robin between this thread and the
+*           worker threads, and waits until all of them are done.
+*           results[i] receives the run result for agents[i].
+*********************************************************************/
+void RunScheduler::StepAgentsInParallel(std::vector<AgentSML*>& agents, std::vector<smlRunResult>& results, smlRunStepSize interleaveStepSize)
+{
+    // No point waking up other threads for a single agent
+    size_t numWorkers = m_RunThreads.size() ;
+    if (agents.size() < 2)
+    {
+        numWorkers = 0 ;
+    }
+    else if (numWorkers > agents.size() - 1)
+    {
+        numWorkers = agents.size() - 1 ;
+    }
+    
+    size_t stride = numWorkers + 1 ;
+    
+    for (size_t i = 0 ; i < numWorkers ; i++)
+    {
+        m_RunThreads[i]->StartStep(&agents, &results, i + 1, stride, interleaveStepSize) ;
+    }
+    
+    AgentRunThread::StepAgents(agents, results, 0, stride, interleaveStepSize) ;
+    
+    for (size_t i = 0 ; i < numWorkers ; i++)
+    {
+        m_RunThreads[i]->WaitForStep() ;
+    }
+}
@@ -13,12 +13,15 @@
 
 #include "sml_Events.h"
 
+#include <vector>
+
 namespace sml
 {
 
 // Forward declarations
     class KernelSML ;
     class AgentSML ;
+    class AgentRunThread ;
     
     class RunScheduler
     {
@@ -34,8 +37,13 @@ namespace sml
             // When running multiple agents, we synchronize them to this agent (same phase) before starting the real run.
             AgentSML*   m_pSynchAgentSML ;
             
+            // Worker threads used to step agents concurrently.  The scheduler's own thread
+            // is the first "worker", so this holds KernelSML::GetAgentRunThreads() - 1 threads.
+            std::vector<AgentRunThread*> m_RunThreads ;
+            
         public:
             RunScheduler(KernelSML* pKernelSML) ;
+            ~RunScheduler() ;
             
             /********************************************************************
             * @brief    This is a method for getting the default value
@@ -131,6 +139,11 @@ namespace sml
             void            TerminateUpdateWorldEvents(bool removeListeners) ;
             void            TestForFiringUpdateWorldEvents();
             bool            TestIfAllFinished(bool forever, smlRunStepSize runStepSize, uint64_t count) ;
+            bool            HandleAgentStepResult(AgentSML* pAgentSML, smlRunResult runResult, bool forever, smlRunStepSize runStepSize, uint64_t count) ;
+            
+            void            StartRunThreads(int numThreads) ;
+            void            StopRunThreads() ;
+            void            StepAgentsInParallel(std::vector<AgentSML*>& agents, std::vector<smlRunResult>& results, smlRunStepSize interleaveStepSize) ;
             
             AgentSML*       GetAgentToSynchronizeWith() ;
     } ;
@@ -63,12 +63,16 @@
 #include <semantic_memory.cpp>
 #include <slot.cpp>
 #include <smem_activation.cpp>
+#include <smem_cache.cpp>
 #include <smem_cli_commands.cpp>
 #include <smem_db.cpp>
+#include <smem_import.cpp>
+#include <smem_index.cpp>
 #include <smem_instance.cpp>
 #include <smem_print.cpp>
 #include <smem_query.cpp>
 #include <smem_settings.cpp>
+#include <smem_spreading.cpp>
 #include <smem_store.cpp>
 #include <smem_timers.cpp>
 #include <soar_db.cpp>
@@ -78,8 +82,10 @@
 #include <soar_to_string.cpp>
 #include <stats.cpp>
 #include <symbol_manager.cpp>
+#include <symbol_table.cpp>
 #include <symbol.cpp>
 #include <test.cpp>
+#include <timeline.cpp>
 #include <trace.cpp>
 #include <visualize.cpp>
 #include <visualize_colors.cpp>
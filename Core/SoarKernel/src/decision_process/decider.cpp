@@ -46,7 +46,7 @@ void SoarDecider::get_enabled_module_strings(std::string &enabledStr, std::strin
     #endif
     bool rlEnabled = rl_enabled(thisAgent);
     bool wmaEnabled = wma_enabled(thisAgent);
-    bool spreadingEnabled = false;
+    bool spreadingEnabled = thisAgent->SMem->spreading_enabled();
     enabledStr = "Core";
     bool notFirstEnabledItem = true, notFirstDisabledItem = false;
     if (ebcEnabled)
@@ -11,6 +11,7 @@
 #include "decider.h"
 #include "ebc.h"
 #include "output_manager.h"
+#include "timeline.h"
 
 //#include "sml_Names.h"
 //#include "sml_AgentSML.h"
@@ -22,6 +23,7 @@ decider_param_container::decider_param_container(agent* new_agent, uint64_t pDec
     pDecider_settings[DECIDER_KEEP_TOP_OPREFS] = false;
     pDecider_settings[DECIDER_MAX_GP] = 20000;
     pDecider_settings[DECIDER_MAX_DC_TIME] = 0;
+    pDecider_settings[DECIDER_SLOW_DC_TIME] = 0;
     pDecider_settings[DECIDER_MAX_ELABORATIONS] = 100;
     pDecider_settings[DECIDER_MAX_GOAL_DEPTH] = 100;
     pDecider_settings[DECIDER_MAX_MEMORY_USAGE] = 100000000;
@@ -52,8 +54,12 @@ decider_param_container::decider_param_container(agent* new_agent, uint64_t pDec
     add(max_memory_usage);
     max_nil_output_cycles = new soar_module::integer_param("max-nil-output-cycles", pDecider_settings[DECIDER_MAX_NIL_OUTPUT_CYCLES], new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
     add(max_nil_output_cycles);
+    slow_dc_time = new soar_module::integer_param("slow-dc-time", pDecider_settings[DECIDER_SLOW_DC_TIME], new soar_module::gt_predicate<int64_t>(0, true), new soar_module::f_predicate<int64_t>());
+    add(slow_dc_time);
     tcl_enabled = new soar_module::boolean_param("tcl", Soar_Instance::Get_Soar_Instance().is_Tcl_on() ? on : off, new soar_module::f_predicate<boolean>());
     add(tcl_enabled);
+    timeline_enabled = new soar_module::boolean_param("timeline", new_agent->timeline->enabled ? on : off, new soar_module::f_predicate<boolean>());
+    add(timeline_enabled);
     timers_enabled = new soar_module::boolean_param("timers", new_agent->timers_enabled ? on : off, new soar_module::f_predicate<boolean>());
     add(timers_enabled);
     wait_snc = new soar_module::boolean_param("wait-snc", pDecider_settings[DECIDER_WAIT_SNC] ? on : off, new soar_module::f_predicate<boolean>());
@@ -134,8 +140,10 @@ void decider_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-dc-time", max_dc_time->get_string(), 47).c_str(), "Interrupt decision after this much time");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-memory-usage", max_memory_usage->get_string(), 47).c_str(), "Threshold for memory warning (see help)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-gp", max_gp->get_string(), 47).c_str(), "Maximum rules gp can generate");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("slow-dc-time", slow_dc_time->get_string(), 47).c_str(), "Log the slowest phase of decisions over this time");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("stop-phase", stop_phase->get_string(), 47).c_str(), "Phase before which Soar will stop");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("tcl", tcl_enabled->get_string(), 47).c_str(), "Allow Tcl code in commands");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("timeline", timeline_enabled->get_string(), 47).c_str(), "Record recent phase timings (see stats --timeline)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("timers", timers_enabled->get_string(), 47).c_str(), "Profile where Soar spends its time");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("wait-snc", wait_snc->get_string(), 47).c_str(), "Wait instead of impasse after state-no-change");
     outputManager->printa(thisAgent, "-----------------------------------------------\n");
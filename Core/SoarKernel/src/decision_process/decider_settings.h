@@ -25,7 +25,9 @@ class decider_param_container: public soar_module::param_container
         soar_module::integer_param* max_goal_depth;
         soar_module::integer_param* max_memory_usage;
         soar_module::integer_param* max_nil_output_cycles;
+        soar_module::integer_param* slow_dc_time;
         soar_module::boolean_param* tcl_enabled;
+        soar_module::boolean_param* timeline_enabled;
         soar_module::boolean_param* timers_enabled;
         soar_module::boolean_param* wait_snc;
 
@@ -11,6 +11,7 @@
 #include "instantiation.h"
 #include "lexer.h"
 #include "mem.h"
+#include "misc.h"
 #include "output_manager.h"
 #include "preference.h"
 #include "print.h"
@@ -28,9 +29,23 @@
 #include "working_memory.h"
 #include "xml.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <mutex>
 #include <sstream>
 #include <stdlib.h>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+    #define RETE_USE_SSE2
+    #include <emmintrin.h>
+#endif
 
 /*************************************************************************
  *
@@ -442,60 +457,248 @@ inline void new_left_token(token* New, rete_node* current_node,
             Structures and Declarations:  Memory Hash Tables
 
    Tokens and alpha memory entries (right memory's) as stored in two
-   global hash tables.  Unlike most hash tables in Soar, these two tables
-   are not dynamically resized -- their size is fixed at compile-time.
+   global hash tables.  Both start small and are resized as the number
+   of entries changes:  they double when there is more than one entry
+   per bucket and halve when there is less than one entry per eight
+   buckets.
+
+   A resize only allocates the new bucket array.  The entries are moved
+   over incrementally by update_rete_hash_tables(), which is called
+   before each WME is added to or removed from the rete, i.e. never while
+   a match routine is walking a bucket.  Each call moves a fixed number
+   of buckets plus two for every insert or remove done since the last
+   call, so the cost of a resize is spread across the rete work that
+   caused it.  A new resize isn't started until the previous one is done.
 ---------------------------------------------------------------------- */
 
-/* --- Hash table sizes (actual sizes are powers of 2) --- */
-#define LOG2_LEFT_HT_SIZE 14
-#define LOG2_RIGHT_HT_SIZE 14
+#define LOG2_MIN_RETE_HT_SIZE 8
+#define RETE_HT_MIGRATE_STEP 16
 
-#define LEFT_HT_SIZE (1 << LOG2_LEFT_HT_SIZE)
-#define RIGHT_HT_SIZE (1 << LOG2_RIGHT_HT_SIZE)
-
-#define LEFT_HT_MASK (LEFT_HT_SIZE - 1)
-#define RIGHT_HT_MASK (RIGHT_HT_SIZE - 1)
-
-
-/* --- Given the hash value (hv), get contents of bucket header cell ---
-#define left_ht_bucket(hv) \
-  (* ( ((token **) thisAgent->left_ht) + ((hv) & LEFT_HT_MASK)))
-#define right_ht_bucket(hv) \
-  (* ( ((right_mem **) thisAgent->right_ht) + ((hv) & RIGHT_HT_MASK)))
-*/
+/* --- Returns the bucket header cell for the given hash value (hv) --- */
+inline void** rete_ht_header(rete_hash_table* ht, uint32_t hv)
+{
+    if (ht->old_buckets && ((hv & ht->old_mask) >= ht->next_old_bucket))
+    {
+        return ht->old_buckets + (hv & ht->old_mask);
+    }
+    return ht->buckets + (hv & ht->mask);
+}
 
 /* The return value is modified by the calling function,
    hence the call by reference, */
 inline token*& left_ht_bucket(agent* thisAgent, uint32_t hv)
 {
-    return * (reinterpret_cast<token**>(thisAgent->left_ht) + (hv & LEFT_HT_MASK));
+    return * reinterpret_cast<token**>(rete_ht_header(thisAgent->left_ht, hv));
 }
 
 inline right_mem* right_ht_bucket(agent* thisAgent, uint32_t hv)
 {
-    return * (reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK));
+    return * reinterpret_cast<right_mem**>(rete_ht_header(thisAgent->right_ht, hv));
 }
 
-/*#define insert_token_into_left_ht(tok,hv) { \
-  token **header_zy37; \
-  header_zy37 = ((token **) thisAgent->left_ht) + ((hv) & LEFT_HT_MASK); \
-  insert_at_head_of_dll (*header_zy37, (tok), \
-                         a.ht.next_in_bucket, a.ht.prev_in_bucket); }*/
 inline void insert_token_into_left_ht(agent* thisAgent, token* tok, uint32_t hv)
 {
     token** header_zy37;
-    header_zy37 = reinterpret_cast<token**>(thisAgent->left_ht) + (hv & LEFT_HT_MASK);
+    header_zy37 = reinterpret_cast<token**>(rete_ht_header(thisAgent->left_ht, hv));
     insert_at_head_of_dll(*header_zy37, tok,
                           a.ht.next_in_bucket, a.ht.prev_in_bucket);
+    thisAgent->left_ht->count++;
+    thisAgent->left_ht->changes_since_step++;
 }
 
-/*#define remove_token_from_left_ht(tok,hv) { \
-  fast_remove_from_dll (left_ht_bucket(hv), tok, token, \
-                        a.ht.next_in_bucket, a.ht.prev_in_bucket); }*/
 inline void remove_token_from_left_ht(agent* thisAgent, token* tok, uint32_t hv)
 {
     fast_remove_from_dll(left_ht_bucket(thisAgent, hv), tok, token,
                          a.ht.next_in_bucket, a.ht.prev_in_bucket);
+    thisAgent->left_ht->count--;
+    thisAgent->left_ht->changes_since_step++;
+}
+
+/* --- Recomputes the hash value an entry was inserted with, so it can be
+   moved to a new bucket array.  CN tokens hash on their parent token and
+   wme; all other tokens on their node and (if hashed) referent. --- */
+inline uint32_t rete_ht_hash_value(token* tok)
+{
+    if (tok->node->node_type == CN_BNODE)
+    {
+        return tok->node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok->parent) ^ cast_and_possibly_truncate<uint32_t>(tok->w);
+    }
+    return tok->node->node_id ^ (tok->a.ht.referent ? tok->a.ht.referent->hash_id : 0);
+}
+
+inline uint32_t rete_ht_hash_value(right_mem* rm)
+{
+    return rm->am->am_id ^ rm->w->id->hash_id;
+}
+
+inline token*& next_in_rete_ht(token* tok) { return tok->a.ht.next_in_bucket; }
+inline token*& prev_in_rete_ht(token* tok) { return tok->a.ht.prev_in_bucket; }
+inline right_mem*& next_in_rete_ht(right_mem* rm) { return rm->next_in_bucket; }
+inline right_mem*& prev_in_rete_ht(right_mem* rm) { return rm->prev_in_bucket; }
+
+rete_hash_table* make_rete_hash_table(agent* thisAgent)
+{
+    rete_hash_table* ht;
+
+    ht = static_cast<rete_hash_table*>(thisAgent->memoryManager->allocate_memory(sizeof(rete_hash_table), HASH_TABLE_MEM_USAGE));
+    ht->mask = (1 << LOG2_MIN_RETE_HT_SIZE) - 1;
+    ht->buckets = static_cast<void**>(thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(void*) * (ht->mask + 1), HASH_TABLE_MEM_USAGE));
+    ht->old_buckets = NIL;
+    ht->old_mask = 0;
+    ht->next_old_bucket = 0;
+    ht->count = 0;
+    ht->changes_since_step = 0;
+    ht->num_resizes = 0;
+    return ht;
+}
+
+void free_rete_hash_table(agent* thisAgent, rete_hash_table* ht)
+{
+    if (ht->old_buckets)
+    {
+        thisAgent->memoryManager->free_memory(ht->old_buckets, HASH_TABLE_MEM_USAGE);
+    }
+    thisAgent->memoryManager->free_memory(ht->buckets, HASH_TABLE_MEM_USAGE);
+    thisAgent->memoryManager->free_memory(ht, HASH_TABLE_MEM_USAGE);
+}
+
+void free_rete_hash_tables(agent* thisAgent)
+{
+    free_rete_hash_table(thisAgent, thisAgent->left_ht);
+    free_rete_hash_table(thisAgent, thisAgent->right_ht);
+}
+
+/* --- Moves the entries in the next few old buckets into the current
+   array.  Each old chain is moved tail first, so entries with the same
+   hash value keep their order and the match routines see them in the
+   same order as before the resize.  This works whether the table is
+   growing or shrinking. --- */
+template <typename T>
+void migrate_rete_hash_table(agent* thisAgent, rete_hash_table* ht)
+{
+    uint64_t lBuckets;
+    T* lItem, *lPrev;
+    T** lHeader;
+
+    lBuckets = RETE_HT_MIGRATE_STEP + (2 * ht->changes_since_step);
+    ht->changes_since_step = 0;
+
+    while (lBuckets-- && (ht->next_old_bucket <= ht->old_mask))
+    {
+        lItem = reinterpret_cast<T*>(ht->old_buckets[ht->next_old_bucket]);
+        if (lItem)
+        {
+            while (next_in_rete_ht(lItem))
+            {
+                lItem = next_in_rete_ht(lItem);
+            }
+            for (; lItem != NIL; lItem = lPrev)
+            {
+                lPrev = prev_in_rete_ht(lItem);
+                lHeader = reinterpret_cast<T**>(ht->buckets + (rete_ht_hash_value(lItem) & ht->mask));
+                next_in_rete_ht(lItem) = *lHeader;
+                prev_in_rete_ht(lItem) = NIL;
+                if (*lHeader)
+                {
+                    prev_in_rete_ht(*lHeader) = lItem;
+                }
+                *lHeader = lItem;
+            }
+            ht->old_buckets[ht->next_old_bucket] = NIL;
+        }
+        ht->next_old_bucket++;
+    }
+
+    if (ht->next_old_bucket > ht->old_mask)
+    {
+        thisAgent->memoryManager->free_memory(ht->old_buckets, HASH_TABLE_MEM_USAGE);
+        ht->old_buckets = NIL;
+    }
+}
+
+template <typename T>
+void update_rete_hash_table(agent* thisAgent, rete_hash_table* ht)
+{
+    uint32_t lNewSize;
+
+    if (ht->old_buckets)
+    {
+        migrate_rete_hash_table<T>(thisAgent, ht);
+        return;
+    }
+
+    if (ht->count > ht->mask + 1)
+    {
+        lNewSize = (ht->mask + 1) << 1;
+    }
+    else if ((ht->mask >= (1 << LOG2_MIN_RETE_HT_SIZE)) && ((ht->count << 3) < ht->mask + 1))
+    {
+        lNewSize = (ht->mask + 1) >> 1;
+    }
+    else
+    {
+        return;
+    }
+
+    ht->old_buckets = ht->buckets;
+    ht->old_mask = ht->mask;
+    ht->next_old_bucket = 0;
+    ht->buckets = static_cast<void**>(thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(void*) * lNewSize, HASH_TABLE_MEM_USAGE));
+    ht->mask = lNewSize - 1;
+    ht->num_resizes++;
+    migrate_rete_hash_table<T>(thisAgent, ht);
+}
+
+inline void update_rete_hash_tables(agent* thisAgent)
+{
+    update_rete_hash_table<token>(thisAgent, thisAgent->left_ht);
+    update_rete_hash_table<right_mem>(thisAgent, thisAgent->right_ht);
+}
+
+template <typename T>
+void add_rete_bucket_array_stats(void** buckets, uint32_t size, rete_hash_table_stats* stats)
+{
+    uint64_t lChain;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        lChain = 0;
+        for (T* lItem = reinterpret_cast<T*>(buckets[i]); lItem != NIL; lItem = next_in_rete_ht(lItem))
+        {
+            lChain++;
+        }
+        if (lChain)
+        {
+            stats->buckets_used++;
+        }
+        if (lChain > stats->longest_chain)
+        {
+            stats->longest_chain = lChain;
+        }
+    }
+}
+
+void get_rete_hash_table_stats(agent* thisAgent, bool left, rete_hash_table_stats* stats)
+{
+    rete_hash_table* ht = left ? thisAgent->left_ht : thisAgent->right_ht;
+
+    stats->size = ht->mask + 1;
+    stats->old_size = ht->old_buckets ? ht->old_mask + 1 : 0;
+    stats->count = ht->count;
+    stats->buckets_used = 0;
+    stats->longest_chain = 0;
+    stats->num_resizes = ht->num_resizes;
+
+    if (left)
+    {
+        add_rete_bucket_array_stats<token>(ht->buckets, ht->mask + 1, stats);
+        if (ht->old_buckets) add_rete_bucket_array_stats<token>(ht->old_buckets, ht->old_mask + 1, stats);
+    }
+    else
+    {
+        add_rete_bucket_array_stats<right_mem>(ht->buckets, ht->mask + 1, stats);
+        if (ht->old_buckets) add_rete_bucket_array_stats<right_mem>(ht->old_buckets, ht->old_mask + 1, stats);
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -741,6 +944,105 @@ inline void token_added(rete_node* node)
 
 #endif
 
+/* ----------------------------------------------------------------------
+
+           Structures and Declarations:  Match Cost Profiler
+
+   While the profiler is on (production profile --enable), every beta
+   node addition routine opens a rete_profile_scope for its node, which
+   counts the activation, the join candidates it tests (token/wme pairs
+   that got past the hash lookup to the remaining tests) and the tokens
+   it builds, and times the node.  Scopes nest as activations are passed
+   down the net, so each one subtracts the time spent in its children,
+   and a node is only charged for the work it did itself.  Times are kept
+   in raw timer ticks.  Removals are not profiled.
+
+   When the profiler is off, a scope costs one test of a pointer.
+---------------------------------------------------------------------- */
+
+typedef struct rete_node_profile_struct
+{
+    uint64_t left_activations;
+    uint64_t right_activations;
+    uint64_t join_candidates;
+    uint64_t tokens;
+    uint64_t ticks;              /* time in the node, not in its children */
+} rete_node_profile;
+
+class rete_profile_scope;
+
+typedef struct rete_profiler_struct
+{
+    bool                                           enabled;
+    std::unordered_map<rete_node*, rete_node_profile> nodes;
+    rete_profile_scope*                            current;  /* innermost open scope */
+} rete_profiler;
+
+class rete_profile_scope
+{
+    public:
+        rete_profile_scope(agent* thisAgent, rete_node* node, bool left)
+        {
+            profiler = thisAgent->rete_profiler;
+            if (!profiler || !profiler->enabled)
+            {
+                stats = NIL;
+                return;
+            }
+            stats = &(profiler->nodes[node]);
+            if (left)
+            {
+                stats->left_activations++;
+            }
+            else
+            {
+                stats->right_activations++;
+            }
+            parent = profiler->current;
+            profiler->current = this;
+            child_ticks = 0;
+            start = get_raw_time();
+        }
+
+        ~rete_profile_scope()
+        {
+            if (!stats)
+            {
+                return;
+            }
+            uint64_t elapsed = get_raw_time() - start;
+            stats->ticks += elapsed - child_ticks;
+            if (parent)
+            {
+                parent->child_ticks += elapsed;
+            }
+            profiler->current = parent;
+        }
+
+        inline void candidate()
+        {
+            if (stats)
+            {
+                stats->join_candidates++;
+            }
+        }
+
+        inline void token()
+        {
+            if (stats)
+            {
+                stats->tokens++;
+            }
+        }
+
+    private:
+        rete_profiler*      profiler;
+        rete_node_profile*  stats;   /* NIL while the profiler is off */
+        rete_profile_scope* parent;
+        uint64_t            start;
+        uint64_t            child_ticks;
+};
+
 /* --- Invoked on every right activation; add=true means right addition --- */
 /* NOT invoked on removals unless DO_ACTIVATION_STATS_ON_REMOVALS is set */
 /*#define right_node_activation(node,add) { \
@@ -781,6 +1083,10 @@ inline void update_stats_for_destroying_node(agent* thisAgent, rete_node* node)
 {
     set_sharing_factor(node, 0);
     thisAgent->rete_node_counts[(node)->node_type]--;
+    if (thisAgent->rete_profiler)
+    {
+        thisAgent->rete_profiler->nodes.erase(node);
+    }
 }
 
 
@@ -1256,6 +1562,213 @@ inline uint32_t get_next_alpha_mem_id(agent* thisAgent)
     return thisAgent->alpha_mem_id_counter++;
 }
 
+/* ----------------------------------------------------------------------
+
+                   Alpha Memory Arrays
+
+   An alpha memory's right_mems are kept in a dll, newest first.  Once an
+   alpha memory holds ALPHA_MEM_ARRAY_THRESHOLD or more of them, it also
+   keeps the right_mems and the id, attr and value of their wmes in
+   parallel arrays, oldest first.  Unhashed joins against a large alpha
+   memory usually have an equality test on some field, so instead of
+   walking the dll and running every test on every wme, they scan that
+   field's array for the symbol they need (ALPHA_MEM_ARRAY_BLOCK entries
+   at a time, with SSE2 when it's available) and only run the other tests
+   on the hits.  The arrays are scanned from the end, so matches are
+   found in the same order as when walking the dll.
+
+   Removing a right_mem just NILs out its entries.  The arrays are
+   compacted, keeping their order, once half the entries are holes.
+   Neither adds nor removes happen while a join is scanning.
+---------------------------------------------------------------------- */
+
+#define ALPHA_MEM_ARRAY_THRESHOLD 32
+#define ALPHA_MEM_ARRAY_BLOCK     4
+
+void resize_alpha_mem_arrays(agent* thisAgent, alpha_mem* am, uint32_t new_capacity)
+{
+    right_mem** lRms;
+    Symbol** lFields[3];
+    uint32_t lSize = 0;
+
+    lRms = static_cast<right_mem**>(thisAgent->memoryManager->allocate_memory_and_zerofill(4 * new_capacity * sizeof(void*), MISCELLANEOUS_MEM_USAGE));
+    for (int f = 0; f < 3; f++)
+    {
+        lFields[f] = reinterpret_cast<Symbol**>(lRms + ((f + 1) * new_capacity));
+    }
+
+    /* --- copy over the live entries, dropping holes --- */
+    for (uint32_t i = 0; i < am->array_size; i++)
+    {
+        if (am->rm_array[i])
+        {
+            lRms[lSize] = am->rm_array[i];
+            lRms[lSize]->array_index = lSize;
+            for (int f = 0; f < 3; f++)
+            {
+                lFields[f][lSize] = am->field_array[f][i];
+            }
+            lSize++;
+        }
+    }
+
+    if (am->rm_array)
+    {
+        thisAgent->memoryManager->free_memory(am->rm_array, MISCELLANEOUS_MEM_USAGE);
+    }
+    am->rm_array = lRms;
+    for (int f = 0; f < 3; f++)
+    {
+        am->field_array[f] = lFields[f];
+    }
+    am->array_size = lSize;
+    am->array_capacity = new_capacity;
+    am->array_holes = 0;
+}
+
+inline void add_rm_to_alpha_mem_arrays(agent* thisAgent, alpha_mem* am, right_mem* rm)
+{
+    if (am->array_size == am->array_capacity)
+    {
+        resize_alpha_mem_arrays(thisAgent, am, (am->array_holes * 2 >= am->array_size) ? am->array_capacity : am->array_capacity * 2);
+    }
+    rm->array_index = am->array_size;
+    am->rm_array[am->array_size] = rm;
+    am->field_array[0][am->array_size] = rm->w->id;
+    am->field_array[1][am->array_size] = rm->w->attr;
+    am->field_array[2][am->array_size] = rm->w->value;
+    am->array_size++;
+}
+
+void make_alpha_mem_arrays(agent* thisAgent, alpha_mem* am)
+{
+    right_mem* rm;
+
+    /* --- capacity is kept a multiple of the block size, so scans can read
+       whole blocks; unused entries are NIL and never match --- */
+    resize_alpha_mem_arrays(thisAgent, am, ALPHA_MEM_ARRAY_THRESHOLD * 2);
+    for (rm = am->right_mems; rm->next_in_am != NIL; rm = rm->next_in_am);
+    for (; rm != NIL; rm = rm->prev_in_am)
+    {
+        add_rm_to_alpha_mem_arrays(thisAgent, am, rm);
+    }
+}
+
+void free_alpha_mem_arrays(agent* thisAgent, alpha_mem* am)
+{
+    if (am->rm_array)
+    {
+        thisAgent->memoryManager->free_memory(am->rm_array, MISCELLANEOUS_MEM_USAGE);
+        am->rm_array = NIL;
+    }
+}
+
+/* --- Returns a bit mask with bit i set if syms[i] == target, for
+   ALPHA_MEM_ARRAY_BLOCK entries --- */
+inline uint32_t alpha_mem_array_block_matches(Symbol** syms, Symbol* target)
+{
+#ifdef RETE_USE_SSE2
+    /* --- compare the two 32-bit halves of each pointer; both must match --- */
+    __m128i lTarget = _mm_set1_epi64x(reinterpret_cast<int64_t>(target));
+    uint32_t lLow = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(syms)), lTarget)));
+    uint32_t lHigh = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(syms + 2)), lTarget)));
+    return ((lLow & 0xFF) == 0xFF) | (((lLow >> 8) == 0xFF) << 1) | (((lHigh & 0xFF) == 0xFF) << 2) | (((lHigh >> 8) == 0xFF) << 3);
+#else
+    return (syms[0] == target) | ((syms[1] == target) << 1) | ((syms[2] == target) << 2) | ((syms[3] == target) << 3);
+#endif
+}
+
+/* --- Iterates over the right_mems of an alpha memory that could join
+   with a token, newest first.  If the alpha memory has arrays and the
+   node has an equality test against a symbol the token determines, only
+   right_mems whose wme has that symbol in the tested field are returned,
+   and eq_test is set so the caller can skip that test.  Otherwise every
+   right_mem is returned. --- */
+typedef struct alpha_mem_scan_struct
+{
+    right_mem* next_rm;        /* dll walk */
+    right_mem** rm_array;      /* array scan */
+    Symbol** field;
+    Symbol* target;
+    int64_t block;
+    uint32_t matches;
+    rete_test* eq_test;
+} alpha_mem_scan;
+
+inline Symbol* symbol_for_equality_test(rete_test* rt, token* left)
+{
+    int i;
+
+    if (rt->type == (CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_EQUAL_RETE_TEST))
+    {
+        return rt->data.constant_referent;
+    }
+    if ((rt->type == (VARIABLE_RELATIONAL_RETE_TEST + RELATIONAL_EQUAL_RETE_TEST)) &&
+            (rt->data.variable_referent.levels_up != 0))
+    {
+        for (i = rt->data.variable_referent.levels_up - 1; i != 0; i--)
+        {
+            left = left->parent;
+        }
+        return field_from_wme(left->w, rt->data.variable_referent.field_num);
+    }
+    return NIL;
+}
+
+inline void start_alpha_mem_scan(alpha_mem_scan* scan, alpha_mem* am, rete_test* tests, token* left)
+{
+    scan->next_rm = am->right_mems;
+    scan->target = NIL;
+    scan->eq_test = NIL;
+    if (am->rm_array)
+    {
+        for (rete_test* rt = tests; rt != NIL; rt = rt->next)
+        {
+            if ((scan->target = symbol_for_equality_test(rt, left)) != NIL)
+            {
+                scan->eq_test = rt;
+                scan->rm_array = am->rm_array;
+                scan->field = am->field_array[rt->right_field_num];
+                scan->block = ((am->array_size + ALPHA_MEM_ARRAY_BLOCK - 1) / ALPHA_MEM_ARRAY_BLOCK) * ALPHA_MEM_ARRAY_BLOCK;
+                scan->matches = 0;
+                return;
+            }
+        }
+    }
+}
+
+inline right_mem* next_in_alpha_mem_scan(alpha_mem_scan* scan)
+{
+    right_mem* rm;
+
+    if (!scan->target)
+    {
+        rm = scan->next_rm;
+        if (rm)
+        {
+            scan->next_rm = rm->next_in_am;
+        }
+        return rm;
+    }
+    while (!scan->matches)
+    {
+        if (scan->block == 0)
+        {
+            return NIL;
+        }
+        scan->block -= ALPHA_MEM_ARRAY_BLOCK;
+        scan->matches = alpha_mem_array_block_matches(scan->field + scan->block, scan->target);
+    }
+    for (int i = ALPHA_MEM_ARRAY_BLOCK - 1; ; i--)
+    {
+        if (scan->matches & (1 << i))
+        {
+            scan->matches &= ~(1 << i);
+            return scan->rm_array[scan->block + i];
+        }
+    }
+}
+
 /* --- Adds a WME to an alpha memory (create a right_mem for it), but doesn't
    inform any successors --- */
 void add_wme_to_alpha_mem(agent* thisAgent, wme* w, alpha_mem* am)
@@ -1270,10 +1783,23 @@ void add_wme_to_alpha_mem(agent* thisAgent, wme* w, alpha_mem* am)
 
     /* --- add it to dll's for the hash bucket, alpha mem, and wme --- */
     hv = am->am_id ^ w->id->hash_id;
-    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK);
+    header = reinterpret_cast<right_mem**>(rete_ht_header(thisAgent->right_ht, hv));
     insert_at_head_of_dll(*header, rm, next_in_bucket, prev_in_bucket);
+    thisAgent->right_ht->count++;
+    thisAgent->right_ht->changes_since_step++;
     insert_at_head_of_dll(am->right_mems, rm, next_in_am, prev_in_am);
     insert_at_head_of_dll(w->right_mems, rm, next_from_wme, prev_from_wme);
+
+    /* --- and to the alpha mem's arrays, making them if it just got large --- */
+    am->num_right_mems++;
+    if (am->rm_array)
+    {
+        add_rm_to_alpha_mem_arrays(thisAgent, am, rm);
+    }
+    else if (am->num_right_mems >= ALPHA_MEM_ARRAY_THRESHOLD)
+    {
+        make_alpha_mem_arrays(thisAgent, am);
+    }
 }
 
 /* --- Removes a WME (right_mem) from its alpha memory, but doesn't inform
@@ -1290,11 +1816,29 @@ void remove_wme_from_alpha_mem(agent* thisAgent, right_mem* rm)
 
     /* --- remove it from dll's for the hash bucket, alpha mem, and wme --- */
     hv = am->am_id ^ w->id->hash_id;
-    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK);
+    header = reinterpret_cast<right_mem**>(rete_ht_header(thisAgent->right_ht, hv));
     remove_from_dll(*header, rm, next_in_bucket, prev_in_bucket);
+    thisAgent->right_ht->count--;
+    thisAgent->right_ht->changes_since_step++;
     remove_from_dll(am->right_mems, rm, next_in_am, prev_in_am);
     remove_from_dll(w->right_mems, rm, next_from_wme, prev_from_wme);
 
+    /* --- leave a hole in the alpha mem's arrays --- */
+    am->num_right_mems--;
+    if (am->rm_array)
+    {
+        am->rm_array[rm->array_index] = NIL;
+        for (int f = 0; f < 3; f++)
+        {
+            am->field_array[f][rm->array_index] = NIL;
+        }
+        am->array_holes++;
+        if ((am->array_holes * 2 > am->array_size) && (am->array_capacity > ALPHA_MEM_ARRAY_THRESHOLD * 2))
+        {
+            resize_alpha_mem_arrays(thisAgent, am, am->array_capacity / 2);
+        }
+    }
+
     /* --- deallocate it --- */
     thisAgent->memoryManager->free_with_pool(MP_right_mem, rm);
 }
@@ -1362,6 +1906,11 @@ alpha_mem* find_or_make_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
     }
     am->acceptable = acceptable;
     am->am_id = get_next_alpha_mem_id(thisAgent);
+    am->num_right_mems = 0;
+    am->rm_array = NIL;
+    am->array_size = 0;
+    am->array_capacity = 0;
+    am->array_holes = 0;
     ht = table_for_tests(thisAgent, id, attr, value, acceptable);
     add_to_hash_table(thisAgent, ht, am);
 
@@ -1438,6 +1987,8 @@ void add_wme_to_rete(agent* thisAgent, wme* w)
 {
     uint32_t hi, ha, hv;
 
+    update_rete_hash_tables(thisAgent);
+
     /* --- add w to all_wmes_in_rete --- */
     insert_at_head_of_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
     thisAgent->num_wmes_in_rete++;
@@ -1648,6 +2199,8 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
 
     dprint(DT_RETE_PNODE_ADD, "Removing WME from RETE: %w\n", w);
 
+    update_rete_hash_tables(thisAgent);
+
     /* --- remove w from all_wmes_in_rete --- */
     remove_from_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
     thisAgent->num_wmes_in_rete--;
@@ -1748,6 +2301,7 @@ void remove_ref_to_alpha_mem(agent* thisAgent, alpha_mem* am)
     {
         remove_wme_from_alpha_mem(thisAgent, am->right_mems);
     }
+    free_alpha_mem_arrays(thisAgent, am);
     thisAgent->memoryManager->free_with_pool(MP_alpha_mem, am);
 }
 
@@ -3767,6 +4321,9 @@ byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
     dprint(DT_RETE_PNODE_ADD, "instantiation:\n%7", refracted_inst);
     dprint(DT_RETE_PNODE_ADD, "lhs:\n%1", lhs_top);
 
+    /* --- any saved image of the net is about to be out of date --- */
+    discard_rete_net_snapshot(thisAgent);
+
     /* --- build the network for all the conditions --- */
     build_network_for_condition_list(thisAgent, lhs_top, 1, thisAgent->dummy_top_node,
                                      &bottom_node, &bottom_depth, &vars_bound);
@@ -3990,6 +4547,8 @@ void excise_production_from_rete(agent* thisAgent, production* pProd)
 
     soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ABOUT_TO_BE_EXCISED_CALLBACK, static_cast<soar_call_data>(pProd));
 
+    discard_rete_net_snapshot(thisAgent);
+
     p_node = pProd->p_node;
     pProd->p_node = NIL;      /* mark production as not being in the rete anymore */
     parent = p_node->parent;
@@ -4875,6 +5434,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     {
         int levels_up;
@@ -4899,6 +5459,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
 
     /* --- build new left token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -4923,11 +5484,13 @@ void unhashed_beta_memory_node_left_addition(agent* thisAgent,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     hv = node->node_id;
 
     /* --- build new left token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -4955,6 +5518,7 @@ void positive_node_left_addition(agent* thisAgent,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     am = node->b.posneg.alpha_mem_;
 
@@ -4982,6 +5546,7 @@ void positive_node_left_addition(agent* thisAgent,
         {
             continue;
         }
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, New, rm->w))
@@ -5005,12 +5570,14 @@ void positive_node_left_addition(agent* thisAgent,
 void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, token* New)
 {
     right_mem* rm;
+    alpha_mem_scan scan;
     rete_test* rt;
     bool failed_a_test;
     rete_node* child;
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5024,13 +5591,14 @@ void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, tok
     }
 
     /* --- look through right memory for matches --- */
-    for (rm = node->b.posneg.alpha_mem_->right_mems; rm != NIL;
-            rm = rm->next_in_am)
+    start_alpha_mem_scan(&scan, node->b.posneg.alpha_mem_, node->b.posneg.other_tests, New);
+    while ((rm = next_in_alpha_mem_scan(&scan)) != NIL)
     {
         /* --- does rm->w match new? --- */
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if ((rt != scan.eq_test) && ! match_left_and_right(thisAgent, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -5063,6 +5631,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     //dprint(DT_RETE_PNODE_ADD, "mp_node_left_addition called with node %d, token %u, and wme %w\n", node->node_id, tok, w);
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     {
         int levels_up;
@@ -5087,6 +5656,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
 
     /* --- build new left token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5124,6 +5694,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
         {
             continue;
         }
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
         {
@@ -5154,16 +5725,19 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
     rete_node* child;
     token* New;
     right_mem* rm;
+    alpha_mem_scan scan;
     rete_test* rt;
     bool failed_a_test;
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     hv = node->node_id;
 
     /* --- build new left token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5186,13 +5760,14 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
     }
 
     /* --- look through right memory for matches --- */
-    for (rm = node->b.posneg.alpha_mem_->right_mems; rm != NIL;
-            rm = rm->next_in_am)
+    start_alpha_mem_scan(&scan, node->b.posneg.alpha_mem_, node->b.posneg.other_tests, New);
+    while ((rm = next_in_alpha_mem_scan(&scan)) != NIL)
     {
         /* --- does rm->w match new? --- */
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if ((rt != scan.eq_test) && ! match_left_and_right(thisAgent, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -5221,6 +5796,7 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, false);
 
     if (node_is_left_unlinked(node))
     {
@@ -5247,6 +5823,7 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         {
             continue;
         }
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, tok, w))
@@ -5277,6 +5854,7 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, false);
 
     if (node_is_left_unlinked(node))
     {
@@ -5298,6 +5876,7 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
             continue;
         }
         /* --- does tok match w? --- */
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, tok, w))
@@ -5334,6 +5913,7 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, false);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5373,6 +5953,7 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         {
             continue;
         }
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
         {
@@ -5407,6 +5988,7 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, false);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5428,6 +6010,7 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             continue;
         }
         /* --- does tok match w? --- */
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, tok, w))
@@ -5468,6 +6051,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5497,6 +6081,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
 
     /* --- build new token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5517,6 +6102,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
         {
             continue;
         }
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, New, rm->w))
@@ -5560,11 +6146,13 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
     rete_test* rt;
     bool failed_a_test;
     right_mem* rm;
+    alpha_mem_scan scan;
     rete_node* child;
     token* New;
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5575,6 +6163,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
 
     /* --- build new token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5582,12 +6171,14 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
     New->negrm_tokens = NIL;
 
     /* --- look through right memory for matches --- */
-    for (rm = node->b.posneg.alpha_mem_->right_mems; rm != NIL; rm = rm->next_in_am)
+    start_alpha_mem_scan(&scan, node->b.posneg.alpha_mem_, node->b.posneg.other_tests, New);
+    while ((rm = next_in_alpha_mem_scan(&scan)) != NIL)
     {
         /* --- does rm->w match new? --- */
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
+            if ((rt != scan.eq_test) && ! match_left_and_right(thisAgent, rt, New, rm->w))
             {
                 failed_a_test = true;
                 break;
@@ -5631,6 +6222,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, false);
 
     referent = w->id;
     hv = node->node_id ^ referent->hash_id;
@@ -5646,6 +6238,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
         {
             continue;
         }
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, tok, w))
@@ -5687,6 +6280,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, false);
 
     hv = node->node_id;
 
@@ -5697,6 +6291,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
             continue;
         }
         /* --- does tok match w? --- */
+        profile.candidate();
         failed_a_test = false;
         for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
             if (! match_left_and_right(thisAgent, rt, tok, w))
@@ -5746,6 +6341,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     hv = node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok) ^ cast_and_possibly_truncate<uint32_t>(w);
 
@@ -5760,6 +6356,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
 
     /* --- build left token, add it to the hash table --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5783,11 +6380,13 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     partner = node->b.cn.partner;
 
     /* --- build new negrm token --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &negrm_tok);
     new_left_token(negrm_tok, node, tok, w);
 
@@ -5812,6 +6411,7 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     if (!left)
     {
         token_added(partner);
+        profile.token();
         thisAgent->memoryManager->allocate_with_pool(MP_token, &left);
         new_left_token(left, partner, tok, w);
         insert_token_into_left_ht(thisAgent, left, hv);
@@ -5889,9 +6489,11 @@ void p_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w)
     //dprint(DT_RETE_PNODE_ADD, "p_node_left_addition called with node %d, token %u, and wme %w\n", node->node_id, tok, w);
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile(thisAgent, node, true);
 
     /* --- build new left token (used only for tree-based remove) --- */
     token_added(node);
+    profile.token();
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
 
@@ -6647,7 +7249,14 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
 
      magic number sequence: "SoarCompactReteNet\n"
      1 byte: 0 (null termination for the above string)
-     1 byte: format version number (current version is version 3)
+     1 byte: format version number (current version is version 5)
+
+     Version 4 is the same as version 3 with every "4 bytes" count and
+     index below widened to 8 bytes.  Version 5 writes those counts and
+     indices as variable-length integers (see reteload_eight_bytes), and
+     writes int_constants as zigzag variable-length integers and
+     float_constants as their 8 IEEE 754 bytes instead of ASCII strings.
+     All three versions can be loaded.
 
      4 bytes: number of str_constants
      4 bytes: number of variables
@@ -6699,8 +7308,52 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
   false if any error occurred.
 ********************************************************************** */
 
-FILE* rete_fs_file;  /* File handle we're using -- "fs" for "fast-save" */
-bool rete_net_64; // used by reteload_eight_bytes, retesave_eight_bytes, BADBAD global, fix with rete_fs_file above
+/* ----------------------------------------------------------------------
+                          Rete Net Streams
+
+   A net is never saved or loaded a byte at a time through stdio.
+   Save_rete_net() builds the whole image in a rete_net_stream and writes
+   it out with one fwrite(); load_rete_net() maps the whole file (or, where
+   mapping isn't available, reads it in one fread()) and parses it from
+   memory.  The same streams hold agents' snapshots for clone_rete_net().
+---------------------------------------------------------------------- */
+
+void init_rete_net_stream(rete_net_stream* f, Memory_Manager* memoryManager, byte version)
+{
+    f->data = NIL;
+    f->size = 0;
+    f->capacity = 0;
+    f->pos = 0;
+    f->version = version;
+    f->memoryManager = memoryManager;
+}
+
+void free_rete_net_stream(rete_net_stream* f)
+{
+    if (f->capacity)
+    {
+        f->memoryManager->free_memory(f->data, MISCELLANEOUS_MEM_USAGE);
+    }
+    f->data = NIL;
+    f->size = f->capacity = f->pos = 0;
+}
+
+void grow_rete_net_stream(rete_net_stream* f)
+{
+    size_t lNewCapacity = f->capacity ? (f->capacity * 2) : 65536;
+    uint8_t* lNewData = static_cast<uint8_t*>(f->memoryManager->allocate_memory(lNewCapacity, MISCELLANEOUS_MEM_USAGE));
+
+    if (f->size)
+    {
+        memcpy(lNewData, f->data, f->size);
+    }
+    if (f->capacity)
+    {
+        f->memoryManager->free_memory(f->data, MISCELLANEOUS_MEM_USAGE);
+    }
+    f->data = lNewData;
+    f->capacity = lNewCapacity;
+}
 
 /* ----------------------------------------------------------------------
                 Save/Load Bytes, Short and Long Integers
@@ -6709,25 +7362,36 @@ bool rete_net_64; // used by reteload_eight_bytes, retesave_eight_bytes, BADBAD
    that all 16-bit or 32-bit words are written LSB first.  We do this
    carefully, so that fastsave files will be portable across machine
    types (big-endian vs. little-endian).
+
+   Counts and symbol/alpha memory indices all go through
+   retesave_eight_bytes().  Format versions 3 and 4 write them as fixed
+   4 or 8 byte words.  Version 5 writes them as variable-length integers,
+   7 bits per byte starting with the low bits, with the high bit set on
+   every byte but the last, so nearly all of them take 1-3 bytes.
 ---------------------------------------------------------------------- */
 
-void retesave_one_byte(uint8_t b, FILE* /*f*/)
+inline void retesave_one_byte(uint8_t b, rete_net_stream* f)
 {
-    fputc(b, rete_fs_file);
+    if (f->size == f->capacity)
+    {
+        grow_rete_net_stream(f);
+    }
+    f->data[f->size++] = b;
 }
 
-uint8_t reteload_one_byte(FILE* f)
+/* --- Past the end of the data we return 0xFF, as fgetc() at EOF did --- */
+inline uint8_t reteload_one_byte(rete_net_stream* f)
 {
-    return static_cast<uint8_t>(fgetc(f));
+    return (f->pos < f->size) ? f->data[f->pos++] : 0xFF;
 }
 
-void retesave_two_bytes(uint16_t w, FILE* f)
+void retesave_two_bytes(uint16_t w, rete_net_stream* f)
 {
     retesave_one_byte(static_cast<uint8_t>(w & 0xFF), f);
     retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
 }
 
-uint16_t reteload_two_bytes(FILE* f)
+uint16_t reteload_two_bytes(rete_net_stream* f)
 {
     uint16_t i;
     i = reteload_one_byte(f);
@@ -6735,7 +7399,7 @@ uint16_t reteload_two_bytes(FILE* f)
     return i;
 }
 
-void retesave_four_bytes(uint32_t w, FILE* f)
+void retesave_four_bytes(uint32_t w, rete_net_stream* f)
 {
     retesave_one_byte(static_cast<uint8_t>(w & 0xFF), f);
     retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
@@ -6743,71 +7407,107 @@ void retesave_four_bytes(uint32_t w, FILE* f)
     retesave_one_byte(static_cast<uint8_t>((w >> 24) & 0xFF), f);
 }
 
-uint32_t reteload_four_bytes(FILE* f)
+uint32_t reteload_four_bytes(rete_net_stream* f)
 {
     uint32_t i;
     i = reteload_one_byte(f);
     i += (reteload_one_byte(f) << 8);
     i += (reteload_one_byte(f) << 16);
-    i += (reteload_one_byte(f) << 24);
+    i += (static_cast<uint32_t>(reteload_one_byte(f)) << 24);
     return i;
 }
 
-void retesave_eight_bytes(uint64_t w, FILE* f)
+void retesave_eight_bytes(uint64_t w, rete_net_stream* f)
 {
-    if (!rete_net_64)
+    if (f->version >= 5)
+    {
+        while (w >= 0x80)
+        {
+            retesave_one_byte(static_cast<uint8_t>((w & 0x7F) | 0x80), f);
+            w >>= 7;
+        }
+        retesave_one_byte(static_cast<uint8_t>(w), f);
+        return;
+    }
+    if (f->version == 3)
     {
         retesave_four_bytes(static_cast<uint32_t>(w), f);
         return;
     }
-    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 16) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 24) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 32) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 40) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 48) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 56) & 0xFF), f);
+    retesave_four_bytes(static_cast<uint32_t>(w & 0xFFFFFFFF), f);
+    retesave_four_bytes(static_cast<uint32_t>(w >> 32), f);
 }
 
-uint64_t reteload_eight_bytes(FILE* f)
+uint64_t reteload_eight_bytes(rete_net_stream* f)
 {
-    if (!rete_net_64)
+    uint64_t i;
+
+    if (f->version >= 5)
+    {
+        uint8_t b;
+        int lShift = 0;
+        i = 0;
+        do
+        {
+            b = reteload_one_byte(f);
+            i |= static_cast<uint64_t>(b & 0x7F) << lShift;
+            lShift += 7;
+        }
+        while ((b & 0x80) && (lShift < 64));
+        return i;
+    }
+    if (f->version == 3)
     {
         return reteload_four_bytes(f);
     }
-
-    uint64_t i;
-    uint64_t tmp;
-    i = reteload_one_byte(f);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 8);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 16);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 24);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 32);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 40);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 48);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 56);
+    i = reteload_four_bytes(f);
+    i |= static_cast<uint64_t>(reteload_four_bytes(f)) << 32;
     return i;
 }
 
+/* --- Version 5 saves int and float constants in binary rather than as
+   strings, so loading them needs no strtol()/strtod() and floats come
+   back exactly.  Ints are zigzag encoded so small negative numbers stay
+   short; floats are written as the 8 bytes of their IEEE 754 bits. --- */
+void retesave_int_value(int64_t i, rete_net_stream* f)
+{
+    retesave_eight_bytes((static_cast<uint64_t>(i) << 1) ^ static_cast<uint64_t>(i >> 63), f);
+}
+
+int64_t reteload_int_value(rete_net_stream* f)
+{
+    uint64_t w = reteload_eight_bytes(f);
+    return static_cast<int64_t>((w >> 1) ^ (0 - (w & 1)));
+}
+
+void retesave_float_value(double d, rete_net_stream* f)
+{
+    uint64_t w;
+    memcpy(&w, &d, sizeof(w));
+    retesave_four_bytes(static_cast<uint32_t>(w & 0xFFFFFFFF), f);
+    retesave_four_bytes(static_cast<uint32_t>(w >> 32), f);
+}
+
+double reteload_float_value(rete_net_stream* f)
+{
+    uint64_t w;
+    double d;
+    w = reteload_four_bytes(f);
+    w |= static_cast<uint64_t>(reteload_four_bytes(f)) << 32;
+    memcpy(&d, &w, sizeof(d));
+    return d;
+}
+
 /* ----------------------------------------------------------------------
-                            Save/Load Strings
+                          Save/Load Strings
 
-   Strings are written as null-terminated sequences of characters, just
-   like the usual C format.  Reteload_string() leaves the result in
-   reteload_string_buf[].
+   Strings are written as null-terminated strings.  Reteload_string()
+   reads a string into reteload_string_buf[].
 ---------------------------------------------------------------------- */
 
 char reteload_string_buf[4 * MAX_LEXEME_LENGTH];
 
-void retesave_string(const char* s, FILE* f)
+void retesave_string(const char* s, rete_net_stream* f)
 {
     while (*s)
     {
@@ -6817,16 +7517,21 @@ void retesave_string(const char* s, FILE* f)
     retesave_one_byte(0, f);
 }
 
-void reteload_string(FILE* f)
+void reteload_string(rete_net_stream* f)
 {
     int i, ch;
     i = 0;
     do
     {
         ch = reteload_one_byte(f);
+        if (ch == 0xFF && f->pos >= f->size)
+        {
+            ch = 0;
+        }
         reteload_string_buf[i++] = static_cast<char>(ch);
     }
-    while (ch);
+    while (ch && (i < static_cast<int>(sizeof(reteload_string_buf)) - 1));
+    reteload_string_buf[i] = 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -6857,13 +7562,13 @@ void reteload_string(FILE* f)
    Reteload_free_symbol_table() frees up the symbol table when we're done.
 ---------------------------------------------------------------------- */
 
-void retesave_symbol_table(agent* thisAgent, FILE* f)
+void retesave_symbol_table(agent* thisAgent, rete_net_stream* f)
 {
     thisAgent->current_retesave_symindex = 0;
     thisAgent->symbolManager->retesave(f);
 }
 
-void reteload_all_symbols(agent* thisAgent, FILE* f)
+void reteload_all_symbols(agent* thisAgent, rete_net_stream* f)
 {
     uint64_t num_str_constants, num_variables;
     uint64_t num_int_constants, num_float_constants;
@@ -6896,19 +7601,29 @@ void reteload_all_symbols(agent* thisAgent, FILE* f)
     }
     for (i = 0; i < num_int_constants; i++)
     {
+        if (f->version >= 5)
+        {
+            *(current_place_in_symtab++) = thisAgent->symbolManager->make_int_constant(reteload_int_value(f));
+            continue;
+        }
         reteload_string(f);
         *(current_place_in_symtab++) =
             thisAgent->symbolManager->make_int_constant(strtol(reteload_string_buf, NULL, 10));
     }
     for (i = 0; i < num_float_constants; i++)
     {
+        if (f->version >= 5)
+        {
+            *(current_place_in_symtab++) = thisAgent->symbolManager->make_float_constant(reteload_float_value(f));
+            continue;
+        }
         reteload_string(f);
         *(current_place_in_symtab++) =
             thisAgent->symbolManager->make_float_constant(strtod(reteload_string_buf, NULL));
     }
 }
 
-Symbol* reteload_symbol_from_index(agent* thisAgent, FILE* f)
+Symbol* reteload_symbol_from_index(agent* thisAgent, rete_net_stream* f)
 {
     uint64_t index;
 
@@ -6967,7 +7682,7 @@ void reteload_free_symbol_table(agent* thisAgent)
 bool retesave_alpha_mem_and_assign_index(agent* thisAgent, void* item, void* userdata)
 {
     alpha_mem* am;
-    FILE* f = reinterpret_cast<FILE*>(userdata);
+    rete_net_stream* f = reinterpret_cast<rete_net_stream*>(userdata);
 
     am = static_cast<alpha_mem_struct*>(item);
     thisAgent->current_retesave_amindex++;
@@ -6979,7 +7694,7 @@ bool retesave_alpha_mem_and_assign_index(agent* thisAgent, void* item, void* use
     return false;
 }
 
-void retesave_alpha_memories(agent* thisAgent, FILE* f)
+void retesave_alpha_memories(agent* thisAgent, rete_net_stream* f)
 {
     uint64_t i, num_ams;
 
@@ -6995,7 +7710,7 @@ void retesave_alpha_memories(agent* thisAgent, FILE* f)
                                        retesave_alpha_mem_and_assign_index, f);
 }
 
-void reteload_alpha_memories(agent* thisAgent, FILE* f)
+void reteload_alpha_memories(agent* thisAgent, rete_net_stream* f)
 {
     uint64_t i;
     Symbol* id, *attr, *value;
@@ -7014,7 +7729,7 @@ void reteload_alpha_memories(agent* thisAgent, FILE* f)
     }
 }
 
-alpha_mem* reteload_am_from_index(agent* thisAgent, FILE* f)
+alpha_mem* reteload_am_from_index(agent* thisAgent, rete_net_stream* f)
 {
     uint64_t amindex;
 
@@ -7056,7 +7771,7 @@ void reteload_free_am_table(agent* thisAgent)
     if list: 4 bytes (number of items) + list of symindices
 ---------------------------------------------------------------------- */
 
-void retesave_varnames(varnames* names, FILE* f)
+void retesave_varnames(varnames* names, rete_net_stream* f)
 {
     cons* c;
     uint64_t i;
@@ -7084,7 +7799,7 @@ void retesave_varnames(varnames* names, FILE* f)
     }
 }
 
-varnames* reteload_varnames(agent* thisAgent, FILE* f)
+varnames* reteload_varnames(agent* thisAgent, rete_net_stream* f)
 {
     cons* c;
     uint64_t i, count;
@@ -7116,7 +7831,7 @@ varnames* reteload_varnames(agent* thisAgent, FILE* f)
     }
 }
 
-void retesave_node_varnames(node_varnames* nvn, rete_node* node, FILE* f)
+void retesave_node_varnames(node_varnames* nvn, rete_node* node, rete_net_stream* f)
 {
     while (true)
     {
@@ -7138,7 +7853,7 @@ void retesave_node_varnames(node_varnames* nvn, rete_node* node, FILE* f)
     }
 }
 
-node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, FILE* f)
+node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, rete_net_stream* f)
 {
     node_varnames* nvn, *nvn_for_ncc;
     rete_node* temp;
@@ -7182,7 +7897,7 @@ node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, FILE* f
     for rhs_unbound_vars: 4 bytes (symindex)
 ---------------------------------------------------------------------- */
 
-void retesave_rhs_value(rhs_value rv, FILE* f)
+void retesave_rhs_value(rhs_value rv, rete_net_stream* f)
 {
     uint64_t i;
     Symbol* sym;
@@ -7221,7 +7936,7 @@ void retesave_rhs_value(rhs_value rv, FILE* f)
     }
 }
 
-rhs_value reteload_rhs_value(agent* thisAgent, FILE* f)
+rhs_value reteload_rhs_value(agent* thisAgent, rete_net_stream* f)
 {
     rhs_value rv, temp;
     uint64_t i, count;
@@ -7312,7 +8027,7 @@ rhs_value reteload_rhs_value(agent* thisAgent, FILE* f)
     record for each one (as above)
 ---------------------------------------------------------------------- */
 
-void retesave_rhs_action(action* a, FILE* f)
+void retesave_rhs_action(action* a, rete_net_stream* f)
 {
     retesave_one_byte(a->type, f);
     retesave_one_byte(a->preference_type, f);
@@ -7333,7 +8048,7 @@ void retesave_rhs_action(action* a, FILE* f)
     }
 }
 
-action* reteload_rhs_action(agent* thisAgent, FILE* f)
+action* reteload_rhs_action(agent* thisAgent, rete_net_stream* f)
 {
     action* a;
 
@@ -7362,7 +8077,7 @@ action* reteload_rhs_action(agent* thisAgent, FILE* f)
     return a;
 }
 
-void retesave_action_list(action* first_a, FILE* f)
+void retesave_action_list(action* first_a, rete_net_stream* f)
 {
     uint64_t i;
     action* a;
@@ -7375,7 +8090,7 @@ void retesave_action_list(action* first_a, FILE* f)
     }
 }
 
-action* reteload_action_list(agent* thisAgent, FILE* f)
+action* reteload_action_list(agent* thisAgent, rete_net_stream* f)
 {
     action* a, *prev_a, *first_a;
     uint64_t count;
@@ -7423,7 +8138,7 @@ action* reteload_action_list(agent* thisAgent, FILE* f)
     Rete test records (as above) for each one
 ---------------------------------------------------------------------- */
 
-void retesave_rete_test(rete_test* rt, FILE* f)
+void retesave_rete_test(rete_test* rt, rete_net_stream* f)
 {
     int i;
     cons* c;
@@ -7450,7 +8165,7 @@ void retesave_rete_test(rete_test* rt, FILE* f)
     }
 }
 
-rete_test* reteload_rete_test(agent* thisAgent, FILE* f)
+rete_test* reteload_rete_test(agent* thisAgent, rete_net_stream* f)
 {
     rete_test* rt;
     Symbol* sym;
@@ -7487,7 +8202,7 @@ rete_test* reteload_rete_test(agent* thisAgent, FILE* f)
     return rt;
 }
 
-void retesave_rete_test_list(rete_test* first_rt, FILE* f)
+void retesave_rete_test_list(rete_test* first_rt, rete_net_stream* f)
 {
     uint64_t i;
     rete_test* rt;
@@ -7500,7 +8215,7 @@ void retesave_rete_test_list(rete_test* first_rt, FILE* f)
     }
 }
 
-rete_test* reteload_rete_test_list(agent* thisAgent, FILE* f)
+rete_test* reteload_rete_test_list(agent* thisAgent, rete_net_stream* f)
 {
     rete_test* rt, *prev_rt, *first;
     uint64_t count;
@@ -7579,9 +8294,9 @@ rete_test* reteload_rete_test_list(agent* thisAgent, FILE* f)
    all its descendents, and reconstructs the Rete network structures.
 ---------------------------------------------------------------------- */
 
-void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f);
+void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, rete_net_stream* f);
 
-void retesave_children_of_node(agent* thisAgent, rete_node* node, FILE* f)
+void retesave_children_of_node(agent* thisAgent, rete_node* node, rete_net_stream* f)
 {
     rete_node* child;
     std::stack<rete_node*> nodeStack;
@@ -7604,7 +8319,7 @@ void retesave_children_of_node(agent* thisAgent, rete_node* node, FILE* f)
     }
 }
 
-void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f)
+void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, rete_net_stream* f)
 {
     uint64_t i;
     production* prod;
@@ -7715,7 +8430,7 @@ void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f)
     retesave_children_of_node(thisAgent, node, f);
 }
 
-void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
+void reteload_node_and_children(agent* thisAgent, rete_node* parent, rete_net_stream* f)
 {
     byte type, left_unlinked_flag;
     rete_node* New, *ncc_top;
@@ -7912,11 +8627,25 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
   Save_rete_net() and load_rete_net() save and load everything to and
   from the given (already open) files.  They return true if successful,
   false if any error occurred.
+
+  Clone_rete_net() loads the net of another agent into this one.  The
+  image of the source net is saved the first time the agent is cloned and
+  kept in its rete_net_snapshot.  Take_rete_net_snapshot() does just that
+  first step, so a caller can find out whether the source net can be
+  saved at all (it can't while justifications are present) before it
+  creates the agent to clone into.  The clone then points at the same
+  snapshot, since its net is now identical, so an agent cloned from a
+  clone reuses it too.  An agent lets go of its snapshot (and the last
+  one to do so frees it) whenever it adds or excises a production, so a
+  snapshot always matches the nets of the agents holding it.
+
+  Agents running on separate threads can learn, and so let go of a shared
+  snapshot, at the same time, so reference counts are only changed while
+  holding rete_net_snapshot_mutex.
 ---------------------------------------------------------------------- */
 
-bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64)
+bool retesave_rete_net(agent* thisAgent, rete_net_stream* f)
 {
-
     /* --- make sure there are no justifications present --- */
     if (thisAgent->all_productions_of_type[JUSTIFICATION_PRODUCTION_TYPE])
     {
@@ -7924,23 +8653,34 @@ bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64)
         return false;
     }
 
-    rete_fs_file = dest_file;
-    rete_net_64 = use_rete_net_64;
-    uint8_t version = use_rete_net_64 ? 4 : 3;
-
-    retesave_string("SoarCompactReteNet\n", dest_file);
-    retesave_one_byte(version, dest_file);  /* format version number */
-    retesave_symbol_table(thisAgent, dest_file);
-    retesave_alpha_memories(thisAgent, dest_file);
-    retesave_children_of_node(thisAgent, thisAgent->dummy_top_node, dest_file);
+    retesave_string("SoarCompactReteNet\n", f);
+    retesave_one_byte(f->version, f);  /* format version number */
+    retesave_symbol_table(thisAgent, f);
+    retesave_alpha_memories(thisAgent, f);
+    retesave_children_of_node(thisAgent, thisAgent->dummy_top_node, f);
     return true;
 }
 
-bool load_rete_net(agent* thisAgent, FILE* source_file)
+bool reteload_rete_net(agent* thisAgent, rete_net_stream* f)
 {
     int format_version_num;
     uint64_t i, count;
 
+    /* --- read file header, make sure it's a valid file before clearing
+       out the agent's productions --- */
+    reteload_string(f);
+    if (strcmp(reteload_string_buf, "SoarCompactReteNet\n"))
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "This file isn't a Soar fastsave file.\n");
+        return false;
+    }
+    format_version_num = reteload_one_byte(f);
+    if ((format_version_num < 3) || (format_version_num > RETE_NET_FORMAT_VERSION))
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "This file is in a format (version %d) I don't understand.\n", format_version_num);
+        return false;
+    }
+
     /* RDF: 20020814 RDF Cleaning up the agent working memory and production
        memory to avoid unnecessary errors in this function. */
     reinitialize_soar(thisAgent);
@@ -7960,39 +8700,14 @@ bool load_rete_net(agent* thisAgent, FILE* source_file)
             thisAgent->outputManager->printa_sf(thisAgent, "Internal error: load_rete_net() called with nonempty PM.\n");
             return false;
         }
+    f->version = static_cast<byte>(format_version_num);
 
-    // BADBAD: this is global, used in retesave_one_byte
-    rete_fs_file = source_file;
-
-    /* --- read file header, make sure it's a valid file --- */
-    reteload_string(source_file);
-    if (strcmp(reteload_string_buf, "SoarCompactReteNet\n"))
-    {
-        thisAgent->outputManager->printa_sf(thisAgent, "This file isn't a Soar fastsave file.\n");
-        return false;
-    }
-    format_version_num = reteload_one_byte(source_file);
-    switch (format_version_num)
-    {
-        case 3:
-            // Since there's already a global, I'm putting the 32- or 64-bit switch out there globally
-            rete_net_64 = false; // used by reteload_eight_bytes
-            break;
-        case 4:
-            // Since there's already a global, I'm putting the 32- or 64-bit switch out there globally
-            rete_net_64 = true; // used by reteload_eight_bytes
-            break;
-        default:
-            thisAgent->outputManager->printa_sf(thisAgent, "This file is in a format (version %d) I don't understand.\n", format_version_num);
-            return false;
-    }
-
-    reteload_all_symbols(thisAgent, source_file);
-    reteload_alpha_memories(thisAgent, source_file);
-    count = reteload_eight_bytes(source_file);
+    reteload_all_symbols(thisAgent, f);
+    reteload_alpha_memories(thisAgent, f);
+    count = reteload_eight_bytes(f);
     while (count--)
     {
-        reteload_node_and_children(thisAgent, thisAgent->dummy_top_node, source_file);
+        reteload_node_and_children(thisAgent, thisAgent->dummy_top_node, f);
     }
 
     /* --- clean up auxilliary tables --- */
@@ -8005,18 +8720,235 @@ bool load_rete_net(agent* thisAgent, FILE* source_file)
     return true;
 }
 
+bool save_rete_net(agent* thisAgent, FILE* dest_file, byte format_version)
+{
+    rete_net_stream f;
+    bool lSuccess;
+
+    init_rete_net_stream(&f, thisAgent->memoryManager, format_version);
+    lSuccess = retesave_rete_net(thisAgent, &f);
+    if (lSuccess && (fwrite(f.data, 1, f.size, dest_file) != f.size))
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "Error writing rete net file.\n");
+        lSuccess = false;
+    }
+    free_rete_net_stream(&f);
+    return lSuccess;
+}
+
+bool load_rete_net(agent* thisAgent, FILE* source_file)
+{
+    rete_net_stream f;
+    bool lSuccess;
+    size_t lRead;
+
+    init_rete_net_stream(&f, thisAgent->memoryManager, RETE_NET_FORMAT_VERSION);
+
+#ifndef _WIN32
+    /* --- map the rest of the file, if it's a regular file we can map --- */
+    struct stat lStat;
+    long lOffset = ftell(source_file);
+    if ((lOffset == 0) && (fstat(fileno(source_file), &lStat) == 0) && S_ISREG(lStat.st_mode) && (lStat.st_size > 0))
+    {
+        void* lMap = mmap(NIL, static_cast<size_t>(lStat.st_size), PROT_READ, MAP_PRIVATE, fileno(source_file), 0);
+        if (lMap != MAP_FAILED)
+        {
+            f.data = static_cast<uint8_t*>(lMap);
+            f.size = static_cast<size_t>(lStat.st_size);
+            lSuccess = reteload_rete_net(thisAgent, &f);
+            munmap(lMap, f.size);
+            return lSuccess;
+        }
+    }
+#endif
+
+    /* --- otherwise read it all in --- */
+    do
+    {
+        grow_rete_net_stream(&f);
+        lRead = fread(f.data + f.size, 1, f.capacity - f.size, source_file);
+        f.size += lRead;
+    }
+    while (f.size == f.capacity);
+
+    lSuccess = reteload_rete_net(thisAgent, &f);
+    free_rete_net_stream(&f);
+    return lSuccess;
+}
+
+std::mutex rete_net_snapshot_mutex;
+
+void release_rete_net_snapshot(rete_net_snapshot* snapshot)
+{
+    bool lLastReference;
+    {
+        std::lock_guard<std::mutex> lLock(rete_net_snapshot_mutex);
+        lLastReference = (--snapshot->reference_count == 0);
+    }
+    if (lLastReference)
+    {
+        free_rete_net_stream(&(snapshot->image));
+        Memory_Manager::Get_MPM().free_memory(snapshot, MISCELLANEOUS_MEM_USAGE);
+    }
+}
+
+void discard_rete_net_snapshot(agent* thisAgent)
+{
+    if (thisAgent->rete_net_snapshot)
+    {
+        release_rete_net_snapshot(thisAgent->rete_net_snapshot);
+        thisAgent->rete_net_snapshot = NIL;
+    }
+}
+
+bool take_rete_net_snapshot(agent* source_agent)
+{
+    rete_net_snapshot* lSnapshot;
+
+    if (source_agent->rete_net_snapshot)
+    {
+        return true;
+    }
+    lSnapshot = static_cast<rete_net_snapshot*>(Memory_Manager::Get_MPM().allocate_memory(sizeof(rete_net_snapshot), MISCELLANEOUS_MEM_USAGE));
+    init_rete_net_stream(&(lSnapshot->image), &Memory_Manager::Get_MPM(), RETE_NET_FORMAT_VERSION);
+    lSnapshot->reference_count = 1;
+    if (!retesave_rete_net(source_agent, &(lSnapshot->image)))
+    {
+        release_rete_net_snapshot(lSnapshot);
+        return false;
+    }
+    source_agent->rete_net_snapshot = lSnapshot;
+    return true;
+}
+
+bool clone_rete_net(agent* thisAgent, agent* source_agent)
+{
+    rete_net_snapshot* lSnapshot;
+    rete_net_stream f;
+    bool lSuccess;
 
+    /* --- take a snapshot of the source net, unless it already has one --- */
+    if (!take_rete_net_snapshot(source_agent))
+    {
+        return false;
+    }
 
+    /* --- hold on to the snapshot while loading, which lets go of this
+       agent's own snapshot, and that may be this very one --- */
+    lSnapshot = source_agent->rete_net_snapshot;
+    {
+        std::lock_guard<std::mutex> lLock(rete_net_snapshot_mutex);
+        lSnapshot->reference_count++;
+    }
+    discard_rete_net_snapshot(thisAgent);
 
+    /* --- read through a copy, so the snapshot itself is never changed --- */
+    f = lSnapshot->image;
+    f.pos = 0;
+    f.capacity = 0;
+    lSuccess = reteload_rete_net(thisAgent, &f);
 
+    /* --- the net now matches the snapshot, so keep the reference --- */
+    if (lSuccess)
+    {
+        discard_rete_net_snapshot(thisAgent);
+        thisAgent->rete_net_snapshot = lSnapshot;
+    }
+    else
+    {
+        release_rete_net_snapshot(lSnapshot);
+    }
+    return lSuccess;
+}
 
+/* ----------------------------------------------------------------------
+                      Benchmarking Rete Net Loading
+
+   Benchmark_rete_net() times saving and reloading the agent's current
+   net in format versions 4 and 5 (through a temporary file), and cloning
+   it from an in-memory snapshot, both when the snapshot has to be built
+   first and when it's already there.  Every step reloads the same net, so
+   the agent ends up with the productions it started with, but working
+   memory is reinitialized.  If the caller timed sourcing the productions,
+   source_usec is printed alongside for comparison.
+---------------------------------------------------------------------- */
 
+void benchmark_rete_net(agent* thisAgent, uint64_t source_usec)
+{
+    soar_timer lTimer;
+    uint64_t lSaveUsec[2], lLoadUsec[2], lBytes[2], lCloneUsec[2];
+    uint64_t lNumProductions = 0;
+    byte lVersions[2] = { 4, RETE_NET_FORMAT_VERSION };
+    char lLine[BUFFER_MSG_SIZE];
 
+    for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
+    {
+        lNumProductions += thisAgent->num_productions_of_type[i];
+    }
 
+    for (int i = 0; i < 2; i++)
+    {
+        FILE* lFile = tmpfile();
+        if (!lFile)
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "Could not open a temporary file for the benchmark.\n");
+            return;
+        }
+        lTimer.start();
+        bool lSaved = save_rete_net(thisAgent, lFile, lVersions[i]);
+        fflush(lFile);
+        lTimer.stop();
+        lSaveUsec[i] = lTimer.get_usec();
+        lBytes[i] = static_cast<uint64_t>(ftell(lFile));
+        rewind(lFile);
 
+        lTimer.start();
+        bool lLoaded = lSaved && load_rete_net(thisAgent, lFile);
+        lTimer.stop();
+        lLoadUsec[i] = lTimer.get_usec();
+        fclose(lFile);
 
+        if (!lLoaded)
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "Rete net benchmark failed saving or loading format version %d.\n", static_cast<int>(lVersions[i]));
+            return;
+        }
+    }
 
+    discard_rete_net_snapshot(thisAgent);
+    for (int i = 0; i < 2; i++)
+    {
+        lTimer.start();
+        bool lCloned = clone_rete_net(thisAgent, thisAgent);
+        lTimer.stop();
+        lCloneUsec[i] = lTimer.get_usec();
+        if (!lCloned)
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "Rete net benchmark failed cloning the net.\n");
+            return;
+        }
+    }
 
+    thisAgent->outputManager->printa_sf(thisAgent, "\nRete net benchmark with %u productions (times in usec):\n\n", lNumProductions);
+    SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-28s %12s %12s %12s\n", "Method", "Bytes", "Save", "Load");
+    thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    if (source_usec)
+    {
+        SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-28s %12s %12s %12llu\n", "source", "-", "-", static_cast<unsigned long long>(source_usec));
+        thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-28s %12llu %12llu %12llu\n", (i == 0) ? "rete-net, version 4" : "rete-net, version 5",
+                 static_cast<unsigned long long>(lBytes[i]), static_cast<unsigned long long>(lSaveUsec[i]), static_cast<unsigned long long>(lLoadUsec[i]));
+        thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    }
+    SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-28s %12llu %12s %12llu\n", "clone, new snapshot",
+             static_cast<unsigned long long>(thisAgent->rete_net_snapshot ? thisAgent->rete_net_snapshot->image.size : 0), "-", static_cast<unsigned long long>(lCloneUsec[0]));
+    thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-28s %12s %12s %12llu\n", "clone, cached snapshot", "-", "-", static_cast<unsigned long long>(lCloneUsec[1]));
+    thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+}
 
 /* **********************************************************************
 
@@ -8073,6 +9005,132 @@ uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod)
     return count;
 }
 
+/* ----------------------------------------------------------------------
+                         Match Cost Profiler
+
+   Set_rete_profiler() turns the profiler on or off.  Turning it off
+   keeps what it has collected so far; clear_rete_profiler() throws that
+   away.  Free_rete_profiler() releases it when the agent is destroyed.
+
+   Get_rete_profile() charges the cost of each profiled beta node to the
+   productions that use it, in equal shares, and returns the productions
+   that have any cost, most expensive first.  The nodes of a production
+   are the ones sharing factors are counted over: its p-node and every
+   node above it, including the nodes of its NCC subnetworks.
+---------------------------------------------------------------------- */
+
+void set_rete_profiler(agent* thisAgent, bool enabled)
+{
+    if (!thisAgent->rete_profiler)
+    {
+        if (!enabled)
+        {
+            return;
+        }
+        thisAgent->rete_profiler = new rete_profiler();
+        thisAgent->rete_profiler->current = NIL;
+    }
+    thisAgent->rete_profiler->enabled = enabled;
+}
+
+bool rete_profiler_enabled(agent* thisAgent)
+{
+    return (thisAgent->rete_profiler && thisAgent->rete_profiler->enabled);
+}
+
+void clear_rete_profiler(agent* thisAgent)
+{
+    if (thisAgent->rete_profiler)
+    {
+        thisAgent->rete_profiler->nodes.clear();
+    }
+}
+
+void free_rete_profiler(agent* thisAgent)
+{
+    delete thisAgent->rete_profiler;
+    thisAgent->rete_profiler = NIL;
+}
+
+inline rete_node* next_node_of_production(rete_node* node)
+{
+    return ((node->node_type == CN_BNODE) ? node->b.cn.partner : node->parent);
+}
+
+bool rete_profile_sort(const rete_production_profile& a, const rete_production_profile& b)
+{
+    if (a.usec != b.usec)
+    {
+        return (a.usec > b.usec);
+    }
+    return (a.join_candidates > b.join_candidates);
+}
+
+void get_rete_profile(agent* thisAgent, std::vector<rete_production_profile>& profiles)
+{
+    std::unordered_map<rete_node*, uint64_t> lShares;
+    std::unordered_map<rete_node*, rete_node_profile>::iterator lStats;
+    rete_production_profile lProfile;
+    production* prod;
+    rete_node* node;
+    double lRawPerUsec, lShare;
+
+    profiles.clear();
+    if (!thisAgent->rete_profiler || thisAgent->rete_profiler->nodes.empty())
+    {
+        return;
+    }
+
+    /* --- count the productions using each node --- */
+    for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
+    {
+        for (prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            for (node = prod->p_node; node && (node != thisAgent->dummy_top_node); node = next_node_of_production(node))
+            {
+                lShares[node]++;
+            }
+        }
+    }
+
+    /* --- give each production its share of every node it uses --- */
+    lRawPerUsec = get_raw_time_per_usec();
+    for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
+    {
+        for (prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            lProfile.prod = prod;
+            lProfile.left_activations = 0;
+            lProfile.right_activations = 0;
+            lProfile.join_candidates = 0;
+            lProfile.tokens = 0;
+            lProfile.usec = 0;
+
+            for (node = prod->p_node; node && (node != thisAgent->dummy_top_node); node = next_node_of_production(node))
+            {
+                lStats = thisAgent->rete_profiler->nodes.find(node);
+                if (lStats == thisAgent->rete_profiler->nodes.end())
+                {
+                    continue;
+                }
+                lShare = 1.0 / static_cast<double>(lShares[node]);
+                lProfile.left_activations += lShare * lStats->second.left_activations;
+                lProfile.right_activations += lShare * lStats->second.right_activations;
+                lProfile.join_candidates += lShare * lStats->second.join_candidates;
+                lProfile.tokens += lShare * lStats->second.tokens;
+                lProfile.usec += lShare * (lStats->second.ticks / lRawPerUsec);
+            }
+
+            if (lProfile.left_activations || lProfile.right_activations)
+            {
+                profiles.push_back(lProfile);
+            }
+        }
+    }
+
+    std::sort(profiles.begin(), profiles.end(), rete_profile_sort);
+}
+
 /* --------------------------------------------------------------------
                           Rete Statistics
 
@@ -9561,8 +10619,8 @@ void init_rete(agent* thisAgent)
         thisAgent->alpha_hash_tables[i] = make_hash_table(thisAgent, 0, hash_alpha_mem);
     }
 
-    thisAgent->left_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * LEFT_HT_SIZE, HASH_TABLE_MEM_USAGE);
-    thisAgent->right_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * RIGHT_HT_SIZE, HASH_TABLE_MEM_USAGE);
+    thisAgent->left_ht = make_rete_hash_table(thisAgent);
+    thisAgent->right_ht = make_rete_hash_table(thisAgent);
 
     init_dummy_top_node(thisAgent);
 
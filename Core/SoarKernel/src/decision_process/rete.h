@@ -43,12 +43,19 @@
    Count_rete_tokens_for_production() returns a count of the number of
    tokens currently in use for the given production.
 
+   Set_rete_profiler() turns on the match cost profiler, which counts
+   the activations, join candidates and tokens of each beta node and
+   times it.  Get_rete_profile() divides those costs among the
+   productions sharing each node and returns them, most expensive first.
+
    Print_partial_match_information(), print_match_set(), and
    print_rete_statistics() do printouts for various interface routines.
 
    Save_rete_net() and load_rete_net() are used for the fastsave/load
    commands.  They save/load everything to/from the given (already open)
    files.  They return true if successful, false if any error occurred.
+   Clone_rete_net() loads another agent's net straight from an in-memory
+   snapshot of it, without going through a file.
 ======================================================================= */
 
 #ifndef RETE_H
@@ -57,6 +64,8 @@
 #include <stdio.h>  // Needed for FILE token below
 #include "kernel.h"
 
+#include <vector>
+
 extern void abort_with_fatal_error_noagent(const char* msg);
 
 inline varnames* one_var_to_varnames(Symbol* x)
@@ -142,6 +151,16 @@ typedef struct alpha_mem_struct
     uint32_t am_id;            /* id for hashing */
     uint64_t reference_count;  /* number of beta nodes using this mem */
     uint64_t retesave_amindex;
+    uint64_t num_right_mems;   /* length of right_mems dll */
+    /* --- once an alpha mem gets large, its right_mems are also kept in
+       parallel arrays, oldest first, so joins can scan the wme fields
+       without chasing pointers (see rete.cpp).  Removed entries are NIL
+       until the arrays are compacted. --- */
+    struct right_mem_struct** rm_array;
+    Symbol** field_array[3];   /* id, attr and value of each rm's wme */
+    uint32_t array_size;       /* entries in use, including removed ones */
+    uint32_t array_capacity;
+    uint32_t array_holes;      /* removed entries not yet compacted */
 } alpha_mem;
 
 /* --- the entry for one WME in one alpha memory --- */
@@ -152,10 +171,38 @@ typedef struct right_mem_struct
     struct right_mem_struct* next_in_bucket, *prev_in_bucket; /*hash bucket dll*/
     struct right_mem_struct* next_in_am, *prev_in_am;       /*rm's in this amem*/
     struct right_mem_struct* next_from_wme, *prev_from_wme; /*tree-based remove*/
+    uint32_t array_index;        /* position in am->rm_array, if it has one */
 } right_mem;
 
 /* Note: right_mem's are stored in hash table thisAgent->right_ht */
 
+/* --- hash table for tokens (left_ht) or right_mem's (right_ht) ---
+   These grow and shrink with the number of entries, but never all at
+   once.  After a resize, entries are moved from the old bucket array to
+   the new one a few buckets at a time, between WME changes.  Until an
+   old bucket has been moved, entries that hash to it stay there. */
+typedef struct rete_hash_table_struct
+{
+    void**   buckets;            /* current bucket array */
+    void**   old_buckets;        /* array still being drained, or NIL */
+    uint32_t mask;               /* size of buckets - 1 */
+    uint32_t old_mask;           /* size of old_buckets - 1 */
+    uint32_t next_old_bucket;    /* old buckets below this have been moved */
+    uint64_t count;              /* number of entries in both arrays */
+    uint64_t changes_since_step; /* inserts + removes since entries were last moved */
+    uint64_t num_resizes;
+} rete_hash_table;
+
+typedef struct rete_hash_table_stats_struct
+{
+    uint64_t size;               /* buckets in the current array */
+    uint64_t old_size;           /* buckets in the array being drained, if any */
+    uint64_t count;
+    uint64_t buckets_used;       /* non-empty buckets in both arrays */
+    uint64_t longest_chain;
+    uint64_t num_resizes;
+} rete_hash_table_stats;
+
 typedef struct var_location_struct
 {
     rete_node_level levels_up; /* 0=current node's alphamem, 1=parent's, etc. */
@@ -365,6 +412,46 @@ typedef struct ms_change_struct
     struct ms_change_struct* next_in_level; /* dll for goal level */
     struct ms_change_struct* prev_in_level;
 } ms_change;
+
+/* --- A saved rete net held in memory.  Save_rete_net() builds the whole
+   image in one of these before writing it out, and load_rete_net() maps
+   the file into one. --- */
+#define RETE_NET_FORMAT_VERSION 5
+
+typedef struct rete_net_stream_struct
+{
+    uint8_t*        data;
+    size_t          size;        /* bytes written, or bytes available to read */
+    size_t          capacity;    /* bytes allocated; 0 if the stream doesn't own data */
+    size_t          pos;         /* next byte to read */
+    byte            version;     /* format version being written or read */
+    Memory_Manager* memoryManager;
+} rete_net_stream;
+
+/* --- The image of an agent's net that other agents are cloned from.
+   Every agent whose net was built from the image holds a reference to
+   it, so a whole family of clones shares a single read-only copy.  Its
+   memory comes from the shared memory manager, not any one agent's, so
+   it outlives the agent it was first taken from. --- */
+typedef struct rete_net_snapshot_struct
+{
+    rete_net_stream image;
+    uint64_t        reference_count;   /* agents whose net matches the image */
+} rete_net_snapshot;
+
+/* --- Match cost the profiler charges to one production.  The cost of a
+   beta node shared by several productions is split evenly among them,
+   so the shares are fractional. --- */
+typedef struct rete_production_profile_struct
+{
+    production* prod;
+    double      left_activations;
+    double      right_activations;
+    double      join_candidates;
+    double      tokens;
+    double      usec;             /* time in the production's beta nodes */
+} rete_production_profile;
+
 extern void init_rete(agent* thisAgent);
 
 extern bool any_assertions_or_retractions_ready(agent* thisAgent);
@@ -389,8 +476,10 @@ extern void excise_production_from_rete(agent* thisAgent, production* p);
 extern void add_wme_to_rete(agent* thisAgent, wme* w);
 extern void remove_wme_from_rete(agent* thisAgent, wme* w);
 
-void retesave_eight_bytes(uint64_t w, FILE* f);
-void retesave_string(const char* s, FILE* f);
+void retesave_eight_bytes(uint64_t w, rete_net_stream* f);
+void retesave_int_value(int64_t i, rete_net_stream* f);
+void retesave_float_value(double d, rete_net_stream* f);
+void retesave_string(const char* s, rete_net_stream* f);
 
 extern void p_node_to_conditions_and_rhs(agent* thisAgent,
         struct rete_node_struct* p_node,
@@ -405,6 +494,11 @@ extern Symbol* get_symbol_from_rete_loc(unsigned short levels_up,
                                         struct token_struct* tok, wme* w);
 
 extern uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod);
+extern void set_rete_profiler(agent* thisAgent, bool enabled);
+extern bool rete_profiler_enabled(agent* thisAgent);
+extern void clear_rete_profiler(agent* thisAgent);
+extern void free_rete_profiler(agent* thisAgent);
+extern void get_rete_profile(agent* thisAgent, std::vector<rete_production_profile>& profiles);
 extern void print_partial_match_information(agent* thisAgent, struct rete_node_struct* p_node,
         wme_trace_type wtt);
 extern void xml_partial_match_information(agent* thisAgent, rete_node* p_node, wme_trace_type wtt) ;
@@ -412,12 +506,18 @@ extern void xml_partial_match_information(agent* thisAgent, rete_node* p_node, w
 extern void print_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void xml_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void get_all_node_count_stats(agent* thisAgent);
+extern void get_rete_hash_table_stats(agent* thisAgent, bool left, rete_hash_table_stats* stats);
+extern void free_rete_hash_tables(agent* thisAgent);
 extern int get_node_count_statistic(agent* thisAgent, char* node_type_name,
                                     char* column_name,
                                     uint64_t* result);
 
-extern bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64);
+extern bool save_rete_net(agent* thisAgent, FILE* dest_file, byte format_version = RETE_NET_FORMAT_VERSION);
 extern bool load_rete_net(agent* thisAgent, FILE* source_file);
+extern bool take_rete_net_snapshot(agent* source_agent);
+extern bool clone_rete_net(agent* thisAgent, agent* source_agent);
+extern void discard_rete_net_snapshot(agent* thisAgent);
+extern void benchmark_rete_net(agent* thisAgent, uint64_t source_usec);
 
 extern void add_varnames_to_test(agent* thisAgent, varnames* vn, test* t);
 
@@ -39,6 +39,7 @@
 #include "soar_rand.h"
 #include "stats.h"
 #include "symbol.h"
+#include "timeline.h"
 #include "working_memory_activation.h"
 #include "working_memory.h"
 #include "xml.h"
@@ -293,6 +294,7 @@ void reset_statistics(agent* thisAgent)
     thisAgent->SMem->timers->reset();
 
     thisAgent->WM->wma_d_cycle_count = 0;
+    thisAgent->WM->wma_forget_wheel_cycle = 0;
 }
 
 void reset_timers(agent* thisAgent)
@@ -344,6 +346,8 @@ void reset_max_stats(agent* thisAgent)
     thisAgent->max_dc_smem_time_sec = 0;
     thisAgent->total_dc_smem_time_sec = -1;
     thisAgent->max_dc_smem_time_cycle = 0;
+
+    thisAgent->dc_latency->reset();
 #endif // NO_TIMING_STUFF
 }
 
@@ -439,6 +443,13 @@ void do_one_top_level_phase(agent* thisAgent)
         return;
     }
 
+    /* The phase can advance inside the switch, so remember which one to close */
+    top_level_phase lPhase = thisAgent->current_phase;
+    thisAgent->timeline->begin(lPhase);
+#ifndef NO_TIMING_STUFF
+    thisAgent->dc_latency->start_phase(thisAgent);
+#endif
+
     switch (thisAgent->current_phase)
     {
 
@@ -1098,6 +1109,11 @@ void do_one_top_level_phase(agent* thisAgent)
 
     }  /* end switch stmt for current_phase */
 
+#ifndef NO_TIMING_STUFF
+    thisAgent->dc_latency->stop_phase(thisAgent, lPhase);
+#endif
+    thisAgent->timeline->end(lPhase);
+
     /* --- update WM size statistics --- */
     if (thisAgent->num_wmes_in_rete > thisAgent->max_wm_size)
     {
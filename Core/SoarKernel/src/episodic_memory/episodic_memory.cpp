@@ -18,6 +18,7 @@
 #include "semantic_memory.h"
 #include "slot.h"
 #include "symbol.h"
+#include "timeline.h"
 #include "output_manager.h"
 #include "print.h"
 #include "production.h"
@@ -32,6 +33,9 @@
 #include <fstream>
 #include <set>
 #include <climits>
+#include <cstring>
+#include <atomic>
+#include <system_error>
 
 
 //////////////////////////////////////////////////////////
@@ -128,6 +132,36 @@ epmem_param_container::epmem_param_container(agent* new_agent): soar_module::par
     lazy_commit = new soar_module::boolean_param("lazy-commit", on, new epmem_db_predicate<boolean>(thisAgent));
     add(lazy_commit);
 
+    // write-behind
+    write_behind = new soar_module::boolean_param("write-behind", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(write_behind);
+
+    // backend
+    backend = new soar_module::constant_param<backend_choices>("backend", backend_sqlite, new epmem_db_predicate<backend_choices>(thisAgent));
+    backend->add_mapping(backend_sqlite, "sqlite");
+    backend->add_mapping(backend_log, "log");
+    add(backend);
+
+    ////////////////////
+    // Retention
+    ////////////////////
+
+    // retention
+    retention = new soar_module::boolean_param("retention", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(retention);
+
+    // retention-recent
+    retention_recent = new soar_module::integer_param("retention-recent", 10000, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(retention_recent);
+
+    // retention-stride
+    retention_stride = new soar_module::integer_param("retention-stride", 10, new soar_module::gt_predicate<int64_t>(0, true), new soar_module::f_predicate<int64_t>());
+    add(retention_stride);
+
+    // retention-batch
+    retention_batch = new soar_module::integer_param("retention-batch", 100, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(retention_batch);
+
     ////////////////////
     // Retrieval
     ////////////////////
@@ -174,6 +208,22 @@ epmem_param_container::epmem_param_container(agent* new_agent): soar_module::par
     opt->add_mapping(epmem_param_container::opt_speed, "performance");
     add(opt);
 
+    // interval index
+    interval_index = new soar_module::boolean_param("interval-index", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(interval_index);
+
+    // summaries
+    summaries = new soar_module::boolean_param("summaries", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(summaries);
+
+    // summary-block
+    summary_block = new soar_module::integer_param("summary-block", 1024, new soar_module::gt_predicate<int64_t>(1, true), new epmem_db_predicate<int64_t>(thisAgent));
+    add(summary_block);
+
+    // query threads
+    query_threads = new soar_module::integer_param("query-threads", 1, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(query_threads);
+
 
     ////////////////////
     // Experimental
@@ -515,6 +565,8 @@ epmem_hash_id epmem_temporal_hash(agent* thisAgent, Symbol* sym, bool add_on_fai
             sym->epmem_hash = NIL;
             sym->epmem_valid = thisAgent->EpMem->epmem_validation;
 
+            epmem_flush_writer(thisAgent);
+
             switch (sym->symbol_type)
             {
                 case STR_CONSTANT_SYMBOL_TYPE:
@@ -609,10 +661,42 @@ epmem_stat_container::epmem_stat_container(agent* new_agent): soar_module::stat_
     qry_lits = new soar_module::integer_stat("qry-lits", 0, new soar_module::f_predicate<int64_t>());
     add(qry_lits);
 
+    // qry-index
+    qry_index = new soar_module::integer_stat("qry-index", 0, new soar_module::f_predicate<int64_t>());
+    add(qry_index);
+
+    // qry-threads
+    qry_threads = new soar_module::integer_stat("qry-threads", 0, new soar_module::f_predicate<int64_t>());
+    add(qry_threads);
+
+    // qry-pruned
+    qry_pruned = new soar_module::integer_stat("qry-pruned", 0, new soar_module::f_predicate<int64_t>());
+    add(qry_pruned);
+
     // next-id
     next_id = new epmem_node_id_stat("next-id", 0, new epmem_db_predicate<epmem_node_id>(thisAgent));
     add(next_id);
 
+    // retention-through
+    retention_through = new epmem_time_id_stat("retention-through", 0, new epmem_db_predicate<epmem_time_id>(thisAgent));
+    add(retention_through);
+
+    // retention-dropped
+    retention_dropped = new soar_module::integer_stat("retention-dropped", 0, new soar_module::f_predicate<int64_t>());
+    add(retention_dropped);
+
+    // retention-reclaimed
+    retention_reclaimed = new soar_module::integer_stat("retention-reclaimed", 0, new soar_module::f_predicate<int64_t>());
+    add(retention_reclaimed);
+
+    // log-flushes
+    log_flushes = new soar_module::integer_stat("log-flushes", 0, new soar_module::f_predicate<int64_t>());
+    add(log_flushes);
+
+    // log-superseded
+    log_superseded = new soar_module::integer_stat("log-superseded", 0, new soar_module::f_predicate<int64_t>());
+    add(log_superseded);
+
     // rit-offset-1
     rit_offset_1 = new soar_module::integer_stat("rit-offset-1", 0, new epmem_db_predicate<int64_t>(thisAgent));
     add(rit_offset_1);
@@ -743,6 +827,9 @@ epmem_timer_container::epmem_timer_container(agent* new_agent): soar_module::tim
     wm_phase = new epmem_timer("epmem_wm_phase", thisAgent, soar_module::timer::two);
     add(wm_phase);
 
+    retention = new epmem_timer("epmem_retention", thisAgent, soar_module::timer::two);
+    add(retention);
+
     // three
 
     ncb_edge = new epmem_timer("ncb_edge", thisAgent, soar_module::timer::three);
@@ -1160,6 +1247,94 @@ epmem_graph_statement_container::epmem_graph_statement_container(agent* new_agen
     update_epmem_wmes_identifier_last_episode_id = new soar_module::sqlite_statement(new_db, "UPDATE epmem_wmes_identifier SET last_episode_id=? WHERE wi_id=?");
     add(update_epmem_wmes_identifier_last_episode_id);
 
+    // retention
+    drop_episodes = new soar_module::sqlite_statement(new_db, "DELETE FROM epmem_episodes WHERE episode_id>? AND episode_id<=? AND (?=0 OR (episode_id % ?)<>0)");
+    add(drop_episodes);
+
+    kept_episode_before = new soar_module::sqlite_statement(new_db, "SELECT episode_id FROM epmem_episodes WHERE episode_id<=? ORDER BY episode_id DESC LIMIT 1");
+    add(kept_episode_before);
+
+    kept_episode_after = new soar_module::sqlite_statement(new_db, "SELECT episode_id FROM epmem_episodes WHERE episode_id>=? ORDER BY episode_id ASC LIMIT 1");
+    add(kept_episode_after);
+
+    {
+        const char* retention_queries[9][2] =
+        {
+            // wmes whose intervals end in (?, ?]
+            {
+                "SELECT wc_id, end_episode_id FROM epmem_wmes_constant_range WHERE end_episode_id>? AND end_episode_id<=? UNION ALL SELECT wc_id, episode_id FROM epmem_wmes_constant_point WHERE episode_id>? AND episode_id<=? ORDER BY 2",
+                "SELECT wi_id, end_episode_id FROM epmem_wmes_identifier_range WHERE end_episode_id>? AND end_episode_id<=? UNION ALL SELECT wi_id, episode_id FROM epmem_wmes_identifier_point WHERE episode_id>? AND episode_id<=? ORDER BY 2"
+            },
+            // start of the wme's interval that ends at ?
+            {
+                "SELECT start_episode_id FROM epmem_wmes_constant_range WHERE wc_id=? AND end_episode_id=? UNION ALL SELECT episode_id FROM epmem_wmes_constant_point WHERE wc_id=? AND episode_id=?",
+                "SELECT start_episode_id FROM epmem_wmes_identifier_range WHERE wi_id=? AND end_episode_id=? UNION ALL SELECT episode_id FROM epmem_wmes_identifier_point WHERE wi_id=? AND episode_id=?"
+            },
+            // end of the wme's interval that starts at ? (none for a NOW interval)
+            {
+                "SELECT end_episode_id FROM epmem_wmes_constant_range WHERE wc_id=? AND start_episode_id=? UNION ALL SELECT episode_id FROM epmem_wmes_constant_point WHERE wc_id=? AND episode_id=?",
+                "SELECT end_episode_id FROM epmem_wmes_identifier_range WHERE wi_id=? AND start_episode_id=? UNION ALL SELECT episode_id FROM epmem_wmes_identifier_point WHERE wi_id=? AND episode_id=?"
+            },
+            // start of the wme's first interval after ?
+            {
+                "SELECT MIN(s) FROM (SELECT MIN(start_episode_id) AS s FROM epmem_wmes_constant_range WHERE wc_id=? AND start_episode_id>? UNION ALL SELECT MIN(episode_id) FROM epmem_wmes_constant_point WHERE wc_id=? AND episode_id>? UNION ALL SELECT MIN(start_episode_id) FROM epmem_wmes_constant_now WHERE wc_id=? AND start_episode_id>?)",
+                "SELECT MIN(s) FROM (SELECT MIN(start_episode_id) AS s FROM epmem_wmes_identifier_range WHERE wi_id=? AND start_episode_id>? UNION ALL SELECT MIN(episode_id) FROM epmem_wmes_identifier_point WHERE wi_id=? AND episode_id>? UNION ALL SELECT MIN(start_episode_id) FROM epmem_wmes_identifier_now WHERE wi_id=? AND start_episode_id>?)"
+            },
+            {
+                "DELETE FROM epmem_wmes_constant_range WHERE wc_id=? AND start_episode_id=?",
+                "DELETE FROM epmem_wmes_identifier_range WHERE wi_id=? AND start_episode_id=?"
+            },
+            {
+                "DELETE FROM epmem_wmes_constant_point WHERE wc_id=? AND episode_id=?",
+                "DELETE FROM epmem_wmes_identifier_point WHERE wi_id=? AND episode_id=?"
+            },
+            {
+                "UPDATE epmem_wmes_constant_now SET start_episode_id=? WHERE wc_id=?",
+                "UPDATE epmem_wmes_identifier_now SET start_episode_id=? WHERE wi_id=?"
+            },
+            // all of the wme's closed intervals, for the interval index
+            {
+                "SELECT start_episode_id, end_episode_id FROM epmem_wmes_constant_range WHERE wc_id=? UNION ALL SELECT episode_id, episode_id FROM epmem_wmes_constant_point WHERE wc_id=? ORDER BY 1, 2",
+                "SELECT start_episode_id, end_episode_id FROM epmem_wmes_identifier_range WHERE wi_id=? UNION ALL SELECT episode_id, episode_id FROM epmem_wmes_identifier_point WHERE wi_id=? ORDER BY 1, 2"
+            },
+            {
+                "SELECT start_episode_id FROM epmem_wmes_constant_now WHERE wc_id=?",
+                "SELECT start_episode_id FROM epmem_wmes_identifier_now WHERE wi_id=?"
+            }
+        };
+
+        for (int j = EPMEM_RIT_STATE_NODE; j <= EPMEM_RIT_STATE_EDGE; j++)
+        {
+            retention_ending[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[0][ j ]);
+            add(retention_ending[ j ]);
+            retention_find_start[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[1][ j ]);
+            add(retention_find_start[ j ]);
+            retention_find_end[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[2][ j ]);
+            add(retention_find_end[ j ]);
+            retention_next_start[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[3][ j ]);
+            add(retention_next_start[ j ]);
+            retention_delete_range[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[4][ j ]);
+            add(retention_delete_range[ j ]);
+            retention_delete_point[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[5][ j ]);
+            add(retention_delete_point[ j ]);
+            retention_update_now[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[6][ j ]);
+            add(retention_update_now[ j ]);
+            retention_intervals[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[7][ j ]);
+            add(retention_intervals[ j ]);
+            retention_now[ j ] = new soar_module::sqlite_statement(new_db, retention_queries[8][ j ]);
+            add(retention_now[ j ]);
+        }
+    }
+
+    page_count = new soar_module::sqlite_statement(new_db, "PRAGMA page_count");
+    add(page_count);
+
+    freelist_count = new soar_module::sqlite_statement(new_db, "PRAGMA freelist_count");
+    add(freelist_count);
+
+    page_size = new soar_module::sqlite_statement(new_db, "PRAGMA page_size");
+    add(page_size);
+
     // init statement pools
     {
         int j, k, m;
@@ -1374,69 +1549,909 @@ inline void _epmem_process_buffered_wme_list(agent* thisAgent, Symbol* state, wm
     }
 }
 
-inline void epmem_process_buffered_wmes(agent* thisAgent, Symbol* state, wme_set& cue_wmes, symbol_triple_list& meta_wmes, symbol_triple_list& retrieval_wmes)
+inline void epmem_process_buffered_wmes(agent* thisAgent, Symbol* state, wme_set& cue_wmes, symbol_triple_list& meta_wmes, symbol_triple_list& retrieval_wmes)
+{
+    _epmem_process_buffered_wme_list(thisAgent, state, cue_wmes, meta_wmes, state->id->epmem_info->epmem_wmes);
+    _epmem_process_buffered_wme_list(thisAgent, state, cue_wmes, retrieval_wmes, NULL);
+}
+
+inline void epmem_buffer_add_wme(agent* thisAgent, symbol_triple_list& my_list, Symbol* id, Symbol* attr, Symbol* value)
+{
+    my_list.push_back(new symbol_triple(id, attr, value));
+
+    thisAgent->symbolManager->symbol_add_ref(id);
+    thisAgent->symbolManager->symbol_add_ref(attr);
+    thisAgent->symbolManager->symbol_add_ref(value);
+}
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Variable Functions (epmem::var)
+//
+// Variables are key-value pairs stored in the database
+// that are necessary to maintain a store between
+// multiple runs of Soar.
+//
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+/***************************************************************************
+ * Function     : epmem_get_variable
+ * Author       : Nate Derbinsky
+ * Notes        : Gets an EpMem variable from the database
+ **************************************************************************/
+bool epmem_get_variable(agent* thisAgent, epmem_variable_key variable_id, int64_t* variable_value)
+{
+    soar_module::exec_result status;
+    soar_module::sqlite_statement* var_get = thisAgent->EpMem->epmem_stmts_common->var_get;
+
+    var_get->bind_int(1, variable_id);
+    status = var_get->execute();
+
+    if (status == soar_module::row)
+    {
+        (*variable_value) = var_get->column_int(0);
+    }
+
+    var_get->reinitialize();
+
+    return (status == soar_module::row);
+}
+
+/***************************************************************************
+ * Function     : epmem_set_variable
+ * Author       : Nate Derbinsky
+ * Notes        : Sets an EpMem variable in the database
+ **************************************************************************/
+void epmem_set_variable(agent* thisAgent, epmem_variable_key variable_id, int64_t variable_value)
+{
+    soar_module::sqlite_statement* var_set = thisAgent->EpMem->epmem_stmts_common->var_set;
+
+    var_set->bind_int(1, variable_id);
+    var_set->bind_int(2, variable_value);
+
+    var_set->execute(soar_module::op_reinit);
+}
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Interval Index Functions (epmem::intervals)
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+/***************************************************************************
+ * Function     : epmem_interval_index_entry
+ * Notes        : Returns the intervals of a wme (wc_id or wi_id),
+ *                growing the index if the id is new
+ **************************************************************************/
+inline epmem_wme_intervals* epmem_interval_index_entry(agent* thisAgent, int type, int64_t id)
+{
+    epmem_interval_index* index = thisAgent->EpMem->epmem_intervals[ type ];
+
+    if (static_cast<size_t>(id) >= index->size())
+    {
+        epmem_wme_intervals empty;
+        empty.now_start = EPMEM_MEMID_NONE;
+        index->resize(static_cast<size_t>(id) + 1, empty);
+    }
+
+    return &((*index)[ static_cast<size_t>(id) ]);
+}
+
+/***************************************************************************
+ * Function     : epmem_update_interval_index
+ * Notes        : Keeps the interval index in step with a write to
+ *                the NOW, point or range tables
+ **************************************************************************/
+void epmem_update_interval_index(agent* thisAgent, const epmem_write& w)
+{
+    epmem_time_range range;
+
+    switch (w.type)
+    {
+        case EPMEM_WRITE_CONSTANT_NOW:
+        case EPMEM_WRITE_IDENTIFIER_NOW:
+            epmem_interval_index_entry(thisAgent, (w.type == EPMEM_WRITE_CONSTANT_NOW) ? EPMEM_RIT_STATE_NODE : EPMEM_RIT_STATE_EDGE, w.args[0])->now_start = w.args[1];
+            break;
+
+        case EPMEM_WRITE_CONSTANT_NOW_DELETE:
+        case EPMEM_WRITE_IDENTIFIER_NOW_DELETE:
+            epmem_interval_index_entry(thisAgent, (w.type == EPMEM_WRITE_CONSTANT_NOW_DELETE) ? EPMEM_RIT_STATE_NODE : EPMEM_RIT_STATE_EDGE, w.args[0])->now_start = EPMEM_MEMID_NONE;
+            break;
+
+        case EPMEM_WRITE_CONSTANT_POINT:
+        case EPMEM_WRITE_IDENTIFIER_POINT:
+            range.start = w.args[1];
+            range.end = w.args[1];
+            epmem_interval_index_entry(thisAgent, (w.type == EPMEM_WRITE_CONSTANT_POINT) ? EPMEM_RIT_STATE_NODE : EPMEM_RIT_STATE_EDGE, w.args[0])->ranges.push_back(range);
+            break;
+
+        case EPMEM_WRITE_RANGE:
+            // (rit, node, start, end, id)
+            range.start = w.args[2];
+            range.end = w.args[3];
+            epmem_interval_index_entry(thisAgent, static_cast<int>(w.args[0]), w.args[4])->ranges.push_back(range);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_build_interval_index
+ * Notes        : Loads the range, point and NOW tables into the
+ *                interval index.  The database stays the only
+ *                persistent copy; the index is rebuilt from it
+ *                whenever the database is opened.
+ **************************************************************************/
+void epmem_build_interval_index(agent* thisAgent)
+{
+    const char* range_select[] =
+    {
+        "SELECT wc_id, start_episode_id, end_episode_id FROM epmem_wmes_constant_range UNION ALL "
+        "SELECT wc_id, episode_id, episode_id FROM epmem_wmes_constant_point ORDER BY 1, 2",
+        "SELECT wi_id, start_episode_id, end_episode_id FROM epmem_wmes_identifier_range UNION ALL "
+        "SELECT wi_id, episode_id, episode_id FROM epmem_wmes_identifier_point ORDER BY 1, 2"
+    };
+    const char* now_select[] = { "SELECT wc_id, start_episode_id FROM epmem_wmes_constant_now", "SELECT wi_id, start_episode_id FROM epmem_wmes_identifier_now" };
+    soar_module::sqlite_statement* temp_q;
+    epmem_time_range range;
+
+    for (int type = EPMEM_RIT_STATE_NODE; type <= EPMEM_RIT_STATE_EDGE; type++)
+    {
+        thisAgent->EpMem->epmem_intervals[ type ]->clear();
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, range_select[ type ]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            range.start = temp_q->column_int(1);
+            range.end = temp_q->column_int(2);
+            epmem_interval_index_entry(thisAgent, type, temp_q->column_int(0))->ranges.push_back(range);
+        }
+        delete temp_q;
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, now_select[ type ]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            epmem_interval_index_entry(thisAgent, type, temp_q->column_int(0))->now_start = temp_q->column_int(1);
+        }
+        delete temp_q;
+    }
+
+    thisAgent->EpMem->epmem_intervals_built = true;
+}
+
+/***************************************************************************
+ * Function     : epmem_clear_interval_index
+ **************************************************************************/
+void epmem_clear_interval_index(agent* thisAgent)
+{
+    for (int type = EPMEM_RIT_STATE_NODE; type <= EPMEM_RIT_STATE_EDGE; type++)
+    {
+        epmem_interval_index().swap(*thisAgent->EpMem->epmem_intervals[ type ]);
+    }
+
+    thisAgent->EpMem->epmem_intervals_built = false;
+}
+
+inline bool epmem_range_starts_after(epmem_time_id time, const epmem_time_range& range)
+{
+    return (time < range.start);
+}
+
+/***************************************************************************
+ * Function     : epmem_interval_index_find
+ * Notes        : Index counterpart of the pool_find_interval_queries:
+ *                positions the interval at the latest start (or end)
+ *                point of the wme at or before current_episode.
+ *                Points are kept with the ranges, so the EP cursor
+ *                covers both and there is no separate point cursor.
+ **************************************************************************/
+bool epmem_interval_index_find(agent* thisAgent, epmem_interval* interval, int type, int interval_type, int64_t id, epmem_time_id current_episode)
+{
+    epmem_interval_index* index = thisAgent->EpMem->epmem_intervals[ type ];
+
+    interval->ranges = NULL;
+    interval->range_pos = -1;
+
+    if (static_cast<size_t>(id) >= index->size())
+    {
+        return false;
+    }
+    const epmem_wme_intervals& intervals = (*index)[ static_cast<size_t>(id) ];
+
+    if (interval_type == EPMEM_RANGE_NOW)
+    {
+        if ((intervals.now_start == EPMEM_MEMID_NONE) || (intervals.now_start > current_episode))
+        {
+            return false;
+        }
+
+        interval->time = (interval->is_end_point ? current_episode : (intervals.now_start - 1));
+        return true;
+    }
+    else if (interval_type == EPMEM_RANGE_EP)
+    {
+        // first range that starts after current_episode
+        std::vector<epmem_time_range>::const_iterator r = std::upper_bound(intervals.ranges.begin(), intervals.ranges.end(), current_episode, epmem_range_starts_after);
+
+        if (r == intervals.ranges.begin())
+        {
+            return false;
+        }
+
+        interval->ranges = &(intervals.ranges);
+        interval->range_pos = (r - intervals.ranges.begin()) - 1;
+        interval->time = (interval->is_end_point ? (*interval->ranges)[ interval->range_pos ].end : ((*interval->ranges)[ interval->range_pos ].start - 1));
+        return true;
+    }
+
+    return false;
+}
+
+/***************************************************************************
+ * Function     : epmem_interval_next
+ * Notes        : Moves an interval to its next (earlier) end point.
+ *                Returns false, and releases its query, once there
+ *                are no more.
+ **************************************************************************/
+bool epmem_interval_next(epmem_interval* interval)
+{
+    if (interval->sql)
+    {
+        if (interval->sql->execute() == soar_module::row)
+        {
+            interval->time = interval->sql->column_int(0);
+            return true;
+        }
+
+        interval->sql->get_pool()->release(interval->sql);
+        interval->sql = NULL;
+    }
+    else if (interval->ranges && (interval->range_pos > 0))
+    {
+        interval->range_pos--;
+        interval->time = (interval->is_end_point ? (*interval->ranges)[ interval->range_pos ].end : ((*interval->ranges)[ interval->range_pos ].start - 1));
+        return true;
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Episode Summary Functions (epmem::summaries)
+//
+// With summaries on, episodes are grouped into blocks of
+// summary-block episodes, and each block keeps a Bloom
+// filter over the wmes that were in working memory
+// during any of its episodes.  A wme is keyed by its
+// attribute and value (identifier wmes by attribute
+// alone), which is also all a cue literal knows about
+// the wmes that can satisfy it.
+//
+// The filters have false positives but no false
+// negatives, so a query may use them to skip literals
+// that cannot hold in its time window and to stop
+// walking once no earlier block can beat the best
+// episode found so far.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+inline uint64_t epmem_summary_key(epmem_hash_id attribute_s_id, epmem_hash_id value_s_id)
+{
+    return ((static_cast<uint64_t>(attribute_s_id) << 32) ^ static_cast<uint64_t>(value_s_id));
+}
+
+inline uint64_t epmem_literal_summary_key(epmem_literal* literal)
+{
+    return epmem_summary_key(literal->attribute_s_id, (literal->value_is_id ? EPMEM_NODEID_BAD : literal->child_n_id));
+}
+
+// 64-bit finalizer (splitmix64); each probe takes 12 bits of the result
+inline uint64_t epmem_summary_hash(uint64_t key)
+{
+    key += 0x9e3779b97f4a7c15ULL;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return (key ^ (key >> 31));
+}
+
+inline void epmem_summary_insert(epmem_summary& summary, uint64_t key)
+{
+    uint64_t h = epmem_summary_hash(key);
+
+    for (int i = 0; i < EPMEM_SUMMARY_PROBES; i++, h >>= 12)
+    {
+        uint64_t bit = (h % (EPMEM_SUMMARY_WORDS * 64));
+        summary.bits[ bit / 64 ] |= (1ULL << (bit % 64));
+    }
+}
+
+inline bool epmem_summary_contains(const epmem_summary& summary, uint64_t key)
+{
+    uint64_t h = epmem_summary_hash(key);
+
+    for (int i = 0; i < EPMEM_SUMMARY_PROBES; i++, h >>= 12)
+    {
+        uint64_t bit = (h % (EPMEM_SUMMARY_WORDS * 64));
+        if (!(summary.bits[ bit / 64 ] & (1ULL << (bit % 64))))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+inline size_t epmem_summary_block_of(agent* thisAgent, epmem_time_id time)
+{
+    return static_cast<size_t>(time / static_cast<epmem_time_id>(thisAgent->EpMem->epmem_params->summary_block->get_value()));
+}
+
+/***************************************************************************
+ * Function     : epmem_summary_block
+ * Notes        : Returns the summary of the block holding an episode.
+ *                Blocks are added as time moves on, each starting out
+ *                with the wmes that are in working memory.
+ **************************************************************************/
+epmem_summary& epmem_summary_block(agent* thisAgent, epmem_time_id time)
+{
+    epmem_summary_list* summaries = thisAgent->EpMem->epmem_summaries;
+    size_t block = epmem_summary_block_of(thisAgent, time);
+
+    while (summaries->size() <= block)
+    {
+        epmem_summary empty;
+        memset(empty.bits, 0, sizeof(empty.bits));
+        summaries->push_back(empty);
+
+        for (epmem_summary_open_map::iterator p = thisAgent->EpMem->epmem_summary_open->begin(); p != thisAgent->EpMem->epmem_summary_open->end(); p++)
+        {
+            epmem_summary_insert(summaries->back(), p->first);
+        }
+    }
+
+    return (*summaries)[ block ];
+}
+
+/***************************************************************************
+ * Function     : epmem_set_summary_key
+ **************************************************************************/
+void epmem_set_summary_key(agent* thisAgent, int type, epmem_node_id id, uint64_t key)
+{
+    epmem_summary_key_list* keys = thisAgent->EpMem->epmem_summary_keys[ type ];
+
+    if (static_cast<size_t>(id) >= keys->size())
+    {
+        keys->resize(static_cast<size_t>(id) + 1, 0);
+    }
+    (*keys)[ static_cast<size_t>(id) ] = key;
+}
+
+/***************************************************************************
+ * Function     : epmem_update_summaries
+ * Notes        : Keeps the summaries in step with a write.  Only the
+ *                NOW writes matter: every point or range that gets
+ *                stored was a NOW interval first (or, for retention,
+ *                lies within one that was).
+ **************************************************************************/
+void epmem_update_summaries(agent* thisAgent, const epmem_write& w)
+{
+    int type;
+
+    switch (w.type)
+    {
+        case EPMEM_WRITE_CONSTANT_NOW:
+        case EPMEM_WRITE_IDENTIFIER_NOW:
+        {
+            type = ((w.type == EPMEM_WRITE_CONSTANT_NOW) ? EPMEM_RIT_STATE_NODE : EPMEM_RIT_STATE_EDGE);
+            uint64_t key = (*thisAgent->EpMem->epmem_summary_keys[ type ])[ static_cast<size_t>(w.args[0]) ];
+            epmem_summary_insert(epmem_summary_block(thisAgent, w.args[1]), key);
+            (*thisAgent->EpMem->epmem_summary_open)[ key ]++;
+            break;
+        }
+
+        case EPMEM_WRITE_CONSTANT_NOW_DELETE:
+        case EPMEM_WRITE_IDENTIFIER_NOW_DELETE:
+        {
+            type = ((w.type == EPMEM_WRITE_CONSTANT_NOW_DELETE) ? EPMEM_RIT_STATE_NODE : EPMEM_RIT_STATE_EDGE);
+            uint64_t key = (*thisAgent->EpMem->epmem_summary_keys[ type ])[ static_cast<size_t>(w.args[0]) ];
+            epmem_summary_open_map::iterator p = thisAgent->EpMem->epmem_summary_open->find(key);
+            if ((p != thisAgent->EpMem->epmem_summary_open->end()) && (--(p->second) == 0))
+            {
+                thisAgent->EpMem->epmem_summary_open->erase(p);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_clear_summaries
+ **************************************************************************/
+void epmem_clear_summaries(agent* thisAgent)
+{
+    epmem_summary_list().swap(*thisAgent->EpMem->epmem_summaries);
+    for (int type = EPMEM_RIT_STATE_NODE; type <= EPMEM_RIT_STATE_EDGE; type++)
+    {
+        epmem_summary_key_list().swap(*thisAgent->EpMem->epmem_summary_keys[ type ]);
+    }
+    thisAgent->EpMem->epmem_summary_open->clear();
+
+    thisAgent->EpMem->epmem_summaries_built = false;
+}
+
+/***************************************************************************
+ * Function     : epmem_build_summaries
+ * Notes        : Rebuilds the wme keys and the block summaries from
+ *                the database whenever it is opened.
+ **************************************************************************/
+void epmem_build_summaries(agent* thisAgent)
+{
+    const char* key_select[] =
+    {
+        "SELECT wc_id, attribute_s_id, value_s_id FROM epmem_wmes_constant",
+        "SELECT wi_id, attribute_s_id FROM epmem_wmes_identifier"
+    };
+    const char* range_select[] =
+    {
+        "SELECT wc_id, start_episode_id, end_episode_id FROM epmem_wmes_constant_range UNION ALL "
+        "SELECT wc_id, episode_id, episode_id FROM epmem_wmes_constant_point",
+        "SELECT wi_id, start_episode_id, end_episode_id FROM epmem_wmes_identifier_range UNION ALL "
+        "SELECT wi_id, episode_id, episode_id FROM epmem_wmes_identifier_point"
+    };
+    const char* now_select[] = { "SELECT wc_id, start_episode_id FROM epmem_wmes_constant_now", "SELECT wi_id, start_episode_id FROM epmem_wmes_identifier_now" };
+    epmem_time_id time_last = thisAgent->EpMem->epmem_stats->time->get_value() - 1;
+    soar_module::sqlite_statement* temp_q;
+
+    epmem_clear_summaries(thisAgent);
+    if (time_last != EPMEM_MEMID_NONE)
+    {
+        epmem_summary_block(thisAgent, time_last);
+    }
+
+    for (int type = EPMEM_RIT_STATE_NODE; type <= EPMEM_RIT_STATE_EDGE; type++)
+    {
+        epmem_summary_key_list* keys = thisAgent->EpMem->epmem_summary_keys[ type ];
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, key_select[ type ]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            epmem_set_summary_key(thisAgent, type, temp_q->column_int(0), epmem_summary_key(temp_q->column_int(1), ((type == EPMEM_RIT_STATE_NODE) ? temp_q->column_int(2) : EPMEM_NODEID_BAD)));
+        }
+        delete temp_q;
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, range_select[ type ]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            uint64_t key = (*keys)[ static_cast<size_t>(temp_q->column_int(0)) ];
+            size_t last = epmem_summary_block_of(thisAgent, temp_q->column_int(2));
+            for (size_t block = epmem_summary_block_of(thisAgent, temp_q->column_int(1)); block <= last && block < thisAgent->EpMem->epmem_summaries->size(); block++)
+            {
+                epmem_summary_insert((*thisAgent->EpMem->epmem_summaries)[ block ], key);
+            }
+        }
+        delete temp_q;
+
+        // only a read-only database still has NOW intervals here
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, now_select[ type ]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            uint64_t key = (*keys)[ static_cast<size_t>(temp_q->column_int(0)) ];
+            for (size_t block = epmem_summary_block_of(thisAgent, temp_q->column_int(1)); block < thisAgent->EpMem->epmem_summaries->size(); block++)
+            {
+                epmem_summary_insert((*thisAgent->EpMem->epmem_summaries)[ block ], key);
+            }
+            (*thisAgent->EpMem->epmem_summary_open)[ key ]++;
+        }
+        delete temp_q;
+    }
+
+    thisAgent->EpMem->epmem_summaries_built = true;
+}
+
+/***************************************************************************
+ * Function     : epmem_summary_possible
+ * Notes        : False if no episode from start to end (inclusive) can
+ *                have a wme with the given key.
+ **************************************************************************/
+bool epmem_summary_possible(agent* thisAgent, uint64_t key, epmem_time_id start, epmem_time_id end)
+{
+    epmem_summary_list* summaries = thisAgent->EpMem->epmem_summaries;
+    size_t last = epmem_summary_block_of(thisAgent, end);
+
+    for (size_t block = epmem_summary_block_of(thisAgent, start); block <= last; block++)
+    {
+        if ((block >= summaries->size()) || epmem_summary_contains((*summaries)[ block ], key))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Write-Behind Functions (epmem::write)
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+/***************************************************************************
+ * Function     : epmem_execute_write
+ * Notes        : Applies one buffered episode write to the database
+ **************************************************************************/
+void epmem_execute_write(agent* thisAgent, const epmem_write& w)
+{
+    epmem_graph_statement_container* stmts = thisAgent->EpMem->epmem_stmts_graph;
+    soar_module::sqlite_statement* stmt = NULL;
+    int first_arg = 0;
+    int num_args = 2;
+
+    switch (w.type)
+    {
+        case EPMEM_WRITE_CONSTANT_NOW:
+            stmt = stmts->add_epmem_wmes_constant_now;
+            break;
+        case EPMEM_WRITE_CONSTANT_NOW_DELETE:
+            stmt = stmts->delete_epmem_wmes_constant_now;
+            num_args = 1;
+            break;
+        case EPMEM_WRITE_CONSTANT_POINT:
+            stmt = stmts->add_epmem_wmes_constant_point;
+            break;
+        case EPMEM_WRITE_IDENTIFIER_NOW:
+            stmt = stmts->add_epmem_wmes_identifier_now;
+            break;
+        case EPMEM_WRITE_IDENTIFIER_NOW_DELETE:
+            stmt = stmts->delete_epmem_wmes_identifier_now;
+            num_args = 1;
+            break;
+        case EPMEM_WRITE_IDENTIFIER_POINT:
+            stmt = stmts->add_epmem_wmes_identifier_point;
+            break;
+        case EPMEM_WRITE_IDENTIFIER_LAST:
+            stmt = stmts->update_epmem_wmes_identifier_last_episode_id;
+            break;
+        case EPMEM_WRITE_RANGE:
+            stmt = thisAgent->EpMem->epmem_rit_state_graph[ w.args[0] ].add_query;
+            first_arg = 1;
+            num_args = 4;
+            break;
+        case EPMEM_WRITE_VARIABLE:
+            stmt = thisAgent->EpMem->epmem_stmts_common->var_set;
+            break;
+        case EPMEM_WRITE_TIME:
+            stmt = stmts->add_time;
+            num_args = 1;
+            break;
+    }
+
+    for (int i = 0; i < num_args; i++)
+    {
+        stmt->bind_int(i + 1, w.args[ first_arg + i ]);
+    }
+    stmt->execute(soar_module::op_reinit);
+}
+
+/***************************************************************************
+ * Function     : epmem_queue_write
+ * Notes        : Adds a write to the episode's buffer, or applies it
+ *                right away when there is no buffer.  Arguments are
+ *                in the order the statement binds them.
+ **************************************************************************/
+void epmem_queue_write(agent* thisAgent, epmem_write_buffer* writes, epmem_write_type type, int64_t a0, int64_t a1 = 0, int64_t a2 = 0, int64_t a3 = 0, int64_t a4 = 0)
+{
+    epmem_write w;
+    w.type = type;
+    w.args[0] = a0;
+    w.args[1] = a1;
+    w.args[2] = a2;
+    w.args[3] = a3;
+    w.args[4] = a4;
+
+    if (thisAgent->EpMem->epmem_intervals_built)
+    {
+        epmem_update_interval_index(thisAgent, w);
+    }
+
+    if (thisAgent->EpMem->epmem_summaries_built)
+    {
+        epmem_update_summaries(thisAgent, w);
+    }
+
+    if (writes)
+    {
+        writes->push_back(w);
+    }
+    else
+    {
+        epmem_execute_write(thisAgent, w);
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_apply_writes
+ * Notes        : Applies a buffer of episode writes.  A batch is
+ *                wrapped in its own transaction unless lazy-commit
+ *                already keeps one open.
+ **************************************************************************/
+void epmem_apply_writes(agent* thisAgent, epmem_write_buffer& writes, bool batch)
+{
+    bool own_transaction = batch && (thisAgent->EpMem->epmem_params->lazy_commit->get_value() == off);
+
+    if (own_transaction)
+    {
+        thisAgent->EpMem->epmem_stmts_common->begin->execute(soar_module::op_reinit);
+    }
+
+    for (epmem_write_buffer::iterator w = writes.begin(); w != writes.end(); w++)
+    {
+        epmem_execute_write(thisAgent, (*w));
+    }
+
+    if (own_transaction)
+    {
+        thisAgent->EpMem->epmem_stmts_common->commit->execute(soar_module::op_reinit);
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_flush_writes
+ * Notes        : Stores the episodes held by the log backend and
+ *                waits for the write-behind thread to store every
+ *                episode handed to it.  Must be called before the
+ *                main thread reads or writes the database.  Storing
+ *                an episode only waits on the writer when it meets
+ *                working memory that isn't in the database yet, so an
+ *                agent whose working memory keeps the same structure
+ *                can record episodes without ever waiting on it.
+ **************************************************************************/
+void epmem_flush_writes(agent* thisAgent)
+{
+    if (thisAgent->EpMem->epmem_log->size())
+    {
+        epmem_flush_log(thisAgent);
+    }
+    thisAgent->EpMem->epmem_writer->flush();
+}
+
+/***************************************************************************
+ * Function     : epmem_flush_writer
+ * Notes        : Waits for the write-behind thread alone.  Storage
+ *                only reads the tables that give wmes their ids, which
+ *                the log backend never holds writes for, so it can go
+ *                on recording episodes without storing the log.
+ **************************************************************************/
+void epmem_flush_writer(agent* thisAgent)
+{
+    thisAgent->EpMem->epmem_writer->flush();
+}
+
+/***************************************************************************
+ * Function     : epmem_flush_log
+ * Notes        : Stores the episodes held by the log backend, in one
+ *                batch, either now or on the write-behind thread.
+ *                A batch stored now waits for the write-behind thread
+ *                first, so the log always reaches the database after
+ *                the episodes handed to the thread before it.
+ **************************************************************************/
+void epmem_flush_log(agent* thisAgent)
+{
+    epmem_write_buffer writes;
+
+    thisAgent->EpMem->epmem_log->take(writes);
+    thisAgent->EpMem->epmem_stats->log_flushes->set_value(thisAgent->EpMem->epmem_stats->log_flushes->get_value() + 1);
+
+    if (thisAgent->EpMem->epmem_params->write_behind->get_value() == on)
+    {
+        thisAgent->EpMem->epmem_writer->submit(writes);
+    }
+    else
+    {
+        epmem_flush_writer(thisAgent);
+        epmem_apply_writes(thisAgent, writes, true);
+    }
+}
+
+epmem_episode_log::epmem_episode_log() {}
+
+size_t epmem_episode_log::size()
+{
+    return entries.size();
+}
+
+// drops the write an id's index points to, if any, and indexes the new one
+bool epmem_episode_log::supersede(log_index& index, int64_t id, size_t pos)
+{
+    log_index::iterator p = index.find(id);
+    if (p != index.end())
+    {
+        live[ p->second ] = false;
+        p->second = pos;
+        return true;
+    }
+
+    index[ id ] = pos;
+    return false;
+}
+
+size_t epmem_episode_log::append(epmem_write_buffer& writes)
+{
+    size_t superseded = 0;
+
+    for (epmem_write_buffer::iterator w = writes.begin(); w != writes.end(); w++)
+    {
+        size_t pos = entries.size();
+        bool keep = true;
+
+        switch (w->type)
+        {
+            case EPMEM_WRITE_CONSTANT_NOW:
+                now_rows[ EPMEM_RIT_STATE_NODE ][ w->args[0] ] = pos;
+                break;
+            case EPMEM_WRITE_IDENTIFIER_NOW:
+                now_rows[ EPMEM_RIT_STATE_EDGE ][ w->args[0] ] = pos;
+                break;
+            case EPMEM_WRITE_CONSTANT_NOW_DELETE:
+            case EPMEM_WRITE_IDENTIFIER_NOW_DELETE:
+            {
+                // a now row still in the log need never be stored
+                log_index& index = now_rows[ (w->type == EPMEM_WRITE_CONSTANT_NOW_DELETE) ? EPMEM_RIT_STATE_NODE : EPMEM_RIT_STATE_EDGE ];
+                log_index::iterator p = index.find(w->args[0]);
+                if (p != index.end())
+                {
+                    live[ p->second ] = false;
+                    index.erase(p);
+                    keep = false;
+                    superseded += 2;
+                }
+                break;
+            }
+            case EPMEM_WRITE_IDENTIFIER_LAST:
+                superseded += supersede(last_updates, w->args[1], pos);
+                break;
+            case EPMEM_WRITE_VARIABLE:
+                superseded += supersede(variables, w->args[0], pos);
+                break;
+            default:
+                break;
+        }
+
+        if (keep)
+        {
+            entries.push_back(*w);
+            live.push_back(true);
+        }
+    }
+    writes.clear();
+
+    return superseded;
+}
+
+void epmem_episode_log::take(epmem_write_buffer& writes)
+{
+    writes.clear();
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (live[ i ])
+        {
+            writes.push_back(entries[ i ]);
+        }
+    }
+
+    entries.clear();
+    live.clear();
+    now_rows[ EPMEM_RIT_STATE_NODE ].clear();
+    now_rows[ EPMEM_RIT_STATE_EDGE ].clear();
+    last_updates.clear();
+    variables.clear();
+}
+
+epmem_storage_writer::epmem_storage_writer(agent* myAgent)
 {
-    _epmem_process_buffered_wme_list(thisAgent, state, cue_wmes, meta_wmes, state->id->epmem_info->epmem_wmes);
-    _epmem_process_buffered_wme_list(thisAgent, state, cue_wmes, retrieval_wmes, NULL);
+    thisAgent = myAgent;
+    writer_thread = NULL;
+    busy = false;
+    quitting = false;
 }
 
-inline void epmem_buffer_add_wme(agent* thisAgent, symbol_triple_list& my_list, Symbol* id, Symbol* attr, Symbol* value)
+epmem_storage_writer::~epmem_storage_writer()
 {
-    my_list.push_back(new symbol_triple(id, attr, value));
-
-    thisAgent->symbolManager->symbol_add_ref(id);
-    thisAgent->symbolManager->symbol_add_ref(attr);
-    thisAgent->symbolManager->symbol_add_ref(value);
+    stop();
 }
 
+void epmem_storage_writer::submit(epmem_write_buffer& writes)
+{
+    std::unique_lock<std::mutex> lLock(lock);
 
-//////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////
-// Variable Functions (epmem::var)
-//
-// Variables are key-value pairs stored in the database
-// that are necessary to maintain a store between
-// multiple runs of Soar.
-//
-//////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////
+    if (queued.empty())
+    {
+        // hands the caller back our (empty) buffer to refill
+        queued.swap(writes);
+    }
+    else
+    {
+        queued.insert(queued.end(), writes.begin(), writes.end());
+    }
+    writes.clear();
 
-/***************************************************************************
- * Function     : epmem_get_variable
- * Author       : Nate Derbinsky
- * Notes        : Gets an EpMem variable from the database
- **************************************************************************/
-bool epmem_get_variable(agent* thisAgent, epmem_variable_key variable_id, int64_t* variable_value)
-{
-    soar_module::exec_result status;
-    soar_module::sqlite_statement* var_get = thisAgent->EpMem->epmem_stmts_common->var_get;
+    if (!writer_thread)
+    {
+        quitting = false;
+        writer_thread = new std::thread(&epmem_storage_writer::run, this);
+    }
 
-    var_get->bind_int(1, variable_id);
-    status = var_get->execute();
+    work_ready.notify_one();
+}
 
-    if (status == soar_module::row)
+void epmem_storage_writer::flush()
+{
+    std::unique_lock<std::mutex> lLock(lock);
+
+    while (busy || !queued.empty())
     {
-        (*variable_value) = var_get->column_int(0);
+        work_done.wait(lLock);
     }
+}
 
-    var_get->reinitialize();
+void epmem_storage_writer::stop()
+{
+    {
+        std::unique_lock<std::mutex> lLock(lock);
 
-    return (status == soar_module::row);
+        if (!writer_thread)
+        {
+            return;
+        }
+        quitting = true;
+        work_ready.notify_one();
+    }
+
+    writer_thread->join();
+    delete writer_thread;
+    writer_thread = NULL;
 }
 
-/***************************************************************************
- * Function     : epmem_set_variable
- * Author       : Nate Derbinsky
- * Notes        : Sets an EpMem variable in the database
- **************************************************************************/
-void epmem_set_variable(agent* thisAgent, epmem_variable_key variable_id, int64_t variable_value)
+void epmem_storage_writer::run()
 {
-    soar_module::sqlite_statement* var_set = thisAgent->EpMem->epmem_stmts_common->var_set;
+    std::unique_lock<std::mutex> lLock(lock);
 
-    var_set->bind_int(1, variable_id);
-    var_set->bind_int(2, variable_value);
+    while (true)
+    {
+        while (queued.empty() && !quitting)
+        {
+            work_ready.wait(lLock);
+        }
 
-    var_set->execute(soar_module::op_reinit);
+        // only stop once everything submitted is stored
+        if (queued.empty())
+        {
+            break;
+        }
+
+        writing.swap(queued);
+        busy = true;
+        lLock.unlock();
+
+        epmem_apply_writes(thisAgent, writing, true);
+        writing.clear();
+
+        lLock.lock();
+        busy = false;
+        work_done.notify_all();
+    }
 }
 
 //////////////////////////////////////////////////////////
@@ -1638,7 +2653,7 @@ void epmem_rit_prep_left_right(agent* thisAgent, int64_t lower, int64_t upper, e
  * Author       : Nate Derbinsky
  * Notes        : Inserts an interval in the RIT
  **************************************************************************/
-void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, epmem_node_id id, epmem_rit_state* rit_state)
+void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, epmem_node_id id, epmem_rit_state* rit_state, epmem_write_buffer* writes = NULL)
 {
     // initialize offset
     int64_t offset = rit_state->offset.stat->get_value();
@@ -1647,7 +2662,7 @@ void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, e
         offset = lower;
 
         // update database
-        epmem_set_variable(thisAgent, rit_state->offset.var_key, offset);
+        epmem_queue_write(thisAgent, writes, EPMEM_WRITE_VARIABLE, rit_state->offset.var_key, offset);
 
         // update stat
         rit_state->offset.stat->set_value(offset);
@@ -1670,7 +2685,7 @@ void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, e
             left_root = static_cast<int64_t>(pow(-2.0, floor(log(static_cast<double>(-l)) / EPMEM_LN_2)));
 
             // update database
-            epmem_set_variable(thisAgent, rit_state->leftroot.var_key, left_root);
+            epmem_queue_write(thisAgent, writes, EPMEM_WRITE_VARIABLE, rit_state->leftroot.var_key, left_root);
 
             // update stat
             rit_state->leftroot.stat->set_value(left_root);
@@ -1682,7 +2697,7 @@ void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, e
             right_root = static_cast<int64_t>(pow(2.0, floor(log(static_cast<double>(u)) / EPMEM_LN_2)));
 
             // update database
-            epmem_set_variable(thisAgent, rit_state->rightroot.var_key, right_root);
+            epmem_queue_write(thisAgent, writes, EPMEM_WRITE_VARIABLE, rit_state->rightroot.var_key, right_root);
 
             // update stat
             rit_state->rightroot.stat->set_value(right_root);
@@ -1697,7 +2712,7 @@ void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, e
             min_step = step;
 
             // update database
-            epmem_set_variable(thisAgent, rit_state->minstep.var_key, min_step);
+            epmem_queue_write(thisAgent, writes, EPMEM_WRITE_VARIABLE, rit_state->minstep.var_key, min_step);
 
             // update stat
             rit_state->minstep.stat->set_value(min_step);
@@ -1706,11 +2721,7 @@ void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, e
 
     // perform insert
     // ( node, start, end, id )
-    rit_state->add_query->bind_int(1, node);
-    rit_state->add_query->bind_int(2, lower);
-    rit_state->add_query->bind_int(3, upper);
-    rit_state->add_query->bind_int(4, id);
-    rit_state->add_query->execute(soar_module::op_reinit);
+    epmem_queue_write(thisAgent, writes, EPMEM_WRITE_RANGE, (rit_state - thisAgent->EpMem->epmem_rit_state_graph), node, lower, upper, id);
 }
 
 
@@ -1776,6 +2787,9 @@ void epmem_clear_transient_structures(agent* thisAgent)
     thisAgent->EpMem->epmem_id_ref_counts->clear();
     thisAgent->EpMem->epmem_wme_adds->clear();
 
+    epmem_clear_interval_index(thisAgent);
+    epmem_clear_summaries(thisAgent);
+
 }
 
 /***************************************************************************
@@ -1786,6 +2800,8 @@ void epmem_clear_transient_structures(agent* thisAgent)
  **************************************************************************/
 void epmem_close(agent* thisAgent)
 {
+    epmem_flush_writes(thisAgent);
+
     if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
     {
         print_sysparam_trace(thisAgent, TRACE_EPMEM_SYSPARAM, "Closing episodic memory database %s.\n", thisAgent->EpMem->epmem_params->path->get_value());
@@ -2153,6 +3169,33 @@ void epmem_init_db(agent* thisAgent, bool readonly)
                 }
             }
 
+            // initialize retention
+            thisAgent->EpMem->epmem_stats->retention_through->set_value(EPMEM_MEMID_NONE);
+            {
+                int64_t stored_through = NIL;
+                if (epmem_get_variable(thisAgent, var_retention_through, &stored_through))
+                {
+                    thisAgent->EpMem->epmem_stats->retention_through->set_value(stored_through);
+                }
+            }
+            if ((thisAgent->EpMem->epmem_params->retention->get_value() == on) && !readonly)
+            {
+                // compaction looks up intervals by the episode they end in
+                const char* end_indices[] =
+                {
+                    "CREATE INDEX IF NOT EXISTS epmem_wmes_constant_range_end ON epmem_wmes_constant_range (end_episode_id)",
+                    "CREATE INDEX IF NOT EXISTS epmem_wmes_identifier_range_end ON epmem_wmes_identifier_range (end_episode_id)"
+                };
+                for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+                {
+                    temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, end_indices[i]);
+                    temp_q->prepare();
+                    temp_q->execute();
+                    delete temp_q;
+                    temp_q = NULL;
+                }
+            }
+
             // initialize rit state
             for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
             {
@@ -2352,6 +3395,16 @@ void epmem_init_db(agent* thisAgent, bool readonly)
                 temp_q = NULL;
             }
 
+            if (thisAgent->EpMem->epmem_params->interval_index->get_value() == on)
+            {
+                epmem_build_interval_index(thisAgent);
+            }
+
+            if (thisAgent->EpMem->epmem_params->summaries->get_value() == on)
+            {
+                epmem_build_summaries(thisAgent);
+            }
+
             // at init, top-state is considered the only known identifier
             thisAgent->top_goal->id->epmem_id = EPMEM_NODEID_ROOT;
             thisAgent->top_goal->id->epmem_valid = thisAgent->EpMem->epmem_validation;
@@ -2566,6 +3619,7 @@ inline void _epmem_store_level(agent* thisAgent,
             if ((*w_p)->value->id->LTI_ID && ((*w_p)->value->id->LTI_epmem_valid != thisAgent->EpMem->epmem_validation))
             {
                 // Update the node database with the new lti_id
+                epmem_flush_writer(thisAgent);
                 thisAgent->EpMem->epmem_stmts_graph->update_node->bind_int(1, (*w_p)->value->id->LTI_ID);
                 thisAgent->EpMem->epmem_stmts_graph->update_node->bind_int(2, (*w_p)->value->id->epmem_id);
                 thisAgent->EpMem->epmem_stmts_graph->update_node->execute(soar_module::op_reinit);
@@ -2727,6 +3781,8 @@ inline void _epmem_store_level(agent* thisAgent,
 #ifdef DEBUG_EPMEM_WME_ADD
                 fprintf(stderr, "   No success, adding wme to database.");
 #endif
+                epmem_flush_writer(thisAgent);
+
                 // can't use value_known_apriori, since value may have been assigned (lti, id repository via case 3)
                 if (((*w_p)->value->id->epmem_id == EPMEM_NODEID_BAD) || ((*w_p)->value->id->epmem_valid != thisAgent->EpMem->epmem_validation))
                 {
@@ -2785,6 +3841,11 @@ inline void _epmem_store_level(agent* thisAgent,
                 epmem_edge.push((*w_p)->epmem_id);
                 thisAgent->EpMem->epmem_edge_mins->push_back(time_counter);
                 thisAgent->EpMem->epmem_edge_maxes->push_back(false);
+
+                if (thisAgent->EpMem->epmem_summaries_built)
+                {
+                    epmem_set_summary_key(thisAgent, EPMEM_RIT_STATE_EDGE, (*w_p)->epmem_id, epmem_summary_key(my_hash, EPMEM_NODEID_BAD));
+                }
             }
             else
             {
@@ -2857,6 +3918,7 @@ inline void _epmem_store_level(agent* thisAgent,
 #ifdef DEBUG_EPMEM_WME_ADD
                     fprintf(stderr, "   Looking for id of a duplicate entry in epmem_wmes_constant.\n");
 #endif
+                    epmem_flush_writer(thisAgent);
                     thisAgent->EpMem->epmem_stmts_graph->find_epmem_wmes_constant->bind_int(1, parent_id);
                     thisAgent->EpMem->epmem_stmts_graph->find_epmem_wmes_constant->bind_int(2, my_hash);
                     thisAgent->EpMem->epmem_stmts_graph->find_epmem_wmes_constant->bind_int(3, my_hash2);
@@ -2891,6 +3953,11 @@ inline void _epmem_store_level(agent* thisAgent,
                     epmem_node.push((*w_p)->epmem_id);
                     thisAgent->EpMem->epmem_node_mins->push_back(time_counter);
                     thisAgent->EpMem->epmem_node_maxes->push_back(false);
+
+                    if (thisAgent->EpMem->epmem_summaries_built)
+                    {
+                        epmem_set_summary_key(thisAgent, EPMEM_RIT_STATE_NODE, (*w_p)->epmem_id, epmem_summary_key(my_hash, my_hash2));
+                    }
                 }
                 else
                 {
@@ -2933,8 +4000,17 @@ void epmem_new_episode(agent* thisAgent)
     // provide trace output
     print_sysparam_trace(thisAgent, TRACE_EPMEM_SYSPARAM,  "New episodic memory recorded for time %u.\n", static_cast<long int>(time_counter));
 
+    // start the summary of a new block, even if no wme changes in it
+    if (thisAgent->EpMem->epmem_summaries_built)
+    {
+        epmem_summary_block(thisAgent, time_counter);
+    }
+
     // perform storage
     {
+        // database writes for this episode
+        epmem_write_buffer* writes = thisAgent->EpMem->epmem_pending_writes;
+
         // seen nodes (non-identifiers) and edges (identifiers)
         std::queue<epmem_node_id> epmem_node;
         std::queue<epmem_node_id> epmem_edge;
@@ -2994,9 +4070,7 @@ void epmem_new_episode(agent* thisAgent)
 
                 // add NOW entry
                 // id = ?, start_episode_id = ?
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now->bind_int(1, (*temp_node));
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now->bind_int(2, time_counter);
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now->execute(soar_module::op_reinit);
+                epmem_queue_write(thisAgent, writes, EPMEM_WRITE_CONSTANT_NOW, (*temp_node), time_counter);
 
                 // update min
                 (*thisAgent->EpMem->epmem_node_mins)[static_cast<size_t>((*temp_node) - 1)] = time_counter;
@@ -3011,16 +4085,12 @@ void epmem_new_episode(agent* thisAgent)
 
                 // add NOW entry
                 // id = ?, start_episode_id = ?
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->bind_int(1, (*temp_node));
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->bind_int(2, time_counter);
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->execute(soar_module::op_reinit);
+                epmem_queue_write(thisAgent, writes, EPMEM_WRITE_IDENTIFIER_NOW, (*temp_node), time_counter);
 
                 // update min
                 (*thisAgent->EpMem->epmem_edge_mins)[static_cast<size_t>((*temp_node) - 1)] = time_counter;
 
-                thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(1, LLONG_MAX);
-                thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(2, *temp_node);
-                thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->execute(soar_module::op_reinit);
+                epmem_queue_write(thisAgent, writes, EPMEM_WRITE_IDENTIFIER_LAST, LLONG_MAX, (*temp_node));
 
                 epmem_edge.pop();
             }
@@ -3041,8 +4111,7 @@ void epmem_new_episode(agent* thisAgent)
 
                     // remove NOW entry
                     // id = ?
-                    thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_constant_now->bind_int(1, r->first);
-                    thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_constant_now->execute(soar_module::op_reinit);
+                    epmem_queue_write(thisAgent, writes, EPMEM_WRITE_CONSTANT_NOW_DELETE, r->first);
 
                     range_start = (*thisAgent->EpMem->epmem_node_mins)[static_cast<size_t>(r->first - 1)];
                     range_end = (time_counter - 1);
@@ -3050,14 +4119,12 @@ void epmem_new_episode(agent* thisAgent)
                     // point (id, start_episode_id)
                     if (range_start == range_end)
                     {
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point->bind_int(1, r->first);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point->bind_int(2, range_start);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point->execute(soar_module::op_reinit);
+                        epmem_queue_write(thisAgent, writes, EPMEM_WRITE_CONSTANT_POINT, r->first, range_start);
                     }
                     // node
                     else
                     {
-                        epmem_rit_insert_interval(thisAgent, range_start, range_end, r->first, &(thisAgent->EpMem->epmem_rit_state_graph[ EPMEM_RIT_STATE_NODE ]));
+                        epmem_rit_insert_interval(thisAgent, range_start, range_end, r->first, &(thisAgent->EpMem->epmem_rit_state_graph[ EPMEM_RIT_STATE_NODE ]), writes);
                     }
 
                     // update max
@@ -3076,26 +4143,21 @@ void epmem_new_episode(agent* thisAgent)
                 {
                     // remove NOW entry
                     // id = ?
-                    thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_identifier_now->bind_int(1, r->first);
-                    thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_identifier_now->execute(soar_module::op_reinit);
+                    epmem_queue_write(thisAgent, writes, EPMEM_WRITE_IDENTIFIER_NOW_DELETE, r->first);
 
                     range_start = (*thisAgent->EpMem->epmem_edge_mins)[static_cast<size_t>(r->first - 1)];
                     range_end = (time_counter - 1);
 
-                    thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(1, range_end);
-                    thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(2, r->first);
-                    thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->execute(soar_module::op_reinit);
+                    epmem_queue_write(thisAgent, writes, EPMEM_WRITE_IDENTIFIER_LAST, range_end, r->first);
                     // point (id, start_episode_id)
                     if (range_start == range_end)
                     {
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->bind_int(1, r->first);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->bind_int(2, range_start);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->execute(soar_module::op_reinit);
+                        epmem_queue_write(thisAgent, writes, EPMEM_WRITE_IDENTIFIER_POINT, r->first, range_start);
                     }
                     // node
                     else
                     {
-                        epmem_rit_insert_interval(thisAgent, range_start, range_end, r->first, &(thisAgent->EpMem->epmem_rit_state_graph[ EPMEM_RIT_STATE_EDGE ]));
+                        epmem_rit_insert_interval(thisAgent, range_start, range_end, r->first, &(thisAgent->EpMem->epmem_rit_state_graph[ EPMEM_RIT_STATE_EDGE ]), writes);
                     }
 
                     // update max
@@ -3108,8 +4170,28 @@ void epmem_new_episode(agent* thisAgent)
         }
 
         // add the time id to the epmem_episodes table
-        thisAgent->EpMem->epmem_stmts_graph->add_time->bind_int(1, time_counter);
-        thisAgent->EpMem->epmem_stmts_graph->add_time->execute(soar_module::op_reinit);
+        epmem_queue_write(thisAgent, writes, EPMEM_WRITE_TIME, time_counter);
+
+        // store the episode, either now, on the write-behind thread or
+        // once something needs the database
+        if (thisAgent->EpMem->epmem_params->backend->get_value() == epmem_param_container::backend_log)
+        {
+            size_t superseded = thisAgent->EpMem->epmem_log->append(*writes);
+            thisAgent->EpMem->epmem_stats->log_superseded->set_value(thisAgent->EpMem->epmem_stats->log_superseded->get_value() + superseded);
+            if (thisAgent->EpMem->epmem_log->size() >= EPMEM_LOG_FLUSH_WRITES)
+            {
+                epmem_flush_log(thisAgent);
+            }
+        }
+        else if (thisAgent->EpMem->epmem_params->write_behind->get_value() == on)
+        {
+            thisAgent->EpMem->epmem_writer->submit(*writes);
+        }
+        else
+        {
+            epmem_apply_writes(thisAgent, *writes, false);
+            writes->clear();
+        }
 
         thisAgent->EpMem->epmem_stats->time->set_value(time_counter + 1);
 
@@ -3127,20 +4209,344 @@ void epmem_new_episode(agent* thisAgent)
 
                 state->id->epmem_info->epmem_time_wme = soar_module::add_module_wme(thisAgent, state->id->epmem_info->epmem_link_wme->value, thisAgent->symbolManager->soarSymbols.epmem_sym_present_id, my_time_sym);
 
-                state = state->id->higher_goal;
-            }
+                state = state->id->higher_goal;
+            }
+
+            thisAgent->symbolManager->symbol_remove_ref(&my_time_sym);
+        }
+
+        // clear add/remove maps
+        {
+            thisAgent->EpMem->epmem_wme_adds->clear();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    thisAgent->EpMem->epmem_timers->storage->stop();
+    ////////////////////////////////////////////////////////////////////////////
+}
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Retention Functions (epmem::retention)
+//
+// With retention on, the last retention-recent episodes
+// are kept as they are.  Of the episodes before them,
+// only every retention-stride'th is kept (none if the
+// stride is 0); the rest are removed from epmem_episodes
+// and can no longer be retrieved.
+//
+// The wme intervals are then rewritten over the episodes
+// that are left.  Intervals that only held in dropped
+// episodes are deleted, the others are trimmed to the
+// first and last kept episode they cover, and intervals
+// of a wme that are only separated by dropped episodes
+// are merged.  Every kept episode still has exactly the
+// wmes it had when it was recorded.
+//
+// This is done retention-batch episodes at a time, after
+// the epmem processing of the decision cycle in which a
+// whole batch has become old, so the cost is spread out.
+// retention-through records the last episode that has
+// been compacted.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+/***************************************************************************
+ * Function     : epmem_kept_episode
+ * Notes        : Returns the last kept episode at or before memory_id
+ *                (before == true), or the first at or after it.  Every
+ *                episode after retention-through is kept.  Returns
+ *                EPMEM_MEMID_NONE if there is no such episode.
+ **************************************************************************/
+epmem_time_id epmem_kept_episode(agent* thisAgent, epmem_time_id memory_id, bool before)
+{
+    if (memory_id > thisAgent->EpMem->epmem_stats->retention_through->get_value())
+    {
+        return memory_id;
+    }
+
+    epmem_time_id return_val = EPMEM_MEMID_NONE;
+    soar_module::sqlite_statement* my_q = (before ? thisAgent->EpMem->epmem_stmts_graph->kept_episode_before : thisAgent->EpMem->epmem_stmts_graph->kept_episode_after);
+
+    my_q->bind_int(1, memory_id);
+    if (my_q->execute() == soar_module::row)
+    {
+        return_val = my_q->column_int(0);
+    }
+    my_q->reinitialize();
+
+    return return_val;
+}
+
+/***************************************************************************
+ * Function     : epmem_db_used_bytes
+ * Notes        : Returns the size of the database pages that are in use
+ *                (not on the free list).
+ **************************************************************************/
+int64_t epmem_db_used_bytes(agent* thisAgent)
+{
+    soar_module::sqlite_statement* pragmas[] = { thisAgent->EpMem->epmem_stmts_graph->page_count, thisAgent->EpMem->epmem_stmts_graph->freelist_count, thisAgent->EpMem->epmem_stmts_graph->page_size };
+    int64_t values[] = { 0, 0, 0 };
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (pragmas[i]->execute() == soar_module::row)
+        {
+            values[i] = pragmas[i]->column_int(0);
+        }
+        pragmas[i]->reinitialize();
+    }
+
+    return ((values[0] - values[1]) * values[2]);
+}
+
+/***************************************************************************
+ * Function     : epmem_retention_insert
+ * Notes        : Records that a wme held from start to end, as a point
+ *                or a range.
+ **************************************************************************/
+void epmem_retention_insert(agent* thisAgent, int type, epmem_node_id id, epmem_time_id start, epmem_time_id end)
+{
+    if (start == end)
+    {
+        epmem_queue_write(thisAgent, NULL, ((type == EPMEM_RIT_STATE_NODE) ? EPMEM_WRITE_CONSTANT_POINT : EPMEM_WRITE_IDENTIFIER_POINT), id, start);
+    }
+    else
+    {
+        epmem_rit_insert_interval(thisAgent, start, end, id, &(thisAgent->EpMem->epmem_rit_state_graph[ type ]));
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_retention_delete
+ * Notes        : Deletes the closed interval of a wme that starts at
+ *                start, whether it is a point or a range.
+ **************************************************************************/
+void epmem_retention_delete(agent* thisAgent, int type, epmem_node_id id, epmem_time_id start)
+{
+    soar_module::sqlite_statement* deletes[] = { thisAgent->EpMem->epmem_stmts_graph->retention_delete_range[ type ], thisAgent->EpMem->epmem_stmts_graph->retention_delete_point[ type ] };
+
+    for (int i = 0; i < 2; i++)
+    {
+        deletes[i]->bind_int(1, id);
+        deletes[i]->bind_int(2, start);
+        deletes[i]->execute(soar_module::op_reinit);
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_compact_interval
+ * Notes        : Rewrites the interval of a wme that ends at end over
+ *                the kept episodes.  If no kept episode lies between it
+ *                and the wme's next interval, the two are merged.
+ **************************************************************************/
+void epmem_compact_interval(agent* thisAgent, int type, epmem_node_id id, epmem_time_id end)
+{
+    epmem_graph_statement_container* stmts = thisAgent->EpMem->epmem_stmts_graph;
+    soar_module::sqlite_statement* my_q;
+    epmem_time_id start;
+
+    // the interval may already have been merged into an earlier one
+    my_q = stmts->retention_find_start[ type ];
+    my_q->bind_int(1, id);
+    my_q->bind_int(2, end);
+    my_q->bind_int(3, id);
+    my_q->bind_int(4, end);
+    if (my_q->execute() != soar_module::row)
+    {
+        my_q->reinitialize();
+        return;
+    }
+    start = my_q->column_int(0);
+    my_q->reinitialize();
+
+    epmem_retention_delete(thisAgent, type, id, start);
+
+    // the wme was only in dropped episodes
+    epmem_time_id kept_start = epmem_kept_episode(thisAgent, start, false);
+    epmem_time_id kept_end = epmem_kept_episode(thisAgent, end, true);
+    if ((kept_start == EPMEM_MEMID_NONE) || (kept_end == EPMEM_MEMID_NONE) || (kept_start > kept_end))
+    {
+        return;
+    }
+
+    // merge with the next interval if it starts by the next kept episode
+    epmem_time_id next_kept = epmem_kept_episode(thisAgent, kept_end + 1, false);
+    epmem_time_id next_start = EPMEM_MEMID_NONE;
+    my_q = stmts->retention_next_start[ type ];
+    for (int i = 0; i < 3; i++)
+    {
+        my_q->bind_int((2 * i) + 1, id);
+        my_q->bind_int((2 * i) + 2, end);
+    }
+    if (my_q->execute() == soar_module::row)
+    {
+        next_start = my_q->column_int(0);
+    }
+    my_q->reinitialize();
+
+    if ((next_start != EPMEM_MEMID_NONE) && (next_kept != EPMEM_MEMID_NONE) && (next_start <= next_kept))
+    {
+        my_q = stmts->retention_find_end[ type ];
+        my_q->bind_int(1, id);
+        my_q->bind_int(2, next_start);
+        my_q->bind_int(3, id);
+        my_q->bind_int(4, next_start);
+        if (my_q->execute() == soar_module::row)
+        {
+            epmem_time_id next_end = my_q->column_int(0);
+            my_q->reinitialize();
+
+            epmem_retention_delete(thisAgent, type, id, next_start);
+            epmem_retention_insert(thisAgent, type, id, kept_start, next_end);
+        }
+        else
+        {
+            my_q->reinitialize();
+
+            // the wme is still in working memory: move its NOW interval back
+            my_q = stmts->retention_update_now[ type ];
+            my_q->bind_int(1, kept_start);
+            my_q->bind_int(2, id);
+            my_q->execute(soar_module::op_reinit);
+
+            std::vector<epmem_time_id>* mins = ((type == EPMEM_RIT_STATE_NODE) ? thisAgent->EpMem->epmem_node_mins : thisAgent->EpMem->epmem_edge_mins);
+            if (static_cast<size_t>(id - 1) < mins->size())
+            {
+                (*mins)[ static_cast<size_t>(id - 1) ] = kept_start;
+            }
+        }
+        return;
+    }
+
+    epmem_retention_insert(thisAgent, type, id, kept_start, kept_end);
+}
+
+/***************************************************************************
+ * Function     : epmem_reload_interval_index_entry
+ * Notes        : Replaces the interval index entry of a wme with its
+ *                intervals as they are now in the database.
+ **************************************************************************/
+void epmem_reload_interval_index_entry(agent* thisAgent, int type, epmem_node_id id)
+{
+    epmem_wme_intervals* intervals = epmem_interval_index_entry(thisAgent, type, id);
+    soar_module::sqlite_statement* my_q;
+    epmem_time_range range;
+
+    intervals->ranges.clear();
+    intervals->now_start = EPMEM_MEMID_NONE;
+
+    my_q = thisAgent->EpMem->epmem_stmts_graph->retention_intervals[ type ];
+    my_q->bind_int(1, id);
+    my_q->bind_int(2, id);
+    while (my_q->execute() == soar_module::row)
+    {
+        range.start = my_q->column_int(0);
+        range.end = my_q->column_int(1);
+        intervals->ranges.push_back(range);
+    }
+    my_q->reinitialize();
+
+    my_q = thisAgent->EpMem->epmem_stmts_graph->retention_now[ type ];
+    my_q->bind_int(1, id);
+    if (my_q->execute() == soar_module::row)
+    {
+        intervals->now_start = my_q->column_int(0);
+    }
+    my_q->reinitialize();
+}
+
+/***************************************************************************
+ * Function     : epmem_apply_retention
+ * Notes        : Drops and compacts the next retention-batch episodes
+ *                that are older than the last retention-recent, once
+ *                there are that many.
+ **************************************************************************/
+void epmem_apply_retention(agent* thisAgent)
+{
+    // episode ids are unsigned, so work out the window in signed arithmetic
+    int64_t through = static_cast<int64_t>(thisAgent->EpMem->epmem_stats->retention_through->get_value());
+    int64_t last_old = static_cast<int64_t>(thisAgent->EpMem->epmem_stats->time->get_value() - 1) - thisAgent->EpMem->epmem_params->retention_recent->get_value();
+    int64_t batch = thisAgent->EpMem->epmem_params->retention_batch->get_value();
+
+    // wait for a whole batch: compacting flushes the log backend and
+    // waits on the write-behind thread, which shouldn't happen every cycle
+    if ((last_old - through) < batch)
+    {
+        return;
+    }
+
+    int64_t new_through = (through + batch);
+    int64_t stride = thisAgent->EpMem->epmem_params->retention_stride->get_value();
+    bool lazy_commit = (thisAgent->EpMem->epmem_params->lazy_commit->get_value() == on);
+    epmem_graph_statement_container* stmts = thisAgent->EpMem->epmem_stmts_graph;
+
+    ////////////////////////////////////////////////////////////////////////////
+    thisAgent->EpMem->epmem_timers->retention->start();
+    ////////////////////////////////////////////////////////////////////////////
+
+    epmem_flush_writes(thisAgent);
+
+    if (!lazy_commit)
+    {
+        thisAgent->EpMem->epmem_stmts_common->begin->execute(soar_module::op_reinit);
+    }
+
+    int64_t used_bytes = epmem_db_used_bytes(thisAgent);
+
+    // drop episodes
+    stmts->drop_episodes->bind_int(1, through);
+    stmts->drop_episodes->bind_int(2, new_through);
+    stmts->drop_episodes->bind_int(3, stride);
+    stmts->drop_episodes->bind_int(4, stride);
+    stmts->drop_episodes->execute(soar_module::op_reinit);
+    thisAgent->EpMem->epmem_stats->retention_dropped->set_value(thisAgent->EpMem->epmem_stats->retention_dropped->get_value() + thisAgent->EpMem->epmem_db->changes());
+
+    thisAgent->EpMem->epmem_stats->retention_through->set_value(new_through);
+    epmem_set_variable(thisAgent, var_retention_through, new_through);
+
+    // compact the intervals that end in the dropped range, earliest first,
+    // so that a run of intervals separated by dropped episodes is merged
+    // into one
+    for (int type = EPMEM_RIT_STATE_NODE; type <= EPMEM_RIT_STATE_EDGE; type++)
+    {
+        std::vector< std::pair<epmem_node_id, epmem_time_id> > ending;
+        soar_module::sqlite_statement* my_q = stmts->retention_ending[ type ];
+
+        my_q->bind_int(1, through);
+        my_q->bind_int(2, new_through);
+        my_q->bind_int(3, through);
+        my_q->bind_int(4, new_through);
+        while (my_q->execute() == soar_module::row)
+        {
+            ending.push_back(std::make_pair(my_q->column_int(0), my_q->column_int(1)));
+        }
+        my_q->reinitialize();
 
-            thisAgent->symbolManager->symbol_remove_ref(&my_time_sym);
+        for (size_t i = 0; i < ending.size(); i++)
+        {
+            epmem_compact_interval(thisAgent, type, ending[i].first, ending[i].second);
         }
 
-        // clear add/remove maps
+        if (thisAgent->EpMem->epmem_intervals_built)
         {
-            thisAgent->EpMem->epmem_wme_adds->clear();
+            for (size_t i = 0; i < ending.size(); i++)
+            {
+                epmem_reload_interval_index_entry(thisAgent, type, ending[i].first);
+            }
         }
     }
 
+    thisAgent->EpMem->epmem_stats->retention_reclaimed->set_value(thisAgent->EpMem->epmem_stats->retention_reclaimed->get_value() + (used_bytes - epmem_db_used_bytes(thisAgent)));
+
+    if (!lazy_commit)
+    {
+        thisAgent->EpMem->epmem_stmts_common->commit->execute(soar_module::op_reinit);
+    }
+
     ////////////////////////////////////////////////////////////////////////////
-    thisAgent->EpMem->epmem_timers->storage->stop();
+    thisAgent->EpMem->epmem_timers->retention->stop();
     ////////////////////////////////////////////////////////////////////////////
 }
 
@@ -3882,6 +5288,7 @@ epmem_literal* epmem_build_dnf(wme* cue_wme, epmem_wme_literal_map& literal_cach
     literal->attribute_s_id = epmem_temporal_hash(thisAgent, cue_wme->attr);
     literal->is_neg_q = query_type;
     literal->weight = (literal->is_neg_q ? -1 : 1) * (thisAgent->EpMem->epmem_params->balance->get_value() >= 1.0 - 1.0e-8 ? 1.0 : wma_get_wme_activation(thisAgent, cue_wme, true));
+    literal->unsatisfiable = false;
 #ifdef USE_MEM_POOL_ALLOCATORS
     new(&(literal->matches)) epmem_node_pair_set(std::less<epmem_node_pair>(), soar_module::soar_memory_pool_allocator<epmem_node_pair>());
 #else
@@ -3897,6 +5304,11 @@ bool epmem_register_pedges(epmem_node_id parent, epmem_literal* literal, epmem_p
 {
     // we don't need to keep track of visited literals/nodes because the literals are guaranteed to be acyclic
     // that is, the expansion to the literal's children will eventually bottom out
+    // literals the summaries rule out never need their edges
+    if (literal->unsatisfiable)
+    {
+        return false;
+    }
     // select the query
     epmem_triple triple = {parent, literal->attribute_s_id, literal->child_n_id};
     int is_edge = literal->value_is_id;
@@ -4182,6 +5594,53 @@ bool epmem_unsatisfy_literal(epmem_literal* literal, epmem_node_id parent, epmem
     return false;
 }
 
+/***************************************************************************
+ * Function     : epmem_graph_match_parent_ok
+ * Notes        : Checks that binding literal to a wme whose parent is
+ *                parent_n_id agrees with the bindings of its parents.
+ **************************************************************************/
+inline bool epmem_graph_match_parent_ok(epmem_literal* literal, epmem_node_id parent_n_id, epmem_literal_node_pair_map& bindings)
+{
+    for (epmem_literal_set::iterator parent_iter = literal->parents.begin(); parent_iter != literal->parents.end(); parent_iter++)
+    {
+        epmem_literal_node_pair_map::iterator bind_iter = bindings.find(*parent_iter);
+        if (bind_iter != bindings.end() && (*bind_iter).second.second != parent_n_id)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/***************************************************************************
+ * Function     : epmem_graph_match_child_ok
+ * Notes        : Checks that binding literal to a wme whose value is
+ *                child_n_id agrees with the nodes already bound and with
+ *                the bindings of its children.
+ **************************************************************************/
+inline bool epmem_graph_match_child_ok(epmem_literal* literal, epmem_node_id child_n_id, epmem_literal_node_pair_map& bindings, epmem_node_symbol_map bound_nodes[])
+{
+    // if the node has already been bound, make sure it's bound to the same thing
+    epmem_node_symbol_map::iterator binder = bound_nodes[literal->value_is_id].find(child_n_id);
+    if (binder != bound_nodes[literal->value_is_id].end() && (*binder).second != literal->value_sym)
+    {
+        return false;
+    }
+    if (literal->child_n_id != EPMEM_NODEID_BAD && literal->child_n_id != child_n_id)
+    {
+        return false;
+    }
+    for (epmem_literal_set::iterator child_iter = literal->children.begin(); child_iter != literal->children.end(); child_iter++)
+    {
+        epmem_literal_node_pair_map::iterator bind_iter = bindings.find(*child_iter);
+        if (bind_iter != bindings.end() && (*bind_iter).second.first != child_n_id)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_deque::iterator& iter_end, epmem_literal_node_pair_map& bindings, epmem_node_symbol_map bound_nodes[], agent* thisAgent, int depth = 0)
 {
     if (dnf_iter == iter_end)
@@ -4195,13 +5654,9 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
     }
     epmem_literal_deque::iterator next_iter = dnf_iter;
     next_iter++;
-#ifdef USE_MEM_POOL_ALLOCATORS
-    epmem_node_set failed_parents = epmem_node_set(std::less<epmem_node_id>(), soar_module::soar_memory_pool_allocator<epmem_node_id>());
-    epmem_node_set failed_children = epmem_node_set(std::less<epmem_node_id>(), soar_module::soar_memory_pool_allocator<epmem_node_id>());
-#else
-    epmem_node_set failed_parents;
-    epmem_node_set failed_children;
-#endif
+    // this uses the heap rather than the memory pools, since with
+    // query-threads above 1 graph match runs on several threads at once
+    std::set<epmem_node_id> failed_parents;
     // go through the list of matches, binding each one to this literal in turn
     for (epmem_node_pair_set::iterator match_iter = literal->matches.begin(); match_iter != literal->matches.end(); match_iter++)
     {
@@ -4217,20 +5672,9 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
             {
                 std::cout << "\t";
             }
-            std::cout << "TRYING " << literal << " " << parent_n_id << std::endl;
-        }
-        bool relations_okay = true;
-        // for all parents
-        for (epmem_literal_set::iterator parent_iter = literal->parents.begin(); relations_okay && parent_iter != literal->parents.end(); parent_iter++)
-        {
-            epmem_literal* parent = *parent_iter;
-            epmem_literal_node_pair_map::iterator bind_iter = bindings.find(parent);
-            if (bind_iter != bindings.end() && (*bind_iter).second.second != parent_n_id)
-            {
-                relations_okay = false;
-            }
+            std::cout << "TRYING " << literal << " " << parent_n_id << " " << child_n_id << std::endl;
         }
-        if (!relations_okay)
+        if (!epmem_graph_match_parent_ok(literal, parent_n_id, bindings))
         {
             if (QUERY_DEBUG >= 2)
             {
@@ -4243,36 +5687,7 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
             failed_parents.insert(parent_n_id);
             continue;
         }
-        // if the node has already been bound, make sure it's bound to the same thing
-        epmem_node_symbol_map::iterator binder = bound_nodes[literal->value_is_id].find(child_n_id);
-        if (binder != bound_nodes[literal->value_is_id].end() && (*binder).second != literal->value_sym)
-        {
-            failed_children.insert(child_n_id);
-            continue;
-        }
-        if (QUERY_DEBUG >= 2)
-        {
-            for (int i = 0; i < depth; i++)
-            {
-                std::cout << "\t";
-            }
-            std::cout << "TRYING " << literal << " " << parent_n_id << " " << child_n_id << std::endl;
-        }
-        if (literal->child_n_id != EPMEM_NODEID_BAD && literal->child_n_id != child_n_id)
-        {
-            relations_okay = false;
-        }
-        // for all children
-        for (epmem_literal_set::iterator child_iter = literal->children.begin(); relations_okay && child_iter != literal->children.end(); child_iter++)
-        {
-            epmem_literal* child = *child_iter;
-            epmem_literal_node_pair_map::iterator bind_iter = bindings.find(child);
-            if (bind_iter != bindings.end() && (*bind_iter).second.first != child_n_id)
-            {
-                relations_okay = false;
-            }
-        }
-        if (!relations_okay)
+        if (!epmem_graph_match_child_ok(literal, child_n_id, bindings, bound_nodes))
         {
             if (QUERY_DEBUG >= 2)
             {
@@ -4282,20 +5697,13 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
                 }
                 std::cout << "CHILD CONSTRAINT FAIL" << std::endl;
             }
-            failed_children.insert(child_n_id);
             continue;
         }
-        if (QUERY_DEBUG >= 2)
-        {
-            for (int i = 0; i < depth; i++)
-            {
-                std::cout << "\t";
-            }
-            std::cout << literal << " " << parent_n_id << " " << child_n_id << std::endl;
-        }
-        // temporarily modify the bindings and bound nodes
+        // temporarily modify the bindings and bound nodes.  The node may
+        // already be bound (to the same symbol) by an earlier literal, in
+        // which case it has to stay bound when we back up.
         bindings[literal] = std::make_pair(parent_n_id, child_n_id);
-        bound_nodes[literal->value_is_id][child_n_id] = literal->value_sym;
+        bool newly_bound = bound_nodes[literal->value_is_id].insert(std::make_pair(child_n_id, literal->value_sym)).second;
         // recurse on the rest of the list
         bool list_satisfied = epmem_graph_match(next_iter, iter_end, bindings, bound_nodes, thisAgent, depth + 1);
         // if the rest of the list matched, we've succeeded
@@ -4307,7 +5715,10 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
         else
         {
             bindings.erase(literal);
-            bound_nodes[literal->value_is_id].erase(child_n_id);
+            if (newly_bound)
+            {
+                bound_nodes[literal->value_is_id].erase(child_n_id);
+            }
         }
     }
     // this means we've tried everything and this whole exercise was a waste of time
@@ -4323,6 +5734,234 @@ bool epmem_graph_match(epmem_literal_deque::iterator& dnf_iter, epmem_literal_de
     return false;
 }
 
+/***************************************************************************
+ * Function     : epmem_graph_match_partials
+ * Notes        : Completes partials first, first + stride... in turn,
+ *                stopping at the first one that completes or once some
+ *                other thread has completed an earlier one.  found holds
+ *                the index of the earliest partial completed so far.
+ *                Returns whether it tried any partial.
+ **************************************************************************/
+bool epmem_graph_match_partials(agent* thisAgent, epmem_literal_deque::iterator dnf_iter, epmem_literal_deque::iterator iter_end, std::vector<epmem_gm_partial>* partials, size_t first, size_t stride, std::atomic<size_t>* found)
+{
+    bool tried = false;
+
+    for (size_t i = first; i < partials->size() && i < found->load(); i += stride)
+    {
+        epmem_gm_partial& partial = (*partials)[ i ];
+        tried = true;
+        if (epmem_graph_match(dnf_iter, iter_end, partial.bindings, partial.bound_nodes, thisAgent, 2))
+        {
+            size_t lFound = found->load();
+            while (i < lFound && !found->compare_exchange_weak(lFound, i));
+            break;
+        }
+    }
+
+    return tried;
+}
+
+epmem_query_pool::epmem_query_pool()
+{
+    job = NULL;
+    job_threads = 0;
+    running = 0;
+    generation = 0;
+    quitting = false;
+}
+
+epmem_query_pool::~epmem_query_pool()
+{
+    stop();
+}
+
+size_t epmem_query_pool::run(size_t num_threads, const std::function<void (size_t, size_t)>& new_job)
+{
+    std::unique_lock<std::mutex> lLock(lock);
+
+    // slot 0 is the calling thread.  If a thread can't be started, the
+    // job is dealt out among the slots we have.
+    while (workers.size() + 1 < num_threads)
+    {
+        try
+        {
+            // a new thread only locks once this job is posted, so it is
+            // told which jobs it has already seen
+            workers.push_back(new std::thread(&epmem_query_pool::work, this, workers.size() + 1, generation));
+        }
+        catch (std::system_error&)
+        {
+            num_threads = workers.size() + 1;
+        }
+    }
+
+    job = &new_job;
+    job_threads = num_threads;
+    running = num_threads - 1;
+    generation++;
+    work_ready.notify_all();
+    lLock.unlock();
+
+    new_job(0, num_threads);
+
+    lLock.lock();
+    while (running)
+    {
+        work_done.wait(lLock);
+    }
+    job = NULL;
+
+    return num_threads;
+}
+
+void epmem_query_pool::stop()
+{
+    {
+        std::unique_lock<std::mutex> lLock(lock);
+
+        if (workers.empty())
+        {
+            return;
+        }
+        quitting = true;
+        work_ready.notify_all();
+    }
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[ i ]->join();
+        delete workers[ i ];
+    }
+    workers.clear();
+    quitting = false;
+}
+
+void epmem_query_pool::work(size_t slot, uint64_t done)
+{
+    std::unique_lock<std::mutex> lLock(lock);
+
+    while (true)
+    {
+        while (generation == done && !quitting)
+        {
+            work_ready.wait(lLock);
+        }
+        if (quitting)
+        {
+            break;
+        }
+        done = generation;
+
+        // a job run on fewer threads than the pool has leaves the rest idle
+        if (slot >= job_threads)
+        {
+            continue;
+        }
+
+        const std::function<void (size_t, size_t)>* lJob = job;
+        size_t lThreads = job_threads;
+        lLock.unlock();
+
+        (*lJob)(slot, lThreads);
+
+        lLock.lock();
+        if (--running == 0)
+        {
+            work_done.notify_all();
+        }
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_graph_match_parallel
+ * Notes        : Graph matches the ordering on up to num_threads threads
+ *                (the calling thread included).
+ *
+ *                The first few literals of the ordering are bound on the
+ *                calling thread, breadth first, until there are at least
+ *                EPMEM_GM_PARTIALS_PER_THREAD partial matches per thread.
+ *                Each level keeps its partials in the order the serial
+ *                search would reach them.  The partials are then dealt
+ *                out round-robin to the query pool and each thread
+ *                completes its own, sharing nothing but the literals'
+ *                match sets, which nobody writes to during graph match.
+ *
+ *                The serial search returns the bindings of the first
+ *                partial (in that order) that can be completed, so that
+ *                is the one we keep: a thread only gives up on its
+ *                partials once an earlier one has completed.  The
+ *                bindings are therefore exactly the ones
+ *                epmem_graph_match would find.
+ **************************************************************************/
+#define EPMEM_GM_PARTIALS_PER_THREAD 4
+
+bool epmem_graph_match_parallel(agent* thisAgent, epmem_literal_deque::iterator dnf_iter, epmem_literal_deque::iterator iter_end, epmem_literal_node_pair_map& bindings, size_t num_threads)
+{
+    std::vector<epmem_gm_partial> lPartials(1);
+    std::vector<epmem_gm_partial> lNextPartials;
+
+    while (dnf_iter != iter_end && lPartials.size() < (num_threads * EPMEM_GM_PARTIALS_PER_THREAD))
+    {
+        epmem_literal* literal = *dnf_iter;
+        lNextPartials.clear();
+        for (std::vector<epmem_gm_partial>::iterator partial = lPartials.begin(); partial != lPartials.end(); partial++)
+        {
+            if (partial->bindings.count(literal))
+            {
+                continue;
+            }
+            for (epmem_node_pair_set::iterator match_iter = literal->matches.begin(); match_iter != literal->matches.end(); match_iter++)
+            {
+                if (epmem_graph_match_parent_ok(literal, (*match_iter).first, partial->bindings) && epmem_graph_match_child_ok(literal, (*match_iter).second, partial->bindings, partial->bound_nodes))
+                {
+                    lNextPartials.push_back(*partial);
+                    lNextPartials.back().bindings[literal] = *match_iter;
+                    lNextPartials.back().bound_nodes[literal->value_is_id][(*match_iter).second] = literal->value_sym;
+                }
+            }
+        }
+        lPartials.swap(lNextPartials);
+        dnf_iter++;
+    }
+
+    if (lPartials.empty())
+    {
+        return false;
+    }
+    if (dnf_iter == iter_end)
+    {
+        bindings.swap(lPartials.front().bindings);
+        return true;
+    }
+
+    if (num_threads > lPartials.size())
+    {
+        num_threads = lPartials.size();
+    }
+    std::atomic<size_t> lFound(lPartials.size());
+    std::atomic<size_t> lTried(0);
+
+    thisAgent->EpMem->epmem_query_workers->run(num_threads, [&](size_t slot, size_t threads)
+    {
+        if (epmem_graph_match_partials(thisAgent, dnf_iter, iter_end, &lPartials, slot, threads, &lFound))
+        {
+            lTried++;
+        }
+    });
+
+    if (static_cast<int64_t>(lTried.load()) > thisAgent->EpMem->epmem_stats->qry_threads->get_value())
+    {
+        thisAgent->EpMem->epmem_stats->qry_threads->set_value(lTried.load());
+    }
+
+    if (lFound.load() == lPartials.size())
+    {
+        return false;
+    }
+    bindings.swap(lPartials[ lFound.load() ].bindings);
+    return true;
+}
+
 void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Symbol* neg_query, epmem_time_list& prohibits, epmem_time_id before, epmem_time_id after, wme_set& cue_wmes, symbol_triple_list& meta_wmes, symbol_triple_list& retrieval_wmes, int level = 3)
 {
     // a query must contain a positive cue
@@ -4355,6 +5994,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
     // epmem options
     bool do_graph_match = (thisAgent->EpMem->epmem_params->graph_match->get_value() == on);
     epmem_param_container::gm_ordering_choices gm_order = thisAgent->EpMem->epmem_params->gm_ordering->get_value();
+    size_t query_threads = static_cast<size_t>(thisAgent->EpMem->epmem_params->query_threads->get_value());
 
     // variables needed for cleanup
     epmem_wme_literal_map literal_cache;
@@ -4404,6 +6044,9 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
         {
             thisAgent->EpMem->epmem_stats->qry_pos->set_value(0);
             thisAgent->EpMem->epmem_stats->qry_neg->set_value(0);
+            thisAgent->EpMem->epmem_stats->qry_index->set_value(0);
+            thisAgent->EpMem->epmem_stats->qry_threads->set_value(0);
+            thisAgent->EpMem->epmem_stats->qry_pruned->set_value(0);
             thisAgent->EpMem->epmem_timers->query_dnf->start();
             root_literal->id_sym = NULL;
             root_literal->value_sym = pos_query;
@@ -4413,6 +6056,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
             root_literal->attribute_s_id = EPMEM_NODEID_BAD;
             root_literal->child_n_id = EPMEM_NODEID_ROOT;
             root_literal->weight = 0.0;
+            root_literal->unsatisfiable = false;
             new(&(root_literal->parents)) epmem_literal_set();
             new(&(root_literal->children)) epmem_literal_set();
 #ifdef USE_MEM_POOL_ALLOCATORS
@@ -4490,6 +6134,56 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
         epmem_time_id current_episode = before;
         epmem_time_id next_episode;
 
+        // use the summaries to rule out literals that cannot hold in the
+        // query window and to bound the score of each block of episodes:
+        // summary_bounds[i] is the best score any episode in the first i
+        // blocks of the window could have, and summary_perfect[i] whether
+        // one of them could match every positive leaf literal
+        size_t summary_first = 0;
+        std::vector<double> summary_bounds;
+        std::vector<bool> summary_perfect;
+        if (thisAgent->EpMem->epmem_summaries_built && (before > after))
+        {
+            for (epmem_wme_literal_map::iterator iter = literal_cache.begin(); iter != literal_cache.end(); iter++)
+            {
+                epmem_literal* literal = iter->second;
+                if (literal != root_literal)
+                {
+                    literal->unsatisfiable = !epmem_summary_possible(thisAgent, epmem_literal_summary_key(literal), after + 1, before);
+                }
+            }
+
+            summary_first = epmem_summary_block_of(thisAgent, after + 1);
+            size_t summary_last = epmem_summary_block_of(thisAgent, before);
+            if (summary_last < thisAgent->EpMem->epmem_summaries->size())
+            {
+                double bound = 0;
+                bool perfect = false;
+                for (size_t block = summary_first; block <= summary_last; block++)
+                {
+                    const epmem_summary& summary = (*thisAgent->EpMem->epmem_summaries)[ block ];
+                    double block_bound = 0;
+                    bool block_perfect = true;
+                    for (epmem_literal_set::iterator iter = leaf_literals.begin(); iter != leaf_literals.end(); iter++)
+                    {
+                        bool possible = (!(*iter)->unsatisfiable && epmem_summary_contains(summary, epmem_literal_summary_key(*iter)));
+                        if (possible && ((*iter)->weight > 0))
+                        {
+                            block_bound += (*iter)->weight;
+                        }
+                        if (!possible && !(*iter)->is_neg_q)
+                        {
+                            block_perfect = false;
+                        }
+                    }
+                    bound = ((block_bound > bound) ? block_bound : bound);
+                    perfect = (perfect || block_perfect);
+                    summary_bounds.push_back(bound);
+                    summary_perfect.push_back(perfect);
+                }
+            }
+        }
+
         // create dummy edges and intervals
         {
             // insert dummy unique edge and interval end point queries for DNF root
@@ -4527,6 +6221,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
             root_interval->sql->prepare();
             root_interval->sql->bind_int(1, before);
             root_interval->sql->execute(soar_module::op_reinit);
+            root_interval->ranges = NULL;
             root_interval->time = before;
             interval_pq.push(root_interval);
             interval_cleanup.insert(root_interval);
@@ -4635,31 +6330,59 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                                     }
                                     break;
                             }
-                            // create the SQL query and bind it
-                            // try to find an existing query first; if none exist, allocate a new one from the memory pools
-                            soar_module::pooled_sqlite_statement* interval_sql = NULL;
-                            interval_sql = thisAgent->EpMem->epmem_stmts_graph->pool_find_interval_queries[pedge->value_is_id][point_type][interval_type]->request(sql_timer);
-                            int bind_pos = 1;
-                            if (point_type == EPMEM_RANGE_END && interval_type == EPMEM_RANGE_NOW)
+                            epmem_interval* interval;
+                            thisAgent->memoryManager->allocate_with_pool(MP_epmem_interval, &interval);
+                            interval->is_end_point = point_type;
+                            interval->uedge = uedge;
+                            interval->sql = NULL;
+                            interval->ranges = NULL;
+                            bool found = false;
+
+                            if (thisAgent->EpMem->epmem_intervals_built)
+                            {
+                                // the index keeps points with the ranges
+                                if (interval_type != EPMEM_RANGE_POINT)
+                                {
+                                    found = epmem_interval_index_find(thisAgent, interval, pedge->value_is_id, interval_type, edge_id, current_episode);
+                                    if (found)
+                                    {
+                                        thisAgent->EpMem->epmem_stats->qry_index->set_value(thisAgent->EpMem->epmem_stats->qry_index->get_value() + 1);
+                                    }
+                                }
+                            }
+                            else
                             {
+                                // create the SQL query and bind it
+                                // try to find an existing query first; if none exist, allocate a new one from the memory pools
+                                soar_module::pooled_sqlite_statement* interval_sql = NULL;
+                                interval_sql = thisAgent->EpMem->epmem_stmts_graph->pool_find_interval_queries[pedge->value_is_id][point_type][interval_type]->request(sql_timer);
+                                int bind_pos = 1;
+                                if (point_type == EPMEM_RANGE_END && interval_type == EPMEM_RANGE_NOW)
+                                {
+                                    interval_sql->bind_int(bind_pos++, current_episode);
+                                }
+                                interval_sql->bind_int(bind_pos++, edge_id);
                                 interval_sql->bind_int(bind_pos++, current_episode);
+                                if (interval_sql->execute() == soar_module::row)
+                                {
+                                    // If it's an start point of a range (ie. not a point) and it's before the promo time
+                                    // (this is possible if a the promotion is in the middle of a range)
+                                    // trim it to the promo time.
+                                    // This will only happen if the LTI is promoted in the last interval it appeared in
+                                    // (since otherwise the start point would not be before its promotion).
+                                    // We don't care about the remaining results of the query
+                                    interval->time = interval_sql->column_int(0);
+                                    interval->sql = interval_sql;
+                                    found = true;
+                                }
+                                else
+                                {
+                                    interval_sql->get_pool()->release(interval_sql);
+                                }
                             }
-                            interval_sql->bind_int(bind_pos++, edge_id);
-                            interval_sql->bind_int(bind_pos++, current_episode);
-                            if (interval_sql->execute() == soar_module::row)
+
+                            if (found)
                             {
-                                epmem_interval* interval;
-                                thisAgent->memoryManager->allocate_with_pool(MP_epmem_interval, &interval);
-                                interval->is_end_point = point_type;
-                                interval->uedge = uedge;
-                                // If it's an start point of a range (ie. not a point) and it's before the promo time
-                                // (this is possible if a the promotion is in the middle of a range)
-                                // trim it to the promo time.
-                                // This will only happen if the LTI is promoted in the last interval it appeared in
-                                // (since otherwise the start point would not be before its promotion).
-                                // We don't care about the remaining results of the query
-                                interval->time = interval_sql->column_int(0);
-                                interval->sql = interval_sql;
                                 interval_pq.push(interval);
                                 interval_cleanup.insert(interval);
                                 uedge->intervals++;
@@ -4667,7 +6390,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                             }
                             else
                             {
-                                interval_sql->get_pool()->release(interval_sql);
+                                thisAgent->memoryManager->free_with_pool(MP_epmem_interval, interval);
                             }
                         }
                     }
@@ -4763,15 +6486,12 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                     }
                     // put the interval query back into the queue if there's more and some literal cares
                     // otherwise, reinitialize the query and put it in a pool
-                    if (interval->sql && interval->sql->execute() == soar_module::row)
+                    if (epmem_interval_next(interval))
                     {
-                        interval->time = interval->sql->column_int(0);
                         interval_pq.push(interval);
                     }
-                    else if (interval->sql)
+                    else
                     {
-                        interval->sql->get_pool()->release(interval->sql);
-                        interval->sql = NULL;
                         uedge->intervals--;
                         if (uedge->intervals)
                         {
@@ -4792,11 +6512,29 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                 {
                     prohibits.pop_back();
                 }
-                // ignore the episode if it is prohibited
-                while (prohibits.size() && current_episode > next_episode && current_episode == prohibits.back())
+                // ignore the episode if it is prohibited or was dropped by
+                // the retention policy; the last kept episode in this
+                // period (if any) has the same score
+                while (current_episode > next_episode)
                 {
-                    current_episode--;
-                    prohibits.pop_back();
+                    epmem_time_id kept_episode = epmem_kept_episode(thisAgent, current_episode, true);
+                    if (kept_episode != current_episode)
+                    {
+                        current_episode = ((kept_episode > next_episode) ? kept_episode : next_episode);
+                        while (prohibits.size() && prohibits.back() > current_episode)
+                        {
+                            prohibits.pop_back();
+                        }
+                    }
+                    else if (prohibits.size() && current_episode == prohibits.back())
+                    {
+                        current_episode--;
+                        prohibits.pop_back();
+                    }
+                    else
+                    {
+                        break;
+                    }
                 }
 
                 if (QUERY_DEBUG >= 2)
@@ -4845,7 +6583,14 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                                 epmem_print_retrieval_state(literal_cache, pedge_caches, uedge_caches);
                             }
                             thisAgent->EpMem->epmem_timers->query_graph_match->start();
-                            graph_matched = epmem_graph_match(begin, end, best_bindings, bound_nodes, thisAgent, 2);
+                            if (query_threads > 1)
+                            {
+                                graph_matched = epmem_graph_match_parallel(thisAgent, begin, end, best_bindings, query_threads);
+                            }
+                            else
+                            {
+                                graph_matched = epmem_graph_match(begin, end, best_bindings, bound_nodes, thisAgent, 2);
+                            }
                             thisAgent->EpMem->epmem_timers->query_graph_match->stop();
                         }
                         if (!do_graph_match || graph_matched)
@@ -4865,6 +6610,24 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                     }
                 }
 
+                // stop if no earlier episode can replace the best one: none
+                // can score higher, and (with graph match) none that scores
+                // the same can match every leaf literal
+                if ((current_episode != EPMEM_MEMID_NONE) && (best_episode != EPMEM_MEMID_NONE) && (next_episode > after) && !summary_bounds.empty())
+                {
+                    size_t summary_pos = epmem_summary_block_of(thisAgent, next_episode) - summary_first;
+                    if (summary_pos < summary_bounds.size())
+                    {
+                        double bound = summary_bounds[ summary_pos ];
+                        if ((bound < best_score - EPMEM_SUMMARY_SLACK) || ((bound <= best_score + EPMEM_SUMMARY_SLACK) && (!do_graph_match || !summary_perfect[ summary_pos ])))
+                        {
+                            // next_episode's block and every earlier one
+                            thisAgent->EpMem->epmem_stats->qry_pruned->set_value(summary_pos + 1);
+                            current_episode = EPMEM_MEMID_NONE;
+                        }
+                    }
+                }
+
                 if (current_episode == EPMEM_MEMID_NONE)
                 {
                     break;
@@ -5037,6 +6800,7 @@ inline std::string _epmem_print_sti(epmem_node_id id)
 
 void epmem_print_episode(agent* thisAgent, epmem_time_id memory_id, std::string* buf)
 {
+    epmem_flush_writes(thisAgent);
     epmem_attach(thisAgent);
 
     // if bad memory, bail
@@ -5167,6 +6931,7 @@ void epmem_print_episode(agent* thisAgent, epmem_time_id memory_id, std::string*
 
 void epmem_visualize_episode(agent* thisAgent, epmem_time_id memory_id, std::string* buf)
 {
+    epmem_flush_writes(thisAgent);
     epmem_attach(thisAgent);
 
     // if bad memory, bail
@@ -5747,6 +7512,7 @@ void epmem_respond_to_cmd(agent* thisAgent)
         if (new_cue && wme_count)
         {
             dprint(DT_EPMEM_CMD, "--- Processing new epmem command...\n");
+            epmem_flush_writes(thisAgent);
             _epmem_respond_to_cmd_parse(thisAgent, cmds, good_cue, path, retrieve, next, previous, query, neg_query, prohibit, before, after, cue_wmes);
 
             ////////////////////////////////////////////////////////////////////////////
@@ -5906,7 +7672,7 @@ void epmem_respond_to_cmd(agent* thisAgent)
  **************************************************************************/
 void epmem_go(agent* thisAgent, bool allow_store)
 {
-
+    thisAgent->timeline->begin(TIMELINE_EPMEM);
     thisAgent->EpMem->epmem_timers->total->start();
 
     if (allow_store)
@@ -5915,15 +7681,21 @@ void epmem_go(agent* thisAgent, bool allow_store)
     }
     epmem_respond_to_cmd(thisAgent);
 
+    if ((thisAgent->EpMem->epmem_params->retention->get_value() == on) && (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected))
+    {
+        epmem_apply_retention(thisAgent);
+    }
 
     thisAgent->EpMem->epmem_timers->total->stop();
-
+    thisAgent->timeline->end(TIMELINE_EPMEM);
 }
 
 bool epmem_backup_db(agent* thisAgent, const char* file_name, std::string* err)
 {
     bool return_val = false;
 
+    epmem_flush_writes(thisAgent);
+
     if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
     {
         if (thisAgent->EpMem->epmem_params->lazy_commit->get_value() == on)
@@ -5984,6 +7756,21 @@ EpMem_Manager::EpMem_Manager(agent* myAgent)
 
      epmem_validation = 0;
 
+     epmem_intervals[ EPMEM_RIT_STATE_NODE ] = new epmem_interval_index();
+     epmem_intervals[ EPMEM_RIT_STATE_EDGE ] = new epmem_interval_index();
+     epmem_intervals_built = false;
+
+     epmem_summaries = new epmem_summary_list();
+     epmem_summary_keys[ EPMEM_RIT_STATE_NODE ] = new epmem_summary_key_list();
+     epmem_summary_keys[ EPMEM_RIT_STATE_EDGE ] = new epmem_summary_key_list();
+     epmem_summary_open = new epmem_summary_open_map();
+     epmem_summaries_built = false;
+
+     epmem_pending_writes = new epmem_write_buffer();
+     epmem_writer = new epmem_storage_writer(thisAgent);
+     epmem_log = new epmem_episode_log();
+     epmem_query_workers = new epmem_query_pool();
+
 };
 
 void EpMem_Manager::clean_up_for_agent_deletion()
@@ -5993,6 +7780,16 @@ void EpMem_Manager::clean_up_for_agent_deletion()
     // cleanup exploration
 
     epmem_close(thisAgent);
+    delete epmem_writer;
+    delete epmem_log;
+    delete epmem_query_workers;
+    delete epmem_pending_writes;
+    delete epmem_intervals[ EPMEM_RIT_STATE_NODE ];
+    delete epmem_intervals[ EPMEM_RIT_STATE_EDGE ];
+    delete epmem_summaries;
+    delete epmem_summary_keys[ EPMEM_RIT_STATE_NODE ];
+    delete epmem_summary_keys[ EPMEM_RIT_STATE_EDGE ];
+    delete epmem_summary_open;
     delete epmem_params;
     delete epmem_stats;
     delete epmem_timers;
@@ -23,6 +23,12 @@
 #include <stack>
 #include <set>
 #include <queue>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 //////////////////////////////////////////////////////////
 // EpMem Parameters
@@ -36,6 +42,7 @@ class epmem_param_container: public soar_module::param_container
 
         // storage
         enum db_choices { memory, file };
+        enum backend_choices { backend_sqlite, backend_log };
 
         // encoding
         enum phase_choices { phase_output, phase_selection };
@@ -66,6 +73,14 @@ class epmem_param_container: public soar_module::param_container
         epmem_path_param* path;
         soar_module::boolean_param* lazy_commit;
         soar_module::boolean_param* append_db;
+        soar_module::boolean_param* write_behind;
+        soar_module::constant_param<backend_choices>* backend;
+
+        // retention
+        soar_module::boolean_param* retention;
+        soar_module::integer_param* retention_recent;
+        soar_module::integer_param* retention_stride;
+        soar_module::integer_param* retention_batch;
 
         // retrieval
         soar_module::boolean_param* graph_match;
@@ -75,6 +90,10 @@ class epmem_param_container: public soar_module::param_container
         soar_module::constant_param<page_choices>* page_size;
         soar_module::integer_param* cache_size;
         soar_module::constant_param<opt_choices>* opt;
+        soar_module::boolean_param* interval_index;
+        soar_module::boolean_param* summaries;
+        soar_module::integer_param* summary_block;
+        soar_module::integer_param* query_threads;
         soar_module::constant_param<soar_module::timer::timer_level>* timers;
 
         // experimental
@@ -135,9 +154,19 @@ class epmem_stat_container: public soar_module::stat_container
         epmem_time_id_stat* qry_ret;
         soar_module::integer_stat* qry_card;
         soar_module::integer_stat* qry_lits;
+        soar_module::integer_stat* qry_index;
+        soar_module::integer_stat* qry_threads;
+        soar_module::integer_stat* qry_pruned;
 
         epmem_node_id_stat* next_id;
 
+        epmem_time_id_stat* retention_through;
+        soar_module::integer_stat* retention_dropped;
+        soar_module::integer_stat* retention_reclaimed;
+
+        soar_module::integer_stat* log_flushes;
+        soar_module::integer_stat* log_superseded;
+
         soar_module::integer_stat* rit_offset_1;
         soar_module::integer_stat* rit_left_root_1;
         soar_module::integer_stat* rit_right_root_1;
@@ -206,6 +235,7 @@ class epmem_timer_container: public soar_module::timer_container
         soar_module::timer* prev;
         soar_module::timer* hash;
         soar_module::timer* wm_phase;
+        soar_module::timer* retention;
 
         soar_module::timer* ncb_edge;
         soar_module::timer* ncb_edge_rit;
@@ -334,6 +364,25 @@ class epmem_graph_statement_container: public soar_module::sqlite_statement_cont
 
         //
 
+        // retention: [ EPMEM_RIT_STATE_NODE | EPMEM_RIT_STATE_EDGE ]
+        soar_module::sqlite_statement* drop_episodes;
+        soar_module::sqlite_statement* kept_episode_before;
+        soar_module::sqlite_statement* kept_episode_after;
+        soar_module::sqlite_statement* retention_ending[2];
+        soar_module::sqlite_statement* retention_find_start[2];
+        soar_module::sqlite_statement* retention_find_end[2];
+        soar_module::sqlite_statement* retention_next_start[2];
+        soar_module::sqlite_statement* retention_delete_range[2];
+        soar_module::sqlite_statement* retention_delete_point[2];
+        soar_module::sqlite_statement* retention_update_now[2];
+        soar_module::sqlite_statement* retention_intervals[2];
+        soar_module::sqlite_statement* retention_now[2];
+        soar_module::sqlite_statement* page_count;
+        soar_module::sqlite_statement* freelist_count;
+        soar_module::sqlite_statement* page_size;
+
+        //
+
         soar_module::sqlite_statement_pool* pool_find_edge_queries[2][2];
         soar_module::sqlite_statement_pool* pool_find_interval_queries[2][2][3];
 //        soar_module::sqlite_statement_pool* pool_find_lti_queries[2][3];
@@ -450,6 +499,149 @@ typedef struct epmem_edge_struct
 
 } epmem_edge;
 
+//////////////////////////////////////////////////////////
+// EpMem Interval Index
+//////////////////////////////////////////////////////////
+
+// an interval of episodes during which a wme was in working memory
+// (a point is an interval with start == end)
+typedef struct epmem_time_range_struct
+{
+    epmem_time_id start;
+    epmem_time_id end;
+} epmem_time_range;
+
+// every stored interval of one wme, ordered by start, plus the
+// start of its current (NOW) interval, if any
+typedef struct epmem_wme_intervals_struct
+{
+    std::vector<epmem_time_range> ranges;
+    epmem_time_id now_start;
+} epmem_wme_intervals;
+
+// in-memory copy of the range, point and NOW tables, indexed by wc_id/wi_id
+typedef std::vector<epmem_wme_intervals> epmem_interval_index;
+
+//////////////////////////////////////////////////////////
+// EpMem Episode Summaries
+//////////////////////////////////////////////////////////
+
+// size of the Bloom filter kept for each block of episodes
+#define EPMEM_SUMMARY_WORDS 64
+#define EPMEM_SUMMARY_PROBES 3
+
+// scores within this of each other are treated as equal when
+// comparing them to a block's bound
+#define EPMEM_SUMMARY_SLACK 1.0e-9
+
+// Bloom filter over the keys of every wme that was in working memory
+// during some episode of a block (see epmem_summary_key)
+typedef struct epmem_summary_struct
+{
+    uint64_t bits[EPMEM_SUMMARY_WORDS];
+} epmem_summary;
+
+typedef std::vector<epmem_summary> epmem_summary_list;
+
+// summary key of each wme, indexed by wc_id/wi_id
+typedef std::vector<uint64_t> epmem_summary_key_list;
+
+// number of wmes in working memory with each summary key
+typedef std::map<uint64_t, int64_t> epmem_summary_open_map;
+
+//////////////////////////////////////////////////////////
+// EpMem Write-Behind Storage
+//////////////////////////////////////////////////////////
+
+// the database writes that record one episode, in the order
+// epmem_new_episode used to execute them
+enum epmem_write_type
+{
+    EPMEM_WRITE_CONSTANT_NOW,           // (id, start)
+    EPMEM_WRITE_CONSTANT_NOW_DELETE,    // (id)
+    EPMEM_WRITE_CONSTANT_POINT,         // (id, start)
+    EPMEM_WRITE_IDENTIFIER_NOW,         // (id, start)
+    EPMEM_WRITE_IDENTIFIER_NOW_DELETE,  // (id)
+    EPMEM_WRITE_IDENTIFIER_POINT,       // (id, start)
+    EPMEM_WRITE_IDENTIFIER_LAST,        // (id, last episode)
+    EPMEM_WRITE_RANGE,                  // (rit, node, start, end, id)
+    EPMEM_WRITE_VARIABLE,               // (key, value)
+    EPMEM_WRITE_TIME                    // (time)
+};
+
+typedef struct epmem_write_struct
+{
+    epmem_write_type type;
+    int64_t args[5];
+} epmem_write;
+
+typedef std::vector<epmem_write> epmem_write_buffer;
+
+// applies buffered episode writes to the database on its own thread.
+// the main thread must flush() before it touches the database itself.
+class epmem_storage_writer
+{
+    public:
+        epmem_storage_writer(agent* myAgent);
+        ~epmem_storage_writer();
+
+        // hands the writes of one episode to the writer thread (empties writes)
+        void submit(epmem_write_buffer& writes);
+
+        // blocks until every submitted write is in the database
+        void flush();
+
+        // flushes and stops the writer thread
+        void stop();
+
+    private:
+        void run();
+
+        agent* thisAgent;
+        std::thread* writer_thread;
+        std::mutex lock;
+        std::condition_variable work_ready;
+        std::condition_variable work_done;
+
+        epmem_write_buffer queued;          // submitted, not yet taken by the thread
+        epmem_write_buffer writing;         // batch the thread is applying
+        bool busy;
+        bool quitting;
+};
+
+// writes the log backend holds before it stores them unasked
+#define EPMEM_LOG_FLUSH_WRITES 65536
+
+// the episode writes of the log backend, held in memory until something
+// needs the database.  each wme's pending now row and last-episode update
+// and each pending variable is indexed by id, so that writes a later
+// episode supersedes can be dropped from the log instead of stored.
+class epmem_episode_log
+{
+    public:
+        epmem_episode_log();
+
+        // appends the writes of one episode (empties writes), returning
+        // how many writes already in the log or in writes it dropped
+        size_t append(epmem_write_buffer& writes);
+
+        // moves the surviving writes, in log order, into writes
+        void take(epmem_write_buffer& writes);
+
+        size_t size();
+
+    private:
+        typedef std::unordered_map<int64_t, size_t> log_index;
+
+        bool supersede(log_index& index, int64_t id, size_t pos);
+
+        epmem_write_buffer entries;
+        std::vector<bool> live;
+        log_index now_rows[2];
+        log_index last_updates;
+        log_index variables;
+};
+
 //////////////////////////////////////////////////////////
 // Parameter Functions (see cpp for comments)
 //////////////////////////////////////////////////////////
@@ -474,6 +666,9 @@ extern void epmem_clear_transient_structures(agent* thisAgent);
 extern void epmem_go(agent* thisAgent, bool allow_store = true);
 extern bool epmem_backup_db(agent* thisAgent, const char* file_name, std::string* err);
 extern void epmem_init_db(agent* thisAgent, bool readonly = false);
+extern void epmem_flush_writes(agent* thisAgent);
+extern void epmem_flush_writer(agent* thisAgent);
+extern void epmem_flush_log(agent* thisAgent);
 // visualization
 extern void epmem_visualize_episode(agent* thisAgent, epmem_time_id memory_id, std::string* buf);
 extern void epmem_print_episode(agent* thisAgent, epmem_time_id memory_id, std::string* buf);
@@ -556,6 +751,7 @@ struct epmem_literal_struct
     epmem_node_id attribute_s_id;
     epmem_node_id child_n_id;
     double weight;
+    bool unsatisfiable;
     epmem_literal_set parents;
     epmem_literal_set children;
     epmem_node_pair_set matches;
@@ -587,6 +783,51 @@ struct epmem_interval_struct
     int is_end_point;
     soar_module::pooled_sqlite_statement* sql;
     epmem_time_id time;
+
+    // when the interval index is used instead of sql
+    const std::vector<epmem_time_range>* ranges;
+    int64_t range_pos;
+};
+
+// a partial graph match: bindings for the literals before some point in
+// the graph match ordering, handed to a query thread to complete
+typedef struct epmem_gm_partial_struct
+{
+    epmem_literal_node_pair_map bindings;
+    epmem_node_symbol_map bound_nodes[2];
+} epmem_gm_partial;
+
+// the threads graph match hands partials to.  they are started the first
+// time a query needs them and wait between queries, so a graph match
+// doesn't pay for starting threads of its own.
+class epmem_query_pool
+{
+    public:
+        epmem_query_pool();
+        ~epmem_query_pool();
+
+        // runs job(slot, threads) for slots 0..threads-1, slot 0 on the
+        // calling thread, and returns threads once all have finished.
+        // threads is num_threads, or fewer if no more could be started.
+        size_t run(size_t num_threads, const std::function<void (size_t, size_t)>& job);
+
+        // stops the pool's threads
+        void stop();
+
+    private:
+        // done is the last job the thread has seen
+        void work(size_t slot, uint64_t done);
+
+        std::vector<std::thread*> workers;  // slots 1..n
+        std::mutex lock;
+        std::condition_variable work_ready;
+        std::condition_variable work_done;
+
+        const std::function<void (size_t, size_t)>* job;
+        size_t job_threads;                 // slots taking part in job
+        size_t running;                     // pool threads still on job
+        uint64_t generation;                // counts the jobs run
+        bool quitting;
 };
 
 // priority queues and comparison functions
@@ -661,6 +902,19 @@ class EpMem_Manager
 
         epmem_rit_state epmem_rit_state_graph[2];
 
+        epmem_interval_index* epmem_intervals[2];
+        bool epmem_intervals_built;
+
+        epmem_summary_list* epmem_summaries;
+        epmem_summary_key_list* epmem_summary_keys[2];
+        epmem_summary_open_map* epmem_summary_open;
+        bool epmem_summaries_built;
+
+        epmem_write_buffer* epmem_pending_writes;
+        epmem_storage_writer* epmem_writer;
+        epmem_episode_log* epmem_log;
+        epmem_query_pool* epmem_query_workers;
+
         uint64_t epmem_validation;
 
     private:
@@ -37,6 +37,7 @@
 #include "slot.h"
 #include "symbol.h"
 #include "test.h"
+#include "timeline.h"
 #include "working_memory.h"
 #include "working_memory_activation.h"
 #include "xml.h"
@@ -811,6 +812,7 @@ void Explanation_Based_Chunker::learn_rule_from_instance(instantiation* inst, in
     condition*          l_inst_bottom = NULL;
     uint64_t            l_clean_up_id;
     soar_timer*          lLocalTimerPtr = NULL;
+    timeline_scope      lTimeline(thisAgent->timeline, TIMELINE_EBC);
 
     #if !defined(NO_TIMING_STUFF) && defined(DETAILED_TIMING_STATS)
     soar_timer local_timer;
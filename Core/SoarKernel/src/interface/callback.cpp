@@ -28,6 +28,7 @@
 #include "run_soar.h"
 #include "output_manager.h"
 #include "print.h"
+#include "timeline.h"
 
 #include <stdlib.h>
 
@@ -328,6 +329,7 @@ void soar_invoke_callbacks(agent* thisAgent,
     /* REW: end 28.07.96 */
 
 
+    thisAgent->timeline->begin(TIMELINE_CALLBACK, callback_type);
     for (c = thisAgent->soar_callbacks[callback_type];
             c != NIL;
             c = c->rest)
@@ -337,6 +339,7 @@ void soar_invoke_callbacks(agent* thisAgent,
         cb = static_cast< soar_callback* >(c->first);
         cb->function(thisAgent, cb->eventid, cb->data, call_data);
     }
+    thisAgent->timeline->end(TIMELINE_CALLBACK, callback_type);
 
     /* REW: begin 28.07.96 */
 
@@ -453,7 +456,9 @@ void soar_invoke_first_callback(agent* thisAgent,
     soar_callback* cb;
 
     cb = static_cast< soar_callback* >(head->first);
+    thisAgent->timeline->begin(TIMELINE_CALLBACK, callback_type);
     cb->function(thisAgent, cb->eventid, cb->data, call_data);
+    thisAgent->timeline->end(TIMELINE_CALLBACK, callback_type);
 
 
     /* REW: begin 28.07.96 */
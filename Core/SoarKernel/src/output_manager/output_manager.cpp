@@ -109,6 +109,7 @@ Output_Manager::Output_Manager()
     m_params = new OM_Parameters(NULL, settings);
     m_pre_string = strdup("          ");
     m_post_string = NULL;
+    global_printer_output_column = 1;
 
     reset_column_indents();
 
@@ -160,6 +161,7 @@ void Output_Manager::set_printer_output_column(agent* thisAgent, int pOutputColu
     }
     else
     {
+        std::lock_guard<std::mutex> lLock(m_stdout_mutex);
         global_printer_output_column = pOutputColumn;
     }
 }
@@ -179,36 +181,29 @@ void Output_Manager::start_fresh_line(agent* pSoarAgent)
 void Output_Manager::update_printer_columns(agent* pSoarAgent, const char* msg)
 {
     const char* ch;
+    int lAgentColumn = pSoarAgent ? pSoarAgent->output_settings->printer_output_column : 1;
+    int lGlobalColumn = global_printer_output_column;
 
     for (ch = msg; *ch != 0; ch++)
     {
         if (*ch == '\n')
         {
-            if (pSoarAgent)
-            {
-                pSoarAgent->output_settings->printer_output_column = 1;
-                if (stdout_mode)
-                {
-                    global_printer_output_column = 1;
-                }
-            } else if (stdout_mode)
-            {
-                global_printer_output_column = 1;
-            }
+            lAgentColumn = 1;
+            lGlobalColumn = 1;
         }
         else
         {
-            if (pSoarAgent)
-            {
-                pSoarAgent->output_settings->printer_output_column++;
-                if (stdout_mode)
-                {
-                    global_printer_output_column++;
-                }
-            } else if (stdout_mode)
-            {
-                global_printer_output_column++;
-            }
+            lAgentColumn++;
+            lGlobalColumn++;
         }
     }
+
+    if (pSoarAgent)
+    {
+        pSoarAgent->output_settings->printer_output_column = lAgentColumn;
+    }
+    if (stdout_mode)
+    {
+        global_printer_output_column = lGlobalColumn;
+    }
 }
@@ -16,7 +16,9 @@
 #include "kernel.h"
 
 #include <string>
+#include <atomic>
 #include <list>
+#include <mutex>
 #include <stdlib.h>
 
 #define MAX_COLUMNS 10
@@ -93,10 +95,15 @@ class Output_Manager
         char* m_pre_string, *m_post_string;
         int  m_column_indent[MAX_COLUMNS];
 
-        /* -- The following tracks column of the next character to print if Soar is writing to cout --*/
-        int     global_printer_output_column;
+        /* -- The following tracks column of the next character to print if Soar is writing to cout.
+         *    Every agent shares it, so it is only written under m_stdout_mutex, and atomic so
+         *    that agents on other threads can check it without the lock --*/
+        std::atomic<int>    global_printer_output_column;
         void    update_printer_columns(agent* pSoarAgent, const char* msg);
 
+        /* -- Serializes writes to cout, since agents may be stepped on the run scheduler's worker threads --*/
+        std::mutex  m_stdout_mutex;
+
         void action_to_string(agent* thisAgent, action* a, std::string &destString);
         void action_list_to_string(agent* thisAgent, action* action_list, std::string &destString);
         void condition_to_string(agent* thisAgent, condition* cond, std::string &destString);
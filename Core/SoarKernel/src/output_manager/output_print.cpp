@@ -50,10 +50,14 @@ void Output_Manager::printa(agent* pSoarAgent, const char* msg)
         }
         if (stdout_mode)
         {
+            std::lock_guard<std::mutex> lLock(m_stdout_mutex);
             fputs(msg, stdout);
+            update_printer_columns(pSoarAgent, msg);
+        }
+        else
+        {
+            update_printer_columns(pSoarAgent, msg);
         }
-
-        update_printer_columns(pSoarAgent, msg);
     }
 }
 /* A way to do variadic printing with std::strings that might be worth using,
@@ -24,6 +24,7 @@
 #include "rhs.h"
 #include "soar_instance.h"
 #include "symbol_manager.h"
+#include "symbol_table.h"
 #include "symbol.h"
 #include "test.h"
 #include "working_memory.h"
@@ -820,7 +821,7 @@ void Output_Manager::print_identifiers(TraceMode mode)
     if (!m_defaultAgent) return;
 
     print("--- Identifiers: ---\n");
-    do_for_all_items_in_hash_table(m_defaultAgent, m_defaultAgent->symbolManager->identifier_hash_table, om_print_sym, &mode);
+    do_for_all_items_in_symbol_table(m_defaultAgent, m_defaultAgent->symbolManager->identifier_hash_table, om_print_sym, &mode);
 }
 
 void Output_Manager::print_variables(TraceMode mode)
@@ -830,7 +831,7 @@ void Output_Manager::print_variables(TraceMode mode)
     if (!m_defaultAgent) return;
 
     print("--- Variables: ---\n");
-    do_for_all_items_in_hash_table(m_defaultAgent, m_defaultAgent->symbolManager->variable_hash_table, om_print_sym, &mode);
+    do_for_all_items_in_symbol_table(m_defaultAgent, m_defaultAgent->symbolManager->variable_hash_table, om_print_sym, &mode);
 }
 
 
@@ -24,6 +24,7 @@
 #include "rhs.h"
 #include "slot.h"
 #include "test.h"
+#include "timeline.h"
 #include "working_memory.h"
 #include "xml.h"
 
@@ -809,6 +810,7 @@ void rl_store_data(agent* thisAgent, Symbol* goal, preference* cand)
 // performs the rl update at a state
 void rl_perform_update(agent* thisAgent, double op_value, bool op_rl, Symbol* goal, bool update_efr)
 {
+    timeline_scope lTimeline(thisAgent->timeline, TIMELINE_RL);
     bool using_gaps = (thisAgent->RL->rl_params->temporal_extension->get_value() == on);
 
     if (!using_gaps || op_rl)
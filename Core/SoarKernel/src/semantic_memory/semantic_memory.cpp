@@ -37,6 +37,7 @@
 #include "slot.h"
 #include "symbol.h"
 #include "symbol_manager.h"
+#include "timeline.h"
 #include "working_memory.h"
 #include "working_memory_activation.h"
 #include "xml.h"
@@ -105,6 +106,7 @@ wme_list* SMem_Manager::get_direct_augs_of_id(Symbol* id, tc_number tc)
 
 void SMem_Manager::go(bool store_only)
 {
+    thisAgent->timeline->begin(TIMELINE_SMEM);
     thisAgent->SMem->timers->total->start();
 
 #ifndef SMEM_EXPERIMENT
@@ -116,6 +118,7 @@ void SMem_Manager::go(bool store_only)
 #endif // SMEM_EXPERIMENT
 
     thisAgent->SMem->timers->total->stop();
+    thisAgent->timeline->end(TIMELINE_SMEM);
 }
 
 void SMem_Manager::respond_to_cmd(bool store_only)
@@ -507,6 +510,7 @@ void SMem_Manager::respond_to_cmd(bool store_only)
                     // commit transaction (if not lazy)
                     if (thisAgent->SMem->settings->lazy_commit->get_value() == off)
                     {
+                        ltm_cache_flush();
                         thisAgent->SMem->SQL->commit->execute(soar_module::op_reinit);
                     }
 
@@ -543,6 +547,7 @@ void SMem_Manager::respond_to_cmd(bool store_only)
                     // commit transaction (if not lazy)
                     if (thisAgent->SMem->settings->lazy_commit->get_value() == off)
                     {
+                        ltm_cache_flush();
                         thisAgent->SMem->SQL->commit->execute(soar_module::op_reinit);
                     }
 
@@ -670,6 +675,9 @@ bool SMem_Manager::clear()
 
 void SMem_Manager::reinit()
 {
+    // working memory is about to be cleared without us seeing every removal
+    spread_clear();
+
     if (thisAgent->SMem->connected() && (thisAgent->SMem->settings->database->get_value() == smem_param_container::file))
     {
         close();
@@ -690,6 +698,12 @@ SMem_Manager::SMem_Manager(agent* myAgent)
 
     smem_validation = 0;
 
+    ltm_cache_hand = 0;
+    history_store.loaded = false;
+    spread_tracking = false;
+    posting_index.loaded = false;
+    posting_index.next_seq = 0;
+
 };
 
 void SMem_Manager::clean_up_for_agent_deletion()
@@ -33,6 +33,7 @@ class SMem_Manager
         friend smem_db_lib_version_stat;
         friend smem_mem_usage_stat;
         friend smem_mem_high_stat;
+        friend smem_ltm_cache_hit_rate_stat;
         friend smem_timer_level_predicate;
         friend smem_db_predicate<int64_t>;
         friend smem_db_predicate<smem_param_container::page_choices>;
@@ -48,6 +49,7 @@ class SMem_Manager
         ~SMem_Manager() {};
 
         bool enabled();
+        bool spreading_enabled();
         void go(bool store_only);
         void clean_up_for_agent_deletion();
         bool clear();
@@ -60,6 +62,7 @@ class SMem_Manager
         void reset(Symbol* state);
         void reset_id_counters() { lti_id_counter = (get_max_lti_id() > settings->initial_variable_id->get_value() ? get_max_lti_id() : settings->initial_variable_id->get_value()-1); };
         bool backup_db(const char* file_name, std::string* err);
+        bool import_triples(const char* file_name, uint64_t* num_imported, std::string* err);
         bool export_smem(uint64_t lti_id, std::string& result_text, std::string** err_msg);
         void close();
 
@@ -84,6 +87,14 @@ class SMem_Manager
         void        print_store(std::string* return_val);
         void        print_smem_object(uint64_t pLTI_ID, uint64_t depth, std::string* return_val, bool history = false);
 
+        /* Tracking of LTM instances in working memory for spreading activation */
+        bool        spreading_tracked() { return spread_tracking; }
+        void        spread_wme_added(wme* w);
+        void        spread_wme_removed(wme* w);
+
+        /* Times base-level activation on a synthetic knowledge base (debug base-level) */
+        void        benchmark_base_level(uint64_t num_ltis);
+
         smem_timer_container*           timers; /* The following remains public because used in run_soar.cpp */
 
     private:
@@ -103,6 +114,25 @@ class SMem_Manager
         id_to_sym_map                   lti_to_sti_map;
         sym_to_id_map                   iSti_to_lti_map;
 
+        /* Working-set cache of recently used LTMs (CLOCK replacement) */
+        smem_ltm_cache_map              ltm_cache;
+        std::vector<smem_cached_ltm*>   ltm_cache_ring;
+        std::vector<smem_cached_ltm*>   ltm_cache_dirty;
+        size_t                          ltm_cache_hand;
+
+        /* Columnar activation histories for batched base-level activation */
+        smem_history_store              history_store;
+
+        /* Spreading activation from LTMs instantiated in working memory */
+        bool                            spread_tracking;
+        smem_spread_instance_map        spread_instances;
+        smem_spread_source_map          spread_sources;
+        smem_spread_value_map           spread_values;
+        std::vector<uint64_t>           spread_changed;
+
+        /* In-memory posting lists that queries can walk instead of the database */
+        smem_posting_index              posting_index;
+
         /* Methods for smem link interface */
         void            clear_result(Symbol* state);
         void            respond_to_cmd(bool store_only);
@@ -112,6 +142,8 @@ class SMem_Manager
         bool            is_version_one_db();
         void            update_schema_one_to_two();
         void            switch_to_memory_db(std::string& buf);
+        void            drop_deferred_indices();
+        void            create_deferred_indices();
         void            store_globals_in_db();
         void            variable_create(smem_variable_key variable_id, int64_t variable_value);
         void            variable_set(smem_variable_key variable_id, int64_t variable_value);
@@ -135,9 +167,49 @@ class SMem_Manager
         void            get_lti_name(uint64_t pLTI_ID, std::string &lti_name) { lti_name.append("@");  lti_name.append(std::to_string(pLTI_ID)); }
         uint64_t        get_max_lti_id();
         double          lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t num_edges = SMEM_ACT_MAX);
-        double          lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t n = 0, uint64_t activations_first = 0);
+        double          lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t n = 0, uint64_t activations_first = 0, const int64_t* history = NULL);
+        void            lti_activate_batch(std::vector<uint64_t>& ltis);
+        void            lti_store_activation(uint64_t pLTI_ID, double new_activation, uint64_t num_edges, smem_cached_ltm* cached);
         id_set          print_LTM(uint64_t pLTI_ID, double lti_act, std::string* return_val, std::list<uint64_t>* history = NIL);
 
+        /* Methods for the in-memory activation history store */
+        bool            history_store_ready();
+        bool            history_store_load(smem_history_store* store);
+        bool            history_store_reserve(smem_history_store* store, uint64_t pLTI_ID);
+        void            history_store_clear(smem_history_store* store);
+        void            history_store_push(uint64_t pLTI_ID, int64_t time_now, bool add_history);
+        void            history_store_calc(smem_history_store* store, const uint64_t* ltis, size_t count, int64_t time_now, bool fast_math);
+
+        /* Methods for spreading activation */
+        void            spread_update();
+        void            spread_clear();
+        void            spread_instance_changed(uint64_t pLTI_ID, bool added);
+        void            spread_compute(uint64_t pLTI_ID, smem_spread_source* source);
+        double          spread_get(uint64_t pLTI_ID);
+
+        /* Methods for the query index */
+        bool            posting_index_ready();
+        void            posting_index_load();
+        void            posting_index_clear();
+        void            posting_edge_added(uint64_t pLTI_ID, smem_hash_id attr, smem_hash_id value_const, uint64_t value_lti, double activation);
+        void            posting_ltm_activated(uint64_t pLTI_ID, double activation);
+        void            posting_ltm_truncated(uint64_t pLTI_ID);
+        bool            posting_ltm_has(uint64_t pLTI_ID, smem_weighted_cue_element* el);
+        bool            crawl_start(smem_weighted_cue_element* el, smem_crawl* crawl, bool use_index);
+        bool            crawl_next(smem_crawl* crawl);
+        void            crawl_stop(smem_crawl* crawl);
+
+        /* Methods for the LTM working-set cache */
+        bool                ltm_cache_enabled() { return (settings->ltm_cache->get_value() > 0); }
+        smem_cached_ltm*    ltm_cache_get(uint64_t pLTI_ID, bool with_children = false);
+        void                ltm_cache_load_history(smem_cached_ltm* entry);
+        void                ltm_cache_load_children(smem_cached_ltm* entry);
+        void                ltm_cache_mark_dirty(smem_cached_ltm* entry);
+        void                ltm_cache_write_back(smem_cached_ltm* entry);
+        void                ltm_cache_flush();
+        void                ltm_cache_invalidate(uint64_t pLTI_ID);
+        void                ltm_cache_clear();
+
         /* Methods for retrieving an LTM structure to be installed in STM */
         void            add_triple_to_recall_buffer(symbol_triple_list& my_list, Symbol* id, Symbol* attr, Symbol* value);
         void            install_buffered_triple_list(Symbol* state, wme_set& cue_wmes, symbol_triple_list& my_list, bool meta, bool stripLTILinks = false);
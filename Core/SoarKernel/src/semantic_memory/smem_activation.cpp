@@ -12,12 +12,230 @@
 #include "smem_stats.h"
 #include "smem_timers.h"
 
-double SMem_Manager::lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t n, uint64_t activations_first)
+#include "agent.h"
+#include "misc.h"
+#include "output_manager.h"
+#include "soar_module.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+    #define SMEM_ACT_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
+/* Fast pow/log for the batched base-level kernel (base-fast-math).  Both work
+ * on x >= 1 (ages in cycles and positive sums) and reduce to a polynomial on a
+ * short interval:
+ *   log2(x): x = m * 2^e with m in [sqrt(1/2), sqrt(2)), ln(m) from the atanh
+ *            series in s = (m-1)/(m+1), |s| <= 0.172, truncated after s^11
+ *            (absolute error below 2e-11)
+ *   exp2(y): y = i + f with f in [-1/2, 1/2], 2^f from its Taylor series to
+ *            degree 9 (relative error below 1e-11), 2^i from the exponent bits
+ * so each pow term is within ~1e-10 of libm and an activation (the log of a
+ * sum of such terms) within 1e-9. */
+#define SMEM_FAST_SQRT2     1.4142135623730951
+#define SMEM_FAST_LN2       0.6931471805599453
+#define SMEM_FAST_LOG2E     1.4426950408889634
+
+inline double smem_fast_log2(double x)
 {
+    uint64_t lBits;
+    memcpy(&lBits, &x, sizeof(lBits));
+    double e = static_cast<double>(static_cast<int64_t>(lBits >> 52)) - 1023.0;
+    lBits = (lBits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    memcpy(&m, &lBits, sizeof(m));
+    if (m > SMEM_FAST_SQRT2)
+    {
+        m *= 0.5;
+        e += 1.0;
+    }
+
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double p = 1.0 / 11.0;
+    p = p * s2 + 1.0 / 9.0;
+    p = p * s2 + 1.0 / 7.0;
+    p = p * s2 + 1.0 / 5.0;
+    p = p * s2 + 1.0 / 3.0;
+    p = p * s2 + 1.0;
+
+    return e + (2.0 * s * p) * SMEM_FAST_LOG2E;
+}
+
+inline double smem_fast_exp2(double y)
+{
+    y = (y < -1022.0) ? (-1022.0) : ((y > 1023.0) ? (1023.0) : (y));
+    int32_t i = static_cast<int32_t>((y < 0) ? (y - 0.5) : (y + 0.5));
+    double z = (y - static_cast<double>(i)) * SMEM_FAST_LN2;
+    double p = 1.0 / 362880.0;
+    p = p * z + 1.0 / 40320.0;
+    p = p * z + 1.0 / 5040.0;
+    p = p * z + 1.0 / 720.0;
+    p = p * z + 1.0 / 120.0;
+    p = p * z + 1.0 / 24.0;
+    p = p * z + 1.0 / 6.0;
+    p = p * z + 0.5;
+    p = p * z + 1.0;
+    p = p * z + 1.0;
+
+    uint64_t lBits = static_cast<uint64_t>(i + 1023) << 52;
+    double lScale;
+    memcpy(&lScale, &lBits, sizeof(lScale));
+    return p * lScale;
+}
+
+inline double smem_fast_pow(double x, double power)
+{
+    return smem_fast_exp2(power * smem_fast_log2(x));
+}
+
+#ifdef SMEM_ACT_USE_SSE2
+inline __m128d smem_fast_log2_sse2(__m128d x)
+{
+    __m128i lBits = _mm_castpd_si128(x);
+    __m128d e = _mm_cvtepi32_pd(_mm_shuffle_epi32(_mm_srli_epi64(lBits, 52), _MM_SHUFFLE(3, 1, 2, 0)));
+    e = _mm_sub_pd(e, _mm_set1_pd(1023.0));
+    __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(lBits, _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm_set1_epi64x(0x3FF0000000000000LL)));
+    __m128d lBig = _mm_cmpgt_pd(m, _mm_set1_pd(SMEM_FAST_SQRT2));
+    m = _mm_or_pd(_mm_and_pd(lBig, _mm_mul_pd(m, _mm_set1_pd(0.5))), _mm_andnot_pd(lBig, m));
+    e = _mm_add_pd(e, _mm_and_pd(lBig, _mm_set1_pd(1.0)));
+
+    __m128d lOne = _mm_set1_pd(1.0);
+    __m128d s = _mm_div_pd(_mm_sub_pd(m, lOne), _mm_add_pd(m, lOne));
+    __m128d s2 = _mm_mul_pd(s, s);
+    __m128d p = _mm_set1_pd(1.0 / 11.0);
+    p = _mm_add_pd(_mm_mul_pd(p, s2), _mm_set1_pd(1.0 / 9.0));
+    p = _mm_add_pd(_mm_mul_pd(p, s2), _mm_set1_pd(1.0 / 7.0));
+    p = _mm_add_pd(_mm_mul_pd(p, s2), _mm_set1_pd(1.0 / 5.0));
+    p = _mm_add_pd(_mm_mul_pd(p, s2), _mm_set1_pd(1.0 / 3.0));
+    p = _mm_add_pd(_mm_mul_pd(p, s2), lOne);
+
+    return _mm_add_pd(e, _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(2.0), s), p), _mm_set1_pd(SMEM_FAST_LOG2E)));
+}
+
+inline __m128d smem_fast_exp2_sse2(__m128d y)
+{
+    y = _mm_min_pd(_mm_max_pd(y, _mm_set1_pd(-1022.0)), _mm_set1_pd(1023.0));
+    __m128i i = _mm_cvtpd_epi32(y);
+    __m128d z = _mm_mul_pd(_mm_sub_pd(y, _mm_cvtepi32_pd(i)), _mm_set1_pd(SMEM_FAST_LN2));
+    __m128d p = _mm_set1_pd(1.0 / 362880.0);
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0 / 40320.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0 / 5040.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0 / 720.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0 / 120.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0 / 24.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0 / 6.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(0.5));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0));
+    p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(1.0));
+
+    __m128i lScale = _mm_slli_epi64(_mm_unpacklo_epi32(_mm_add_epi32(i, _mm_set1_epi32(1023)), _mm_setzero_si128()), 52);
+    return _mm_mul_pd(p, _mm_castsi128_pd(lScale));
+}
+#endif
+
+/* Base-level activation of count LTMs at once, from gathered inputs: age[k][c]
+ * is the age of the (k+1)th most recent access of LTM c (1.0 when it has
+ * fewer), n[c] its number of accesses and age_first[c] the age of its first.
+ * Without fast_math this is exactly lti_calc_base, term for term. */
+static void smem_base_level_kernel(size_t count, double d, const std::vector<double>* age, const double* n, const double* age_first, double* act, bool fast_math)
+{
+    size_t c = 0;
+
+    if (!fast_math)
+    {
+        for (; c < count; c++)
+        {
+            double sum = 0.0;
+            int available_history = static_cast<int>((SMEM_ACT_HISTORY_ENTRIES < n[c]) ? (SMEM_ACT_HISTORY_ENTRIES) : (n[c]));
+
+            for (int k = 0; k < available_history; k++)
+            {
+                sum += pow(age[k][c], static_cast<double>(-d));
+            }
+
+            if (n[c] > SMEM_ACT_HISTORY_ENTRIES)
+            {
+                double t_n = age_first[c];
+                double t_k = age[SMEM_ACT_HISTORY_ENTRIES - 1][c];
+                double apx_numerator = ((n[c] - SMEM_ACT_HISTORY_ENTRIES) * (pow(t_n, 1.0 - d) - pow(t_k, 1.0 - d)));
+                double apx_denominator = ((1.0 - d) * (t_n - t_k));
+
+                sum += (apx_numerator / apx_denominator);
+            }
+
+            act[c] = ((sum > 0) ? (log(sum)) : (SMEM_ACT_LOW));
+        }
+        return;
+    }
+
+#ifdef SMEM_ACT_USE_SSE2
+    // two LTMs per step; unused history slots and the approximation for
+    // short histories are masked out rather than branched around
+    __m128d lNegD = _mm_set1_pd(-d);
+    __m128d lOneMinusD = _mm_set1_pd(1.0 - d);
+    __m128d lEntries = _mm_set1_pd(static_cast<double>(SMEM_ACT_HISTORY_ENTRIES));
+    for (; c + 2 <= count; c += 2)
+    {
+        __m128d lN = _mm_loadu_pd(n + c);
+        __m128d lSum = _mm_setzero_pd();
+
+        for (int k = 0; k < SMEM_ACT_HISTORY_ENTRIES; k++)
+        {
+            __m128d lUsed = _mm_cmpgt_pd(lN, _mm_set1_pd(static_cast<double>(k)));
+            __m128d lTerm = smem_fast_exp2_sse2(_mm_mul_pd(lNegD, smem_fast_log2_sse2(_mm_loadu_pd(&(age[k][c])))));
+            lSum = _mm_add_pd(lSum, _mm_and_pd(lUsed, lTerm));
+        }
+
+        __m128d lTn = _mm_loadu_pd(age_first + c);
+        __m128d lTk = _mm_loadu_pd(&(age[SMEM_ACT_HISTORY_ENTRIES - 1][c]));
+        __m128d lNumerator = _mm_mul_pd(_mm_sub_pd(lN, lEntries),
+                                        _mm_sub_pd(smem_fast_exp2_sse2(_mm_mul_pd(lOneMinusD, smem_fast_log2_sse2(lTn))),
+                                                   smem_fast_exp2_sse2(_mm_mul_pd(lOneMinusD, smem_fast_log2_sse2(lTk)))));
+        __m128d lApx = _mm_div_pd(lNumerator, _mm_mul_pd(lOneMinusD, _mm_sub_pd(lTn, lTk)));
+        lSum = _mm_add_pd(lSum, _mm_and_pd(_mm_cmpgt_pd(lN, lEntries), lApx));
+
+        __m128d lPositive = _mm_cmpgt_pd(lSum, _mm_setzero_pd());
+        __m128d lLog = _mm_mul_pd(smem_fast_log2_sse2(_mm_max_pd(lSum, _mm_set1_pd(1.0e-300))), _mm_set1_pd(SMEM_FAST_LN2));
+        _mm_storeu_pd(act + c, _mm_or_pd(_mm_and_pd(lPositive, lLog), _mm_andnot_pd(lPositive, _mm_set1_pd(static_cast<double>(SMEM_ACT_LOW)))));
+    }
+#endif
+
+    for (; c < count; c++)
+    {
+        double sum = 0.0;
+        for (int k = 0; (k < SMEM_ACT_HISTORY_ENTRIES) && (k < n[c]); k++)
+        {
+            sum += smem_fast_pow(age[k][c], -d);
+        }
+
+        if (n[c] > SMEM_ACT_HISTORY_ENTRIES)
+        {
+            double t_n = age_first[c];
+            double t_k = age[SMEM_ACT_HISTORY_ENTRIES - 1][c];
+            sum += ((n[c] - SMEM_ACT_HISTORY_ENTRIES) * (smem_fast_pow(t_n, 1.0 - d) - smem_fast_pow(t_k, 1.0 - d))) / ((1.0 - d) * (t_n - t_k));
+        }
+
+        act[c] = ((sum > 0) ? (smem_fast_log2(sum) * SMEM_FAST_LN2) : (SMEM_ACT_LOW));
+    }
+}
+
+double SMem_Manager::lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t n, uint64_t activations_first, const int64_t* history)
+{
+    // the history store, when loaded, is already up to date with this access
+    if (history_store.loaded && (pLTI_ID < history_store.access_n.size()))
+    {
+        history_store_calc(&history_store, &pLTI_ID, 1, time_now, (settings->base_fast_math->get_value() == on));
+        return history_store.batch_act[0];
+    }
+
     double sum = 0.0;
     double d = settings->base_decay->get_value();
     uint64_t t_k;
-    uint64_t t_n = (time_now - activations_first);
 
     if (n == 0)
     {
@@ -30,20 +248,36 @@ double SMem_Manager::lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t
         SQL->lti_access_get->reinitialize();
     }
 
-    // get all history
-    SQL->history_get->bind_int(1, pLTI_ID);
-    SQL->history_get->execute();
+    uint64_t t_n = (time_now - activations_first);
+
+    // get all history (from the ltm cache, if the caller has it)
+    if (history)
     {
         int available_history = static_cast<int>((SMEM_ACT_HISTORY_ENTRIES < n) ? (SMEM_ACT_HISTORY_ENTRIES) : (n));
-        t_k = static_cast<uint64_t>(time_now - SQL->history_get->column_int(available_history - 1));
+        t_k = static_cast<uint64_t>(time_now - ((available_history > 0) ? (history[available_history - 1]) : (0)));
 
         for (int i = 0; i < available_history; i++)
         {
-            sum += pow(static_cast<double>(time_now - SQL->history_get->column_int(i)),
+            sum += pow(static_cast<double>(time_now - history[i]),
                        static_cast<double>(-d));
         }
     }
-    SQL->history_get->reinitialize();
+    else
+    {
+        SQL->history_get->bind_int(1, pLTI_ID);
+        SQL->history_get->execute();
+        {
+            int available_history = static_cast<int>((SMEM_ACT_HISTORY_ENTRIES < n) ? (SMEM_ACT_HISTORY_ENTRIES) : (n));
+            t_k = static_cast<uint64_t>(time_now - SQL->history_get->column_int(available_history - 1));
+
+            for (int i = 0; i < available_history; i++)
+            {
+                sum += pow(static_cast<double>(time_now - SQL->history_get->column_int(i)),
+                           static_cast<double>(-d));
+            }
+        }
+        SQL->history_get->reinitialize();
+    }
 
     // if available history was insufficient, approximate rest
     if (n > SMEM_ACT_HISTORY_ENTRIES)
@@ -88,6 +322,9 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
                     {
                         std::list< uint64_t > to_update;
 
+                        // activations_last of cached ltms may not be in the db yet
+                        ltm_cache_flush();
+
                         SQL->lti_get_t->bind_int(1, time_diff);
                         while (SQL->lti_get_t->execute() == soar_module::row)
                         {
@@ -95,10 +332,8 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
                         }
                         SQL->lti_get_t->reinitialize();
 
-                        for (std::list< uint64_t >::iterator it = to_update.begin(); it != to_update.end(); it++)
-                        {
-                            lti_activate((*it), false);
-                        }
+                        std::vector< uint64_t > batch(to_update.begin(), to_update.end());
+                        lti_activate_batch(batch);
                     }
                 }
             }
@@ -111,10 +346,40 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         statistics->act_updates->set_value(statistics->act_updates->get_value() + 1);
     }
 
+    smem_param_container::act_choices act_mode = settings->activation_mode->get_value();
+    if (act_mode == smem_param_container::act_base)
+    {
+        // loads the store before this access changes anything
+        history_store_ready();
+    }
+
+    // working-set copy of this ltm, if the cache is on
+    smem_cached_ltm* cached = NULL;
+    if (ltm_cache_enabled())
+    {
+        cached = ltm_cache_get(pLTI_ID);
+    }
+
     // access information
     uint64_t prev_access_n = 0;
     uint64_t prev_access_t = 0;
     uint64_t prev_access_1 = 0;
+    if (cached)
+    {
+        prev_access_n = cached->access_n;
+        prev_access_t = cached->access_t;
+        prev_access_1 = cached->access_1;
+
+        if (add_access)
+        {
+            cached->access_n = (prev_access_n + 1);
+            cached->access_t = time_now;
+            cached->access_1 = ((prev_access_n == 0) ? (time_now) : (prev_access_1));
+            cached->access_dirty = true;
+            ltm_cache_mark_dirty(cached);
+        }
+    }
+    else
     {
         // get old (potentially useful below)
         {
@@ -139,9 +404,13 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         }
     }
 
+    if (add_access && history_store.loaded)
+    {
+        history_store_push(pLTI_ID, time_now, (act_mode == smem_param_container::act_base));
+    }
+
     // get new activation value (depends upon bias)
     double new_activation = 0.0;
-    smem_param_container::act_choices act_mode = settings->activation_mode->get_value();
     if (act_mode == smem_param_container::act_recency)
     {
         new_activation = static_cast<double>(time_now);
@@ -150,6 +419,26 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
     {
         new_activation = static_cast<double>(prev_access_n + ((add_access) ? (1) : (0)));
     }
+    else if ((act_mode == smem_param_container::act_base) && cached)
+    {
+        if (!cached->history_loaded)
+        {
+            ltm_cache_load_history(cached);
+        }
+
+        if (add_access)
+        {
+            for (int i = SMEM_ACT_HISTORY_ENTRIES - 1; i > 0; i--)
+            {
+                cached->history[i] = ((prev_access_n == 0) ? (0) : (cached->history[i - 1]));
+            }
+            cached->history[0] = time_now;
+            cached->history_dirty = true;
+            ltm_cache_mark_dirty(cached);
+        }
+
+        new_activation = lti_calc_base(pLTI_ID, time_now + ((add_access) ? (1) : (0)), prev_access_n + ((add_access) ? (1) : (0)), prev_access_1, cached->history);
+    }
     else if (act_mode == smem_param_container::act_base)
     {
         if (prev_access_n == 0)
@@ -176,8 +465,25 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         }
     }
 
+    lti_store_activation(pLTI_ID, new_activation, num_edges, cached);
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->act->stop();
+    ////////////////////////////////////////////////////////////////////////////
+
+    return new_activation;
+}
+
+// writes a freshly computed activation to the ltm and, if it has few
+// enough augmentations, to its edges
+void SMem_Manager::lti_store_activation(uint64_t pLTI_ID, double new_activation, uint64_t num_edges, smem_cached_ltm* cached)
+{
     // get number of augmentations (if not supplied)
-    if (num_edges == SMEM_ACT_MAX)
+    if ((num_edges == SMEM_ACT_MAX) && cached)
+    {
+        num_edges = cached->num_edges;
+    }
+    else if (num_edges == SMEM_ACT_MAX)
     {
         SQL->act_lti_child_ct_get->bind_int(1, pLTI_ID);
         SQL->act_lti_child_ct_get->execute();
@@ -187,26 +493,376 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         SQL->act_lti_child_ct_get->reinitialize();
     }
 
+    // cached ltms defer both activation writes to the next write-back
+    if (cached)
+    {
+        cached->activation = new_activation;
+        cached->activation_on_edges = (num_edges < static_cast<uint64_t>(settings->thresh->get_value()));
+        cached->activation_dirty = true;
+        ltm_cache_mark_dirty(cached);
+    }
     // only if augmentation count is less than threshold do we associate with edges
-    if (num_edges < static_cast<uint64_t>(settings->thresh->get_value()))
+    else if (num_edges < static_cast<uint64_t>(settings->thresh->get_value()))
     {
         // activation_value=? WHERE lti=?
         SQL->act_set->bind_double(1, new_activation);
         SQL->act_set->bind_int(2, pLTI_ID);
         SQL->act_set->execute(soar_module::op_reinit);
+        posting_ltm_activated(pLTI_ID, new_activation);
     }
 
     // always associate activation with lti
+    if (!cached)
     {
         // activation_value=? WHERE lti=?
         SQL->act_lti_set->bind_double(1, new_activation);
         SQL->act_lti_set->bind_int(2, pLTI_ID);
         SQL->act_lti_set->execute(soar_module::op_reinit);
     }
+}
+
+// recomputes (without an access) the activation of several ltms; under
+// base-level activation with the history store loaded, this is a single pass
+// of the batched kernel instead of a history query per ltm
+void SMem_Manager::lti_activate_batch(std::vector<uint64_t>& ltis)
+{
+    if (ltis.empty())
+    {
+        return;
+    }
+
+    if ((settings->activation_mode->get_value() != smem_param_container::act_base) || !history_store_ready())
+    {
+        for (std::vector<uint64_t>::iterator it = ltis.begin(); it != ltis.end(); it++)
+        {
+            lti_activate((*it), false);
+        }
+        return;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->act->start();
+    ////////////////////////////////////////////////////////////////////////////
+
+    int64_t time_now = smem_max_cycle;
+    statistics->act_updates->set_value(statistics->act_updates->get_value() + ltis.size());
+
+    history_store_calc(&history_store, &(ltis[0]), ltis.size(), time_now, (settings->base_fast_math->get_value() == on));
+
+    for (size_t i = 0; i < ltis.size(); i++)
+    {
+        smem_cached_ltm* cached = NULL;
+        if (ltm_cache_enabled())
+        {
+            cached = ltm_cache_get(ltis[i]);
+        }
+
+        lti_store_activation(ltis[i], history_store.batch_act[i], SMEM_ACT_MAX, cached);
+    }
 
     ////////////////////////////////////////////////////////////////////////////
     timers->act->stop();
     ////////////////////////////////////////////////////////////////////////////
+}
 
-    return new_activation;
+/***************************************************************************
+ * In-memory activation history store
+ *
+ * A columnar copy of activations_total, activations_first and t1..t10 for
+ * every ltm, indexed by lti_id.  It is loaded in one pass the first time it
+ * is needed, kept current by lti_activate alongside the database (which
+ * remains the persistent copy) and dropped with the database or when
+ * base-history-store is turned off.
+ ***************************************************************************/
+
+bool SMem_Manager::history_store_ready()
+{
+    if (settings->base_history_store->get_value() == off)
+    {
+        if (history_store.loaded)
+        {
+            history_store_clear(&history_store);
+        }
+        return false;
+    }
+
+    if (!history_store.loaded)
+    {
+        // accesses deferred by the ltm cache must be in the db first
+        ltm_cache_flush();
+
+        if (!history_store_load(&history_store))
+        {
+            history_store_clear(&history_store);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SMem_Manager::history_store_load(smem_history_store* store)
+{
+    history_store_clear(store);
+
+    uint64_t num_ltis = 0;
+    while (SQL->history_get_all->execute() == soar_module::row)
+    {
+        uint64_t lti_id = static_cast<uint64_t>(SQL->history_get_all->column_int(0));
+        num_ltis++;
+
+        // the store is indexed by id, so give up on very sparse id spaces
+        if ((lti_id > ((4 * num_ltis) + 65536)) || !history_store_reserve(store, lti_id))
+        {
+            SQL->history_get_all->reinitialize();
+            return false;
+        }
+
+        store->access_n[lti_id] = static_cast<uint64_t>(SQL->history_get_all->column_int(1));
+        store->access_1[lti_id] = SQL->history_get_all->column_int(2);
+        for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+        {
+            store->history[i][lti_id] = SQL->history_get_all->column_int(3 + i);
+        }
+    }
+    SQL->history_get_all->reinitialize();
+
+    store->loaded = true;
+    return true;
+}
+
+bool SMem_Manager::history_store_reserve(smem_history_store* store, uint64_t pLTI_ID)
+{
+    if (pLTI_ID < store->access_n.size())
+    {
+        return true;
+    }
+
+    // grow geometrically so loading in id order stays linear
+    size_t new_size = ((store->access_n.size() < 1024) ? (1024) : (store->access_n.size()));
+    while (new_size <= pLTI_ID)
+    {
+        new_size *= 2;
+    }
+
+    store->access_n.resize(new_size, 0);
+    store->access_1.resize(new_size, 0);
+    for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+    {
+        store->history[i].resize(new_size, 0);
+    }
+
+    return true;
+}
+
+void SMem_Manager::history_store_clear(smem_history_store* store)
+{
+    store->loaded = false;
+
+    std::vector<uint64_t>().swap(store->access_n);
+    std::vector<int64_t>().swap(store->access_1);
+    for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+    {
+        std::vector<int64_t>().swap(store->history[i]);
+        std::vector<double>().swap(store->batch_age[i]);
+    }
+    std::vector<double>().swap(store->batch_n);
+    std::vector<double>().swap(store->batch_first);
+    std::vector<double>().swap(store->batch_act);
+}
+
+// mirrors lti_access_set and, under base-level activation, history_add/push
+void SMem_Manager::history_store_push(uint64_t pLTI_ID, int64_t time_now, bool add_history)
+{
+    history_store_reserve(&history_store, pLTI_ID);
+
+    uint64_t prev_n = history_store.access_n[pLTI_ID];
+    history_store.access_n[pLTI_ID] = (prev_n + 1);
+    if (prev_n == 0)
+    {
+        history_store.access_1[pLTI_ID] = time_now;
+    }
+
+    if (add_history)
+    {
+        for (int i = SMEM_ACT_HISTORY_ENTRIES - 1; i > 0; i--)
+        {
+            history_store.history[i][pLTI_ID] = ((prev_n == 0) ? (0) : (history_store.history[i - 1][pLTI_ID]));
+        }
+        history_store.history[0][pLTI_ID] = time_now;
+    }
+}
+
+// base-level activation of count ltms into store->batch_act
+void SMem_Manager::history_store_calc(smem_history_store* store, const uint64_t* ltis, size_t count, int64_t time_now, bool fast_math)
+{
+    if (store->batch_act.size() < count)
+    {
+        for (int k = 0; k < SMEM_ACT_HISTORY_ENTRIES; k++)
+        {
+            store->batch_age[k].resize(count);
+        }
+        store->batch_n.resize(count);
+        store->batch_first.resize(count);
+        store->batch_act.resize(count);
+    }
+
+    // gather into contiguous rows, one per history slot
+    for (size_t c = 0; c < count; c++)
+    {
+        uint64_t lti_id = ltis[c];
+        uint64_t n = store->access_n[lti_id];
+
+        store->batch_n[c] = static_cast<double>(n);
+        store->batch_first[c] = static_cast<double>(static_cast<uint64_t>(time_now - store->access_1[lti_id]));
+        for (int k = 0; k < SMEM_ACT_HISTORY_ENTRIES; k++)
+        {
+            store->batch_age[k][c] = ((static_cast<uint64_t>(k) < n) ? (static_cast<double>(time_now - store->history[k][lti_id])) : (1.0));
+        }
+    }
+
+    smem_base_level_kernel(count, settings->base_decay->get_value(), store->batch_age, &(store->batch_n[0]), &(store->batch_first[0]), &(store->batch_act[0]), fast_math);
+}
+
+/***************************************************************************
+ * Base-level activation benchmark (debug base-level)
+ *
+ * Builds a synthetic knowledge base of num_ltis ltms with 1..30 accesses
+ * each in a private in-memory database and times computing all of their
+ * activations with the per-ltm sql path, loading the history store, and
+ * the batched kernel with and without fast math.
+ ***************************************************************************/
+
+void SMem_Manager::benchmark_base_level(uint64_t num_ltis)
+{
+    const size_t lChunk = 4096;
+    const int64_t lTimeNow = 100000000;
+
+    // swap in a scratch database and store, leaving the agent's untouched
+    soar_module::sqlite_database* lAgentDB = DB;
+    smem_statement_container* lAgentSQL = SQL;
+    smem_history_store lAgentStore;
+    lAgentStore.loaded = false;
+    std::swap(lAgentStore, history_store);
+
+    DB = new soar_module::sqlite_database();
+    DB->connect(":memory:");
+    SQL = new smem_statement_container(thisAgent);
+    SQL->structure();
+    SQL->prepare();
+
+    // deterministic histories: most recent access within 1000 cycles of
+    // now, earlier ones 1..100 cycles apart
+    uint64_t lSeed = 12345;
+    SQL->begin->execute(soar_module::op_reinit);
+    for (uint64_t lti_id = 1; lti_id <= num_ltis; lti_id++)
+    {
+        int64_t lHistory[SMEM_ACT_HISTORY_ENTRIES] = { 0 };
+
+        lSeed = (lSeed * 6364136223846793005ULL) + 1442695040888963407ULL;
+        uint64_t n = 1 + ((lSeed >> 33) % 30);
+        int64_t t = lTimeNow - 1 - static_cast<int64_t>((lSeed >> 13) % 1000);
+        for (uint64_t k = 0; k < n; k++)
+        {
+            if (k < SMEM_ACT_HISTORY_ENTRIES)
+            {
+                lHistory[k] = t;
+            }
+            lSeed = (lSeed * 6364136223846793005ULL) + 1442695040888963407ULL;
+            t -= 1 + static_cast<int64_t>((lSeed >> 33) % 100);
+        }
+
+        SQL->lti_add->bind_int(1, lti_id);
+        SQL->lti_add->bind_int(2, 1);
+        SQL->lti_add->bind_double(3, 0);
+        SQL->lti_add->bind_int(4, n);
+        SQL->lti_add->bind_int(5, lHistory[0]);
+        SQL->lti_add->bind_int(6, t);
+        SQL->lti_add->execute(soar_module::op_reinit);
+
+        SQL->history_set->bind_int(1, lti_id);
+        for (int k = 0; k < SMEM_ACT_HISTORY_ENTRIES; k++)
+        {
+            SQL->history_set->bind_int(k + 2, lHistory[k]);
+        }
+        SQL->history_set->execute(soar_module::op_reinit);
+    }
+    SQL->commit->execute(soar_module::op_reinit);
+
+    std::vector<uint64_t> lIds(num_ltis);
+    std::vector<double> lSqlAct(num_ltis), lExactAct(num_ltis), lFastAct(num_ltis);
+    for (uint64_t i = 0; i < num_ltis; i++)
+    {
+        lIds[i] = i + 1;
+    }
+
+    soar_timer lTimer;
+    uint64_t lUsec[4];
+
+    lTimer.start();
+    for (uint64_t i = 0; i < num_ltis; i++)
+    {
+        lSqlAct[i] = lti_calc_base(lIds[i], lTimeNow);
+    }
+    lTimer.stop();
+    lUsec[0] = lTimer.get_usec();
+
+    lTimer.start();
+    bool lLoaded = history_store_load(&history_store);
+    lTimer.stop();
+    lUsec[1] = lTimer.get_usec();
+
+    for (int lFast = 0; lLoaded && (lFast < 2); lFast++)
+    {
+        std::vector<double>& lAct = ((lFast) ? (lFastAct) : (lExactAct));
+
+        lTimer.start();
+        for (uint64_t i = 0; i < num_ltis; i += lChunk)
+        {
+            size_t lCount = static_cast<size_t>(std::min<uint64_t>(lChunk, num_ltis - i));
+            history_store_calc(&history_store, &(lIds[i]), lCount, lTimeNow, (lFast == 1));
+            std::copy(history_store.batch_act.begin(), history_store.batch_act.begin() + lCount, lAct.begin() + i);
+        }
+        lTimer.stop();
+        lUsec[2 + lFast] = lTimer.get_usec();
+    }
+
+    uint64_t lMismatches = 0;
+    double lMaxError = 0.0;
+    for (uint64_t i = 0; lLoaded && (i < num_ltis); i++)
+    {
+        if (lExactAct[i] != lSqlAct[i])
+        {
+            lMismatches++;
+        }
+        lMaxError = std::max(lMaxError, fabs(lFastAct[i] - lExactAct[i]));
+    }
+
+    // restore the agent's database and store
+    history_store_clear(&history_store);
+    std::swap(lAgentStore, history_store);
+    delete SQL;
+    DB->disconnect();
+    delete DB;
+    SQL = lAgentSQL;
+    DB = lAgentDB;
+
+    if (!lLoaded)
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "Could not load the activation history store.\n");
+        return;
+    }
+
+    const char* lLabels[4] = { "sql, per ltm", "history store, load", "batched, exact", "batched, fast math" };
+    char lLine[BUFFER_MSG_SIZE];
+    thisAgent->outputManager->printa_sf(thisAgent, "Base-level activation benchmark with %u ltms (times in usec):\n\n", num_ltis);
+    SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-24s %12s\n", "Method", "Time");
+    thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    for (int i = 0; i < 4; i++)
+    {
+        SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-24s %12llu\n", lLabels[i], static_cast<unsigned long long>(lUsec[i]));
+        thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    }
+    SNPRINTF(lLine, BUFFER_MSG_SIZE, "\nExact batch differs from sql on %llu ltms; fast math max abs error %.3g\n", static_cast<unsigned long long>(lMismatches), lMaxError);
+    thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
 }
@@ -0,0 +1,245 @@
+/*
+ * smem_cache.cpp
+ *
+ *  Working-set cache of recently used LTMs.  Retrievals of the same few
+ *  LTMs otherwise read and rewrite their smem_lti, smem_activation_history
+ *  and smem_augmentations rows every time.  Entries are replaced with the
+ *  CLOCK (second-chance) policy; dirty access/history/activation fields are
+ *  written back on commit, before queries or prints read those columns
+ *  through SQL, and when an entry is evicted or invalidated by a store.
+ */
+
+#include "semantic_memory.h"
+
+#include "smem_db.h"
+#include "smem_settings.h"
+#include "smem_stats.h"
+
+smem_cached_ltm* SMem_Manager::ltm_cache_get(uint64_t pLTI_ID, bool with_children)
+{
+    smem_cached_ltm* entry;
+    smem_ltm_cache_map::iterator c = ltm_cache.find(pLTI_ID);
+
+    if (c != ltm_cache.end())
+    {
+        entry = c->second;
+        entry->referenced = true;
+
+        if (with_children && !entry->children_loaded)
+        {
+            statistics->ltm_cache_misses->set_value(statistics->ltm_cache_misses->get_value() + 1);
+            ltm_cache_load_children(entry);
+        }
+        else
+        {
+            statistics->ltm_cache_hits->set_value(statistics->ltm_cache_hits->get_value() + 1);
+        }
+
+        return entry;
+    }
+
+    statistics->ltm_cache_misses->set_value(statistics->ltm_cache_misses->get_value() + 1);
+
+    // find a slot: grow until the configured size, then sweep the
+    // clock hand, giving referenced entries a second chance
+    if (ltm_cache_ring.size() < static_cast<size_t>(settings->ltm_cache->get_value()))
+    {
+        entry = new smem_cached_ltm;
+        entry->queued = false;
+        ltm_cache_ring.push_back(entry);
+    }
+    else
+    {
+        while (ltm_cache_ring[ltm_cache_hand]->referenced)
+        {
+            ltm_cache_ring[ltm_cache_hand]->referenced = false;
+            ltm_cache_hand = (ltm_cache_hand + 1) % ltm_cache_ring.size();
+        }
+
+        entry = ltm_cache_ring[ltm_cache_hand];
+        ltm_cache_hand = (ltm_cache_hand + 1) % ltm_cache_ring.size();
+
+        if (entry->lti_id)
+        {
+            ltm_cache_write_back(entry);
+            ltm_cache.erase(entry->lti_id);
+        }
+    }
+
+    // total_augmentations, activations_total, activations_last, activations_first
+    entry->lti_id = pLTI_ID;
+    SQL->ltm_cache_load->bind_int(1, pLTI_ID);
+    if (SQL->ltm_cache_load->execute() == soar_module::row)
+    {
+        entry->num_edges = SQL->ltm_cache_load->column_int(0);
+        entry->access_n = SQL->ltm_cache_load->column_int(1);
+        entry->access_t = SQL->ltm_cache_load->column_int(2);
+        entry->access_1 = SQL->ltm_cache_load->column_int(3);
+    }
+    else
+    {
+        entry->num_edges = 0;
+        entry->access_n = 0;
+        entry->access_t = 0;
+        entry->access_1 = 0;
+    }
+    SQL->ltm_cache_load->reinitialize();
+
+    entry->access_dirty = false;
+    entry->history_loaded = false;
+    entry->history_dirty = false;
+    entry->activation = 0.0;
+    entry->activation_on_edges = false;
+    entry->activation_dirty = false;
+    entry->children.clear();
+    entry->children_loaded = false;
+    entry->referenced = true;
+
+    ltm_cache[pLTI_ID] = entry;
+
+    if (with_children)
+    {
+        ltm_cache_load_children(entry);
+    }
+
+    return entry;
+}
+
+void SMem_Manager::ltm_cache_load_history(smem_cached_ltm* entry)
+{
+    SQL->history_get->bind_int(1, entry->lti_id);
+    if (SQL->history_get->execute() == soar_module::row)
+    {
+        for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+        {
+            entry->history[i] = SQL->history_get->column_int(i);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+        {
+            entry->history[i] = 0;
+        }
+    }
+    SQL->history_get->reinitialize();
+
+    entry->history_loaded = true;
+}
+
+void SMem_Manager::ltm_cache_load_children(smem_cached_ltm* entry)
+{
+    smem_cached_child child;
+
+    // attr_type, attr_hash, value_type, value_hash, value_lti
+    entry->children.clear();
+    SQL->web_expand->bind_int(1, entry->lti_id);
+    while (SQL->web_expand->execute() == soar_module::row)
+    {
+        child.attr_type = static_cast<byte>(SQL->web_expand->column_int(0));
+        child.attr_hash = static_cast<smem_hash_id>(SQL->web_expand->column_int(1));
+        child.value_type = static_cast<byte>(SQL->web_expand->column_int(2));
+        child.value_hash = static_cast<smem_hash_id>(SQL->web_expand->column_int(3));
+        child.value_lti = static_cast<uint64_t>(SQL->web_expand->column_int(4));
+        entry->children.push_back(child);
+    }
+    SQL->web_expand->reinitialize();
+
+    entry->children_loaded = true;
+}
+
+void SMem_Manager::ltm_cache_mark_dirty(smem_cached_ltm* entry)
+{
+    if (!entry->queued)
+    {
+        entry->queued = true;
+        ltm_cache_dirty.push_back(entry);
+    }
+}
+
+void SMem_Manager::ltm_cache_write_back(smem_cached_ltm* entry)
+{
+    if (entry->access_dirty)
+    {
+        SQL->lti_access_set->bind_int(1, entry->access_n);
+        SQL->lti_access_set->bind_int(2, entry->access_t);
+        SQL->lti_access_set->bind_int(3, entry->access_1);
+        SQL->lti_access_set->bind_int(4, entry->lti_id);
+        SQL->lti_access_set->execute(soar_module::op_reinit);
+
+        entry->access_dirty = false;
+    }
+
+    if (entry->history_dirty)
+    {
+        SQL->history_set->bind_int(1, entry->lti_id);
+        for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+        {
+            SQL->history_set->bind_int(i + 2, entry->history[i]);
+        }
+        SQL->history_set->execute(soar_module::op_reinit);
+
+        entry->history_dirty = false;
+    }
+
+    if (entry->activation_dirty)
+    {
+        if (entry->activation_on_edges)
+        {
+            SQL->act_set->bind_double(1, entry->activation);
+            SQL->act_set->bind_int(2, entry->lti_id);
+            SQL->act_set->execute(soar_module::op_reinit);
+            posting_ltm_activated(entry->lti_id, entry->activation);
+        }
+
+        SQL->act_lti_set->bind_double(1, entry->activation);
+        SQL->act_lti_set->bind_int(2, entry->lti_id);
+        SQL->act_lti_set->execute(soar_module::op_reinit);
+
+        entry->activation_dirty = false;
+    }
+}
+
+// writes every dirty entry back to the database; entries stay cached
+void SMem_Manager::ltm_cache_flush()
+{
+    for (std::vector<smem_cached_ltm*>::iterator e = ltm_cache_dirty.begin(); e != ltm_cache_dirty.end(); e++)
+    {
+        ltm_cache_write_back(*e);
+        (*e)->queued = false;
+    }
+    ltm_cache_dirty.clear();
+}
+
+// writes back and forgets one LTM, e.g. before its augmentations are rewritten
+void SMem_Manager::ltm_cache_invalidate(uint64_t pLTI_ID)
+{
+    smem_ltm_cache_map::iterator c = ltm_cache.find(pLTI_ID);
+
+    if (c != ltm_cache.end())
+    {
+        smem_cached_ltm* entry = c->second;
+
+        ltm_cache_write_back(entry);
+        ltm_cache.erase(c);
+
+        // the slot stays in the ring and is the first to be reused
+        entry->lti_id = 0;
+        entry->children.clear();
+        entry->children_loaded = false;
+        entry->referenced = false;
+    }
+}
+
+// drops every entry without writing back; callers flush first
+void SMem_Manager::ltm_cache_clear()
+{
+    for (std::vector<smem_cached_ltm*>::iterator e = ltm_cache_ring.begin(); e != ltm_cache_ring.end(); e++)
+    {
+        delete (*e);
+    }
+    ltm_cache_ring.clear();
+    ltm_cache_dirty.clear();
+    ltm_cache.clear();
+    ltm_cache_hand = 0;
+}
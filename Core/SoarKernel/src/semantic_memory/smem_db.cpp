@@ -60,17 +60,28 @@ void smem_statement_container::create_tables()
     }
 }
 
+// indices on the edge and frequency tables, which a bulk import drops while
+// it inserts and rebuilds once at the end (name, creation statement)
+static const char* const smem_deferred_indices[][2] =
+{
+    { "smem_augmentations_parent_attr_val_lti", "CREATE INDEX smem_augmentations_parent_attr_val_lti ON smem_augmentations (lti_id, attribute_s_id, value_constant_s_id, value_lti_id)" },
+    { "smem_augmentations_attr_val_lti_cycle", "CREATE INDEX smem_augmentations_attr_val_lti_cycle ON smem_augmentations (attribute_s_id, value_constant_s_id, value_lti_id, activation_value)" },
+    { "smem_augmentations_attr_cycle", "CREATE INDEX smem_augmentations_attr_cycle ON smem_augmentations (attribute_s_id, activation_value)" },
+    { "smem_wmes_constant_frequency_attr_val", "CREATE UNIQUE INDEX smem_wmes_constant_frequency_attr_val ON smem_wmes_constant_frequency (attribute_s_id, value_constant_s_id)" },
+    { "smem_ct_lti_attr_val", "CREATE UNIQUE INDEX smem_ct_lti_attr_val ON smem_wmes_lti_frequency (attribute_s_id, value_lti_id)" }
+};
+static const size_t smem_num_deferred_indices = sizeof(smem_deferred_indices) / sizeof(smem_deferred_indices[0]);
+
 void smem_statement_container::create_indices()
 {
     add_structure("CREATE UNIQUE INDEX smem_symbols_int_const ON smem_symbols_integer (symbol_value)");
     add_structure("CREATE UNIQUE INDEX smem_symbols_float_const ON smem_symbols_float (symbol_value)");
     add_structure("CREATE UNIQUE INDEX smem_symbols_str_const ON smem_symbols_string (symbol_value)");
     add_structure("CREATE INDEX smem_lti_t ON smem_lti (activations_last)");
-    add_structure("CREATE INDEX smem_augmentations_parent_attr_val_lti ON smem_augmentations (lti_id, attribute_s_id, value_constant_s_id, value_lti_id)");
-    add_structure("CREATE INDEX smem_augmentations_attr_val_lti_cycle ON smem_augmentations (attribute_s_id, value_constant_s_id, value_lti_id, activation_value)");
-    add_structure("CREATE INDEX smem_augmentations_attr_cycle ON smem_augmentations (attribute_s_id, activation_value)");
-    add_structure("CREATE UNIQUE INDEX smem_wmes_constant_frequency_attr_val ON smem_wmes_constant_frequency (attribute_s_id, value_constant_s_id)");
-    add_structure("CREATE UNIQUE INDEX smem_ct_lti_attr_val ON smem_wmes_lti_frequency (attribute_s_id, value_lti_id)");
+    for (size_t i = 0; i < smem_num_deferred_indices; i++)
+    {
+        add_structure(smem_deferred_indices[i][1]);
+    }
 }
 
 void smem_statement_container::drop_tables(agent* new_agent)
@@ -289,6 +300,21 @@ smem_statement_container::smem_statement_container(agent* new_agent): soar_modul
     history_add = new soar_module::sqlite_statement(new_db, "INSERT INTO smem_activation_history (lti_id,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10) VALUES (?,?,0,0,0,0,0,0,0,0,0)");
     add(history_add);
 
+    history_set = new soar_module::sqlite_statement(new_db, "INSERT OR REPLACE INTO smem_activation_history (lti_id,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10) VALUES (?,?,?,?,?,?,?,?,?,?,?)");
+    add(history_set);
+
+    ltm_cache_load = new soar_module::sqlite_statement(new_db, "SELECT total_augmentations, activations_total, activations_last, activations_first FROM smem_lti WHERE lti_id=?");
+    add(ltm_cache_load);
+
+    history_get_all = new soar_module::sqlite_statement(new_db, "SELECT l.lti_id, l.activations_total, l.activations_first, h.t1, h.t2, h.t3, h.t4, h.t5, h.t6, h.t7, h.t8, h.t9, h.t10 FROM smem_lti l LEFT JOIN smem_activation_history h ON h.lti_id=l.lti_id");
+    add(history_get_all);
+
+    spread_children = new soar_module::sqlite_statement(new_db, "SELECT value_lti_id FROM smem_augmentations WHERE lti_id=? AND value_lti_id<>" SMEM_AUGMENTATIONS_NULL_STR);
+    add(spread_children);
+
+    web_index_all = new soar_module::sqlite_statement(new_db, "SELECT rowid, lti_id, attribute_s_id, value_constant_s_id, value_lti_id, activation_value FROM smem_augmentations");
+    add(web_index_all);
+
     //
 
     vis_lti = new soar_module::sqlite_statement(new_db, "SELECT lti_id, activation_value FROM smem_lti ORDER BY lti_id ASC");
@@ -848,6 +874,12 @@ void SMem_Manager::close()
 {
     if (connected())
     {
+        ltm_cache_flush();
+        ltm_cache_clear();
+        history_store_clear(&history_store);
+        spread_clear();
+        posting_index_clear();
+
         store_globals_in_db();
 
         // if lazy, commit
@@ -880,6 +912,7 @@ bool SMem_Manager::backup_db(const char* file_name, std::string* err)
 
     if (connected())
     {
+        ltm_cache_flush();
         store_globals_in_db();
 
         if (settings->lazy_commit->get_value() == on)
@@ -902,6 +935,25 @@ bool SMem_Manager::backup_db(const char* file_name, std::string* err)
     return return_val;
 }
 
+void SMem_Manager::drop_deferred_indices()
+{
+    std::string drop_sql;
+    for (size_t i = 0; i < smem_num_deferred_indices; i++)
+    {
+        drop_sql.assign("DROP INDEX IF EXISTS ");
+        drop_sql.append(smem_deferred_indices[i][0]);
+        DB->sql_execute(drop_sql.c_str());
+    }
+}
+
+void SMem_Manager::create_deferred_indices()
+{
+    for (size_t i = 0; i < smem_num_deferred_indices; i++)
+    {
+        DB->sql_execute(smem_deferred_indices[i][1]);
+    }
+}
+
 void SMem_Manager::switch_to_memory_db(std::string& buf)
 {
     print_sysparam_trace(thisAgent, 0, buf.c_str());
@@ -83,6 +83,13 @@ class smem_statement_container: public soar_module::sqlite_statement_container
         soar_module::sqlite_statement* history_get;
         soar_module::sqlite_statement* history_push;
         soar_module::sqlite_statement* history_add;
+        soar_module::sqlite_statement* history_set;
+
+        soar_module::sqlite_statement* ltm_cache_load;
+
+        soar_module::sqlite_statement* history_get_all;
+        soar_module::sqlite_statement* spread_children;
+        soar_module::sqlite_statement* web_index_all;
 
         soar_module::sqlite_statement* vis_lti;
         soar_module::sqlite_statement* vis_lti_act;
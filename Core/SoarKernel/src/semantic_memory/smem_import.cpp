@@ -0,0 +1,441 @@
+/*
+ * smem_import.cpp
+ *
+ *  Bulk loading of a knowledge base into semantic memory.
+ *
+ *  The input is a file of triples, one per line:
+ *
+ *      @12 ^name |grey heron|
+ *      @12 ^isa @7
+ *
+ *  Everything is parsed before the database is touched, so a bad line leaves
+ *  semantic memory unchanged.  Each distinct constant is then hashed once,
+ *  the triples are sorted by subject, and the edges go in with the indices
+ *  on the edge and frequency tables dropped.  Frequency counts are gathered
+ *  in memory on the way and merged into the frequency tables in a single
+ *  pass once the indices are back, instead of row by row as smem --add does.
+ */
+
+#include "semantic_memory.h"
+
+#include "smem_db.h"
+#include "smem_settings.h"
+#include "smem_stats.h"
+#include "smem_timers.h"
+
+#include "agent.h"
+#include "lexer.h"
+#include "misc.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// reads the constant at the current lexeme into the import's symbol table
+// (like smem --add, something that lexes as an identifier is read as a string)
+static bool smem_import_constant(soar::Lexeme* lexeme, std::unordered_map<std::string, uint64_t>* symbol_index, std::vector<soar::Lexeme>* symbols, uint64_t* result)
+{
+    char type_tag;
+    switch (lexeme->type)
+    {
+        case STR_CONSTANT_LEXEME:
+        case IDENTIFIER_LEXEME:
+            type_tag = 's';
+            break;
+        case INT_CONSTANT_LEXEME:
+            type_tag = 'i';
+            break;
+        case FLOAT_CONSTANT_LEXEME:
+            type_tag = 'f';
+            break;
+        default:
+            return false;
+    }
+
+    std::string key(1, type_tag);
+    key.append(lexeme->string());
+
+    std::pair<std::unordered_map<std::string, uint64_t>::iterator, bool> inserted = symbol_index->insert(std::make_pair(key, symbols->size()));
+    if (inserted.second)
+    {
+        symbols->push_back(*lexeme);
+    }
+    (*result) = inserted.first->second;
+
+    return true;
+}
+
+bool SMem_Manager::import_triples(const char* file_name, uint64_t* num_imported, std::string* err)
+{
+    (*num_imported) = 0;
+
+    attach();
+    if (!connected())
+    {
+        err->assign("Semantic database is not currently connected.");
+        return false;
+    }
+
+    std::ifstream in_file(file_name);
+    if (!in_file)
+    {
+        err->assign("Could not open file ");
+        err->append(file_name);
+        return false;
+    }
+
+    // parse everything first; nothing is written until the whole file is good
+    std::vector<smem_import_triple> triples;
+    std::unordered_map<std::string, uint64_t> symbol_index;
+    std::vector<soar::Lexeme> symbols;
+    {
+        std::string line;
+        uint64_t line_number = 0;
+        const char* problem = NULL;
+
+        while (!problem && std::getline(in_file, line))
+        {
+            line_number++;
+
+            soar::Lexer lexer(thisAgent, line.c_str());
+            lexer.get_lexeme();
+
+            // blank line or comment
+            if (lexer.current_lexeme.type == EOF_LEXEME)
+            {
+                continue;
+            }
+
+            smem_import_triple triple;
+
+            if (lexer.current_lexeme.type != AT_LEXEME)
+            {
+                problem = "expected @ at the start of the triple";
+                break;
+            }
+            lexer.get_lexeme();
+            if ((lexer.current_lexeme.type != INT_CONSTANT_LEXEME) || (lexer.current_lexeme.int_val <= 0))
+            {
+                problem = "@ must be followed by a positive integer";
+                break;
+            }
+            triple.lti_id = static_cast<uint64_t>(lexer.current_lexeme.int_val);
+
+            lexer.get_lexeme();
+            if (lexer.current_lexeme.type == UP_ARROW_LEXEME)
+            {
+                lexer.get_lexeme();
+            }
+            if (!smem_import_constant(&(lexer.current_lexeme), &symbol_index, &symbols, &(triple.attr)))
+            {
+                problem = "attribute must be a constant";
+                break;
+            }
+
+            lexer.get_lexeme();
+            if (lexer.current_lexeme.type == AT_LEXEME)
+            {
+                lexer.get_lexeme();
+                if ((lexer.current_lexeme.type != INT_CONSTANT_LEXEME) || (lexer.current_lexeme.int_val <= 0))
+                {
+                    problem = "@ must be followed by a positive integer";
+                    break;
+                }
+                triple.value = static_cast<uint64_t>(lexer.current_lexeme.int_val);
+                triple.value_is_lti = true;
+            }
+            else if (smem_import_constant(&(lexer.current_lexeme), &symbol_index, &symbols, &(triple.value)))
+            {
+                triple.value_is_lti = false;
+            }
+            else
+            {
+                problem = "value must be a constant or a long-term identifier";
+                break;
+            }
+
+            lexer.get_lexeme();
+            if (lexer.current_lexeme.type != EOF_LEXEME)
+            {
+                problem = "unexpected text after the value";
+                break;
+            }
+
+            triples.push_back(triple);
+        }
+
+        if (problem)
+        {
+            std::string num;
+            to_string(line_number, num);
+
+            err->assign("Error parsing line ");
+            err->append(num);
+            err->append(": ");
+            err->append(problem);
+            return false;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->storage->start();
+    ////////////////////////////////////////////////////////////////////////////
+
+    // deferred accesses must be in the db, and cached children become stale
+    ltm_cache_flush();
+
+    if (settings->lazy_commit->get_value() == off)
+    {
+        SQL->begin->execute(soar_module::op_reinit);
+    }
+
+    // hash each distinct constant once, then rewrite the triples in terms of hashes
+    {
+        std::vector<smem_hash_id> hashes(symbols.size());
+        for (size_t i = 0; i < symbols.size(); i++)
+        {
+            switch (symbols[i].type)
+            {
+                case STR_CONSTANT_LEXEME:
+                case IDENTIFIER_LEXEME:
+                    hashes[i] = hash_str(const_cast<char*>(symbols[i].string()));
+                    break;
+                case INT_CONSTANT_LEXEME:
+                    hashes[i] = hash_int(symbols[i].int_val);
+                    break;
+                default:
+                    hashes[i] = hash_float(symbols[i].float_val);
+                    break;
+            }
+        }
+
+        for (std::vector<smem_import_triple>::iterator t = triples.begin(); t != triples.end(); t++)
+        {
+            t->attr = hashes[t->attr];
+            if (!t->value_is_lti)
+            {
+                t->value = hashes[t->value];
+            }
+        }
+    }
+
+    std::sort(triples.begin(), triples.end());
+    triples.erase(std::unique(triples.begin(), triples.end()), triples.end());
+
+    // drop edges that are already stored and tally what the rest add, while
+    // the edge indices are still there to answer those lookups
+    std::vector<uint64_t> new_ltis;
+    std::vector<std::pair<uint64_t, uint64_t> > edge_counts;     // subject, total edges after import
+    std::vector<uint64_t> crossed_thresh;
+    std::map<smem_hash_id, uint64_t> attr_counts;
+    std::map<std::pair<smem_hash_id, smem_hash_id>, uint64_t> const_counts;
+    std::map<std::pair<smem_hash_id, uint64_t>, uint64_t> lti_counts;
+    {
+        uint64_t thresh = static_cast<uint64_t>(settings->thresh->get_value());
+
+        std::vector<uint64_t> mentioned;
+        for (std::vector<smem_import_triple>::iterator t = triples.begin(); t != triples.end(); t++)
+        {
+            mentioned.push_back(t->lti_id);
+            if (t->value_is_lti)
+            {
+                mentioned.push_back(t->value);
+            }
+        }
+        std::sort(mentioned.begin(), mentioned.end());
+        mentioned.erase(std::unique(mentioned.begin(), mentioned.end()), mentioned.end());
+        for (std::vector<uint64_t>::iterator l = mentioned.begin(); l != mentioned.end(); l++)
+        {
+            if (lti_exists(*l) == NIL)
+            {
+                new_ltis.push_back(*l);
+            }
+        }
+
+        std::vector<smem_import_triple>::iterator kept = triples.begin();
+        std::vector<smem_import_triple>::iterator t = triples.begin();
+        while (t != triples.end())
+        {
+            uint64_t lti_id = t->lti_id;
+            bool is_new = std::binary_search(new_ltis.begin(), new_ltis.end(), lti_id);
+
+            uint64_t existing_edges = 0;
+            if (!is_new)
+            {
+                SQL->act_lti_child_ct_get->bind_int(1, lti_id);
+                SQL->act_lti_child_ct_get->execute();
+                existing_edges = static_cast<uint64_t>(SQL->act_lti_child_ct_get->column_int(0));
+                SQL->act_lti_child_ct_get->reinitialize();
+            }
+
+            uint64_t added_edges = 0;
+            smem_hash_id last_attr = NIL;
+            for (; (t != triples.end()) && (t->lti_id == lti_id); t++)
+            {
+                if (!is_new)
+                {
+                    soar_module::sqlite_statement* q = (t->value_is_lti ? SQL->web_lti_child : SQL->web_const_child);
+                    q->bind_int(1, lti_id);
+                    q->bind_int(2, t->attr);
+                    q->bind_int(3, t->value);
+                    if (q->execute(soar_module::op_reinit) == soar_module::row)
+                    {
+                        continue;
+                    }
+                }
+
+                if (t->attr != last_attr)
+                {
+                    last_attr = t->attr;
+
+                    bool attr_new = is_new;
+                    if (!attr_new)
+                    {
+                        SQL->web_attr_child->bind_int(1, lti_id);
+                        SQL->web_attr_child->bind_int(2, t->attr);
+                        attr_new = (SQL->web_attr_child->execute(soar_module::op_reinit) != soar_module::row);
+                    }
+                    if (attr_new)
+                    {
+                        attr_counts[t->attr]++;
+                    }
+                }
+
+                if (t->value_is_lti)
+                {
+                    lti_counts[std::make_pair(t->attr, t->value)]++;
+                }
+                else
+                {
+                    const_counts[std::make_pair(t->attr, t->value)]++;
+                }
+
+                added_edges++;
+                (*kept++) = (*t);
+            }
+
+            if (added_edges)
+            {
+                edge_counts.push_back(std::make_pair(lti_id, existing_edges + added_edges));
+
+                // see LTM_to_DB: an ltm that goes over thresh keeps its edges at low activation
+                if ((existing_edges < thresh) && ((existing_edges + added_edges) >= thresh))
+                {
+                    crossed_thresh.push_back(lti_id);
+                }
+            }
+        }
+        triples.erase(kept, triples.end());
+    }
+
+    drop_deferred_indices();
+
+    for (std::vector<uint64_t>::iterator l = new_ltis.begin(); l != new_ltis.end(); l++)
+    {
+        add_specific_LTI(*l);
+    }
+
+    for (std::vector<smem_import_triple>::iterator t = triples.begin(); t != triples.end(); t++)
+    {
+        // lti_id, attribute_s_id, val_const, value_lti_id, activation_value
+        SQL->web_add->bind_int(1, t->lti_id);
+        SQL->web_add->bind_int(2, t->attr);
+        SQL->web_add->bind_int(3, (t->value_is_lti ? SMEM_AUGMENTATIONS_NULL : t->value));
+        SQL->web_add->bind_int(4, (t->value_is_lti ? t->value : SMEM_AUGMENTATIONS_NULL));
+        SQL->web_add->bind_double(5, static_cast<double>(SMEM_ACT_LOW));
+        SQL->web_add->execute(soar_module::op_reinit);
+    }
+
+    for (std::vector<std::pair<uint64_t, uint64_t> >::iterator c = edge_counts.begin(); c != edge_counts.end(); c++)
+    {
+        SQL->act_lti_child_ct_set->bind_int(1, c->second);
+        SQL->act_lti_child_ct_set->bind_int(2, c->first);
+        SQL->act_lti_child_ct_set->execute(soar_module::op_reinit);
+    }
+
+    create_deferred_indices();
+
+    for (std::vector<uint64_t>::iterator l = crossed_thresh.begin(); l != crossed_thresh.end(); l++)
+    {
+        SQL->act_set->bind_double(1, static_cast<double>(SMEM_ACT_LOW));
+        SQL->act_set->bind_int(2, (*l));
+        SQL->act_set->execute(soar_module::op_reinit);
+    }
+
+    // merge the frequency counts (adjustment first, as the update statements expect)
+    for (std::map<smem_hash_id, uint64_t>::iterator a = attr_counts.begin(); a != attr_counts.end(); a++)
+    {
+        SQL->attribute_frequency_check->bind_int(1, a->first);
+        if (SQL->attribute_frequency_check->execute(soar_module::op_reinit) != soar_module::row)
+        {
+            SQL->attribute_frequency_add->bind_int(1, a->first);
+            SQL->attribute_frequency_add->execute(soar_module::op_reinit);
+            a->second--;
+        }
+        if (a->second)
+        {
+            SQL->attribute_frequency_update->bind_int(1, a->second);
+            SQL->attribute_frequency_update->bind_int(2, a->first);
+            SQL->attribute_frequency_update->execute(soar_module::op_reinit);
+        }
+    }
+
+    for (std::map<std::pair<smem_hash_id, smem_hash_id>, uint64_t>::iterator p = const_counts.begin(); p != const_counts.end(); p++)
+    {
+        SQL->wmes_constant_frequency_check->bind_int(1, p->first.first);
+        SQL->wmes_constant_frequency_check->bind_int(2, p->first.second);
+        if (SQL->wmes_constant_frequency_check->execute(soar_module::op_reinit) != soar_module::row)
+        {
+            SQL->wmes_constant_frequency_add->bind_int(1, p->first.first);
+            SQL->wmes_constant_frequency_add->bind_int(2, p->first.second);
+            SQL->wmes_constant_frequency_add->execute(soar_module::op_reinit);
+            p->second--;
+        }
+        if (p->second)
+        {
+            SQL->wmes_constant_frequency_update->bind_int(1, p->second);
+            SQL->wmes_constant_frequency_update->bind_int(2, p->first.first);
+            SQL->wmes_constant_frequency_update->bind_int(3, p->first.second);
+            SQL->wmes_constant_frequency_update->execute(soar_module::op_reinit);
+        }
+    }
+
+    for (std::map<std::pair<smem_hash_id, uint64_t>, uint64_t>::iterator p = lti_counts.begin(); p != lti_counts.end(); p++)
+    {
+        SQL->wmes_lti_frequency_check->bind_int(1, p->first.first);
+        SQL->wmes_lti_frequency_check->bind_int(2, p->first.second);
+        if (SQL->wmes_lti_frequency_check->execute(soar_module::op_reinit) != soar_module::row)
+        {
+            SQL->wmes_lti_frequency_add->bind_int(1, p->first.first);
+            SQL->wmes_lti_frequency_add->bind_int(2, p->first.second);
+            SQL->wmes_lti_frequency_add->execute(soar_module::op_reinit);
+            p->second--;
+        }
+        if (p->second)
+        {
+            SQL->wmes_lti_frequency_update->bind_int(1, p->second);
+            SQL->wmes_lti_frequency_update->bind_int(2, p->first.first);
+            SQL->wmes_lti_frequency_update->bind_int(3, p->first.second);
+            SQL->wmes_lti_frequency_update->execute(soar_module::op_reinit);
+        }
+    }
+
+    if (settings->lazy_commit->get_value() == off)
+    {
+        SQL->commit->execute(soar_module::op_reinit);
+    }
+
+    ltm_cache_clear();
+    posting_index_clear();
+
+    statistics->edges->set_value(statistics->edges->get_value() + triples.size());
+    (*num_imported) = triples.size();
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->storage->stop();
+    ////////////////////////////////////////////////////////////////////////////
+
+    return true;
+}
@@ -0,0 +1,303 @@
+/*
+ * smem_index.cpp
+ *
+ *  An in-memory inverted index over smem_augmentations for queries.
+ *
+ *  Every attribute, attribute/constant and attribute/lti pair that a cue
+ *  element can name has a posting list of the ltms with such an edge, kept
+ *  in the order the activation indices give a web crawl.  A query walks the
+ *  list of its most selective element exactly as it would walk the crawl,
+ *  and stops once it has the memories it asked for, but checks candidates
+ *  against the remaining cue elements in memory instead of with one SQL
+ *  probe per candidate and element.
+ *
+ *  The index is built in one pass over smem_augmentations the first time a
+ *  query needs it and is then kept current wherever edges are added,
+ *  truncated or have their activation set, so it always agrees with the
+ *  database.  It is dropped with the database, after a bulk import (which
+ *  is cheaper to rebuild from than to apply edge by edge) and when
+ *  query-index is turned off.
+ */
+
+#include "semantic_memory.h"
+
+#include "smem_db.h"
+#include "smem_settings.h"
+
+static void smem_posting_key_for(smem_weighted_cue_element* el, smem_posting_key* key)
+{
+    key->attr = el->attr_hash;
+    key->value_const = ((el->element_type == value_const_t) ? el->value_hash : SMEM_AUGMENTATIONS_NULL);
+    key->value_lti = ((el->element_type == value_lti_t) ? el->value_lti : SMEM_AUGMENTATIONS_NULL);
+}
+
+bool SMem_Manager::posting_index_ready()
+{
+    if (settings->query_index->get_value() == off)
+    {
+        if (posting_index.loaded)
+        {
+            posting_index_clear();
+        }
+        return false;
+    }
+
+    if (!posting_index.loaded)
+    {
+        // activations deferred by the ltm cache must be on the edges first
+        ltm_cache_flush();
+        posting_index_load();
+    }
+
+    return true;
+}
+
+void SMem_Manager::posting_index_load()
+{
+    posting_index_clear();
+
+    smem_posting lPosting;
+    smem_posting_edge lEdge;
+    smem_posting_key lAttrKey;
+
+    while (SQL->web_index_all->execute() == soar_module::row)
+    {
+        lPosting.seq = static_cast<uint64_t>(SQL->web_index_all->column_int(0));
+        lPosting.lti_id = static_cast<uint64_t>(SQL->web_index_all->column_int(1));
+        lPosting.activation = SQL->web_index_all->column_double(5);
+
+        lEdge.key.attr = static_cast<smem_hash_id>(SQL->web_index_all->column_int(2));
+        lEdge.key.value_const = static_cast<smem_hash_id>(SQL->web_index_all->column_int(3));
+        lEdge.key.value_lti = static_cast<uint64_t>(SQL->web_index_all->column_int(4));
+        lEdge.seq = lPosting.seq;
+        lEdge.activation = lPosting.activation;
+
+        lAttrKey.attr = lEdge.key.attr;
+        lAttrKey.value_const = SMEM_AUGMENTATIONS_NULL;
+        lAttrKey.value_lti = SMEM_AUGMENTATIONS_NULL;
+
+        posting_index.lists[lAttrKey].insert(lPosting);
+        posting_index.lists[lEdge.key].insert(lPosting);
+        posting_index.edges[lPosting.lti_id].push_back(lEdge);
+
+        // new edges sort after every edge already in the table, as their rowids will
+        if (lPosting.seq >= posting_index.next_seq)
+        {
+            posting_index.next_seq = lPosting.seq + 1;
+        }
+    }
+    SQL->web_index_all->reinitialize();
+
+    posting_index.loaded = true;
+}
+
+void SMem_Manager::posting_index_clear()
+{
+    posting_index.lists.clear();
+    posting_index.edges.clear();
+    posting_index.next_seq = 0;
+    posting_index.loaded = false;
+}
+
+void SMem_Manager::posting_edge_added(uint64_t pLTI_ID, smem_hash_id attr, smem_hash_id value_const, uint64_t value_lti, double activation)
+{
+    if (!posting_index.loaded)
+    {
+        return;
+    }
+
+    smem_posting lPosting;
+    lPosting.activation = activation;
+    lPosting.seq = posting_index.next_seq++;
+    lPosting.lti_id = pLTI_ID;
+
+    smem_posting_edge lEdge;
+    lEdge.key.attr = attr;
+    lEdge.key.value_const = value_const;
+    lEdge.key.value_lti = value_lti;
+    lEdge.seq = lPosting.seq;
+    lEdge.activation = activation;
+
+    smem_posting_key lAttrKey;
+    lAttrKey.attr = attr;
+    lAttrKey.value_const = SMEM_AUGMENTATIONS_NULL;
+    lAttrKey.value_lti = SMEM_AUGMENTATIONS_NULL;
+
+    posting_index.lists[lAttrKey].insert(lPosting);
+    posting_index.lists[lEdge.key].insert(lPosting);
+    posting_index.edges[pLTI_ID].push_back(lEdge);
+}
+
+// mirrors act_set, which gives every edge of the ltm the same activation
+void SMem_Manager::posting_ltm_activated(uint64_t pLTI_ID, double activation)
+{
+    if (!posting_index.loaded)
+    {
+        return;
+    }
+
+    std::unordered_map<uint64_t, std::vector<smem_posting_edge> >::iterator lEdges = posting_index.edges.find(pLTI_ID);
+    if (lEdges == posting_index.edges.end())
+    {
+        return;
+    }
+
+    smem_posting lPosting;
+    lPosting.lti_id = pLTI_ID;
+
+    smem_posting_key lAttrKey;
+    lAttrKey.value_const = SMEM_AUGMENTATIONS_NULL;
+    lAttrKey.value_lti = SMEM_AUGMENTATIONS_NULL;
+
+    for (std::vector<smem_posting_edge>::iterator e = lEdges->second.begin(); e != lEdges->second.end(); e++)
+    {
+        if (e->activation == activation)
+        {
+            continue;
+        }
+
+        lAttrKey.attr = e->key.attr;
+        smem_posting_list& lAttrList = posting_index.lists[lAttrKey];
+        smem_posting_list& lValueList = posting_index.lists[e->key];
+
+        lPosting.seq = e->seq;
+        lPosting.activation = e->activation;
+        lAttrList.erase(lPosting);
+        lValueList.erase(lPosting);
+
+        e->activation = activation;
+        lPosting.activation = activation;
+        lAttrList.insert(lPosting);
+        lValueList.insert(lPosting);
+    }
+}
+
+// mirrors web_truncate, which removes every edge of the ltm
+void SMem_Manager::posting_ltm_truncated(uint64_t pLTI_ID)
+{
+    if (!posting_index.loaded)
+    {
+        return;
+    }
+
+    std::unordered_map<uint64_t, std::vector<smem_posting_edge> >::iterator lEdges = posting_index.edges.find(pLTI_ID);
+    if (lEdges == posting_index.edges.end())
+    {
+        return;
+    }
+
+    smem_posting lPosting;
+    lPosting.lti_id = pLTI_ID;
+
+    smem_posting_key lAttrKey;
+    lAttrKey.value_const = SMEM_AUGMENTATIONS_NULL;
+    lAttrKey.value_lti = SMEM_AUGMENTATIONS_NULL;
+
+    for (std::vector<smem_posting_edge>::iterator e = lEdges->second.begin(); e != lEdges->second.end(); e++)
+    {
+        lPosting.seq = e->seq;
+        lPosting.activation = e->activation;
+
+        lAttrKey.attr = e->key.attr;
+        posting_index.lists[lAttrKey].erase(lPosting);
+        posting_index.lists[e->key].erase(lPosting);
+    }
+
+    posting_index.edges.erase(lEdges);
+}
+
+// in-memory equivalent of web_attr_child, web_const_child and web_lti_child
+bool SMem_Manager::posting_ltm_has(uint64_t pLTI_ID, smem_weighted_cue_element* el)
+{
+    std::unordered_map<uint64_t, std::vector<smem_posting_edge> >::iterator lEdges = posting_index.edges.find(pLTI_ID);
+    if (lEdges == posting_index.edges.end())
+    {
+        return false;
+    }
+
+    smem_posting_key lKey;
+    smem_posting_key_for(el, &lKey);
+
+    for (std::vector<smem_posting_edge>::iterator e = lEdges->second.begin(); e != lEdges->second.end(); e++)
+    {
+        if ((el->element_type == attr_t) ? (e->key.attr == lKey.attr) : (e->key == lKey))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/***************************************************************************
+ * Candidate walks
+ *
+ * process_query takes its candidates, in activation order, from a crawl:
+ * the posting list of the cue element when the index is in use, otherwise
+ * the web crawl statement for it.  Each call leaves the current candidate
+ * in lti_id and activation and returns false once the walk is exhausted.
+ ***************************************************************************/
+
+bool SMem_Manager::crawl_start(smem_weighted_cue_element* el, smem_crawl* crawl, bool use_index)
+{
+    crawl->q = NULL;
+    crawl->list = NULL;
+
+    if (use_index)
+    {
+        smem_posting_key lKey;
+        smem_posting_key_for(el, &lKey);
+
+        std::unordered_map<smem_posting_key, smem_posting_list, smem_posting_key_hash>::iterator lList = posting_index.lists.find(lKey);
+        if (lList == posting_index.lists.end())
+        {
+            return false;
+        }
+
+        crawl->list = &(lList->second);
+        crawl->pos = crawl->list->begin();
+    }
+    else
+    {
+        crawl->q = setup_web_crawl(el);
+    }
+
+    return crawl_next(crawl);
+}
+
+bool SMem_Manager::crawl_next(smem_crawl* crawl)
+{
+    if (crawl->list)
+    {
+        if (crawl->pos == crawl->list->end())
+        {
+            return false;
+        }
+
+        crawl->lti_id = crawl->pos->lti_id;
+        crawl->activation = crawl->pos->activation;
+        crawl->pos++;
+
+        return true;
+    }
+
+    if (crawl->q->execute() != soar_module::row)
+    {
+        return false;
+    }
+
+    crawl->lti_id = static_cast<uint64_t>(crawl->q->column_int(0));
+    crawl->activation = crawl->q->column_double(1);
+
+    return true;
+}
+
+void SMem_Manager::crawl_stop(smem_crawl* crawl)
+{
+    if (crawl->q)
+    {
+        crawl->q->reinitialize();
+        crawl->q = NULL;
+    }
+    crawl->list = NULL;
+}
@@ -302,20 +302,45 @@ void SMem_Manager::install_memory(Symbol* state, uint64_t pLTI_ID, Symbol* sti,
         Symbol* value_sym;
 
         // get direct children: attr_type, attr_hash, value_type, value_hash, value_letter, value_num, value_lti
-        expand_q->bind_int(1, pLTI_ID);
+        // (read once into the ltm cache, when it is on, and replayed from there)
+        smem_cached_ltm* cached = NULL;
+        std::vector<smem_cached_child>::iterator cached_child;
+        if (ltm_cache_enabled())
+        {
+            cached = ltm_cache_get(pLTI_ID, true);
+            cached_child = cached->children.begin();
+        }
+        else
+        {
+            expand_q->bind_int(1, pLTI_ID);
+        }
 
         std::set<Symbol*> children;
+        smem_cached_child child;
 
-        while (expand_q->execute() == soar_module::row)
+        while (cached ? (cached_child != cached->children.end()) : (expand_q->execute() == soar_module::row))
         {
+            if (cached)
+            {
+                child = *(cached_child++);
+            }
+            else
+            {
+                child.attr_type = static_cast<byte>(expand_q->column_int(0));
+                child.attr_hash = static_cast<smem_hash_id>(expand_q->column_int(1));
+                child.value_type = static_cast<byte>(expand_q->column_int(2));
+                child.value_hash = static_cast<smem_hash_id>(expand_q->column_int(3));
+                child.value_lti = static_cast<uint64_t>(expand_q->column_int(4));
+            }
+
             // make the identifier symbol irrespective of value type
-            attr_sym = rhash_(static_cast<byte>(expand_q->column_int(0)), static_cast<smem_hash_id>(expand_q->column_int(1)));
+            attr_sym = rhash_(child.attr_type, child.attr_hash);
 
             // identifier vs. constant
-            if (expand_q->column_int(4) != SMEM_AUGMENTATIONS_NULL)
+            if (child.value_lti != SMEM_AUGMENTATIONS_NULL)
             {
-                dprint(DT_SMEM_INSTANCE, "Child LTI augmentation found.  Getting STI for lti_id %u...", static_cast<uint64_t>(expand_q->column_int(4)));
-                value_sym = get_current_iSTI_for_LTI(static_cast<uint64_t>(expand_q->column_int(4)), sti->id->level, 'L');
+                dprint(DT_SMEM_INSTANCE, "Child LTI augmentation found.  Getting STI for lti_id %u...", child.value_lti);
+                value_sym = get_current_iSTI_for_LTI(child.value_lti, sti->id->level, 'L');
                 dprint_noprefix(DT_SMEM_INSTANCE, "%y\n", value_sym);
                 if (depth > 1)
                 {
@@ -325,8 +350,8 @@ void SMem_Manager::install_memory(Symbol* state, uint64_t pLTI_ID, Symbol* sti,
             }
             else
             {
-                dprint(DT_SMEM_INSTANCE, "Child constant augmentation found.  Getting constant for value hash %d %u...", static_cast<byte>(expand_q->column_int(2)), static_cast<smem_hash_id>(expand_q->column_int(3)));
-                value_sym = rhash_(static_cast<byte>(expand_q->column_int(2)), static_cast<smem_hash_id>(expand_q->column_int(3)));
+                dprint(DT_SMEM_INSTANCE, "Child constant augmentation found.  Getting constant for value hash %d %u...", child.value_type, child.value_hash);
+                value_sym = rhash_(child.value_type, child.value_hash);
                 dprint_noprefix(DT_SMEM_INSTANCE, "%y\n", value_sym);
             }
 
@@ -342,7 +367,10 @@ void SMem_Manager::install_memory(Symbol* state, uint64_t pLTI_ID, Symbol* sti,
             thisAgent->symbolManager->symbol_remove_ref(&attr_sym);
             thisAgent->symbolManager->symbol_remove_ref(&value_sym);
         }
-        expand_q->reinitialize();
+        if (!cached)
+        {
+            expand_q->reinitialize();
+        }
 
         //Attempt to find children for the case of depth.
         std::set<Symbol*>::iterator iterator;
@@ -341,6 +341,8 @@ id_set SMem_Manager::print_LTM(uint64_t pLTI_ID, double lti_act, std::string* re
 
 void SMem_Manager::print_store(std::string* return_val)
 {
+    ltm_cache_flush();
+
     soar_module::sqlite_statement* q = thisAgent->SMem->SQL->vis_lti;
     while (q->execute() == soar_module::row)
     {
@@ -365,6 +367,8 @@ void SMem_Manager::print_smem_object(uint64_t pLTI_ID, uint64_t depth, std::stri
     soar_module::sqlite_statement* lti_access_q = thisAgent->SMem->SQL->lti_access_get;
     unsigned int i;
 
+    // activation and history are read straight from the db
+    ltm_cache_flush();
 
     // initialize queue/set
     to_visit.push(std::make_pair(pLTI_ID, 1u));
@@ -312,8 +312,6 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
     //This is used when doing math queries that need to look at more that just the first valid element
     bool needFullSearch = false;
 
-    soar_module::sqlite_statement* q = NULL;
-
     std::list<uint64_t> temp_list;
     if (query_level == qry_full)
     {
@@ -326,6 +324,10 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
     timers->query->start();
     ////////////////////////////////////////////////////////////////////////////
 
+    // the web crawls below order candidates by the stored activation
+    ltm_cache_flush();
+    spread_update();
+
     // prepare query stats
     {
         smem_prioritized_weighted_cue weighted_pq;
@@ -429,6 +431,10 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
         uint64_t cand;
         bool good_cand;
 
+        // candidates come from the query index when it is on
+        bool use_index = posting_index_ready();
+        smem_crawl crawl;
+
         if (settings->activation_mode->get_value() == smem_param_container::act_base)
         {
             // naive base-level updates means update activation of
@@ -436,54 +442,73 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
             // confirmation walk
             if (settings->base_update->get_value() == smem_param_container::bupt_naive)
             {
-                q =setup_web_crawl((*cand_set));
-
                 // queue up distinct lti's to update
                 // - set because queries could contain wilds
                 // - not in loop because the effects of activation may actually
                 //   alter the resultset of the query (isolation???)
                 std::set< uint64_t > to_update;
-                while (q->execute() == soar_module::row)
+                bool more_rows = crawl_start((*cand_set), &crawl, use_index);
+                while (more_rows)
                 {
-                    to_update.insert(q->column_int(0));
+                    to_update.insert(crawl.lti_id);
+                    more_rows = crawl_next(&crawl);
                 }
+                crawl_stop(&crawl);
 
-                for (std::set< uint64_t >::iterator it = to_update.begin(); it != to_update.end(); it++)
-                {
-                    lti_activate((*it), false);
-                }
+                std::vector< uint64_t > batch(to_update.begin(), to_update.end());
+                lti_activate_batch(batch);
 
-                q->reinitialize();
+                ltm_cache_flush();
             }
         }
 
         // setup first query, which is sorted on activation already
-        q =setup_web_crawl((*cand_set));
         thisAgent->lastCue = new agent::BasicWeightedCue((*cand_set)->cue_element, (*cand_set)->weight);
 
         // this becomes the minimal set to walk (till match or fail)
-        if (q->execute() == soar_module::row)
+        if (crawl_start((*cand_set), &crawl, use_index))
         {
             smem_prioritized_activated_lti_queue plentiful_parents;
+            smem_prioritized_activated_lti_queue spread_boosted;
             bool more_rows = true;
             bool use_db = false;
+            bool use_spread = false;
             bool has_feature = false;
 
-            while (more_rows && (q->column_double(1) == static_cast<double>(SMEM_ACT_MAX)))
+            // ltms receiving spread are ranked by activation plus spread, so
+            // they are taken out of the activation-ordered walk and queued
+            // on their own (they still have to match the whole cue)
+            for (smem_spread_value_map::iterator spread_it = spread_values.begin(); spread_it != spread_values.end(); spread_it++)
             {
-                SQL->act_lti_get->bind_int(1, q->column_int(0));
+                if (prohibit->find(spread_it->first) != prohibit->end())
+                {
+                    continue;
+                }
+
+                SQL->act_lti_get->bind_int(1, spread_it->first);
+                if (SQL->act_lti_get->execute() == soar_module::row)
+                {
+                    spread_boosted.push(std::make_pair< double, uint64_t >(SQL->act_lti_get->column_double(0) + spread_it->second.amount, static_cast<uint64_t>(spread_it->first)));
+                }
+                SQL->act_lti_get->reinitialize();
+            }
+
+            while (more_rows && (crawl.activation == static_cast<double>(SMEM_ACT_MAX)))
+            {
+                SQL->act_lti_get->bind_int(1, crawl.lti_id);
                 SQL->act_lti_get->execute();
-                plentiful_parents.push(std::make_pair< double, uint64_t >(SQL->act_lti_get->column_double(0), q->column_int(0)));
+                plentiful_parents.push(std::make_pair< double, uint64_t >(SQL->act_lti_get->column_double(0), static_cast<uint64_t>(crawl.lti_id)));
                 SQL->act_lti_get->reinitialize();
 
-                more_rows = (q->execute() == soar_module::row);
+                more_rows = crawl_next(&crawl);
             }
             bool first_element = false;
-            while (((match_ids->size() < number_to_retrieve) || (needFullSearch)) && ((more_rows) || (!plentiful_parents.empty())))
+            while (((match_ids->size() < number_to_retrieve) || (needFullSearch)) && ((more_rows) || (!plentiful_parents.empty()) || (!spread_boosted.empty())))
             {
-                // choose next candidate (db vs. priority queue)
+                // choose next candidate (db vs. priority queue vs. spread)
                 {
                     use_db = false;
+                    use_spread = false;
 
                     if (!more_rows)
                     {
@@ -495,19 +520,42 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
                     }
                     else
                     {
-                        use_db = (q->column_double(1) >  plentiful_parents.top().first);
+                        use_db = (crawl.activation >  plentiful_parents.top().first);
                     }
 
-                    if (use_db)
+                    if (!spread_boosted.empty())
                     {
-                        cand = q->column_int(0);
-                        more_rows = (q->execute() == soar_module::row);
+                        if (!more_rows && plentiful_parents.empty())
+                        {
+                            use_spread = true;
+                        }
+                        else
+                        {
+                            use_spread = (spread_boosted.top().first > ((use_db) ? (crawl.activation) : (plentiful_parents.top().first)));
+                        }
+                    }
+
+                    if (use_spread)
+                    {
+                        cand = spread_boosted.top().second;
+                        spread_boosted.pop();
+                    }
+                    else if (use_db)
+                    {
+                        cand = crawl.lti_id;
+                        more_rows = crawl_next(&crawl);
                     }
                     else
                     {
                         cand = plentiful_parents.top().second;
                         plentiful_parents.pop();
                     }
+
+                    // already queued by activation plus spread
+                    if (!use_spread && (spread_values.find(cand) != spread_values.end()))
+                    {
+                        continue;
+                    }
                 }
 
                 // if not prohibited, submit to the remaining cue elements
@@ -520,11 +568,23 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
                     {
                         // don't need to check the generating list
                         //If the cand_set is a math query, we care about more than its existence
-                        if ((*next_element) == (*cand_set) && (*next_element)->mathElement == NIL)
+                        if ((*next_element) == (*cand_set) && (*next_element)->mathElement == NIL && !use_spread)
                         {
                             continue;
                         }
 
+                        // math queries need the values themselves, so only plain elements are checked in memory
+                        if (use_index && ((*next_element)->mathElement == NIL))
+                        {
+                            has_feature = posting_ltm_has(cand, (*next_element));
+                            good_cand = (((*next_element)->pos_element) ? (has_feature) : (!has_feature));
+                            if (!good_cand)
+                            {
+                                break;
+                            }
+                            continue;
+                        }
+
                         if ((*next_element)->element_type == attr_t)
                         {
                             // parent=? AND attribute_s_id=?
@@ -623,7 +683,7 @@ uint64_t SMem_Manager::process_query(Symbol* state, Symbol* query, Symbol* negqu
 //                king_id = match_ids->front();
 //            }
         }
-        q->reinitialize();
+        crawl_stop(&crawl);
 
         // clean weighted cue
         for (next_element = weighted_cue.begin(); next_element != weighted_cue.end(); next_element++)
@@ -60,6 +60,14 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     cache_size = new soar_module::integer_param("cache-size", 10000, new soar_module::gt_predicate<int64_t>(1, true), new smem_db_predicate<int64_t>(thisAgent));
     add(cache_size);
 
+    // ltm_cache (number of LTMs kept in memory, 0 disables the working-set cache)
+    ltm_cache = new soar_module::integer_param("ltm-cache", 0, new soar_module::gt_predicate<int64_t>(0, true), new smem_db_predicate<int64_t>(thisAgent));
+    add(ltm_cache);
+
+    // query_index (in-memory posting lists that queries walk instead of the database)
+    query_index = new soar_module::boolean_param("query-index", off, new soar_module::f_predicate<boolean>());
+    add(query_index);
+
     // opt
     opt = new soar_module::constant_param<opt_choices>("optimization", opt_speed, new smem_db_predicate<opt_choices>(thisAgent));
     opt->add_mapping(opt_safety, "safety");
@@ -96,6 +104,30 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     base_incremental_threshes = new soar_module::int_set_param("base-incremental-threshes", new soar_module::f_predicate< int64_t >());
     add(base_incremental_threshes);
 
+    // keep activation histories in memory and compute base-level activation in batches
+    base_history_store = new soar_module::boolean_param("base-history-store", off, new soar_module::f_predicate<boolean>());
+    add(base_history_store);
+
+    // approximate pow/log in the batched base-level kernel
+    base_fast_math = new soar_module::boolean_param("base-fast-math", off, new soar_module::f_predicate<boolean>());
+    add(base_fast_math);
+
+    // spread activation from ltms instantiated in working memory
+    spreading = new soar_module::boolean_param("spreading", off, new soar_module::f_predicate<boolean>());
+    add(spreading);
+
+    // number of edges spread travels from a source
+    spreading_depth = new soar_module::integer_param("spreading-depth", 2, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(spreading_depth);
+
+    // children of an ltm that spread is passed to
+    spreading_limit = new soar_module::integer_param("spreading-limit", 20, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(spreading_limit);
+
+    // fraction of spread that continues past each edge
+    spreading_continue = new soar_module::decimal_param("spreading-continue", 0.9, new soar_module::btw_predicate<double>(0, 1, true), new soar_module::f_predicate<double>());
+    add(spreading_continue);
+
     // initial variable id
     initial_variable_id = new soar_module::unsigned_integer_param("initial-variable-id", 1, new soar_module::predicate<uint64_t>(), new smem_db_predicate<uint64_t>(thisAgent));
     add(initial_variable_id);
@@ -226,6 +258,21 @@ smem_stat_container::smem_stat_container(agent* new_agent): soar_module::stat_co
 
     edges = new soar_module::integer_stat("edges", 0, new smem_db_predicate< int64_t >(thisAgent));
     add(edges);
+
+    ltm_cache_hits = new soar_module::integer_stat("ltm-cache-hits", 0, new soar_module::f_predicate<int64_t>());
+    add(ltm_cache_hits);
+
+    ltm_cache_misses = new soar_module::integer_stat("ltm-cache-misses", 0, new soar_module::f_predicate<int64_t>());
+    add(ltm_cache_misses);
+
+    ltm_cache_hit_rate = new smem_ltm_cache_hit_rate_stat(thisAgent, "ltm-cache-hit-rate", 0.0, new soar_module::predicate<double>());
+    add(ltm_cache_hit_rate);
+
+    spread_sources = new soar_module::integer_stat("spread-sources", 0, new soar_module::f_predicate<int64_t>());
+    add(spread_sources);
+
+    spread_targets = new soar_module::integer_stat("spread-targets", 0, new soar_module::f_predicate<int64_t>());
+    add(spread_targets);
 }
 
 //
@@ -251,11 +298,26 @@ int64_t smem_mem_high_stat::get_value()
     return thisAgent->SMem->DB->memory_highwater();
 }
 
+smem_ltm_cache_hit_rate_stat::smem_ltm_cache_hit_rate_stat(agent* new_agent, const char* new_name, double new_value, soar_module::predicate<double>* new_prot_pred): soar_module::decimal_stat(new_name, new_value, new_prot_pred), thisAgent(new_agent) {}
+
+double smem_ltm_cache_hit_rate_stat::get_value()
+{
+    int64_t hits = thisAgent->SMem->statistics->ltm_cache_hits->get_value();
+    int64_t lookups = hits + thisAgent->SMem->statistics->ltm_cache_misses->get_value();
+
+    return ((lookups > 0) ? (static_cast<double>(hits) / static_cast<double>(lookups)) : (0.0));
+}
+
 bool SMem_Manager::enabled()
 {
     return (settings->learning->get_value() == on);
 }
 
+bool SMem_Manager::spreading_enabled()
+{
+    return (enabled() && (settings->spreading->get_value() == on));
+}
+
 bool SMem_Manager::connected()
 {
     return (DB->get_status() == soar_module::connected);
@@ -283,6 +345,7 @@ void smem_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --backup","<filename>", 55).c_str(), "Saves a copy of database");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --clear","", 55).c_str(), "Deletes all semantic knowledge");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --export","<filename> [<LTI>]", 55).c_str(), "Export database to text file");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --import","<filename>", 55).c_str(), "Bulk load a file of (@id ^attr value) triples");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --init ","", 55).c_str(), "Reinitialize semantic memory store");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --query ","{(cue)* [<num>]}", 55).c_str(), "Query for concepts in semantic store matching cue");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --remove","{ (id [^attr [value]])* }", 55).c_str(), "Remove semantic memory structures");
@@ -296,12 +359,20 @@ void smem_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-decay", base_decay->get_string(), 55).c_str(), "Decay parameter for base-level activation computation");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-update-policy", base_update->get_string(), 55).c_str(), "stable, naive, incremental");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-incremental-threshes", base_incremental_threshes->get_string(), 55).c_str(), "integer > 0");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-history-store", base_history_store->get_string(), 55).c_str(), "Keep histories in memory, batch updates");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-fast-math", base_fast_math->get_string(), 55).c_str(), "Approximate pow/log in batched updates");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("thresh", thresh->get_string(), 55).c_str(), "integer >= 0");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading", spreading->get_string(), 55).c_str(), "Spread from LTMs in working memory");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-depth", spreading_depth->get_string(), 55).c_str(), "integer >= 1");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-limit", spreading_limit->get_string(), 55).c_str(), "Max children spread to, integer >= 1");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-continue", spreading_continue->get_string(), 55).c_str(), "0 <= decimal <= 1");
     outputManager->printa(thisAgent, "------------- Database Optimization Settings ----------\n");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("lazy-commit", lazy_commit->get_string(), 55).c_str(), "Delay writing semantic store until exit");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("optimization", opt->get_string(), 55).c_str(), "safety, performance");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("cache-size", cache_size->get_string(), 55).c_str(), "Number of memory pages used for SQLite cache");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("page-size", page_size->get_string(), 55).c_str(), "Size of each memory page used");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("ltm-cache", ltm_cache->get_string(), 55).c_str(), "Number of LTMs kept in memory (0 = off)");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("query-index", query_index->get_string(), 55).c_str(), "Answer queries from in-memory posting lists");
     outputManager->printa(thisAgent, "----------------- Timers and Statistics ---------------\n");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("timers <detail>", timers->get_string(), 55).c_str(), "How detailed timers should be (use --set)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("smem --timers ","[<timer>]", 55).c_str(), "Print timer summary or specific statistic");
@@ -312,8 +383,10 @@ void smem_param_container::print_settings(agent* thisAgent)
         "Timers: smem_api, smem_hash, smem_init, smem_query,\n"
         "        smem_ncb_retrieval, three_activation\n"
         "        smem_storage, _total\n"
-        "Stats:  act_updates, db-lib-version, edges, mem-usage,\n"
-        "        mem-high, nodes, queries, retrieves, stores\n");
+        "Stats:  act_updates, db-lib-version, edges, ltm-cache-hits,\n"
+        "        ltm-cache-misses, ltm-cache-hit-rate, mem-usage,\n"
+        "        mem-high, nodes, queries, retrieves, spread-sources,\n"
+        "        spread-targets, stores\n");
     outputManager->printa(thisAgent, "-------------------------------------------------------\n\n");
     outputManager->printa_sf(thisAgent, "For a detailed explanation of these settings:  %-%- help smem\n");
 }
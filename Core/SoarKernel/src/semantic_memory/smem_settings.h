@@ -33,6 +33,8 @@ class smem_param_container: public soar_module::param_container
 
         soar_module::constant_param<page_choices>* page_size;
         soar_module::integer_param* cache_size;
+        soar_module::integer_param* ltm_cache;
+        soar_module::boolean_param* query_index;
         soar_module::constant_param<opt_choices>* opt;
 
         soar_module::integer_param* thresh;
@@ -46,6 +48,14 @@ class smem_param_container: public soar_module::param_container
 
         soar_module::int_set_param* base_incremental_threshes;
 
+        soar_module::boolean_param* base_history_store;
+        soar_module::boolean_param* base_fast_math;
+
+        soar_module::boolean_param* spreading;
+        soar_module::integer_param* spreading_depth;
+        soar_module::integer_param* spreading_limit;
+        soar_module::decimal_param* spreading_continue;
+
         void print_settings(agent* thisAgent);
         void print_summary(agent* thisAgent);
         soar_module::unsigned_integer_param* initial_variable_id;
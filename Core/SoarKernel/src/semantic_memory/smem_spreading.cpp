@@ -0,0 +1,212 @@
+/*
+ * smem_spreading.cpp
+ *
+ *  Spreading activation from LTMs instantiated in working memory.
+ *
+ *  Every identifier in working memory that instantiates an LTM is a source.
+ *  Sources are counted as WMEs pointing at them are added and removed, which
+ *  is cheap and happens on every working memory change.  The spread itself is
+ *  only brought up to date when a query needs it: a source that appeared walks
+ *  at most spreading-depth edges out, passing spreading-continue of what it
+ *  received, divided by the node's fan, on to no more than spreading-limit
+ *  children, and remembers what it gave; a source that disappeared takes back
+ *  exactly that.  The cost of a query is therefore bounded by the sources that
+ *  changed since the last one, not by everything in working memory.
+ */
+
+#include "semantic_memory.h"
+
+#include "smem_db.h"
+#include "smem_settings.h"
+#include "smem_stats.h"
+
+#include "agent.h"
+#include "symbol.h"
+#include "working_memory.h"
+
+#include <map>
+
+void SMem_Manager::spread_wme_added(wme* w)
+{
+    Symbol* lValue = w->value;
+    if (!lValue->is_sti() || !lValue->id->LTI_ID)
+    {
+        return;
+    }
+
+    // instances are keyed by symbol, since the lti link can be stripped
+    // while the wme is still in working memory
+    std::pair<uint64_t, uint64_t>& lInstance = spread_instances[lValue];
+    if (lInstance.second++ == 0)
+    {
+        lInstance.first = lValue->id->LTI_ID;
+        spread_instance_changed(lInstance.first, true);
+    }
+}
+
+void SMem_Manager::spread_wme_removed(wme* w)
+{
+    smem_spread_instance_map::iterator lInstance = spread_instances.find(w->value);
+    if (lInstance == spread_instances.end())
+    {
+        return;
+    }
+
+    if (--(lInstance->second.second) == 0)
+    {
+        spread_instance_changed(lInstance->second.first, false);
+        spread_instances.erase(lInstance);
+    }
+}
+
+void SMem_Manager::spread_instance_changed(uint64_t pLTI_ID, bool added)
+{
+    smem_spread_source& lSource = spread_sources[pLTI_ID];
+
+    if (added)
+    {
+        if (lSource.instances++ == 0)
+        {
+            spread_changed.push_back(pLTI_ID);
+        }
+    }
+    else if (--lSource.instances == 0)
+    {
+        spread_changed.push_back(pLTI_ID);
+    }
+}
+
+// applies the sources that appeared or disappeared since the last query
+void SMem_Manager::spread_update()
+{
+    if (!spreading_enabled())
+    {
+        if (spread_tracking)
+        {
+            spread_clear();
+        }
+        return;
+    }
+
+    if (!spread_tracking)
+    {
+        // count what is already in working memory, then follow changes
+        spread_tracking = true;
+        for (wme* w = thisAgent->all_wmes_in_rete; w != NIL; w = w->rete_next)
+        {
+            spread_wme_added(w);
+        }
+    }
+
+    for (std::vector<uint64_t>::iterator c = spread_changed.begin(); c != spread_changed.end(); c++)
+    {
+        smem_spread_source_map::iterator lSource = spread_sources.find(*c);
+        if (lSource == spread_sources.end())
+        {
+            continue;
+        }
+
+        if ((lSource->second.instances > 0) && !lSource->second.spreading)
+        {
+            spread_compute(lSource->first, &(lSource->second));
+            for (std::vector<std::pair<uint64_t, double> >::iterator t = lSource->second.contributions.begin(); t != lSource->second.contributions.end(); t++)
+            {
+                smem_spread_value& lValue = spread_values[t->first];
+                lValue.amount += t->second;
+                lValue.sources++;
+            }
+            lSource->second.spreading = true;
+        }
+        else if (lSource->second.instances == 0)
+        {
+            if (lSource->second.spreading)
+            {
+                for (std::vector<std::pair<uint64_t, double> >::iterator t = lSource->second.contributions.begin(); t != lSource->second.contributions.end(); t++)
+                {
+                    smem_spread_value_map::iterator lValue = spread_values.find(t->first);
+                    if (--(lValue->second.sources) == 0)
+                    {
+                        spread_values.erase(lValue);
+                    }
+                    else
+                    {
+                        lValue->second.amount -= t->second;
+                    }
+                }
+            }
+            spread_sources.erase(lSource);
+        }
+    }
+    spread_changed.clear();
+
+    statistics->spread_sources->set_value(spread_sources.size());
+    statistics->spread_targets->set_value(spread_values.size());
+}
+
+// walks out from a source, recording the spread each ltm it reaches receives
+void SMem_Manager::spread_compute(uint64_t pLTI_ID, smem_spread_source* source)
+{
+    int64_t lDepth = settings->spreading_depth->get_value();
+    size_t lLimit = static_cast<size_t>(settings->spreading_limit->get_value());
+    double lContinue = settings->spreading_continue->get_value();
+
+    std::map<uint64_t, double> lTotals;
+    std::map<uint64_t, double> lFrontier, lNext;
+    std::vector<uint64_t> lChildren;
+
+    lFrontier[pLTI_ID] = 1.0;
+    for (int64_t d = 0; (d < lDepth) && !lFrontier.empty(); d++)
+    {
+        lNext.clear();
+        for (std::map<uint64_t, double>::iterator n = lFrontier.begin(); n != lFrontier.end(); n++)
+        {
+            lChildren.clear();
+            SQL->spread_children->bind_int(1, n->first);
+            while (SQL->spread_children->execute() == soar_module::row)
+            {
+                lChildren.push_back(static_cast<uint64_t>(SQL->spread_children->column_int(0)));
+            }
+            SQL->spread_children->reinitialize();
+
+            if (lChildren.empty())
+            {
+                continue;
+            }
+
+            // the whole fan dilutes the spread, but only the first
+            // spreading-limit children receive (and pass on) their share
+            double lShare = (n->second * lContinue) / static_cast<double>(lChildren.size());
+            size_t lCount = ((lChildren.size() < lLimit) ? (lChildren.size()) : (lLimit));
+            for (size_t i = 0; i < lCount; i++)
+            {
+                if (lChildren[i] != pLTI_ID)
+                {
+                    lTotals[lChildren[i]] += lShare;
+                    lNext[lChildren[i]] += lShare;
+                }
+            }
+        }
+        lFrontier.swap(lNext);
+    }
+
+    source->contributions.assign(lTotals.begin(), lTotals.end());
+}
+
+void SMem_Manager::spread_clear()
+{
+    spread_tracking = false;
+
+    spread_instances.clear();
+    spread_sources.clear();
+    spread_values.clear();
+    spread_changed.clear();
+
+    statistics->spread_sources->set_value(0);
+    statistics->spread_targets->set_value(0);
+}
+
+double SMem_Manager::spread_get(uint64_t pLTI_ID)
+{
+    smem_spread_value_map::iterator lValue = spread_values.find(pLTI_ID);
+    return ((lValue == spread_values.end()) ? (0.0) : (lValue->second.amount));
+}
@@ -25,6 +25,13 @@ class smem_stat_container: public soar_module::stat_container
         soar_module::integer_stat* nodes;
         soar_module::integer_stat* edges;
 
+        soar_module::integer_stat* ltm_cache_hits;
+        soar_module::integer_stat* ltm_cache_misses;
+        smem_ltm_cache_hit_rate_stat* ltm_cache_hit_rate;
+
+        soar_module::integer_stat* spread_sources;
+        soar_module::integer_stat* spread_targets;
+
         smem_stat_container(agent* thisAgent);
 };
 
@@ -58,4 +65,14 @@ class smem_mem_high_stat: public soar_module::integer_stat
         int64_t get_value();
 };
 
+class smem_ltm_cache_hit_rate_stat: public soar_module::decimal_stat
+{
+    protected:
+        agent* thisAgent;
+
+    public:
+        smem_ltm_cache_hit_rate_stat(agent* new_agent, const char* new_name, double new_value, soar_module::predicate<double>* new_prot_pred);
+        double get_value();
+};
+
 #endif /* CORE_SOARKERNEL_SRC_SEMANTIC_MEMORY_SMEM_STATS_H_ */
@@ -147,6 +147,7 @@ void SMem_Manager::disconnect_ltm(uint64_t pLTI_ID)
     {
         SQL->web_truncate->bind_int(1, pLTI_ID);
         SQL->web_truncate->execute(soar_module::op_reinit);
+        posting_ltm_truncated(pLTI_ID);
     }
 }
 
@@ -155,6 +156,9 @@ void SMem_Manager::disconnect_ltm(uint64_t pLTI_ID)
 void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remove_old_children, bool activate)
 {
     assert(pLTI_ID);
+    // augmentations and counts change below, so the cached copy is stale
+    ltm_cache_invalidate(pLTI_ID);
+
     // if remove children, disconnect ltm -> no existing edges
     // else, need to query number of existing edges
     uint64_t existing_edges = 0;
@@ -308,6 +312,7 @@ void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remo
                 SQL->act_set->bind_double(1, web_act);
                 SQL->act_set->bind_int(2, pLTI_ID);
                 SQL->act_set->execute(soar_module::op_reinit);
+                posting_ltm_activated(pLTI_ID, web_act);
             }
         }
     }
@@ -345,6 +350,7 @@ void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remo
                     SQL->web_add->bind_int(4, SMEM_AUGMENTATIONS_NULL);
                     SQL->web_add->bind_double(5, web_act);
                     SQL->web_add->execute(soar_module::op_reinit);
+                    posting_edge_added(pLTI_ID, p->first, p->second, SMEM_AUGMENTATIONS_NULL, web_act);
                 }
 
                 // update counter
@@ -383,6 +389,7 @@ void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remo
                     SQL->web_add->bind_int(4, p->second);
                     SQL->web_add->bind_double(5, web_act);
                     SQL->web_add->execute(soar_module::op_reinit);
+                    posting_edge_added(pLTI_ID, p->first, SMEM_AUGMENTATIONS_NULL, p->second, web_act);
                 }
 
                 // update counter
@@ -13,6 +13,8 @@
 #include "stl_typedefs.h"
 
 #include <queue>
+#include <set>
+#include <unordered_map>
 
 typedef struct smem_data_struct
 {   uint64_t                last_cmd_time[2];          // last update to smem.command
@@ -72,6 +74,165 @@ struct smem_compare_activated_lti
 typedef std::priority_queue<smem_weighted_cue_element*, std::vector<smem_weighted_cue_element*>, smem_compare_weighted_cue_elements>    smem_prioritized_weighted_cue;
 typedef std::priority_queue< smem_activated_lti, std::vector<smem_activated_lti>, smem_compare_activated_lti>                           smem_prioritized_activated_lti_queue;
 
+// one augmentation of a cached LTM, in the column order of web_expand
+typedef struct smem_cached_child_struct
+{   byte                    attr_type;
+    smem_hash_id            attr_hash;
+    byte                    value_type;
+    smem_hash_id            value_hash;
+    uint64_t                value_lti;
+} smem_cached_child;
+
+// working-set copy of an LTM's smem_lti/smem_activation_history rows
+// (and, once retrieved, its augmentations); dirty fields are written
+// back on commit, before anything reads them through SQL, and on eviction
+typedef struct smem_cached_ltm_struct
+{   uint64_t                lti_id;
+    uint64_t                num_edges;
+
+    uint64_t                access_n;
+    uint64_t                access_t;
+    uint64_t                access_1;
+    bool                    access_dirty;
+
+    int64_t                 history[SMEM_ACT_HISTORY_ENTRIES];
+    bool                    history_loaded;
+    bool                    history_dirty;
+
+    double                  activation;
+    bool                    activation_on_edges;
+    bool                    activation_dirty;
+
+    std::vector<smem_cached_child> children;
+    bool                    children_loaded;
+
+    bool                    referenced;
+    bool                    queued;
+} smem_cached_ltm;
+
+typedef std::unordered_map<uint64_t, smem_cached_ltm*> smem_ltm_cache_map;
+
+// in-memory copy of activations_total/activations_first and the activation
+// history of every LTM, one column per field, indexed by lti_id, so that
+// base-level activation never has to read smem_activation_history
+typedef struct smem_history_store_struct
+{   bool                    loaded;
+    std::vector<uint64_t>   access_n;
+    std::vector<int64_t>    access_1;
+    std::vector<int64_t>    history[SMEM_ACT_HISTORY_ENTRIES];
+
+    // gathered inputs/outputs of the batched kernel, reused between calls
+    std::vector<double>     batch_age[SMEM_ACT_HISTORY_ENTRIES];
+    std::vector<double>     batch_n;
+    std::vector<double>     batch_first;
+    std::vector<double>     batch_act;
+} smem_history_store;
+
+// an ltm instantiated in working memory, and the spread it contributes to
+// other ltms (kept so that it can be withdrawn without walking the graph)
+typedef struct smem_spread_source_struct
+{   uint64_t                                        instances;
+    bool                                            spreading;
+    std::vector<std::pair<uint64_t, double> >       contributions;
+} smem_spread_source;
+
+// total spread an ltm receives, and from how many sources
+typedef struct smem_spread_value_struct
+{   double                                          amount;
+    uint64_t                                        sources;
+} smem_spread_value;
+
+typedef std::unordered_map<uint64_t, smem_spread_source> smem_spread_source_map;
+typedef std::unordered_map<uint64_t, smem_spread_value> smem_spread_value_map;
+typedef std::unordered_map<Symbol*, std::pair<uint64_t, uint64_t> > smem_spread_instance_map;
+
+// an edge in one of the query index's posting lists, which are kept in the
+// order the activation indices on smem_augmentations hand edges to a web
+// crawl: activation descending, then the most recently added edge first
+typedef struct smem_posting_struct
+{   double                  activation;
+    uint64_t                seq;
+    uint64_t                lti_id;
+} smem_posting;
+
+struct smem_posting_order
+{
+    bool operator()(const smem_posting& a, const smem_posting& b) const
+    {
+        if (a.activation != b.activation) return (a.activation > b.activation);
+        return (a.seq > b.seq);
+    }
+};
+
+typedef std::set<smem_posting, smem_posting_order> smem_posting_list;
+
+// what a posting list is for: an attribute (both values NULL), an
+// attribute/constant pair or an attribute/lti pair, as in a cue element
+typedef struct smem_posting_key_struct
+{   smem_hash_id            attr;
+    smem_hash_id            value_const;
+    uint64_t                value_lti;
+
+    bool operator==(const smem_posting_key_struct& other) const
+    {
+        return ((attr == other.attr) && (value_const == other.value_const) && (value_lti == other.value_lti));
+    }
+} smem_posting_key;
+
+struct smem_posting_key_hash
+{
+    size_t operator()(const smem_posting_key& key) const
+    {
+        return static_cast<size_t>((key.attr * 0x9E3779B97F4A7C15ULL) ^ (key.value_const * 0xC2B2AE3D27D4EB4FULL) ^ key.value_lti);
+    }
+};
+
+// the edges of one ltm as they appear in the posting lists
+typedef struct smem_posting_edge_struct
+{   smem_posting_key        key;
+    uint64_t                seq;
+    double                  activation;
+} smem_posting_edge;
+
+typedef struct smem_posting_index_struct
+{   bool                                                                            loaded;
+    uint64_t                                                                        next_seq;
+    std::unordered_map<smem_posting_key, smem_posting_list, smem_posting_key_hash>  lists;
+    std::unordered_map<uint64_t, std::vector<smem_posting_edge> >                   edges;
+} smem_posting_index;
+
+// a walk over the candidates for a cue element, in activation order, from
+// either the query index or a web crawl of the database
+typedef struct smem_crawl_struct
+{   soar_module::sqlite_statement*      q;
+    smem_posting_list*                  list;
+    smem_posting_list::iterator         pos;
+    uint64_t                            lti_id;
+    double                              activation;
+} smem_crawl;
+
+// one (@lti ^attr value) edge read by a bulk import; attr and a constant
+// value are indices into the import's own symbol table until they are
+// resolved to smem hashes, after which triples sort by subject and attribute
+typedef struct smem_import_triple_struct
+{   uint64_t                lti_id;
+    uint64_t                attr;
+    uint64_t                value;
+    bool                    value_is_lti;
+
+    bool operator<(const smem_import_triple_struct& other) const
+    {
+        if (lti_id != other.lti_id) return (lti_id < other.lti_id);
+        if (attr != other.attr) return (attr < other.attr);
+        if (value_is_lti != other.value_is_lti) return (value_is_lti < other.value_is_lti);
+        return (value < other.value);
+    }
+    bool operator==(const smem_import_triple_struct& other) const
+    {
+        return ((lti_id == other.lti_id) && (attr == other.attr) && (value == other.value) && (value_is_lti == other.value_is_lti));
+    }
+} smem_import_triple;
+
 typedef union ltm_value_union
 {
     struct ltm_value_const       val_const;
@@ -129,6 +129,7 @@ void load_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "load library %-<filename> <args...>\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "load rete-network %---load <filename>\n");
+    outputManager->printa_sf(thisAgent, "load rete-network %---clone <agent>\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "load percepts %---open <filename>\n");
     outputManager->printa_sf(thisAgent, "load percepts %---close\n");
@@ -196,6 +197,8 @@ production_param_container::production_param_container(agent* new_agent): soar_m
     add(memories_cmd);
     multi_attributes_cmd = new soar_module::boolean_param("optimize-attribute", on, new soar_module::f_predicate<boolean>());
     add(multi_attributes_cmd);
+    profile_cmd = new soar_module::boolean_param("profile", on, new soar_module::f_predicate<boolean>());
+    add(profile_cmd);
     break_cmd = new soar_module::boolean_param("break", on, new soar_module::f_predicate<boolean>());
     add(break_cmd);
     find_cmd = new soar_module::boolean_param("find", on, new soar_module::f_predicate<boolean>());
@@ -249,6 +252,9 @@ void production_param_container::print_settings(agent* thisAgent)
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "production optimize-attribute [symbol [n]]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
+    outputManager->printa_sf(thisAgent, "production profile %-[--enable --disable --clear]\n");
+    outputManager->printa_sf(thisAgent, "production profile %-[n]\n");
+    outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "production watch %-[--disable --enable] <prod-name>\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n\n");
     outputManager->printa_sf(thisAgent, "For a detailed explanation of sub-commands:    help production\n");
@@ -324,6 +330,7 @@ void wm_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "              %-            decay-thresh  | forgetting\n");
     outputManager->printa_sf(thisAgent, "              %-            forget-wme    | max-pow-cache\n");
     outputManager->printa_sf(thisAgent, "              %-            petrov-approx | timers\n");
+    outputManager->printa_sf(thisAgent, "              %-            decay-fast-math\n");
     outputManager->printa_sf(thisAgent, "wm activation %---stats [<statistic>]     \n");
     outputManager->printa_sf(thisAgent, "              %-<statistic> = forgotten-wmes\n");
     outputManager->printa_sf(thisAgent, "wm activation %---timers [<timer>]        \n");
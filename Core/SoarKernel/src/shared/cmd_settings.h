@@ -59,6 +59,7 @@ class production_param_container: public soar_module::param_container
         soar_module::boolean_param* matches_cmd;
         soar_module::boolean_param* memories_cmd;
         soar_module::boolean_param* multi_attributes_cmd;
+        soar_module::boolean_param* profile_cmd;
         soar_module::boolean_param* break_cmd;
         soar_module::boolean_param* find_cmd;
         soar_module::boolean_param* watch_cmd;
@@ -118,6 +118,7 @@ enum Decider_settings {
     DECIDER_KEEP_TOP_OPREFS,
     DECIDER_MAX_GP,
     DECIDER_MAX_DC_TIME,
+    DECIDER_SLOW_DC_TIME,
     DECIDER_MAX_ELABORATIONS,
     DECIDER_MAX_GOAL_DEPTH,
     DECIDER_MAX_MEMORY_USAGE,
@@ -297,7 +298,6 @@ MP_rl_info,
 MP_rl_et,
 MP_rl_rule,
 MP_wma_decay_element,
-MP_wma_decay_set,
 MP_wma_wme_oset,
 MP_wma_slot_refs,
 MP_epmem_wmes,
@@ -528,7 +528,7 @@ enum epmem_variable_key
 {
     var_rit_offset_1, var_rit_leftroot_1, var_rit_rightroot_1, var_rit_minstep_1,
     var_rit_offset_2, var_rit_leftroot_2, var_rit_rightroot_2, var_rit_minstep_2,
-    var_next_id
+    var_next_id, var_retention_through
 };
 
 enum smem_query_levels { qry_search, qry_full };
@@ -85,6 +85,8 @@ class Explanation_Based_Chunker;
 class ebc_timer_container;
 class Repair_Path;
 class Explanation_Memory;
+class Timeline;
+class decision_latency;
 class action_record;
 class chunk_record;
 class chunk_record;
@@ -112,6 +114,7 @@ class rl_stat_container;
 class SMem_Manager;
 class MathQuery;
 class smem_db_lib_version_stat;
+class smem_ltm_cache_hit_rate_stat;
 class smem_mem_high_stat;
 class smem_mem_usage_stat;
 class smem_param_container;
@@ -45,6 +45,8 @@ Memory_Manager::Memory_Manager()
 //    std::cout << "MemPool Manager constructor called.\n";
 
     memory_for_usage_overhead = memory_for_usage + STATS_OVERHEAD_MEM_USAGE;
+    memory_pools_in_use = NIL;
+    m_concurrent = false;
 
     dprint(DT_SOAR_INSTANCE, "init_MemPool_Manager called.\n");
 
@@ -128,6 +130,7 @@ void Memory_Manager::init_memory_pool(MemoryPoolType mempool_index, size_t item_
 
 memory_pool* Memory_Manager::get_memory_pool(size_t size)
 {
+    pool_lock lLock(this);
     memory_pool* return_val = NULL;
 
     std::unordered_map< size_t, memory_pool* >::iterator it = dyn_memory_pools.find(size);
@@ -171,6 +174,30 @@ void Memory_Manager::free_memory_pool(MemoryPoolType mempool_index)
     free_memory_pool_by_ptr(&(memory_pools[mempool_index]));
 }
 
+/* Gives back the blocks of every pool whose items are all on its free list.
+ * Called on init-soar, after working memory has been cleared, so that an
+ * agent doesn't keep the high-water mark of its last run.  Pools that still
+ * have items in use (rete nodes, productions, etc.) are left alone. */
+void Memory_Manager::free_unused_memory_pools()
+{
+    pool_lock lLock(this);
+    for (memory_pool* lThisPool = memory_pools_in_use; lThisPool != NIL; lThisPool = lThisPool->next)
+    {
+        if (!lThisPool->num_blocks) continue;
+
+        size_t lCapacity = lThisPool->num_blocks * lThisPool->items_per_block;
+        size_t lNumFree = 0;
+        for (void* lItem = lThisPool->free_list; lItem && (lNumFree <= lCapacity); lItem = *(void**)lItem)
+        {
+            lNumFree++;
+        }
+        if (lNumFree == lCapacity)
+        {
+            free_memory_pool_by_ptr(lThisPool);
+        }
+    }
+}
+
 /* This is only called by the CLI DoAllocate command */
 bool Memory_Manager::add_block_to_memory_pool_by_name(const std::string& pool_name, int blocks)
 {
@@ -196,6 +223,7 @@ bool Memory_Manager::add_block_to_memory_pool_by_name(const std::string& pool_na
 
 void Memory_Manager::add_block_to_memory_pool(memory_pool* pThisPool)
 {
+    pool_lock lLock(this);
     char* new_block;
     size_t size, i, item_num, interleave_factor;
     char* item, *prev_item;
@@ -269,6 +297,7 @@ thisAgent->Decider->settings[DECIDER_MAX_MEMORY_USAGE]);
 
 void* Memory_Manager::allocate_memory(size_t size, int usage_code)
 {
+    pool_lock lLock(this);
     char* p;
 
     memory_for_usage[usage_code] += size;
@@ -310,6 +339,7 @@ void* Memory_Manager::allocate_memory_and_zerofill(size_t size, int usage_code)
 
 void Memory_Manager::free_memory(void* mem, int usage_code)
 {
+    pool_lock lLock(this);
     size_t size;
 
     if (mem == 0)
@@ -10,8 +10,11 @@
  * A memory manager class that decouples memory pools from the individual
  * agent.
  *
- * - MPM is a singleton like the OutputManager and SoarInstance.  It
- *   is created on Kernel creation.
+ * - Each agent owns its own MPM, created in create_soar_agent and
+ *   deleted in destroy_soar_agent, so one agent's pools are never touched
+ *   by another agent.  The shared instance returned by Get_MPM() is a
+ *   singleton like the OutputManager and SoarInstance and is only used
+ *   by the STL pool allocator.
  *
  * - MPM uses an enum list for all the core memory pool types.  Kernel
  *   calls that deal with memory pools now pass in a parameter to
@@ -32,6 +35,7 @@
 
 #include "kernel.h"
 
+#include <mutex>
 #include <unordered_map>
 
 #ifndef _WIN32
@@ -124,12 +128,14 @@ class Memory_Manager
             static Memory_Manager instance;
             return instance;
         }
+        Memory_Manager();
         virtual ~Memory_Manager();
 
         void init_memory_pool(MemoryPoolType mempool_index, size_t item_size, const char* name);
         void init_memory_pool_by_ptr(memory_pool* pThisPool, size_t item_size, const char* name);
         void free_memory_pool(MemoryPoolType mempool_index);
         void reinit_memory_pool(MemoryPoolType mempool_index);
+        void free_unused_memory_pools();
         void add_block_to_memory_pool(memory_pool* pThisPool);
         bool add_block_to_memory_pool_by_name(const std::string& pool_name, int blocks);
 
@@ -141,13 +147,16 @@ class Memory_Manager
         void print_memory_statistics();
         void debug_print_memory_stats(agent* thisAgent);
 
+        /* Set by the run scheduler while it steps agents on more than one thread.
+         * While it is on, every pool operation takes m_pool_mutex. */
+        void set_concurrent(bool pConcurrent) { m_concurrent = pConcurrent; }
+        bool is_concurrent() { return m_concurrent; }
+
         std::unordered_map< size_t, memory_pool* >   dyn_memory_pools;
 
     private:
 
-        Memory_Manager();
-
-        /* The following two functions are declared but not implemented to avoid copies of singletons */
+        /* The following two functions are declared but not implemented to avoid copies of managers */
         Memory_Manager(Memory_Manager const&) {};
         void operator=(Memory_Manager const&) {};
 
@@ -156,12 +165,26 @@ class Memory_Manager
         memory_pool*        memory_pools_in_use;
         size_t*             memory_for_usage_overhead;
 
+        bool                    m_concurrent;
+        std::recursive_mutex    m_pool_mutex;
+
         void free_memory_pool_by_ptr(memory_pool* pThisPool);
 
+        /* Holds m_pool_mutex for its lifetime, but only when the manager is in concurrent mode */
+        class pool_lock
+        {
+            public:
+                pool_lock(Memory_Manager* pMM) : m_mm(pMM->m_concurrent ? pMM : NULL) { if (m_mm) m_mm->m_pool_mutex.lock(); }
+                ~pool_lock() { if (m_mm) m_mm->m_pool_mutex.unlock(); }
+            private:
+                Memory_Manager* m_mm;
+        };
+
     public:
         template <typename T>
         inline void allocate_with_pool(MemoryPoolType mempool_index, T** dest_item_pointer)
         {
+            pool_lock lLock(this);
             memory_pool* lThisPool = &(memory_pools[mempool_index]);
 
         #if MEM_POOLS_ENABLED
@@ -199,6 +222,7 @@ class Memory_Manager
         template <typename T>
         inline void allocate_with_pool_ptr(memory_pool* pThisPool, T** dest_item_pointer)
         {
+            pool_lock lLock(this);
 
         #if MEM_POOLS_ENABLED
             // if there's no memory blocks left in the pool, then allocate a new one
@@ -235,6 +259,7 @@ class Memory_Manager
         template <typename T>
         inline void free_with_pool(MemoryPoolType mempool_index, T* item)
         {
+            pool_lock lLock(this);
             memory_pool* lThisPool = &(memory_pools[mempool_index]);
             fill_with_garbage((item), lThisPool->item_size);
 //            fill_with_zeroes((item), lThisPool->item_size);
@@ -257,6 +282,7 @@ class Memory_Manager
         template <typename T>
         inline void free_with_pool_ptr(memory_pool* pThisPool, T* item)
         {
+            pool_lock lLock(this);
             fill_with_garbage((item), pThisPool->item_size);
 //            fill_with_zeroes((item), pThisPool->item_size);
         #if MEM_POOLS_ENABLED
@@ -321,7 +347,6 @@ class Memory_Manager
 //        memory_pool         rl_rule_pool;
 //
 //        memory_pool         wma_decay_element_pool;
-//        memory_pool         wma_decay_set_pool;
 //        memory_pool         wma_wme_oset_pool;
 //        memory_pool         wma_slot_refs_pool;
 //
@@ -300,6 +300,10 @@ namespace soar_module
             {
                 return static_cast<int64_t>(sqlite3_last_insert_rowid(my_db));
             }
+            inline int64_t changes()
+            {
+                return static_cast<int64_t>(sqlite3_changes(my_db));
+            }
             inline int64_t memory_usage()
             {
                 return static_cast<int64_t>(sqlite3_memory_used());
@@ -1,28 +1,40 @@
 #include "soar_rand.h"
 
+#include "agent.h"
+
+#include <mutex>
+
+/* The process-wide generator.  Agents draw from their own (see below), but
+ * they are created and seeded from this one on whatever thread the client
+ * uses, so all access is serialized. */
 static MTRand gSoarRand;
+static std::mutex gSoarRandMutex;
 
 // real number in [0,1]
 double SoarRand()
 {
+    std::lock_guard<std::mutex> lLock(gSoarRandMutex);
     return gSoarRand.rand();
 }
 
 // real number in [0,n]
 double SoarRand(const double& max)
 {
+    std::lock_guard<std::mutex> lLock(gSoarRandMutex);
     return gSoarRand.rand(max);
 }
 
 // integer in [0,2^32-1]
 uint32_t SoarRandInt()
 {
+    std::lock_guard<std::mutex> lLock(gSoarRandMutex);
     return gSoarRand.randInt();
 }
 
 // integer in [0,n] for n < 2^32
 uint32_t SoarRandInt(const uint32_t& max)
 {
+    std::lock_guard<std::mutex> lLock(gSoarRandMutex);
     return gSoarRand.randInt(max);
 }
 
@@ -30,11 +42,45 @@ uint32_t SoarRandInt(const uint32_t& max)
 // automatically seed with a value based on the time or /dev/urandom
 void SoarSeedRNG()
 {
+    std::lock_guard<std::mutex> lLock(gSoarRandMutex);
     gSoarRand.seed();
 }
 
 // seed with a provided value
 void SoarSeedRNG(const uint32_t seed)
 {
+    std::lock_guard<std::mutex> lLock(gSoarRandMutex);
     gSoarRand.seed(seed);
 }
+
+// agent's generator: only the thread stepping the agent draws from it
+
+double SoarRand(agent* thisAgent)
+{
+    return thisAgent->rand_gen->rand();
+}
+
+double SoarRand(agent* thisAgent, const double& max)
+{
+    return thisAgent->rand_gen->rand(max);
+}
+
+uint32_t SoarRandInt(agent* thisAgent)
+{
+    return thisAgent->rand_gen->randInt();
+}
+
+uint32_t SoarRandInt(agent* thisAgent, const uint32_t& max)
+{
+    return thisAgent->rand_gen->randInt(max);
+}
+
+void SoarSeedRNG(agent* thisAgent)
+{
+    thisAgent->rand_gen->seed();
+}
+
+void SoarSeedRNG(agent* thisAgent, const uint32_t seed)
+{
+    thisAgent->rand_gen->seed(seed);
+}
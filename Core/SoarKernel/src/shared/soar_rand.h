@@ -491,6 +491,17 @@ EXPORT void SoarSeedRNG();
 // seed with a provided value
 EXPORT void SoarSeedRNG(const uint32_t seed);
 
+// The same, using the agent's own generator.  Every agent has one, so agents
+// stepped on different threads never share a generator, and an agent given a
+// seed draws the same sequence however the other agents are scheduled.  A new
+// agent's generator is seeded from the process-wide one above.
+EXPORT double SoarRand(agent* thisAgent);
+EXPORT double SoarRand(agent* thisAgent, const double& max);
+EXPORT uint32_t SoarRandInt(agent* thisAgent);
+EXPORT uint32_t SoarRandInt(agent* thisAgent, const uint32_t& max);
+EXPORT void SoarSeedRNG(agent* thisAgent);
+EXPORT void SoarSeedRNG(agent* thisAgent, const uint32_t seed);
+
 #endif  // SOAR_RAND_H
 
 // Change log:
@@ -1,6 +1,7 @@
 #include "stats.h"
 
 #include "agent.h"
+#include "decider.h"
 #include "misc.h"
 #include "output_manager.h"
 #include "working_memory.h"
@@ -132,7 +133,184 @@ uint64_t get_derived_kernel_time_usec(agent* thisAgent)
 #endif
 }
 
+static inline uint64_t latency_bucket(uint64_t usec)
+{
+    if (usec < LATENCY_SUB_BUCKETS)
+    {
+        return usec;
+    }
 
+    /* shift the value down until it lands in the top half of the sub-buckets */
+    uint64_t shift = 1;
+    while ((usec >> shift) >= LATENCY_SUB_BUCKETS)
+    {
+        shift++;
+    }
 
+    uint64_t bucket = LATENCY_SUB_BUCKETS + (shift - 1) * (LATENCY_SUB_BUCKETS / 2) + ((usec >> shift) - (LATENCY_SUB_BUCKETS / 2));
+    return (bucket < LATENCY_BUCKETS) ? bucket : (LATENCY_BUCKETS - 1);
+}
 
+/* Largest value that falls in the bucket */
+static inline uint64_t latency_bucket_value(uint64_t bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    uint64_t offset = bucket - LATENCY_SUB_BUCKETS;
+    uint64_t shift = offset / (LATENCY_SUB_BUCKETS / 2) + 1;
+    uint64_t sub = offset % (LATENCY_SUB_BUCKETS / 2) + (LATENCY_SUB_BUCKETS / 2);
+
+    return ((sub + 1) << shift) - 1;
+}
+
+void latency_histogram::reset()
+{
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        counts[i] = 0;
+    }
+    count = total = max = 0;
+}
+
+void latency_histogram::record(uint64_t usec)
+{
+    counts[latency_bucket(usec)]++;
+    count++;
+    total += usec;
+    if (usec > max)
+    {
+        max = usec;
+    }
+}
+
+uint64_t latency_histogram::get_percentile(double pct)
+{
+    if (!count)
+    {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>((pct / 100.0) * count + 0.5);
+    if (target < 1)
+    {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint64_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= target)
+        {
+            uint64_t value = latency_bucket_value(i);
+            return (value < max) ? value : max;
+        }
+    }
+    return max;
+}
 
+decision_latency::decision_latency()
+{
+    ticks_per_usec = get_raw_time_per_usec();
+    reset();
+}
+
+void decision_latency::reset()
+{
+    dc_wall.reset();
+    dc_cpu.reset();
+    for (int i = 0; i < NUM_PHASE_TYPES; i++)
+    {
+        phase_wall[i].reset();
+        cycle_ticks[i] = 0;
+        cycle_ran[i] = false;
+    }
+    cycle_started = false;
+    cycle_incomplete = false;
+    in_phase = false;
+    slow_count = 0;
+}
+
+void decision_latency::start_phase(agent* thisAgent)
+{
+    if (!thisAgent->timers_enabled)
+    {
+        /* a cycle that was only partly timed would look faster than it was */
+        cycle_incomplete = true;
+        in_phase = false;
+        return;
+    }
+
+    if (!cycle_started)
+    {
+        cycle_start_cpu = get_thread_cpu_usec();
+        cycle_started = true;
+    }
+    in_phase = true;
+    phase_start_ticks = get_raw_time();
+}
+
+void decision_latency::stop_phase(agent* thisAgent, top_level_phase phase)
+{
+    if (in_phase)
+    {
+        cycle_ticks[phase] += get_raw_time() - phase_start_ticks;
+        cycle_ran[phase] = true;
+        in_phase = false;
+    }
+
+    if (phase == OUTPUT_PHASE)
+    {
+        finish_cycle(thisAgent);
+    }
+}
+
+void decision_latency::finish_cycle(agent* thisAgent)
+{
+    if (!cycle_incomplete && cycle_started)
+    {
+        uint64_t wall_usec = 0;
+        top_level_phase slowest_phase = OUTPUT_PHASE;
+        uint64_t slowest_usec = 0;
+
+        for (int i = 0; i < NUM_PHASE_TYPES; i++)
+        {
+            if (cycle_ran[i])
+            {
+                uint64_t phase_usec = static_cast<uint64_t>(cycle_ticks[i] / ticks_per_usec);
+                phase_wall[i].record(phase_usec);
+                wall_usec += phase_usec;
+                if (phase_usec >= slowest_usec)
+                {
+                    slowest_usec = phase_usec;
+                    slowest_phase = static_cast<top_level_phase>(i);
+                }
+            }
+        }
+        dc_wall.record(wall_usec);
+        dc_cpu.record(get_thread_cpu_usec() - cycle_start_cpu);
+
+        uint64_t threshold = thisAgent->Decider->settings[DECIDER_SLOW_DC_TIME];
+        if ((threshold > 0) && (wall_usec >= threshold))
+        {
+            /* the output phase has already advanced the cycle count */
+            slow_decision* s = &(slow[slow_count % LATENCY_SLOW_DECISIONS]);
+            s->d_cycle = thisAgent->d_cycle_count - 1;
+            s->wall_usec = wall_usec;
+            s->phase = slowest_phase;
+            s->phase_usec = slowest_usec;
+            slow_count++;
+        }
+    }
+
+    for (int i = 0; i < NUM_PHASE_TYPES; i++)
+    {
+        cycle_ticks[i] = 0;
+        cycle_ran[i] = false;
+    }
+    cycle_started = false;
+    cycle_incomplete = false;
+}
@@ -50,6 +50,95 @@ class stats_statement_container: public soar_module::sqlite_statement_container
 extern void stats_db_store(agent* thisAgent, const uint64_t& dc_time, const uint64_t& dc_wm_changes, const uint64_t& dc_firing_counts);
 extern void stats_close(agent* thisAgent);
 
+//////////////////////////////////////////////////////////
+// Decision cycle latency
+//////////////////////////////////////////////////////////
+
+/* A log-linear ("HDR") histogram of microsecond values.  Values below
+ * LATENCY_SUB_BUCKETS get a bucket each; above that, every power of two is
+ * split into LATENCY_SUB_BUCKETS / 2 equal buckets, so any recorded value
+ * is known to within 1/64th (about 1.5%) while the whole range up to
+ * 2^LATENCY_MAX_BITS usec (twelve days) fits in a couple of thousand
+ * counters.  Recording is a few shifts and an increment. */
+
+#define LATENCY_SUB_BUCKET_BITS 7
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_BITS 40
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS + (LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS) * (LATENCY_SUB_BUCKETS / 2))
+
+class latency_histogram
+{
+    public:
+        latency_histogram() { reset(); }
+
+        void reset();
+        void record(uint64_t usec);
+
+        /* Smallest recorded value that pct percent of the values are at or below */
+        uint64_t get_percentile(double pct);
+        uint64_t get_count() { return count; }
+        uint64_t get_max() { return max; }
+        double get_mean() { return count ? (static_cast<double>(total) / count) : 0; }
+
+    private:
+        uint64_t counts[LATENCY_BUCKETS];
+        uint64_t count;
+        uint64_t total;
+        uint64_t max;
+};
+
+/* Most recent decisions that went over the slow-dc-time threshold */
+#define LATENCY_SLOW_DECISIONS 16
+
+typedef struct slow_decision_struct
+{
+    uint64_t        d_cycle;
+    uint64_t        wall_usec;
+    top_level_phase phase;          // phase that took the most time
+    uint64_t        phase_usec;
+} slow_decision;
+
+/* Wall and CPU time of whole decision cycles and wall time of each phase
+ * in them.  A phase can run several times in one decision when Soar is run
+ * by elaborations or phases, so times are summed over the cycle and
+ * recorded when its output phase ends.  Wall time between runs does not
+ * count.  Reading the thread's CPU clock is a system call of about a third
+ * of a microsecond, so CPU time is read only when the cycle starts and
+ * ends; a cycle split across runs also counts what the thread did between
+ * them. */
+class decision_latency
+{
+    public:
+        decision_latency();
+
+        latency_histogram dc_wall;
+        latency_histogram dc_cpu;
+        latency_histogram phase_wall[NUM_PHASE_TYPES];
+
+        uint64_t        slow_count;
+        slow_decision   slow[LATENCY_SLOW_DECISIONS];
+
+        void start_phase(agent* thisAgent);
+        void stop_phase(agent* thisAgent, top_level_phase phase);
+        void reset();
+
+        /* The slow decisions in the order they happened */
+        uint64_t get_slow_count() { return (slow_count < LATENCY_SLOW_DECISIONS) ? slow_count : LATENCY_SLOW_DECISIONS; }
+        slow_decision* get_slow(uint64_t i) { return &(slow[(slow_count - get_slow_count() + i) % LATENCY_SLOW_DECISIONS]); }
+
+    private:
+        bool        in_phase;
+        uint64_t    phase_start_ticks;
+        uint64_t    cycle_ticks[NUM_PHASE_TYPES];
+        bool        cycle_ran[NUM_PHASE_TYPES];
+        bool        cycle_started;
+        uint64_t    cycle_start_cpu;
+        bool        cycle_incomplete;
+        double      ticks_per_usec;
+
+        void finish_cycle(agent* thisAgent);
+};
+
 /* derived_kernel_time := Total of the time spent in the phases of the decision cycle,
 excluding Input Function, Output function, and pre-defined callbacks.
 This computed time should be roughly equal to total_kernel_time,
@@ -45,10 +45,6 @@ struct IDSetLessThan;
     typedef std::set< production_record*, std::less< production_record* >,
                       soar_module::soar_memory_pool_allocator< production_record* > >                               production_record_set;
     typedef std::set< Symbol*, std::less< Symbol* >, soar_module::soar_memory_pool_allocator< Symbol* > >           symbol_set;
-    typedef std::set< wma_decay_element*, std::less< wma_decay_element* >,
-                      soar_module::soar_memory_pool_allocator< wma_decay_element* > >                               wma_decay_set;
-    typedef std::set< wma_d_cycle, std::less< wma_d_cycle >,
-                      soar_module::soar_memory_pool_allocator< wma_d_cycle > >                                      wma_decay_cycle_set;
     typedef std::set< wme*, std::less< wme* >, soar_module::soar_memory_pool_allocator< wme* > >                    wme_set;
 
     typedef std::map< Symbol*, Symbol*, std::less< Symbol* >,
@@ -58,8 +54,6 @@ struct IDSetLessThan;
     typedef std::map< production*, double, std::less< production* >,
                       soar_module::soar_memory_pool_allocator< std::pair< production*, double > > >                 rl_et_map;
 
-    typedef std::map< wma_d_cycle, wma_decay_set*, std::less< wma_d_cycle >,
-                      soar_module::soar_memory_pool_allocator< std::pair< wma_d_cycle, wma_decay_set* > > >         wma_forget_p_queue;
     typedef std::map< Symbol*, uint64_t, std::less< Symbol* >,
                       soar_module::soar_memory_pool_allocator< std::pair< Symbol*, uint64_t > > >                   wma_sym_reference_map;
 
@@ -89,14 +83,11 @@ struct IDSetLessThan;
     typedef std::set< instantiation* >                          inst_set;
     typedef std::set< production_record* >                      production_record_set;
     typedef std::set< Symbol* >                                 symbol_set;
-    typedef std::set< wma_decay_element* >                      wma_decay_set;
-    typedef std::set< wma_d_cycle >                             wma_decay_cycle_set;
     typedef std::set< wme* >                                    wme_set;
 
     typedef std::map< production*, double >                     rl_et_map;
     typedef std::map< Symbol*, Symbol* >                        rl_symbol_map;
     typedef std::set< rl_symbol_map >                           rl_symbol_map_set;
-    typedef std::map< wma_d_cycle, wma_decay_set* >             wma_forget_p_queue;
     typedef std::map< Symbol*, uint64_t >                       wma_sym_reference_map;
 
 #endif
@@ -198,5 +189,6 @@ struct IDSetLessThan;
     #endif
 
 typedef std::pair< double, uint64_t >                   smem_activated_lti;
+typedef std::vector< wma_decay_element* >               wma_decay_pool;
 
 #endif /* STL_TYPEDEFS_H_ */
@@ -0,0 +1,145 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* -- timeline.cpp
+ *
+ *    Decision cycle event ring and its Chrome trace writer.  See timeline.h.
+ *
+ */
+
+#include "timeline.h"
+
+#include "agent.h"
+#include "callback.h"
+
+#include <fstream>
+#include <iomanip>
+
+const char* timeline_category_names[NUM_TIMELINE_CATEGORIES] =
+{
+    "input", "propose", "decision", "apply", "output", "preference", "working-memory",
+    "match", "chunking", "epmem", "smem", "wma", "rl", "callback"
+};
+
+Timeline::Timeline(agent* myAgent)
+{
+    thisAgent = myAgent;
+    enabled = false;
+    events = new timeline_event[TIMELINE_CAPACITY];
+    next_event = 0;
+}
+
+Timeline::~Timeline()
+{
+    delete[] events;
+}
+
+void Timeline::record(uint8_t category, uint8_t type, uint16_t detail)
+{
+    timeline_event* e = &(events[next_event & (TIMELINE_CAPACITY - 1)]);
+
+    e->ticks = get_raw_time();
+    e->d_cycle = static_cast<uint32_t>(thisAgent->d_cycle_count);
+    e->detail = detail;
+    e->category = category;
+    e->type = type;
+
+    next_event++;
+}
+
+void Timeline::clear()
+{
+    next_event = 0;
+}
+
+uint64_t Timeline::size()
+{
+    return (next_event < TIMELINE_CAPACITY) ? next_event : TIMELINE_CAPACITY;
+}
+
+static void timeline_write_string(std::ofstream& out, const char* str)
+{
+    out << '"';
+    for (const char* c = str; *c; c++)
+    {
+        if ((*c == '"') || (*c == '\\'))
+        {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+bool Timeline::dump(const char* pFileName, std::string& pError)
+{
+    std::ofstream out(pFileName);
+    if (!out)
+    {
+        pError = "Could not open file for writing: ";
+        pError.append(pFileName);
+        return false;
+    }
+
+    uint64_t first = next_event - size();
+    double ticks_per_usec = get_raw_time_per_usec();
+    uint64_t base_ticks = (first < next_event) ? events[first & (TIMELINE_CAPACITY - 1)].ticks : 0;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":";
+    timeline_write_string(out, thisAgent->name);
+    out << "}}";
+
+    out << std::fixed << std::setprecision(3);
+
+    /* Once the ring has wrapped, the oldest events can be the ends of
+     * phases whose beginnings were overwritten.  Viewers expect every end
+     * to close a begin, so those are dropped. */
+    uint64_t depth = 0;
+    for (uint64_t i = first; i < next_event; i++)
+    {
+        timeline_event* e = &(events[i & (TIMELINE_CAPACITY - 1)]);
+
+        if (e->type == TIMELINE_END)
+        {
+            if (depth == 0)
+            {
+                continue;
+            }
+            depth--;
+        }
+        else
+        {
+            depth++;
+        }
+
+        const char* name = NULL;
+        if (e->category == TIMELINE_CALLBACK)
+        {
+            name = soar_callback_enum_to_name(static_cast<SOAR_CALLBACK_TYPE>(e->detail), false);
+        }
+        if (!name)
+        {
+            name = timeline_category_names[e->category];
+        }
+
+        out << ",\n{\"name\":";
+        timeline_write_string(out, name);
+        out << ",\"cat\":\"" << ((e->category < NUM_PHASE_TYPES) ? "phase" : timeline_category_names[e->category]) << "\"";
+        out << ",\"ph\":\"" << ((e->type == TIMELINE_BEGIN) ? "B" : "E") << "\"";
+        out << ",\"ts\":" << ((e->ticks - base_ticks) / ticks_per_usec);
+        out << ",\"pid\":1,\"tid\":1,\"args\":{\"decision\":" << e->d_cycle << "}}";
+    }
+
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        pError = "Error writing to file: ";
+        pError.append(pFileName);
+        return false;
+    }
+    return true;
+}
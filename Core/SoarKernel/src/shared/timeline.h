@@ -0,0 +1,120 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* -- timeline.h
+ *
+ *    A flight recorder for the decision cycle.  Every agent keeps a fixed
+ *    size ring of compact begin/end events for each phase and for the
+ *    modules that run inside them (match, chunking, epmem, smem, wma, rl
+ *    and client callbacks).  Recording an event is a clock read and a
+ *    16-byte store into the next slot.  A decision records 16-20 events,
+ *    so the ring holds roughly the last thousand decisions, and the clock
+ *    reads add about a microsecond to each one.  That is a noticeable share
+ *    of a cheap decision, so recording is off until "soar timeline on".  An
+ *    agent only ever records from the thread that runs it, so the ring
+ *    needs no locks.
+ *
+ *    When something slow happens, "stats --timeline <file>" writes the ring
+ *    out in the Chrome trace event format, which chrome://tracing, Perfetto
+ *    and speedscope can all display as a timeline.
+ *
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include "kernel.h"
+
+#include <string>
+
+/* The first NUM_PHASE_TYPES categories are the top_level_phase values */
+enum timeline_category
+{
+    TIMELINE_MATCH = NUM_PHASE_TYPES,
+    TIMELINE_EBC,
+    TIMELINE_EPMEM,
+    TIMELINE_SMEM,
+    TIMELINE_WMA,
+    TIMELINE_RL,
+    TIMELINE_CALLBACK,
+    NUM_TIMELINE_CATEGORIES
+};
+
+enum timeline_event_type
+{
+    TIMELINE_BEGIN = 0,
+    TIMELINE_END
+};
+
+/* Must stay a power of two */
+#define TIMELINE_CAPACITY 16384
+
+typedef struct timeline_event_struct
+{
+    uint64_t ticks;             // get_raw_time()
+    uint32_t d_cycle;
+    uint16_t detail;            // callback type for TIMELINE_CALLBACK
+    uint8_t  category;
+    uint8_t  type;
+} timeline_event;
+
+class Timeline
+{
+    public:
+
+        Timeline(agent* myAgent);
+        ~Timeline();
+
+        bool enabled;
+
+        inline void begin(uint8_t category, uint16_t detail = 0)
+        {
+            if (enabled)
+            {
+                record(category, TIMELINE_BEGIN, detail);
+            }
+        }
+        inline void end(uint8_t category, uint16_t detail = 0)
+        {
+            if (enabled)
+            {
+                record(category, TIMELINE_END, detail);
+            }
+        }
+
+        void clear();
+        uint64_t size();
+
+        /* Writes the recorded events to pFileName as Chrome trace JSON */
+        bool dump(const char* pFileName, std::string& pError);
+
+    private:
+
+        agent*          thisAgent;
+        timeline_event* events;
+        uint64_t        next_event;
+
+        void record(uint8_t category, uint8_t type, uint16_t detail);
+};
+
+/* Brackets a module call that can return from several places */
+class timeline_scope
+{
+    public:
+        timeline_scope(Timeline* pTimeline, uint8_t pCategory): timeline(pTimeline), category(pCategory)
+        {
+            timeline->begin(category);
+        }
+        ~timeline_scope()
+        {
+            timeline->end(category);
+        }
+
+    private:
+        Timeline* timeline;
+        uint8_t   category;
+};
+
+#endif // TIMELINE_H
@@ -58,8 +58,10 @@
 #include "smem_structs.h"
 #include "soar_instance.h"
 #include "soar_module.h"
+#include "soar_rand.h"
 #include "stats.h"
 #include "symbol.h"
+#include "timeline.h"
 #include "trace.h"
 #include "working_memory_activation.h"
 #include "working_memory.h"
@@ -115,7 +117,6 @@ void init_soar_agent(agent* thisAgent)
     thisAgent->memoryManager->init_memory_pool(MP_rl_rule, sizeof(production_list), "rl_rules");
 
     thisAgent->memoryManager->init_memory_pool(MP_wma_decay_element, sizeof(wma_decay_element), "wma_decay");
-    thisAgent->memoryManager->init_memory_pool(MP_wma_decay_set, sizeof(wma_decay_set), "wma_decay_set");
     thisAgent->memoryManager->init_memory_pool(MP_wma_wme_oset, sizeof(wme_set), "wma_oset");
     thisAgent->memoryManager->init_memory_pool(MP_wma_slot_refs, sizeof(wma_sym_reference_map), "wma_slot_ref");
 
@@ -198,6 +199,8 @@ agent* create_soar_agent(char* agent_name)
     thisAgent->num_existing_wmes                        = 0;
     thisAgent->num_wmes_in_rete                         = 0;
     thisAgent->prev_top_state                           = NIL;
+    thisAgent->rete_net_snapshot                        = NIL;
+    thisAgent->rete_profiler                            = NIL;
     thisAgent->production_being_fired                   = NIL;
     thisAgent->productions_being_traced                 = NIL;
     thisAgent->promoted_ids                             = NIL;
@@ -234,6 +237,9 @@ agent* create_soar_agent(char* agent_name)
         thisAgent->if_no_sharing[i] = 0;
     }
 
+#ifndef NO_TIMING_STUFF
+    thisAgent->dc_latency = new decision_latency();
+#endif
     reset_max_stats(thisAgent);
 
     if (!getcwd(cur_path, MAXPATHLEN))
@@ -258,7 +264,7 @@ agent* create_soar_agent(char* agent_name)
     soar_init_callbacks(thisAgent);
 
     //
-    thisAgent->memoryManager = &Memory_Manager::Get_MPM();
+    thisAgent->memoryManager = new Memory_Manager();
     init_memory_utilities(thisAgent);
 
     //
@@ -282,6 +288,9 @@ agent* create_soar_agent(char* agent_name)
     // dynamic counters
     thisAgent->dyn_counters = new std::unordered_map< std::string, uint64_t >();
 
+    thisAgent->timeline = new Timeline(thisAgent);
+    thisAgent->rand_gen = new MTRand(SoarRandInt());
+
     thisAgent->outputManager = &Output_Manager::Get_OM();
     thisAgent->command_params = new cli_command_params(thisAgent);
     thisAgent->EpMem = new EpMem_Manager(thisAgent);
@@ -375,8 +384,9 @@ void destroy_soar_agent(agent* delete_agent)
 
     soar_remove_all_monitorable_callbacks(delete_agent);
 
-    delete_agent->memoryManager->free_memory(delete_agent->left_ht, HASH_TABLE_MEM_USAGE);
-    delete_agent->memoryManager->free_memory(delete_agent->right_ht, HASH_TABLE_MEM_USAGE);
+    discard_rete_net_snapshot(delete_agent);
+    free_rete_profiler(delete_agent);
+    free_rete_hash_tables(delete_agent);
     delete_agent->memoryManager->free_memory(delete_agent->rhs_variable_bindings, MISCELLANEOUS_MEM_USAGE);
 
     /* Releasing trace formats (needs to happen before tracing hashtables are released) */
@@ -410,6 +420,11 @@ void destroy_soar_agent(agent* delete_agent)
     delete delete_agent->EpMem;
     delete delete_agent->SMem;
     delete delete_agent->symbolManager;
+    delete delete_agent->timeline;
+    delete delete_agent->rand_gen;
+#ifndef NO_TIMING_STUFF
+    delete delete_agent->dc_latency;
+#endif
 
 
     delete delete_agent->dyn_counters;
@@ -417,6 +432,10 @@ void destroy_soar_agent(agent* delete_agent)
     /* Release data used by XML generation */
     xml_destroy(delete_agent);
 
+    /* Release whatever is left in the agent's memory pools in one go */
+    delete delete_agent->memoryManager;
+    delete_agent->memoryManager = NULL;
+
     /* Release agent data structure */
     delete delete_agent;
 }
@@ -472,6 +491,9 @@ void reinitialize_agent(agent* thisAgent)
     /* Reset basic Soar counters and pending XML trace/commands */
     reset_statistics(thisAgent);
     xml_reset(thisAgent);
+
+    /* Give back pool memory that only held working memory from the last run */
+    thisAgent->memoryManager->free_unused_memory_pools();
 }
 
 cli_command_params::cli_command_params(agent* thisAgent)
@@ -43,6 +43,7 @@ typedef struct alpha_mem_struct alpha_mem;
 typedef struct token_struct token;
 
 class stats_statement_container;
+class MTRand;
 #ifndef NO_SVS
 class svs_interface;
 #endif
@@ -75,8 +76,8 @@ typedef struct EXPORT agent_struct
     /////////////////////////////////////////////////////////////////////////////
 
     /* Hash tables for alpha memories, and for entries in left & right memories */
-    void*               left_ht;
-    void*               right_ht;
+    struct rete_hash_table_struct* left_ht;
+    struct rete_hash_table_struct* right_ht;
     hash_table*        (alpha_hash_tables[16]);
 
     /* Number of WMEs, and list of WMEs, the Rete has been told about */
@@ -87,6 +88,12 @@ typedef struct EXPORT agent_struct
     struct rete_node_struct* dummy_top_node;
     struct token_struct* dummy_top_token;
 
+    /* Saved image of this agent's net, possibly shared with its clones */
+    struct rete_net_snapshot_struct* rete_net_snapshot;
+
+    /* Match cost profiler; NIL until it is first turned on */
+    struct rete_profiler_struct* rete_profiler;
+
     /* Various Rete statistics counters */
     uint64_t       rete_node_counts[256];
     uint64_t       rete_node_counts_if_no_sharing[256];
@@ -324,6 +331,8 @@ typedef struct EXPORT agent_struct
     double total_dc_smem_time_sec;                // Holds last amount smem time, used to calculate delta
     uint64_t max_dc_smem_time_cycle;              // Holds what cycle max_dc_smem_time_sec was acheived
 
+    decision_latency* dc_latency;                 // Distribution of decision cycle and phase times
+
     soar_timer_accumulator callback_timers[NUMBER_OF_CALLBACKS];
 
     /* accumulated cpu time spent in various parts of the system */
@@ -476,6 +485,9 @@ typedef struct EXPORT agent_struct
     // select
     select_info* select;
 
+    // random number generator, see soar_rand.h
+    MTRand*      rand_gen;
+
     // predict
     uint32_t     predict_seed;
     std::string* prediction;
@@ -506,6 +518,9 @@ typedef struct EXPORT agent_struct
     soar_module::sqlite_database* stats_db;
     stats_statement_container* stats_stmts;
 
+    // recent phase and module begin/end times, see timeline.h
+    Timeline* timeline;
+
     // Soar execution will be interrupted when this substate level is removed
     goal_stack_level substate_break_level;
 
@@ -1483,9 +1483,9 @@ Symbol* rand_float_rhs_function_code(agent* thisAgent, cons* args, void* /*user_
 
     if (n > 0)
     {
-        return thisAgent->symbolManager->make_float_constant(SoarRand(n));
+        return thisAgent->symbolManager->make_float_constant(SoarRand(thisAgent, n));
     }
-    return thisAgent->symbolManager->make_float_constant(SoarRand());
+    return thisAgent->symbolManager->make_float_constant(SoarRand(thisAgent));
 }
 
 /* --------------------------------------------------------------------
@@ -1527,9 +1527,9 @@ Symbol* rand_int_rhs_function_code(agent* thisAgent, cons* args, void* /*user_da
 
     if (n > 0)
     {
-        return thisAgent->symbolManager->make_int_constant(static_cast<int64_t>(SoarRandInt(static_cast<uint32_t>(n))));
+        return thisAgent->symbolManager->make_int_constant(static_cast<int64_t>(SoarRandInt(thisAgent, static_cast<uint32_t>(n))));
     }
-    return thisAgent->symbolManager->make_int_constant(SoarRandInt());
+    return thisAgent->symbolManager->make_int_constant(SoarRandInt(thisAgent));
 }
 
 inline double _dice_zero_tolerance(double in)
@@ -67,16 +67,12 @@ struct strSymbol;
  * to see the type-specific variables in a debugger.  It can also help find some
  * bugs where some part of the kernel may be treating a symbol as the wrong type.
  *
- * WARNING: next_in_hash_table MUST be the first field.  This field is used
- *          by the resizable hash table routines.
- *
  * Explanations of all the fields are at the end of the file.
  *
  * -- */
 
 typedef struct EXPORT symbol_struct
 {
-    struct symbol_struct* next_in_hash_table;
     uint64_t reference_count;
     byte symbol_type;
     byte decider_flag;
@@ -312,7 +308,6 @@ double get_number_from_symbol(Symbol* sym);
  * =====================
  * symbol_type                 Indicates which of the five kinds of symbols
  * reference_count             Current reference count for this symbol
- * next_in_hash_table          Next item in hash bucket
  * hash_id                     Used for hashing in the rete (and elsewhere)
  * retesave_symindex           Used for rete fastsave/fastload
  * tc_num                      Used for transitive closure/marking
@@ -20,6 +20,7 @@
 #include "soar_instance.h"
 #include "smem_db.h"
 #include "symbol.h"
+#include "symbol_table.h"
 
 Symbol_Manager::Symbol_Manager(agent* pAgent)
 {
@@ -34,133 +35,114 @@ Symbol_Manager::Symbol_Manager(agent* pAgent)
 
 Symbol_Manager::~Symbol_Manager()
 {
-    free_hash_table(thisAgent, variable_hash_table);
-    free_hash_table(thisAgent, identifier_hash_table);
-    free_hash_table(thisAgent, str_constant_hash_table);
-    free_hash_table(thisAgent, int_constant_hash_table);
-    free_hash_table(thisAgent, float_constant_hash_table);
+    free_symbol_table(thisAgent, variable_hash_table);
+    free_symbol_table(thisAgent, identifier_hash_table);
+    free_symbol_table(thisAgent, str_constant_hash_table);
+    free_symbol_table(thisAgent, int_constant_hash_table);
+    free_symbol_table(thisAgent, float_constant_hash_table);
 }
 
 /* -------------------------------------------------------------------
                            Hash Functions
 
-   Compress() takes a 32-bit hash value and compresses it down to a few
-   bits, xor-ing pieces of the 32-bit value to avoid throwing away bits
-   that might be important for the hash function to be effective.
-
-   Hash_string() produces a hash value for a string of characters.
+   Hash_string() produces a hash value for a string of characters.  It
+   used to just rotate and xor in each character, but that gave long
+   names that differ only in a few characters (e.g. gensyms) the same
+   hash too often, and the symbol tables compare full hashes.
 
    Hash_xxx_raw_info() are the hash functions for the five kinds of
    symbols.  These functions operate on the basic info about the symbol
-   (i.e., the name, value, etc.).  Hash_xxx(), on the other hand,
-   operate on the symbol table entries for the five kinds of symbols--
-   these routines are the callback hashing functions used by the
-   resizable hash table routines.
+   (i.e., the name, value, etc.) and return a full 32-bit hash.  The
+   symbol tables mix these bits themselves (see symbol_table.h) and store
+   the result, so there is no per-table callback to rehash a symbol.
 ------------------------------------------------------------------- */
 
-uint32_t compress(uint32_t h, short num_bits)
-{
-    uint32_t result;
-
-    if (num_bits < 16)
-    {
-        h = (h & 0xFFFF) ^ (h >> 16);
-    }
-    if (num_bits < 8)
-    {
-        h = (h & 0xFF) ^ (h >> 8);
-    }
-    result = 0;
-    while (h)
-    {
-        result ^= (h & masks_for_n_low_order_bits[num_bits]);
-        h = h >> num_bits;
-    }
-    return result;
-}
-
-uint32_t hash_string(const char* s)      /* AGR 600 */
+uint32_t hash_string(const char* s)      /* FNV-1a */
 {
     uint32_t h;
 
-    h = 0;
+    h = 2166136261u;
     while (*s != 0)
     {
-        h = ((h << 8) | (h >> 24)) ^ (*s);
+        h = (h ^ static_cast<unsigned char>(*s)) * 16777619u;
         s++;
     }
     return h;
 }
 
-/* -----------------------------------------
-   Hashing symbols using their basic info
------------------------------------------ */
-
-uint32_t hash_variable_raw_info(const char* name, short num_bits)
+inline uint32_t hash_variable_raw_info(const char* name)
 {
-    return compress(hash_string(name), num_bits);
+    return hash_string(name);
 }
 
-uint32_t hash_identifier_raw_info(char name_letter,
-                                  uint64_t name_number,
-                                  short num_bits)
+inline uint32_t hash_identifier_raw_info(char name_letter, uint64_t name_number)
 {
-    return compress(static_cast<uint32_t>(name_number) ^ (static_cast<uint32_t>(name_letter) << 24), num_bits);  // FIXME: cast from 64 to 32 bits
+    return static_cast<uint32_t>(name_number ^ (name_number >> 32)) ^ (static_cast<uint32_t>(name_letter) << 24);
 }
 
-uint32_t hash_str_constant_raw_info(const char* name, short num_bits)
+inline uint32_t hash_str_constant_raw_info(const char* name)
 {
-    return compress(hash_string(name), num_bits);
+    return hash_string(name);
 }
 
-uint32_t hash_int_constant_raw_info(int64_t value, short num_bits)
+inline uint32_t hash_int_constant_raw_info(int64_t value)
 {
-    return compress(static_cast<uint32_t>(value), num_bits);
+    return static_cast<uint32_t>(value ^ (value >> 32));
 }
 
-uint32_t hash_float_constant_raw_info(double value, short num_bits)
+inline uint32_t hash_float_constant_raw_info(double value)
 {
-    return compress(static_cast<uint32_t>(value), num_bits);
+    uint64_t lBits;
+
+    /* 0.0 and -0.0 compare equal, so they must hash the same */
+    if (value == 0.0)
+    {
+        value = 0.0;
+    }
+    memcpy(&lBits, &value, sizeof(lBits));
+    return static_cast<uint32_t>(lBits ^ (lBits >> 32));
 }
 
 /* ---------------------------------------------------
-   Hashing symbols using their symbol table entries
+   Key matching functors used to find each kind of
+   symbol in its symbol table
 --------------------------------------------------- */
 
-uint32_t hash_variable(void* item, short num_bits)
+struct symbol_name_matches
 {
-    varSymbol* var;
-    var = static_cast<varSymbol*>(item);
-    return compress(hash_string(var->name), num_bits);
-}
+    const char* name;
+    symbol_name_matches(const char* pName) : name(pName) {}
+    bool operator()(Symbol* sym) const { return !strcmp(sym->sc->name, name); }
+};
 
-uint32_t hash_identifier(void* item, short num_bits)
+struct variable_name_matches
 {
-    idSymbol* id;
-    id = static_cast<idSymbol*>(item);
-    return compress(static_cast<uint32_t>(id->name_number) ^ (static_cast<uint32_t>(id->name_letter) << 24), num_bits);  // FIXME: cast from 64 to 32 bits
-}
+    const char* name;
+    variable_name_matches(const char* pName) : name(pName) {}
+    bool operator()(Symbol* sym) const { return !strcmp(sym->var->name, name); }
+};
 
-uint32_t hash_str_constant(void* item, short num_bits)
+struct identifier_name_matches
 {
-    strSymbol* sc;
-    sc = static_cast<strSymbol*>(item);
-    return compress(hash_string(sc->name), num_bits);
-}
+    char name_letter;
+    uint64_t name_number;
+    identifier_name_matches(char pLetter, uint64_t pNumber) : name_letter(pLetter), name_number(pNumber) {}
+    bool operator()(Symbol* sym) const { return (sym->id->name_number == name_number) && (sym->id->name_letter == name_letter); }
+};
 
-uint32_t hash_int_constant(void* item, short num_bits)
+struct int_value_matches
 {
-    intSymbol* ic;
-    ic = static_cast<intSymbol*>(item);
-    return compress(static_cast<uint32_t>(ic->value), num_bits);
-}
+    int64_t value;
+    int_value_matches(int64_t pValue) : value(pValue) {}
+    bool operator()(Symbol* sym) const { return sym->ic->value == value; }
+};
 
-uint32_t hash_float_constant(void* item, short num_bits)
+struct float_value_matches
 {
-    floatSymbol* fc;
-    fc = static_cast<floatSymbol*>(item);
-    return compress(static_cast<uint32_t>(fc->value), num_bits);
-}
+    double value;
+    float_value_matches(double pValue) : value(pValue) {}
+    bool operator()(Symbol* sym) const { return sym->fc->value == value; }
+};
 
 /* -----------------------------------------------------------------
                        Symbol Table Routines
@@ -217,11 +199,11 @@ uint32_t hash_float_constant(void* item, short num_bits)
 
 void Symbol_Manager::init_symbol_tables()
 {
-    variable_hash_table = make_hash_table(thisAgent, 0, hash_variable);
-    identifier_hash_table = make_hash_table(thisAgent, 0, hash_identifier);
-    str_constant_hash_table = make_hash_table(thisAgent, 0, hash_str_constant);
-    int_constant_hash_table = make_hash_table(thisAgent, 0, hash_int_constant);
-    float_constant_hash_table = make_hash_table(thisAgent, 0, hash_float_constant);
+    variable_hash_table = make_symbol_table(thisAgent, 0);
+    identifier_hash_table = make_symbol_table(thisAgent, 0);
+    str_constant_hash_table = make_symbol_table(thisAgent, 0);
+    int_constant_hash_table = make_symbol_table(thisAgent, 0);
+    float_constant_hash_table = make_symbol_table(thisAgent, 0);
 
     thisAgent->memoryManager->init_memory_pool(MP_variable, sizeof(varSymbol), "variable");
     thisAgent->memoryManager->init_memory_pool(MP_identifier, sizeof(idSymbol), "identifier");
@@ -235,17 +217,28 @@ void Symbol_Manager::init_symbol_tables()
 bool retesave_symbol_and_assign_index(agent* thisAgent, void* item, void* userdata)
 {
     Symbol* sym;
-    FILE* f = reinterpret_cast<FILE*>(userdata);
+    rete_net_stream* f = reinterpret_cast<rete_net_stream*>(userdata);
 
     sym = static_cast<symbol_struct*>(item);
     thisAgent->current_retesave_symindex++;
     sym->retesave_symindex = thisAgent->current_retesave_symindex;
-    retesave_string(sym->to_string(), f);
+    if ((f->version >= 5) && (sym->symbol_type == INT_CONSTANT_SYMBOL_TYPE))
+    {
+        retesave_int_value(sym->ic->value, f);
+    }
+    else if ((f->version >= 5) && (sym->symbol_type == FLOAT_CONSTANT_SYMBOL_TYPE))
+    {
+        retesave_float_value(sym->fc->value, f);
+    }
+    else
+    {
+        retesave_string(sym->to_string(), f);
+    }
     return false;
 }
 
 
-void Symbol_Manager::retesave(FILE* f)
+void Symbol_Manager::retesave(rete_net_stream* f)
 {
     thisAgent->current_retesave_symindex = 0;
 
@@ -254,99 +247,35 @@ void Symbol_Manager::retesave(FILE* f)
     retesave_eight_bytes(int_constant_hash_table->count, f);
     retesave_eight_bytes(float_constant_hash_table->count, f);
 
-    do_for_all_items_in_hash_table(thisAgent, str_constant_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, int_constant_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, float_constant_hash_table, retesave_symbol_and_assign_index, f);
+    do_for_all_items_in_symbol_table(thisAgent, str_constant_hash_table, retesave_symbol_and_assign_index, f);
+    do_for_all_items_in_symbol_table(thisAgent, variable_hash_table, retesave_symbol_and_assign_index, f);
+    do_for_all_items_in_symbol_table(thisAgent, int_constant_hash_table, retesave_symbol_and_assign_index, f);
+    do_for_all_items_in_symbol_table(thisAgent, float_constant_hash_table, retesave_symbol_and_assign_index, f);
 }
 Symbol* Symbol_Manager::find_variable(const char* name)
 {
-    uint32_t hash_value;
-    varSymbol* sym;
-
-    hash_value = hash_variable_raw_info(name, variable_hash_table->log2size);
-    sym = reinterpret_cast<varSymbol*>(*(variable_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<varSymbol*>(sym->next_in_hash_table))
-    {
-        if (!strcmp(sym->name, name))
-        {
-            return sym;
-        }
-    }
-    return NIL;
+    return find_in_symbol_table(variable_hash_table, hash_variable_raw_info(name), variable_name_matches(name));
 }
 
 Symbol* Symbol_Manager::find_identifier(char name_letter, uint64_t name_number)
 {
-    uint32_t hash_value;
-    idSymbol* sym;
-
-    hash_value = hash_identifier_raw_info(name_letter, name_number,
-                                          identifier_hash_table->log2size);
-    sym = reinterpret_cast<idSymbol*>(*(identifier_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<idSymbol*>(sym->next_in_hash_table))
-    {
-        if ((name_letter == sym->name_letter) &&
-                (name_number == sym->name_number))
-        {
-            return sym;
-        }
-    }
-    return NIL;
+    return find_in_symbol_table(identifier_hash_table, hash_identifier_raw_info(name_letter, name_number),
+                                identifier_name_matches(name_letter, name_number));
 }
 
 Symbol* Symbol_Manager::find_str_constant(const char* name)
 {
-    uint32_t hash_value;
-    strSymbol* sym;
-
-    hash_value = hash_str_constant_raw_info(name,
-                                            str_constant_hash_table->log2size);
-    sym = reinterpret_cast<strSymbol*>(*(str_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<strSymbol*>(sym->next_in_hash_table))
-    {
-        if (!strcmp(sym->name, name))
-        {
-            return sym;
-        }
-    }
-    return NIL;
+    return find_in_symbol_table(str_constant_hash_table, hash_str_constant_raw_info(name), symbol_name_matches(name));
 }
 
 Symbol* Symbol_Manager::find_int_constant(int64_t value)
 {
-    uint32_t hash_value;
-    intSymbol* sym;
-
-    hash_value = hash_int_constant_raw_info(value,
-                                            int_constant_hash_table->log2size);
-    sym = reinterpret_cast<intSymbol*>(*(int_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<intSymbol*>(sym->next_in_hash_table))
-    {
-        if (value == sym->value)
-        {
-            return sym;
-        }
-    }
-    return NIL;
+    return find_in_symbol_table(int_constant_hash_table, hash_int_constant_raw_info(value), int_value_matches(value));
 }
 
 Symbol* Symbol_Manager::find_float_constant(double value)
 {
-    uint32_t hash_value;
-    floatSymbol* sym;
-
-    hash_value = hash_float_constant_raw_info(value,
-                 float_constant_hash_table->log2size);
-    sym = reinterpret_cast<floatSymbol*>(*(float_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<floatSymbol*>(sym->next_in_hash_table))
-    {
-        if (value == sym->value)
-        {
-            return sym;
-        }
-    }
-    return NIL;
+    return find_in_symbol_table(float_constant_hash_table, hash_float_constant_raw_info(value), float_value_matches(value));
 }
 
 Symbol* Symbol_Manager::make_variable(const char* name)
@@ -378,7 +307,7 @@ Symbol* Symbol_Manager::make_variable(const char* name)
     sym->id = NULL;
     sym->var = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, variable_hash_table, sym);
+    add_to_symbol_table(thisAgent, variable_hash_table, sym, hash_variable_raw_info(sym->name));
 
     return sym;
 }
@@ -467,7 +396,7 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
     sym->var = NULL;
     sym->id = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, identifier_hash_table, sym);
+    add_to_symbol_table(thisAgent, identifier_hash_table, sym, hash_identifier_raw_info(sym->name_letter, sym->name_number));
 
     return sym;
 }
@@ -499,7 +428,7 @@ Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
     sym->var = NULL;
     sym->sc = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, str_constant_hash_table, sym);
+    add_to_symbol_table(thisAgent, str_constant_hash_table, sym, hash_str_constant_raw_info(sym->name));
 
     return sym;
 }
@@ -545,7 +474,7 @@ Symbol* Symbol_Manager::make_int_constant(int64_t value)
         sym->var = NULL;
         sym->ic = sym;
         symbol_add_ref(sym);
-        add_to_hash_table(thisAgent, int_constant_hash_table, sym);
+        add_to_symbol_table(thisAgent, int_constant_hash_table, sym, hash_int_constant_raw_info(sym->value));
     }
     return sym;
 }
@@ -579,7 +508,7 @@ Symbol* Symbol_Manager::make_float_constant(double value)
         sym->var = NULL;
         sym->fc = sym;
         symbol_add_ref(sym);
-        add_to_hash_table(thisAgent, float_constant_hash_table, sym);
+        add_to_symbol_table(thisAgent, float_constant_hash_table, sym, hash_float_constant_raw_info(sym->value));
     }
     return sym;
 }
@@ -936,31 +865,31 @@ void Symbol_Manager::deallocate_symbol(Symbol*& sym)
     switch (sym->symbol_type)
     {
         case VARIABLE_SYMBOL_TYPE:
-            remove_from_hash_table(thisAgent, variable_hash_table, sym);
+            remove_from_symbol_table(thisAgent, variable_hash_table, sym, hash_variable_raw_info(sym->var->name));
             free_memory_block_for_string(thisAgent, sym->var->name);
             thisAgent->memoryManager->free_with_pool(MP_variable, sym);
             break;
         case IDENTIFIER_SYMBOL_TYPE:
             if (sym->id->cached_print_str) free_memory_block_for_string(thisAgent, sym->id->cached_print_str);
             if (sym->id->cached_lti_str) free_memory_block_for_string(thisAgent, sym->id->cached_lti_str);
-            remove_from_hash_table(thisAgent, identifier_hash_table, sym);
+            remove_from_symbol_table(thisAgent, identifier_hash_table, sym, hash_identifier_raw_info(sym->id->name_letter, sym->id->name_number));
             thisAgent->memoryManager->free_with_pool(MP_identifier, sym);
             break;
         case STR_CONSTANT_SYMBOL_TYPE:
             if (sym->sc->cached_rereadable_print_str && (sym->sc->cached_rereadable_print_str != sym->sc->name))
                 free_memory_block_for_string(thisAgent, sym->sc->cached_rereadable_print_str);
-            remove_from_hash_table(thisAgent, str_constant_hash_table, sym);
+            remove_from_symbol_table(thisAgent, str_constant_hash_table, sym, hash_str_constant_raw_info(sym->sc->name));
             free_memory_block_for_string(thisAgent, sym->sc->name);
             thisAgent->memoryManager->free_with_pool(MP_str_constant, sym);
             break;
         case INT_CONSTANT_SYMBOL_TYPE:
             if (sym->ic->cached_print_str) free_memory_block_for_string(thisAgent, sym->ic->cached_print_str);
-            remove_from_hash_table(thisAgent, int_constant_hash_table, sym);
+            remove_from_symbol_table(thisAgent, int_constant_hash_table, sym, hash_int_constant_raw_info(sym->ic->value));
             thisAgent->memoryManager->free_with_pool(MP_int_constant, sym);
             break;
         case FLOAT_CONSTANT_SYMBOL_TYPE:
             if (sym->fc->cached_print_str) free_memory_block_for_string(thisAgent, sym->fc->cached_print_str);
-            remove_from_hash_table(thisAgent, float_constant_hash_table, sym);
+            remove_from_symbol_table(thisAgent, float_constant_hash_table, sym, hash_float_constant_raw_info(sym->fc->value));
             thisAgent->memoryManager->free_with_pool(MP_float_constant, sym);
             break;
         default:
@@ -1051,21 +980,21 @@ bool print_sym(agent* thisAgent, void* item, void*)
 
 void Symbol_Manager::clear_variable_gensym_numbers()
 {
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, clear_gensym_number, 0);
+    do_for_all_items_in_symbol_table(thisAgent, variable_hash_table, clear_gensym_number, 0);
 }
 
 void Symbol_Manager::print_internal_symbols()
 {
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Symbolic Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, str_constant_hash_table, print_sym, 0);
+    do_for_all_items_in_symbol_table(thisAgent, str_constant_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Integer Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, int_constant_hash_table, print_sym, 0);
+    do_for_all_items_in_symbol_table(thisAgent, int_constant_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Floating-Point Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, float_constant_hash_table, print_sym, 0);
+    do_for_all_items_in_symbol_table(thisAgent, float_constant_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Identifiers: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+    do_for_all_items_in_symbol_table(thisAgent, identifier_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Variables: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, print_sym, 0);
+    do_for_all_items_in_symbol_table(thisAgent, variable_hash_table, print_sym, 0);
 }
 
 void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
@@ -1080,7 +1009,7 @@ void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
                  * detect refcount leaks in unit tests and print out a message accordingly */
                 #ifndef SOAR_RELEASE_VERSION
                     if (identifier_hash_table->count < 23)
-                        do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+                        do_for_all_items_in_symbol_table(thisAgent, identifier_hash_table, print_sym, 0);
                     else
                         std::cout << "Refcount leak of " << identifier_hash_table->count << " identifiers detected. ";
                 #else
@@ -1096,12 +1025,12 @@ void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
                 /* Note:  The do_for_all_items_in_hash_table printing could cause a crash if there's
                  *        memory corruption, but usually prints out and is good for debugging. */
                 #ifndef SOAR_RELEASE_VERSION
-                do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+                do_for_all_items_in_symbol_table(thisAgent, identifier_hash_table, print_sym, 0);
                 #endif
             }
-            free_hash_table(thisAgent, identifier_hash_table);
+            free_symbol_table(thisAgent, identifier_hash_table);
             thisAgent->memoryManager->free_memory_pool(MP_identifier);
-            identifier_hash_table = make_hash_table(thisAgent, 0, hash_identifier);
+            identifier_hash_table = make_symbol_table(thisAgent, 0);
         }
     }
 }
@@ -1122,8 +1051,8 @@ bool reset_tc_num(agent* /*thisAgent*/, void* item, void*)
 
 void Symbol_Manager::reset_id_and_variable_tc_numbers()
 {
-    do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, reset_tc_num, 0);
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, reset_tc_num, 0);
+    do_for_all_items_in_symbol_table(thisAgent, identifier_hash_table, reset_tc_num, 0);
+    do_for_all_items_in_symbol_table(thisAgent, variable_hash_table, reset_tc_num, 0);
 }
 
 Symbol* Symbol_Manager::generate_new_str_constant(const char* prefix, uint64_t* counter)
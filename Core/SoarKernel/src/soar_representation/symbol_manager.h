@@ -28,7 +28,7 @@ class EXPORT Symbol_Manager {
         predefined_symbols  soarSymbols;
 
         void init_symbol_tables();
-        void retesave(FILE* f);
+        void retesave(struct rete_net_stream_struct* f);
 
         void create_predefined_symbols();
         void create_common_variables_and_numbers();
@@ -147,11 +147,11 @@ class EXPORT Symbol_Manager {
         uint64_t    current_variable_gensym_number;
         uint64_t    gensymed_variable_count[26];
 
-        struct hash_table_struct* float_constant_hash_table;
-        struct hash_table_struct* identifier_hash_table;
-        struct hash_table_struct* int_constant_hash_table;
-        struct hash_table_struct* str_constant_hash_table;
-        struct hash_table_struct* variable_hash_table;
+        struct symbol_table_struct* float_constant_hash_table;
+        struct symbol_table_struct* identifier_hash_table;
+        struct symbol_table_struct* int_constant_hash_table;
+        struct symbol_table_struct* str_constant_hash_table;
+        struct symbol_table_struct* variable_hash_table;
 
         void clear_variable_gensym_numbers();
 
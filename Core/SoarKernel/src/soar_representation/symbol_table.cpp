@@ -0,0 +1,350 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+#include "symbol_table.h"
+
+#include "agent.h"
+#include "memory_manager.h"
+#include "misc.h"
+#include "output_manager.h"
+#include "symbol.h"
+
+#include <string>
+#include <vector>
+
+/* ====================================================================
+
+                      Open-Addressing Symbol Tables
+
+   A table grows when live entries plus tombstones would fill more than
+   7/8 of its slots, and shrinks when less than 1/8 of them are live.
+   Resizing (and cleaning out tombstones) rebuilds the arrays from the
+   stored hashes.
+
+   When a symbol is removed, its slot only needs a tombstone if some
+   other symbol's probe sequence may have passed over it, i.e. if its
+   group has ever been full.  Since EMPTY slots are never created
+   except by a rebuild, a group that still has an EMPTY slot has never
+   been full, and the removed slot can simply be marked EMPTY again.
+==================================================================== */
+
+static void allocate_symbol_table_slots(agent* thisAgent, symbol_table* st, uint32_t capacity)
+{
+    size_t lBytes = capacity * (sizeof(Symbol*) + sizeof(uint32_t) + sizeof(uint8_t));
+    char* lMemory = static_cast<char*>(thisAgent->memoryManager->allocate_memory(lBytes, HASH_TABLE_MEM_USAGE));
+
+    st->capacity = capacity;
+    st->num_deleted = 0;
+    st->symbols = reinterpret_cast<Symbol**>(lMemory);
+    st->hashes = reinterpret_cast<uint32_t*>(lMemory + capacity * sizeof(Symbol*));
+    st->ctrl = reinterpret_cast<uint8_t*>(lMemory + capacity * (sizeof(Symbol*) + sizeof(uint32_t)));
+    memset(st->ctrl, SYMBOL_TABLE_EMPTY, capacity);
+}
+
+/* Places a symbol that is known not to be in the table yet.  Returns the slot used. */
+static uint32_t place_in_symbol_table(symbol_table* st, Symbol* sym, uint32_t mixed_hash)
+{
+    uint32_t lGroupMask = (st->capacity / SYMBOL_TABLE_GROUP_SIZE) - 1;
+    uint32_t lGroup = (mixed_hash >> 7) & lGroupMask;
+
+    for (uint32_t lStep = 1; ; lStep++)
+    {
+        uint32_t lBase = lGroup * SYMBOL_TABLE_GROUP_SIZE;
+        uint32_t lFree = symbol_table_match_free(st->ctrl + lBase);
+        if (lFree)
+        {
+            uint32_t lSlot = lBase + symbol_table_lowest_bit(lFree);
+            if (st->ctrl[lSlot] == SYMBOL_TABLE_DELETED)
+            {
+                st->num_deleted--;
+            }
+            st->ctrl[lSlot] = static_cast<uint8_t>(mixed_hash & 0x7F);
+            st->hashes[lSlot] = mixed_hash;
+            st->symbols[lSlot] = sym;
+            return lSlot;
+        }
+        lGroup = (lGroup + lStep) & lGroupMask;
+    }
+}
+
+static void resize_symbol_table(agent* thisAgent, symbol_table* st, uint32_t new_capacity)
+{
+    Symbol** lOldSymbols = st->symbols;
+    uint32_t* lOldHashes = st->hashes;
+    uint8_t* lOldCtrl = st->ctrl;
+    uint32_t lOldCapacity = st->capacity;
+
+    allocate_symbol_table_slots(thisAgent, st, new_capacity);
+    for (uint32_t i = 0; i < lOldCapacity; i++)
+    {
+        if (!(lOldCtrl[i] & 0x80))
+        {
+            place_in_symbol_table(st, lOldSymbols[i], lOldHashes[i]);
+        }
+    }
+    thisAgent->memoryManager->free_memory(lOldSymbols, HASH_TABLE_MEM_USAGE);
+}
+
+symbol_table* make_symbol_table(agent* thisAgent, uint32_t minimum_capacity)
+{
+    symbol_table* st;
+    uint32_t lCapacity = SYMBOL_TABLE_GROUP_SIZE;
+
+    while (lCapacity < minimum_capacity)
+    {
+        lCapacity <<= 1;
+    }
+    st = static_cast<symbol_table*>(thisAgent->memoryManager->allocate_memory(sizeof(symbol_table), HASH_TABLE_MEM_USAGE));
+    st->count = 0;
+    st->minimum_capacity = lCapacity;
+    allocate_symbol_table_slots(thisAgent, st, lCapacity);
+    return st;
+}
+
+void free_symbol_table(agent* thisAgent, symbol_table* st)
+{
+    thisAgent->memoryManager->free_memory(st->symbols, HASH_TABLE_MEM_USAGE);
+    thisAgent->memoryManager->free_memory(st, HASH_TABLE_MEM_USAGE);
+}
+
+void add_to_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym, uint32_t hash_value)
+{
+    if ((st->count + st->num_deleted + 1) * 8 > static_cast<int64_t>(st->capacity) * 7)
+    {
+        /* --- grow if mostly live entries, otherwise just clear out the tombstones --- */
+        resize_symbol_table(thisAgent, st, ((st->count + 1) * 2 > st->capacity) ? st->capacity * 2 : st->capacity);
+    }
+    place_in_symbol_table(st, sym, symbol_table_mix(hash_value));
+    st->count++;
+}
+
+void remove_from_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym, uint32_t hash_value)
+{
+    uint32_t lHash = symbol_table_mix(hash_value);
+    uint8_t lFingerprint = static_cast<uint8_t>(lHash & 0x7F);
+    uint32_t lGroupMask = (st->capacity / SYMBOL_TABLE_GROUP_SIZE) - 1;
+    uint32_t lGroup = (lHash >> 7) & lGroupMask;
+
+    for (uint32_t lStep = 1; ; lStep++)
+    {
+        uint32_t lBase = lGroup * SYMBOL_TABLE_GROUP_SIZE;
+        const uint8_t* lCtrl = st->ctrl + lBase;
+        for (uint32_t lMatches = symbol_table_match_byte(lCtrl, lFingerprint); lMatches; lMatches &= lMatches - 1)
+        {
+            uint32_t lSlot = lBase + symbol_table_lowest_bit(lMatches);
+            if (st->symbols[lSlot] == sym)
+            {
+                if (symbol_table_match_byte(lCtrl, SYMBOL_TABLE_EMPTY))
+                {
+                    st->ctrl[lSlot] = SYMBOL_TABLE_EMPTY;
+                }
+                else
+                {
+                    st->ctrl[lSlot] = SYMBOL_TABLE_DELETED;
+                    st->num_deleted++;
+                }
+                st->symbols[lSlot] = NIL;
+                st->count--;
+                if ((st->capacity > st->minimum_capacity) && (st->count * 8 < st->capacity))
+                {
+                    resize_symbol_table(thisAgent, st, st->capacity / 2);
+                }
+                return;
+            }
+        }
+        if (symbol_table_match_byte(lCtrl, SYMBOL_TABLE_EMPTY))
+        {
+            /* Reaching here means that we couldn't find the symbol */
+            assert(false && "Couldn't find symbol to remove from symbol table!");
+            return;
+        }
+        lGroup = (lGroup + lStep) & lGroupMask;
+    }
+}
+
+void do_for_all_items_in_symbol_table(agent* thisAgent, symbol_table* st, hash_table_callback_fn2 f, void* userdata)
+{
+    for (uint32_t i = 0; i < st->capacity; i++)
+    {
+        if (!(st->ctrl[i] & 0x80))
+        {
+            if ((*f)(thisAgent, st->symbols[i], userdata))
+            {
+                return;
+            }
+        }
+    }
+}
+
+/* ====================================================================
+
+                      Symbol Table Microbenchmark
+
+   Used by "debug symbol-tables".  Times inserting, finding and
+   removing num_items string and integer keys in a symbol table and in
+   the chained hash_table from mem.cpp, which is what the symbol
+   manager used before.  The items are stand-in symbols built here, so
+   the agent's own symbol tables are not touched.
+==================================================================== */
+
+typedef struct benchmark_chained_item_struct
+{
+    struct benchmark_chained_item_struct* next;     /* must be first, used by the hash_table routines */
+    Symbol* sym;
+    uint32_t hash_value;
+} benchmark_chained_item;
+
+static uint32_t hash_benchmark_chained_item(void* item, short num_bits)
+{
+    return symbol_table_mix(static_cast<benchmark_chained_item*>(item)->hash_value) & masks_for_n_low_order_bits[num_bits];
+}
+
+struct benchmark_str_matches
+{
+    const char* name;
+    benchmark_str_matches(const char* pName) : name(pName) {}
+    bool operator()(Symbol* sym) const { return !strcmp(sym->sc->name, name); }
+};
+
+struct benchmark_int_matches
+{
+    int64_t value;
+    benchmark_int_matches(int64_t pValue) : value(pValue) {}
+    bool operator()(Symbol* sym) const { return sym->ic->value == value; }
+};
+
+static bool benchmark_chained_table(agent* thisAgent, std::vector<benchmark_chained_item>& items, bool isString, uint64_t* usec)
+{
+    soar_timer lTimer;
+    uint64_t lFound = 0;
+    hash_table* ht = make_hash_table(thisAgent, 0, hash_benchmark_chained_item);
+
+    lTimer.start();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        add_to_hash_table(thisAgent, ht, &items[i]);
+    }
+    lTimer.stop();
+    usec[0] = lTimer.get_usec();
+
+    lTimer.start();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        uint32_t lHash = symbol_table_mix(items[i].hash_value) & masks_for_n_low_order_bits[ht->log2size];
+        for (benchmark_chained_item* lItem = reinterpret_cast<benchmark_chained_item*>(ht->buckets[lHash]); lItem; lItem = lItem->next)
+        {
+            if (isString ? !strcmp(lItem->sym->sc->name, items[i].sym->sc->name) : (lItem->sym->ic->value == items[i].sym->ic->value))
+            {
+                lFound++;
+                break;
+            }
+        }
+    }
+    lTimer.stop();
+    usec[1] = lTimer.get_usec();
+
+    lTimer.start();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        remove_from_hash_table(thisAgent, ht, &items[i]);
+    }
+    lTimer.stop();
+    usec[2] = lTimer.get_usec();
+
+    free_hash_table(thisAgent, ht);
+    return (lFound == items.size());
+}
+
+template <typename KeyMatch>
+static bool benchmark_symbol_table(agent* thisAgent, std::vector<benchmark_chained_item>& items, const std::vector<KeyMatch>& keys, uint64_t* usec)
+{
+    soar_timer lTimer;
+    uint64_t lFound = 0;
+    symbol_table* st = make_symbol_table(thisAgent, 0);
+
+    lTimer.start();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        add_to_symbol_table(thisAgent, st, items[i].sym, items[i].hash_value);
+    }
+    lTimer.stop();
+    usec[0] = lTimer.get_usec();
+
+    lTimer.start();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (find_in_symbol_table(st, items[i].hash_value, keys[i]) == items[i].sym)
+        {
+            lFound++;
+        }
+    }
+    lTimer.stop();
+    usec[1] = lTimer.get_usec();
+
+    lTimer.start();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        remove_from_symbol_table(thisAgent, st, items[i].sym, items[i].hash_value);
+    }
+    lTimer.stop();
+    usec[2] = lTimer.get_usec();
+
+    free_symbol_table(thisAgent, st);
+    return (lFound == items.size());
+}
+
+extern uint32_t hash_string(const char* s);
+
+void benchmark_symbol_tables(agent* thisAgent, uint64_t num_items)
+{
+    std::vector<std::string> lNames(num_items);
+    std::vector<strSymbol> lStrSymbols(num_items);
+    std::vector<intSymbol> lIntSymbols(num_items);
+    std::vector<benchmark_chained_item> lStrItems(num_items), lIntItems(num_items);
+    std::vector<benchmark_str_matches> lStrKeys;
+    std::vector<benchmark_int_matches> lIntKeys;
+    uint64_t lUsec[4][3];
+    bool lFoundAll[4];
+
+    for (uint64_t i = 0; i < num_items; i++)
+    {
+        lNames[i] = "input-value-" + std::to_string(i);
+        lStrSymbols[i].sc = &(lStrSymbols[i]);
+        lStrSymbols[i].name = const_cast<char*>(lNames[i].c_str());
+        lStrItems[i].sym = &(lStrSymbols[i]);
+        lStrItems[i].hash_value = hash_string(lStrSymbols[i].name);
+        lStrKeys.push_back(benchmark_str_matches(lStrSymbols[i].name));
+
+        lIntSymbols[i].ic = &(lIntSymbols[i]);
+        lIntSymbols[i].value = static_cast<int64_t>(i) * 7;
+        lIntItems[i].sym = &(lIntSymbols[i]);
+        lIntItems[i].hash_value = static_cast<uint32_t>(lIntSymbols[i].value);
+        lIntKeys.push_back(benchmark_int_matches(lIntSymbols[i].value));
+    }
+
+    lFoundAll[0] = benchmark_chained_table(thisAgent, lStrItems, true, lUsec[0]);
+    lFoundAll[1] = benchmark_symbol_table(thisAgent, lStrItems, lStrKeys, lUsec[1]);
+    lFoundAll[2] = benchmark_chained_table(thisAgent, lIntItems, false, lUsec[2]);
+    lFoundAll[3] = benchmark_symbol_table(thisAgent, lIntItems, lIntKeys, lUsec[3]);
+
+    const char* lLabels[4] = { "chained, strings", "symbol table, strings", "chained, integers", "symbol table, integers" };
+    char lLine[BUFFER_MSG_SIZE];
+    thisAgent->outputManager->printa_sf(thisAgent, "Symbol table benchmark with %u keys (times in usec):\n\n", num_items);
+    SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-24s %12s %12s %12s\n", "Table", "Insert", "Find", "Remove");
+    thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    for (int i = 0; i < 4; i++)
+    {
+        if (!lFoundAll[i])
+        {
+            SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-24s did not find every key it inserted!\n", lLabels[i]);
+        }
+        else
+        {
+            SNPRINTF(lLine, BUFFER_MSG_SIZE, "%-24s %12llu %12llu %12llu\n", lLabels[i],
+                     static_cast<unsigned long long>(lUsec[i][0]), static_cast<unsigned long long>(lUsec[i][1]), static_cast<unsigned long long>(lUsec[i][2]));
+        }
+        thisAgent->outputManager->printa_sf(thisAgent, "%s", lLine);
+    }
+}
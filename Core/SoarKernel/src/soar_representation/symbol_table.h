@@ -0,0 +1,151 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* -------------------------------------------------------------------
+                          symbol_table.h
+
+   Open-addressing hash tables used by the Symbol_Manager to intern the
+   five kinds of symbols.
+
+   Unlike the chained hash tables in mem.cpp, a symbol table keeps its
+   entries in flat arrays.  Each slot has a one-byte control value that
+   is either EMPTY, DELETED or the low 7 bits of the symbol's hash (its
+   fingerprint).  Slots are probed in groups of SYMBOL_TABLE_GROUP_SIZE,
+   so a lookup compares a whole group of fingerprints at once (with SSE2
+   when it's available) and only looks at the symbols whose fingerprint
+   matches.  The full hash of every symbol is stored as well, so we
+   never have to call back into the symbol to resize the table.
+
+   Lookups take a key-matching functor, which lets each kind of symbol
+   compare its own key (name, value, letter/number) without a function
+   pointer call per probe.
+------------------------------------------------------------------- */
+
+#ifndef SYMBOL_TABLE_H_
+#define SYMBOL_TABLE_H_
+
+#include "kernel.h"
+
+#include "mem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define SYMBOL_TABLE_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#define SYMBOL_TABLE_GROUP_SIZE     16
+#define SYMBOL_TABLE_EMPTY          0x80
+#define SYMBOL_TABLE_DELETED        0xFE
+
+typedef struct symbol_table_struct
+{
+    int64_t   count;              /* number of symbols in the table */
+    uint32_t  capacity;           /* number of slots (a power of two, at least one group) */
+    uint32_t  minimum_capacity;   /* table never shrinks below this size */
+    uint32_t  num_deleted;        /* number of slots holding a tombstone */
+    Symbol**  symbols;            /* symbol in each slot */
+    uint32_t* hashes;             /* mixed hash of the symbol in each slot */
+    uint8_t*  ctrl;               /* EMPTY, DELETED or fingerprint of each slot */
+} symbol_table;
+
+extern symbol_table* make_symbol_table(agent* thisAgent, uint32_t minimum_capacity);
+extern void free_symbol_table(agent* thisAgent, symbol_table* st);
+extern void add_to_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym, uint32_t hash_value);
+extern void remove_from_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym, uint32_t hash_value);
+extern void do_for_all_items_in_symbol_table(agent* thisAgent, symbol_table* st, hash_table_callback_fn2 f, void* userdata);
+extern void benchmark_symbol_tables(agent* thisAgent, uint64_t num_items);
+
+/* Spreads the bits of a raw symbol hash so that both the fingerprint (low bits)
+ * and the group index (high bits) are well distributed, even for sequential
+ * integers and identifier numbers. */
+inline uint32_t symbol_table_mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    return h;
+}
+
+/* Returns a bit mask with bit i set if byte i of the group equals b */
+inline uint32_t symbol_table_match_byte(const uint8_t* group, uint8_t b)
+{
+#ifdef SYMBOL_TABLE_USE_SSE2
+    __m128i lCtrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lCtrl, _mm_set1_epi8(static_cast<char>(b)))));
+#else
+    uint32_t lMask = 0;
+    for (int i = 0; i < SYMBOL_TABLE_GROUP_SIZE; i++)
+    {
+        if (group[i] == b) lMask |= (static_cast<uint32_t>(1) << i);
+    }
+    return lMask;
+#endif
+}
+
+/* Returns a bit mask with bit i set if slot i of the group is EMPTY or DELETED.  Both
+ * have their high bit set, which a fingerprint never does. */
+inline uint32_t symbol_table_match_free(const uint8_t* group)
+{
+#ifdef SYMBOL_TABLE_USE_SSE2
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    uint32_t lMask = 0;
+    for (int i = 0; i < SYMBOL_TABLE_GROUP_SIZE; i++)
+    {
+        if (group[i] & 0x80) lMask |= (static_cast<uint32_t>(1) << i);
+    }
+    return lMask;
+#endif
+}
+
+inline uint32_t symbol_table_lowest_bit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long lIndex;
+    _BitScanForward(&lIndex, mask);
+    return static_cast<uint32_t>(lIndex);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+/* Looks up the symbol with the given raw hash for which key_matches(sym) is true.
+ * Groups are visited in triangular order, which reaches every group of a
+ * power-of-two table, and the search stops at the first group with an EMPTY slot. */
+template <typename KeyMatch>
+inline Symbol* find_in_symbol_table(symbol_table* st, uint32_t hash_value, const KeyMatch& key_matches)
+{
+    uint32_t lHash = symbol_table_mix(hash_value);
+    uint8_t lFingerprint = static_cast<uint8_t>(lHash & 0x7F);
+    uint32_t lGroupMask = (st->capacity / SYMBOL_TABLE_GROUP_SIZE) - 1;
+    uint32_t lGroup = (lHash >> 7) & lGroupMask;
+
+    for (uint32_t lStep = 1; ; lStep++)
+    {
+        uint32_t lBase = lGroup * SYMBOL_TABLE_GROUP_SIZE;
+        const uint8_t* lCtrl = st->ctrl + lBase;
+        for (uint32_t lMatches = symbol_table_match_byte(lCtrl, lFingerprint); lMatches; lMatches &= lMatches - 1)
+        {
+            uint32_t lSlot = lBase + symbol_table_lowest_bit(lMatches);
+            if ((st->hashes[lSlot] == lHash) && key_matches(st->symbols[lSlot]))
+            {
+                return st->symbols[lSlot];
+            }
+        }
+        if (symbol_table_match_byte(lCtrl, SYMBOL_TABLE_EMPTY))
+        {
+            return NIL;
+        }
+        lGroup = (lGroup + lStep) & lGroupMask;
+    }
+}
+
+#endif /* SYMBOL_TABLE_H_ */
@@ -9,9 +9,11 @@
 #include "output_manager.h"
 #include "print.h"
 #include "rete.h"
+#include "semantic_memory.h"
 #include "slot.h"
 #include "soar_TraceNames.h"
 #include "symbol.h"
+#include "timeline.h"
 #include "working_memory_activation.h"
 #include "xml.h"
 
@@ -57,9 +59,10 @@ WM_Manager::WM_Manager(agent* myAgent)
     wma_stats = new wma_stat_container(thisAgent);
     wma_timers = new wma_timer_container(thisAgent);
 
-    wma_forget_pq = new wma_forget_p_queue();
-    wma_touched_sets = new wma_decay_cycle_set();
-    wma_touched_elements = new wme_set();
+    wma_forget_wheel = NULL;
+    wma_forget_overflow = NULL;
+    wma_forget_wheel_cycle = 0;
+    wma_touched_elements = new wma_decay_pool();
     wma_initialized = false;
     wma_tc_counter = 2;
 
@@ -72,9 +75,7 @@ void WM_Manager::clean_up_for_agent_deletion()
      * deletion code that may need params, stats or timers to exist */
 
     wma_params->activation->set_value(off);
-    delete wma_forget_pq;
     delete wma_touched_elements;
-    delete wma_touched_sets;
     delete wma_params;
     delete wma_stats;
     delete wma_timers;
@@ -264,6 +265,7 @@ void do_buffered_wm_changes(agent* thisAgent)
     local_timer.start();
 #endif
 #endif
+    thisAgent->timeline->begin(TIMELINE_MATCH);
     dprint(DT_WME_CHANGES, "...adding wmes_to_add to rete.\n");
     for (c = thisAgent->wmes_to_add; c != NIL; c = c->rest)
     {
@@ -276,6 +278,7 @@ void do_buffered_wm_changes(agent* thisAgent)
         dprint(DT_WME_CHANGES, "...removing %w from rete.\n", static_cast<wme_struct*>(c->first));
         remove_wme_from_rete(thisAgent, static_cast<wme_struct*>(c->first));
     }
+    thisAgent->timeline->end(TIMELINE_MATCH);
 #ifndef NO_TIMING_STUFF
 #ifdef DETAILED_TIMING_STATS
     local_timer.stop();
@@ -323,6 +326,10 @@ void do_buffered_wm_changes(agent* thisAgent)
         }
 
         dprint(DT_WME_CHANGES, "      %w:\n",w);
+        if (thisAgent->SMem->spreading_tracked())
+        {
+            thisAgent->SMem->spread_wme_added(w);
+        }
         wme_add_ref(w, true);
         free_cons(thisAgent, c);
         thisAgent->wme_addition_count++;
@@ -341,6 +348,10 @@ void do_buffered_wm_changes(agent* thisAgent)
         }
 
         dprint(DT_WME_CHANGES, "      %w:\n",w);
+        if (thisAgent->SMem->spreading_tracked())
+        {
+            thisAgent->SMem->spread_wme_removed(w);
+        }
         wme_remove_ref(thisAgent, w);
         free_cons(thisAgent, c);
         thisAgent->wme_removal_count++;
@@ -59,9 +59,10 @@ class WM_Manager
         wma_stat_container*     wma_stats;
         wma_timer_container*    wma_timers;
 
-        wme_set*                wma_touched_elements;
-        wma_forget_p_queue*     wma_forget_pq;
-        wma_decay_cycle_set*    wma_touched_sets;
+        wma_decay_pool*         wma_touched_elements;
+        wma_decay_element**     wma_forget_wheel;
+        wma_decay_element*      wma_forget_overflow;
+        wma_d_cycle             wma_forget_wheel_cycle;
 
         unsigned int            wma_power_size;
         double*                 wma_power_array;
@@ -23,6 +23,7 @@
 #include "preference.h"
 #include "output_manager.h"
 #include "slot.h"
+#include "timeline.h"
 #include "working_memory.h"
 #include "xml.h"
 
@@ -30,6 +31,11 @@
 #include <cmath>
 #include <cstdlib>
 
+#if (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+    #define WMA_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
 
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
@@ -146,6 +152,10 @@ wma_param_container::wma_param_container(agent* new_agent): soar_module::param_c
     // max size of power cache
     max_pow_cache = new soar_module::integer_param("max-pow-cache", 10, new soar_module::gt_predicate< int64_t >(0, false), new wma_activation_predicate< int64_t >(thisAgent));
     add(max_pow_cache);
+
+    // vectorized (reordered) sums for forgetting?
+    decay_fast_math = new soar_module::boolean_param("decay-fast-math", off, new soar_module::f_predicate<boolean>());
+    add(decay_fast_math);
 };
 
 //
@@ -254,22 +264,35 @@ void wma_init(agent* thisAgent)
     // calls to log
     thisAgent->WM->wma_thresh_exp = exp(decay_thresh);
 
-    // approximation cache
-    if (thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::approx)
+    // forgetting queue and lifetime cache: entry i is how many cycles
+    // i references made at once keep a WME at or above the threshold,
+    // the approximation looks it up directly and the binary search uses
+    // it to bound where the activation crosses the threshold
+    if ((thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::approx) || (thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::bsearch))
     {
-        thisAgent->WM->wma_approx_array = new wma_d_cycle[ WMA_REFERENCES_PER_DECISION ];
+        thisAgent->WM->wma_approx_array = new wma_d_cycle[ WMA_LIFETIME_CACHE_SIZE ];
 
         thisAgent->WM->wma_approx_array[0] = 0;
-        for (int i = 1; i < WMA_REFERENCES_PER_DECISION; i++)
+        for (int i = 1; i < WMA_LIFETIME_CACHE_SIZE; i++)
         {
             thisAgent->WM->wma_approx_array[i] = static_cast< wma_d_cycle >(ceil(exp(static_cast<double>(decay_thresh - log(static_cast<double>(i))) / static_cast<double>(decay_rate))));
         }
+
+        thisAgent->WM->wma_forget_wheel = new wma_decay_element*[ 2 * WMA_FORGET_WHEEL_SIZE ];
+        for (int i = 0; i < (2 * WMA_FORGET_WHEEL_SIZE); i++)
+        {
+            thisAgent->WM->wma_forget_wheel[i] = NULL;
+        }
+        thisAgent->WM->wma_forget_overflow = NULL;
+        thisAgent->WM->wma_forget_wheel_cycle = thisAgent->WM->wma_d_cycle_count;
     }
 
     // note initialization
     thisAgent->WM->wma_initialized = true;
 }
 
+inline void wma_forgetting_unlink(wma_decay_element* decay_el);
+inline void wma_clear_touched(agent* thisAgent);
 void wma_deinit(agent* thisAgent)
 {
     if (!thisAgent->WM->wma_initialized)
@@ -280,23 +303,30 @@ void wma_deinit(agent* thisAgent)
     // release power array memory
     delete[] thisAgent->WM->wma_power_array;
 
-    // release approximation array memory (if applicable)
-    if (thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::approx)
+    // release forgetting memory (if applicable)
+    if ((thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::approx) || (thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::bsearch))
     {
         delete[] thisAgent->WM->wma_approx_array;
-    }
 
-    // clear touched
-    thisAgent->WM->wma_touched_elements->clear();
-    thisAgent->WM->wma_touched_sets->clear();
+        // the decay elements outlive the queue, so unhook them
+        for (int i = 0; i < (2 * WMA_FORGET_WHEEL_SIZE); i++)
+        {
+            while (thisAgent->WM->wma_forget_wheel[i])
+            {
+                wma_forgetting_unlink(thisAgent->WM->wma_forget_wheel[i]);
+            }
+        }
+        while (thisAgent->WM->wma_forget_overflow)
+        {
+            wma_forgetting_unlink(thisAgent->WM->wma_forget_overflow);
+        }
 
-    // clear forgetting priority queue
-    for (wma_forget_p_queue::iterator pq_p = thisAgent->WM->wma_forget_pq->begin(); pq_p != thisAgent->WM->wma_forget_pq->end(); pq_p++)
-    {
-        pq_p->second->~wma_decay_set();
-        thisAgent->memoryManager->free_with_pool(MP_wma_decay_set, pq_p->second);
+        delete[] thisAgent->WM->wma_forget_wheel;
+        thisAgent->WM->wma_forget_wheel = NULL;
     }
-    thisAgent->WM->wma_forget_pq->clear();
+
+    // clear touched
+    wma_clear_touched(thisAgent);
 
     thisAgent->WM->wma_initialized = false;
 }
@@ -342,21 +372,28 @@ inline double wma_sum_history(agent* thisAgent, wma_history* history, wma_d_cycl
 {
     double return_val = 0.0;
 
+    const wma_d_cycle* d_cycles = history->d_cycles;
+    const wma_reference* references = history->references;
     unsigned int p = history->next_p;
-    unsigned int counter = history->history_ct;
     wma_d_cycle cycle_diff = 0;
 
-    //
-
-    while (counter)
+    // references are summed newest first: down from next_p and
+    // then, once the ring has wrapped, down from its top end
+    while (p)
     {
-        p = wma_history_prev(p);
-
-        cycle_diff = (current_cycle - history->access_history[ p ].d_cycle);
-
-        return_val += (history->access_history[ p ].num_references * wma_pow(thisAgent, cycle_diff));
+        p--;
+        cycle_diff = (current_cycle - d_cycles[ p ]);
+        return_val += (references[ p ] * wma_pow(thisAgent, cycle_diff));
+    }
 
-        counter--;
+    if (history->history_ct == WMA_DECAY_HISTORY)
+    {
+        for (p = WMA_DECAY_HISTORY; p > history->next_p;)
+        {
+            p--;
+            cycle_diff = (current_cycle - d_cycles[ p ]);
+            return_val += (references[ p ] * wma_pow(thisAgent, cycle_diff));
+        }
     }
 
     // see (Petrov, 2006)
@@ -408,6 +445,89 @@ inline double wma_calculate_decay_activation(agent* thisAgent, wma_decay_element
     }
 }
 
+// decay-fast-math: the sum of wma_sum_history, two history slots at a
+// time.  The terms are the same, but they are added up in another order,
+// so the sum may differ in its last bits.  Only forgetting (the check of
+// whether a WME is below threshold, and the search for when it will be)
+// uses it; reported activations are always from wma_sum_history.
+inline double wma_sum_history_fast(agent* thisAgent, wma_history* history, wma_d_cycle current_cycle)
+{
+    double return_val = 0.0;
+    unsigned int p = 0;
+
+#ifdef WMA_USE_SSE2
+    // the filled slots are always the first history_ct.  References are
+    // far below 2^52, so they convert to double exactly by or'ing them
+    // into the mantissa of 2^52.
+    __m128i lMagic = _mm_set1_epi64x(0x4330000000000000LL);
+    __m128d lMagicD = _mm_set1_pd(4503599627370496.0);
+    __m128d lSum = _mm_setzero_pd();
+    for (; (p + 2) <= history->history_ct; p += 2)
+    {
+        __m128d lRefs = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(history->references + p)), lMagic)), lMagicD);
+        __m128d lPows = _mm_set_pd(wma_pow(thisAgent, (current_cycle - history->d_cycles[ p + 1 ])), wma_pow(thisAgent, (current_cycle - history->d_cycles[ p ])));
+        lSum = _mm_add_pd(lSum, _mm_mul_pd(lRefs, lPows));
+    }
+
+    double lLanes[2];
+    _mm_storeu_pd(lLanes, lSum);
+    return_val = (lLanes[0] + lLanes[1]);
+#endif
+
+    for (; p < history->history_ct; p++)
+    {
+        return_val += (history->references[ p ] * wma_pow(thisAgent, (current_cycle - history->d_cycles[ p ])));
+    }
+
+    // see wma_sum_history: tk is the age of the oldest slot
+    if ((thisAgent->WM->wma_params->petrov_approx->get_value() == on) && (history->total_references > history->history_references))
+    {
+        double d_inv = (1 + thisAgent->WM->wma_params->decay_rate->get_value());
+        wma_d_cycle t_n = (current_cycle - history->first_reference);
+        wma_d_cycle t_k = (current_cycle - history->d_cycles[ (history->history_ct < WMA_DECAY_HISTORY) ? (0) : (history->next_p) ]);
+
+        return_val += (((history->total_references - history->history_references) * (pow(static_cast<double>(t_n), d_inv) - pow(static_cast<double>(t_k), d_inv))) /
+                       (d_inv * (t_n - t_k)));
+    }
+
+    return return_val;
+}
+
+// the (unlogged) sum forgetting compares to the threshold
+inline double wma_forgetting_decay_sum(agent* thisAgent, wma_decay_element* decay_el, wma_d_cycle current_cycle, bool fast_math)
+{
+    if (fast_math)
+    {
+        return ((decay_el->touches.history_ct) ? (wma_sum_history_fast(thisAgent, &(decay_el->touches), current_cycle)) : (0.0));
+    }
+
+    return wma_calculate_decay_activation(thisAgent, decay_el, current_cycle, false);
+}
+
+// elements referenced this cycle are pooled in the order they
+// were first touched, so the history update is a single pass
+// over a flat array; removal leaves a NULL in the slot
+inline void wma_touch_element(agent* thisAgent, wma_decay_element* decay_el)
+{
+    if (decay_el->touched_p == WMA_UNTOUCHED)
+    {
+        decay_el->touched_p = static_cast< unsigned int >(thisAgent->WM->wma_touched_elements->size());
+        thisAgent->WM->wma_touched_elements->push_back(decay_el);
+    }
+}
+
+inline void wma_clear_touched(agent* thisAgent)
+{
+    for (wma_decay_pool::iterator el_p = thisAgent->WM->wma_touched_elements->begin(); el_p != thisAgent->WM->wma_touched_elements->end(); el_p++)
+    {
+        if (*el_p)
+        {
+            (*el_p)->touched_p = WMA_UNTOUCHED;
+        }
+    }
+    thisAgent->WM->wma_touched_elements->clear();
+}
+
 inline wma_reference wma_calculate_initial_boost(agent* thisAgent, wme* w)
 {
     wma_reference return_val = 0;
@@ -497,8 +617,8 @@ void wma_activate_wme(agent* thisAgent, wme* w, wma_reference num_references, wm
 
             for (int i = 0; i < WMA_DECAY_HISTORY; i++)
             {
-                temp_el->touches.access_history[ i ].d_cycle = 0;
-                temp_el->touches.access_history[ i ].num_references = 0;
+                temp_el->touches.d_cycles[ i ] = 0;
+                temp_el->touches.references[ i ] = 0;
             }
 
             temp_el->touches.history_references = 0;
@@ -507,6 +627,10 @@ void wma_activate_wme(agent* thisAgent, wme* w, wma_reference num_references, wm
 
             // prevents confusion with delayed forgetting
             temp_el->forget_cycle = static_cast< wma_d_cycle >(-1);
+            temp_el->forget_next = NULL;
+            temp_el->forget_prev = NULL;
+
+            temp_el->touched_p = WMA_UNTOUCHED;
 
             w->wma_decay_el = temp_el;
 
@@ -582,7 +706,7 @@ void wma_activate_wme(agent* thisAgent, wme* w, wma_reference num_references, wm
         else
         {
             temp_el->num_references += num_references;
-            thisAgent->WM->wma_touched_elements->insert(w);
+            wma_touch_element(thisAgent, temp_el);
         }
     }
     // i-supported, non-architectural WME
@@ -630,7 +754,7 @@ void wma_activate_wme(agent* thisAgent, wme* w, wma_reference num_references, wm
                 if ((*wme_p)->wma_decay_el)
                 {
                     (*wme_p)->wma_decay_el->num_references += num_references;
-                    thisAgent->WM->wma_touched_elements->insert((*wme_p));
+                    wma_touch_element(thisAgent, (*wme_p)->wma_decay_el);
                 }
             }
         }
@@ -655,7 +779,11 @@ void wma_deactivate_element(agent* thisAgent, wme* w)
     {
         if (!temp_el->just_removed)
         {
-            thisAgent->WM->wma_touched_elements->erase(w);
+            if (temp_el->touched_p != WMA_UNTOUCHED)
+            {
+                (*thisAgent->WM->wma_touched_elements)[ temp_el->touched_p ] = NULL;
+                temp_el->touched_p = WMA_UNTOUCHED;
+            }
 
             if ((thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::approx) || (thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::bsearch))
             {
@@ -732,52 +860,88 @@ void wma_remove_pref_o_set(agent* thisAgent, preference* pref)
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
 
-inline void wma_forgetting_add_to_p_queue(agent* thisAgent, wma_decay_element* decay_el, wma_d_cycle new_cycle)
+inline void wma_forgetting_link(wma_decay_element** list, wma_decay_element* decay_el)
 {
-    if (decay_el)
+    decay_el->forget_next = (*list);
+    if (decay_el->forget_next)
     {
-        decay_el->forget_cycle = new_cycle;
+        decay_el->forget_next->forget_prev = &(decay_el->forget_next);
+    }
+    decay_el->forget_prev = list;
+    (*list) = decay_el;
+}
 
-        wma_forget_p_queue::iterator pq_p = thisAgent->WM->wma_forget_pq->find(new_cycle);
-        if (pq_p == thisAgent->WM->wma_forget_pq->end())
-        {
-            wma_decay_set* newbie;
-            thisAgent->memoryManager->allocate_with_pool(MP_wma_decay_set, &newbie);
-#ifdef USE_MEM_POOL_ALLOCATORS
-            newbie = new(newbie) wma_decay_set(std::less< wma_decay_element* >(), soar_module::soar_memory_pool_allocator< wma_decay_element* >(thisAgent));
-#else
-            newbie = new(newbie) wma_decay_set();
-#endif
-            newbie->insert(decay_el);
+inline void wma_forgetting_unlink(wma_decay_element* decay_el)
+{
+    (*decay_el->forget_prev) = decay_el->forget_next;
+    if (decay_el->forget_next)
+    {
+        decay_el->forget_next->forget_prev = decay_el->forget_prev;
+    }
+    decay_el->forget_next = NULL;
+    decay_el->forget_prev = NULL;
+}
 
-            thisAgent->WM->wma_forget_pq->insert(std::make_pair(new_cycle, newbie));
-        }
-        else
+// finds the bucket for a cycle relative to the last one processed
+inline wma_decay_element** wma_forgetting_bucket(agent* thisAgent, wma_d_cycle forget_cycle)
+{
+    wma_d_cycle wheel_cycle = thisAgent->WM->wma_forget_wheel_cycle;
+
+    // already past, so handle with the next cycle
+    if (forget_cycle <= wheel_cycle)
+    {
+        forget_cycle = (wheel_cycle + 1);
+    }
+
+    if ((forget_cycle >> WMA_FORGET_WHEEL_BITS) == (wheel_cycle >> WMA_FORGET_WHEEL_BITS))
+    {
+        return &(thisAgent->WM->wma_forget_wheel[ forget_cycle & WMA_FORGET_WHEEL_MASK ]);
+    }
+    else if ((forget_cycle >> (2 * WMA_FORGET_WHEEL_BITS)) == (wheel_cycle >> (2 * WMA_FORGET_WHEEL_BITS)))
+    {
+        return &(thisAgent->WM->wma_forget_wheel[ WMA_FORGET_WHEEL_SIZE + ((forget_cycle >> WMA_FORGET_WHEEL_BITS) & WMA_FORGET_WHEEL_MASK) ]);
+    }
+    else
+    {
+        return &(thisAgent->WM->wma_forget_overflow);
+    }
+}
+
+// re-buckets everything on a list, which moves it down a level
+inline void wma_forgetting_cascade(agent* thisAgent, wma_decay_element** list)
+{
+    wma_decay_element* pending = (*list);
+    wma_decay_element* decay_el;
+
+    if (pending)
+    {
+        (*list) = NULL;
+        pending->forget_prev = &pending;
+
+        while (pending)
         {
-            pq_p->second->insert(decay_el);
+            decay_el = pending;
+            wma_forgetting_unlink(decay_el);
+            wma_forgetting_link(wma_forgetting_bucket(thisAgent, decay_el->forget_cycle), decay_el);
         }
     }
 }
 
-inline void wma_forgetting_remove_from_p_queue(agent* thisAgent, wma_decay_element* decay_el)
+inline void wma_forgetting_add_to_p_queue(agent* thisAgent, wma_decay_element* decay_el, wma_d_cycle new_cycle)
 {
     if (decay_el)
     {
-        // try to find set for the element per cycle
-        wma_forget_p_queue::iterator pq_p = thisAgent->WM->wma_forget_pq->find(decay_el->forget_cycle);
-        if (pq_p != thisAgent->WM->wma_forget_pq->end())
-        {
-            wma_decay_set::iterator d_p = pq_p->second->find(decay_el);
-            if (d_p != pq_p->second->end())
-            {
-                pq_p->second->erase(d_p);
+        decay_el->forget_cycle = new_cycle;
 
-                if (pq_p->second->empty())
-                {
-                    thisAgent->WM->wma_touched_sets->insert(pq_p->first);
-                }
-            }
-        }
+        wma_forgetting_link(wma_forgetting_bucket(thisAgent, new_cycle), decay_el);
+    }
+}
+
+inline void wma_forgetting_remove_from_p_queue(agent* /*thisAgent*/, wma_decay_element* decay_el)
+{
+    if (decay_el && decay_el->forget_prev)
+    {
+        wma_forgetting_unlink(decay_el);
     }
 }
 
@@ -790,6 +954,22 @@ inline void wma_forgetting_move_in_p_queue(agent* thisAgent, wma_decay_element*
     }
 }
 
+// cycles that this many references made at once stay at or above threshold
+inline wma_d_cycle wma_forgetting_lifetime(agent* thisAgent, wma_reference num_references)
+{
+    if (num_references < WMA_LIFETIME_CACHE_SIZE)
+    {
+        return thisAgent->WM->wma_approx_array[ num_references ];
+    }
+    else
+    {
+        double decay_rate = thisAgent->WM->wma_params->decay_rate->get_value();
+        double decay_thresh = thisAgent->WM->wma_params->decay_thresh->get_value();
+
+        return static_cast< wma_d_cycle >(ceil(exp((decay_thresh - log(static_cast<double>(num_references))) / decay_rate)));
+    }
+}
+
 inline wma_d_cycle wma_forgetting_estimate_cycle(agent* thisAgent, wma_decay_element* decay_el, bool fresh_reference)
 {
     wma_d_cycle return_val = static_cast<wma_d_cycle>(thisAgent->WM->wma_d_cycle_count);
@@ -800,26 +980,20 @@ inline wma_d_cycle wma_forgetting_estimate_cycle(agent* thisAgent, wma_decay_ele
         wma_d_cycle to_add = 0;
 
         wma_history* history = &(decay_el->touches);
-        unsigned int p = history->next_p;
-        unsigned int counter = history->history_ct;
         wma_d_cycle cycle_diff = 0;
         wma_reference approx_ref;
 
-        //
-
-        while (counter)
+        // the filled slots are always the first history_ct, and
+        // the order they are added up in makes no difference
+        for (unsigned int p = 0; p < history->history_ct; p++)
         {
-            p = wma_history_prev(p);
+            cycle_diff = (return_val - history->d_cycles[ p ]);
 
-            cycle_diff = (return_val - history->access_history[ p ].d_cycle);
-
-            approx_ref = ((history->access_history[ p ].num_references < WMA_REFERENCES_PER_DECISION) ? (history->access_history[ p ].num_references) : (WMA_REFERENCES_PER_DECISION - 1));
+            approx_ref = ((history->references[ p ] < WMA_REFERENCES_PER_DECISION) ? (history->references[ p ]) : (WMA_REFERENCES_PER_DECISION - 1));
             if (thisAgent->WM->wma_approx_array[ approx_ref ] > cycle_diff)
             {
                 to_add += (thisAgent->WM->wma_approx_array[ approx_ref ] - cycle_diff);
             }
-
-            counter--;
         }
 
         return_val += to_add;
@@ -828,62 +1002,62 @@ inline wma_d_cycle wma_forgetting_estimate_cycle(agent* thisAgent, wma_decay_ele
     if (return_val == static_cast<wma_d_cycle>(thisAgent->WM->wma_d_cycle_count))
     {
         double my_thresh = thisAgent->WM->wma_thresh_exp;
+        bool fast_math = (thisAgent->WM->wma_params->decay_fast_math->get_value() == on);
 
         // binary parameter search
         {
-            wma_d_cycle to_add = 1;
-            double act = wma_calculate_decay_activation(thisAgent, decay_el, (return_val + to_add), false);
-
-            if (act >= my_thresh)
+            // with k references in the history, the sum is at least
+            // k * ( t - oldest )^-d and at most k * ( t - newest )^-d,
+            // so it drops below threshold no sooner than the lifetime
+            // of k references after the oldest, and no later than that
+            // lifetime after the newest
+            wma_history* history = &(decay_el->touches);
+            wma_d_cycle lower_bound = (return_val + 1);
+            wma_d_cycle upper_bound = lower_bound;
+            wma_d_cycle mid;
+
+            if (history->history_ct)
             {
-                while (act >= my_thresh)
-                {
-                    to_add *= 2;
-                    act = wma_calculate_decay_activation(thisAgent, decay_el, (return_val + to_add), false);
-                }
+                wma_d_cycle lifetime = wma_forgetting_lifetime(thisAgent, history->history_references);
+                wma_d_cycle oldest = history->d_cycles[ (history->history_ct < WMA_DECAY_HISTORY) ? (0) : (history->next_p) ];
+                wma_d_cycle newest = history->d_cycles[ wma_history_prev(history->next_p) ];
 
-                //
-
-                wma_d_cycle upper_bound = to_add;
-                wma_d_cycle lower_bound, mid;
-                if (to_add < 4)
-                {
-                    lower_bound = upper_bound;
-                }
-                else
+                if ((oldest + lifetime) > lower_bound)
                 {
-                    lower_bound = (to_add / 2);
+                    lower_bound = (oldest + lifetime);
                 }
 
-                while (lower_bound != upper_bound)
+                upper_bound = (newest + lifetime + 1);
+                if (upper_bound < lower_bound)
                 {
-                    mid = ((lower_bound + upper_bound) / 2);
-                    act = wma_calculate_decay_activation(thisAgent, decay_el, (return_val + mid), false);
+                    upper_bound = lower_bound;
+                }
+            }
 
-                    if (act < my_thresh)
-                    {
-                        upper_bound = mid;
+            // the petrov approximation adds to the sum, so
+            // the upper bound may need to be pushed out
+            while (wma_forgetting_decay_sum(thisAgent, decay_el, upper_bound, fast_math) >= my_thresh)
+            {
+                lower_bound = (upper_bound + 1);
+                upper_bound += (upper_bound - return_val);
+            }
 
-                        if (upper_bound - lower_bound <= 1)
-                        {
-                            lower_bound = mid;
-                        }
-                    }
-                    else
-                    {
-                        lower_bound = mid;
+            // first cycle in the window below threshold
+            while (lower_bound < upper_bound)
+            {
+                mid = (lower_bound + ((upper_bound - lower_bound) / 2));
 
-                        if (upper_bound - lower_bound <= 1)
-                        {
-                            lower_bound = upper_bound;
-                        }
-                    }
+                if (wma_forgetting_decay_sum(thisAgent, decay_el, mid, fast_math) < my_thresh)
+                {
+                    upper_bound = mid;
+                }
+                else
+                {
+                    lower_bound = (mid + 1);
                 }
-
-                to_add = upper_bound;
             }
 
-            return_val += to_add;
+            return_val = upper_bound;
         }
     }
 
@@ -927,96 +1101,99 @@ inline bool wma_forgetting_update_p_queue(agent* thisAgent)
     slot* s;
     wme* w;
 
-    if (!thisAgent->WM->wma_forget_pq->empty())
+    wma_d_cycle current_cycle = thisAgent->WM->wma_d_cycle_count;
+    double decay_thresh = thisAgent->WM->wma_thresh_exp;
+    bool forget_only_lti = (thisAgent->WM->wma_params->forget_wme->get_value() == wma_param_container::lti);
+    bool fast_math = (thisAgent->WM->wma_params->decay_fast_math->get_value() == on);
+
+    wma_decay_element** wheel = thisAgent->WM->wma_forget_wheel;
+    wma_decay_element* due;
+    wma_decay_element* decay_el;
+
+    // normally just the current cycle
+    while (thisAgent->WM->wma_forget_wheel_cycle < current_cycle)
     {
-        wma_forget_p_queue::iterator pq_p = thisAgent->WM->wma_forget_pq->begin();
-        wma_d_cycle current_cycle = thisAgent->WM->wma_d_cycle_count;
-        double decay_thresh = thisAgent->WM->wma_thresh_exp;
-        bool forget_only_lti = (thisAgent->WM->wma_params->forget_wme->get_value() == wma_param_container::lti);
+        wma_d_cycle wheel_cycle = ++(thisAgent->WM->wma_forget_wheel_cycle);
+
+        // bring down whatever falls in the new epoch/revolution
+        if ((wheel_cycle & WMA_FORGET_EPOCH_MASK) == 0)
+        {
+            wma_forgetting_cascade(thisAgent, &(thisAgent->WM->wma_forget_overflow));
+        }
+        if ((wheel_cycle & WMA_FORGET_WHEEL_MASK) == 0)
+        {
+            wma_forgetting_cascade(thisAgent, &(wheel[ WMA_FORGET_WHEEL_SIZE + ((wheel_cycle >> WMA_FORGET_WHEEL_BITS) & WMA_FORGET_WHEEL_MASK) ]));
+        }
+
+        // detach the bucket, so that elements can be
+        // re-queued (or removed) while we walk it
+        due = wheel[ wheel_cycle & WMA_FORGET_WHEEL_MASK ];
+        if (!due)
+        {
+            continue;
+        }
+        wheel[ wheel_cycle & WMA_FORGET_WHEEL_MASK ] = NULL;
+        due->forget_prev = &due;
 
-        if (pq_p->first == current_cycle)
+        while (due)
         {
-            wma_decay_set::iterator d_p = pq_p->second->begin();
-            wma_decay_set::iterator current_p;
+            decay_el = due;
+            wma_forgetting_unlink(decay_el);
 
-            while (d_p != pq_p->second->end())
+            if (wma_forgetting_decay_sum(thisAgent, decay_el, current_cycle, fast_math) < decay_thresh)
             {
-                current_p = d_p++;
+                decay_el->forget_cycle = WMA_FORGOTTEN_CYCLE;
 
-                if (wma_calculate_decay_activation(thisAgent, (*current_p), current_cycle, false) < decay_thresh)
+                if (!forget_only_lti || (decay_el->this_wme->id->id->LTI_ID != NIL))
                 {
-                    (*current_p)->forget_cycle = WMA_FORGOTTEN_CYCLE;
+                    do_forget = true;
 
-                    if (!forget_only_lti || ((*current_p)->this_wme->id->id->LTI_ID != NIL))
+                    // implements all-or-nothing check for lti mode
+                    if (forget_only_lti)
                     {
-                        do_forget = true;
-
-                        // implements all-or-nothing check for lti mode
-                        if (forget_only_lti)
+                        for (s = decay_el->this_wme->id->id->slots; (s && do_forget); s = s->next)
                         {
-                            for (s = (*current_p)->this_wme->id->id->slots; (s && do_forget); s = s->next)
+                            for (w = s->wmes; (w && do_forget); w = w->next)
                             {
-                                for (w = s->wmes; (w && do_forget); w = w->next)
+                                if (w->preference->o_supported && (!w->wma_decay_el || (w->wma_decay_el->forget_cycle != WMA_FORGOTTEN_CYCLE)))
                                 {
-                                    if (w->preference->o_supported && (!w->wma_decay_el || (w->wma_decay_el->forget_cycle != WMA_FORGOTTEN_CYCLE)))
-                                    {
-                                        do_forget = false;
-                                    }
+                                    do_forget = false;
                                 }
                             }
                         }
+                    }
 
-                        if (do_forget)
+                    if (do_forget)
+                    {
+                        if (forget_only_lti)
                         {
-                            if (forget_only_lti)
+                            // implements all-or-nothing forget for lti mode
+                            for (s = decay_el->this_wme->id->id->slots; (s && do_forget); s = s->next)
                             {
-                                // implements all-or-nothing forget for lti mode
-                                for (s = (*current_p)->this_wme->id->id->slots; (s && do_forget); s = s->next)
+                                for (w = s->wmes; (w && do_forget); w = w->next)
                                 {
-                                    for (w = s->wmes; (w && do_forget); w = w->next)
+                                    if (wma_forgetting_forget_wme(thisAgent, w))
                                     {
-                                        if (wma_forgetting_forget_wme(thisAgent, w))
-                                        {
-                                            return_val = true;
-                                        }
+                                        return_val = true;
                                     }
                                 }
                             }
-                            else
+                        }
+                        else
+                        {
+                            if (wma_forgetting_forget_wme(thisAgent, decay_el->this_wme))
                             {
-                                if (wma_forgetting_forget_wme(thisAgent, (*current_p)->this_wme))
-                                {
-                                    return_val = true;
-                                }
+                                return_val = true;
                             }
                         }
                     }
                 }
-                else
-                {
-                    wma_forgetting_move_in_p_queue(thisAgent, (*current_p), wma_forgetting_estimate_cycle(thisAgent, (*current_p), false));
-                }
             }
-
-            // clean up decay set
-            thisAgent->WM->wma_touched_sets->insert(pq_p->first);
-            pq_p->second->clear();
-        }
-
-        // clean up touched sets
-        for (wma_decay_cycle_set::iterator touched_it = thisAgent->WM->wma_touched_sets->begin(); touched_it != thisAgent->WM->wma_touched_sets->end(); touched_it++)
-        {
-            pq_p = thisAgent->WM->wma_forget_pq->find(*touched_it);
-
-            if ((pq_p != thisAgent->WM->wma_forget_pq->end()) && (pq_p->second->empty()))
+            else
             {
-                pq_p->second->~wma_decay_set();
-                thisAgent->memoryManager->free_with_pool(MP_wma_decay_set, pq_p->second);
-
-                thisAgent->WM->wma_forget_pq->erase(pq_p);
+                wma_forgetting_add_to_p_queue(thisAgent, decay_el, wma_forgetting_estimate_cycle(thisAgent, decay_el, false));
             }
         }
-        thisAgent->WM->wma_touched_sets->clear();
     }
 
     return return_val;
@@ -1027,6 +1204,7 @@ inline bool wma_forgetting_naive_sweep(agent* thisAgent)
     wma_d_cycle current_cycle = thisAgent->WM->wma_d_cycle_count;
     double decay_thresh = thisAgent->WM->wma_thresh_exp;
     bool forget_only_lti = (thisAgent->WM->wma_params->forget_wme->get_value() == wma_param_container::lti);
+    bool fast_math = (thisAgent->WM->wma_params->decay_fast_math->get_value() == on);
     bool return_val = false;
 
     for (wme* w = thisAgent->all_wmes_in_rete; w; w = w->rete_next)
@@ -1038,8 +1216,8 @@ inline bool wma_forgetting_naive_sweep(agent* thisAgent)
             // - not have been accessed this cycle (i.e. no decay)
             // - have activation less than threshold
             if ((w->wma_decay_el->touches.total_references > 0) &&
-                    (w->wma_decay_el->touches.access_history[ wma_history_prev(w->wma_decay_el->touches.next_p) ].d_cycle < current_cycle) &&
-                    (wma_calculate_decay_activation(thisAgent, w->wma_decay_el, current_cycle, false) < decay_thresh))
+                    (w->wma_decay_el->touches.d_cycles[ wma_history_prev(w->wma_decay_el->touches.next_p) ] < current_cycle) &&
+                    (wma_forgetting_decay_sum(thisAgent, w->wma_decay_el, current_cycle, fast_math) < decay_thresh))
             {
                 if (wma_forgetting_forget_wme(thisAgent, w))
                 {
@@ -1124,23 +1302,30 @@ void wma_activate_wmes_tested_in_prods(agent* thisAgent)
 
 inline void wma_update_decay_histories(agent* thisAgent)
 {
-    wme_set::iterator wme_p;
+    wma_decay_pool::iterator el_p;
     wma_decay_element* temp_el;
     wma_d_cycle current_cycle = thisAgent->WM->wma_d_cycle_count;
     bool forgetting = ((thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::approx) || (thisAgent->WM->wma_params->forgetting->get_value() == wma_param_container::bsearch));
 
     // add to history for changed elements
-    for (wme_p = thisAgent->WM->wma_touched_elements->begin(); wme_p != thisAgent->WM->wma_touched_elements->end(); wme_p++)
+    for (el_p = thisAgent->WM->wma_touched_elements->begin(); el_p != thisAgent->WM->wma_touched_elements->end(); el_p++)
     {
-        temp_el = (*wme_p)->wma_decay_el;
+        temp_el = (*el_p);
+
+        // removed from working memory since it was touched
+        if (!temp_el)
+        {
+            continue;
+        }
+        temp_el->touched_p = WMA_UNTOUCHED;
 
         // update number of references in the current history
         // (has to come before history overwrite)
-        temp_el->touches.history_references += (temp_el->num_references - temp_el->touches.access_history[ temp_el->touches.next_p ].num_references);
+        temp_el->touches.history_references += (temp_el->num_references - temp_el->touches.references[ temp_el->touches.next_p ]);
 
         // set history
-        temp_el->touches.access_history[ temp_el->touches.next_p ].d_cycle = current_cycle;
-        temp_el->touches.access_history[ temp_el->touches.next_p ].num_references = temp_el->num_references;
+        temp_el->touches.d_cycles[ temp_el->touches.next_p ] = current_cycle;
+        temp_el->touches.references[ temp_el->touches.next_p ] = temp_el->num_references;
 
         // log
         if (thisAgent->trace_settings[ TRACE_WMA_SYSPARAM ])
@@ -1224,17 +1409,17 @@ double wma_get_wme_activation(agent* thisAgent, wme* w, bool log_result)
     return return_val;
 }
 
-inline void _wma_ref_to_str(wma_cycle_reference& ref, wma_d_cycle current_cycle, std::string& str)
+inline void _wma_ref_to_str(wma_reference num_references, wma_d_cycle d_cycle, wma_d_cycle current_cycle, std::string& str)
 {
     std::string temp;
-    wma_d_cycle cycle_diff = (current_cycle - ref.d_cycle);
+    wma_d_cycle cycle_diff = (current_cycle - d_cycle);
 
-    to_string(ref.num_references, temp);
+    to_string(num_references, temp);
     str.append(temp);
 
     str.append(" @ d");
 
-    to_string(ref.d_cycle, temp);
+    to_string(d_cycle, temp);
     str.append(temp);
 
     str.append(" (-");
@@ -1285,7 +1470,7 @@ void wma_get_wme_history(agent* thisAgent, wme* w, std::string& buffer)
             counter--;
 
             buffer.append("\n ");
-            _wma_ref_to_str(history->access_history[ p ], current_cycle, buffer);
+            _wma_ref_to_str(history->references[ p ], history->d_cycles[ p ], current_cycle, buffer);
         }
 
         //
@@ -1310,6 +1495,8 @@ void wma_get_wme_history(agent* thisAgent, wme* w, std::string& buffer)
 
 void wma_go(agent* thisAgent, wma_go_action go_action)
 {
+    timeline_scope lTimeline(thisAgent->timeline, TIMELINE_WMA);
+
     // update history for all touched elements
     if (go_action == wma_histories)
     {
@@ -34,6 +34,31 @@
   */
 #define WMA_REFERENCES_PER_DECISION 50
 
+/**
+ * Size of the cache of how many cycles a number of
+ * simultaneous references keeps a WME above the
+ * forgetting threshold
+ */
+#define WMA_LIFETIME_CACHE_SIZE ( WMA_DECAY_HISTORY * WMA_REFERENCES_PER_DECISION )
+
+/**
+ * The forgetting queue is a two-level timing wheel. The
+ * first level has a bucket for every cycle of the current
+ * revolution, the second a bucket for every revolution of
+ * the current epoch. Anything due later waits on an overflow
+ * list. Buckets are moved down a level as their time comes.
+ */
+#define WMA_FORGET_WHEEL_BITS 10
+#define WMA_FORGET_WHEEL_SIZE ( 1 << WMA_FORGET_WHEEL_BITS )
+#define WMA_FORGET_WHEEL_MASK ( WMA_FORGET_WHEEL_SIZE - 1 )
+#define WMA_FORGET_EPOCH_MASK ( ( static_cast< uint64_t >( 1 ) << ( 2 * WMA_FORGET_WHEEL_BITS ) ) - 1 )
+
+/**
+ * Marks a decay element that is not in the pool of
+ * elements touched this cycle.
+ */
+#define WMA_UNTOUCHED static_cast< unsigned int >( -1 )
+
 /**
  * If an external caller asks for the activation level/value
  * of a WME that is not activated, then this is the value that
@@ -78,6 +103,7 @@ class wma_param_container: public soar_module::param_container
         // performance
         soar_module::constant_param< soar_module::timer::timer_level >* timers;
         soar_module::integer_param* max_pow_cache;
+        soar_module::boolean_param* decay_fast_math;
 
         wma_param_container(agent* new_agent);
 };
@@ -154,15 +180,13 @@ class wma_timer: public soar_module::timer
 typedef uint64_t wma_reference;
 typedef uint64_t wma_d_cycle;
 
-typedef struct wma_cycle_reference_struct
-{
-    wma_reference num_references;
-    wma_d_cycle d_cycle;
-} wma_cycle_reference;
-
+// the ring of recent references is kept as parallel arrays,
+// rather than an array of (cycle, count) pairs, so that summing
+// a history reads each one as a contiguous run
 typedef struct wma_history_struct
 {
-    wma_cycle_reference access_history[ WMA_DECAY_HISTORY ];
+    wma_d_cycle d_cycles[ WMA_DECAY_HISTORY ];
+    wma_reference references[ WMA_DECAY_HISTORY ];
     unsigned int next_p;
     unsigned int history_ct;
 
@@ -199,6 +223,16 @@ typedef struct wma_decay_element_struct
     // we need to forget this wme
     wma_d_cycle forget_cycle;
 
+    // links within its forgetting queue bucket; forget_prev
+    // points at whatever points at this element and is NULL
+    // when the element is not queued
+    struct wma_decay_element_struct* forget_next;
+    struct wma_decay_element_struct** forget_prev;
+
+    // slot in this cycle's pool of touched elements, or
+    // WMA_UNTOUCHED if it has not been referenced this cycle
+    unsigned int touched_p;
+
 } wma_decay_element;
 
 enum wma_go_action { wma_histories, wma_forgetting };
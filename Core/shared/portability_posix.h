@@ -182,5 +182,15 @@ inline double get_raw_time_per_usec()
 
 #endif
 
+#include <ctime>
+
+// CPU time consumed so far by the calling thread
+inline uint64_t get_thread_cpu_usec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
 #endif // PORTABILITY_POSIX_H
 
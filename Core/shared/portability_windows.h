@@ -148,5 +148,19 @@ inline double get_raw_time_per_usec() {
 	}
 }
 
+// CPU time consumed so far by the calling thread
+inline uint64_t get_thread_cpu_usec() {
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+		return 0;
+	}
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (k.QuadPart + u.QuadPart) / 10; // FILETIME counts 100ns intervals
+}
+
 #endif // PORTABILITY_WINDOWS_H
 
@@ -4,6 +4,8 @@
 #include "sml_Client.h"
 #include "sml_Connection.h"
 
+#include <chrono>
+
 using namespace std;
 using namespace sml;
 
@@ -67,6 +69,72 @@ void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, con
     cout.flush();
 }
 
+/* Runs numAgents copies of the agent together, stepping them on numThreads threads.  Records
+ * wall clock time, since kernel time is summed over all agents and doesn't show any speedup. */
+void Run_MultiAgentPerformanceTest(int numTrials, int numDecisions, int numAgents, int numThreads, StatsTracker* pSt, const vector<string>& commands, int numInits, const vector<string>& init_commands)
+{
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInNewThread();
+        kernel->SetAgentRunThreads(numThreads);
+        cout << (i+1) << " ";
+        cout.flush();
+
+        vector<Agent*> agents;
+        for (int a = 0; a < numAgents; ++a)
+        {
+            string agentName = "Soar" + to_string(a + 1);
+            Agent* agent = kernel->CreateAgent(agentName.c_str());
+            agent->SetOutputLinkChangeTracking(false);
+            for (int j = 0; j < commands.size(); ++j)
+            {
+                agent->ExecuteCommandLine(commands[j].c_str());
+            }
+            agents.push_back(agent);
+        }
+
+        for (int pass = 0; pass <= numInits; ++pass)
+        {
+            if (pass > 0)
+            {
+                for (int a = 0; a < numAgents; ++a)
+                {
+                    for (int j = 0; j < init_commands.size(); ++j)
+                    {
+                        agents[a]->ExecuteCommandLine(init_commands[j].c_str());
+                    }
+                }
+                cout << ".";
+                cout.flush();
+            }
+
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            if (numDecisions > 0)
+            {
+                kernel->RunAllAgents(numDecisions);
+            }
+            else
+            {
+                kernel->RunAllAgentsForever();
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            pSt->realtimes.push_back(seconds);
+            pSt->kerneltimes.push_back(seconds);
+            pSt->totaltimes.push_back(seconds);
+        }
+
+        kernel->Shutdown();
+        delete kernel;
+
+        if (!numInits) cout << "✅  "; else cout << "✅\n";
+        cout.flush();
+    }
+
+    cout << endl;
+    cout.flush();
+}
+
 int main(int argc, char* argv[])
 {
     set_working_directory_to_executable_path();
@@ -75,6 +143,8 @@ int main(int argc, char* argv[])
     int numTrials = DEFAULT_TRIALS;
     int numDCs = DEFAULT_DCS;
     int numInits = DEFAULT_INITS;
+    int numAgents = 1;
+    int numThreads = 1;
 
     if (argc == 1)
     {
@@ -102,9 +172,18 @@ int main(int argc, char* argv[])
         stringstream(argv[3]) >> numDCs;
         stringstream(argv[4]) >> numInits;
     }
+    else if (argc == 6 || argc == 7)
+    {
+        agentname = argv[1];
+        stringstream(argv[2]) >> numTrials;
+        stringstream(argv[3]) >> numDCs;
+        stringstream(argv[4]) >> numInits;
+        stringstream(argv[5]) >> numAgents;
+        if (argc == 7) stringstream(argv[6]) >> numThreads;
+    }
     else
     {
-        cout << "Usage: " << argv[0] << " [default | <agent name>] [<numtrials>] [<num_decisions>] [<num_init_and_rerun>]" << endl;
+        cout << "Usage: " << argv[0] << " [default | <agent name>] [<numtrials>] [<num_decisions>] [<num_init_and_rerun>] [<num_agents>] [<num_run_threads>]" << endl;
         return 1;
     }
     if (!strcmp(agentname, "default"))
@@ -116,6 +195,7 @@ int main(int argc, char* argv[])
     cout << "\e[1;31m" << agentname << "\e[0;37m" << ": ";
     if (numTrials > 1) cout << numTrials << " trials"; else cout << "single run";
     if (numDCs > 0) cout << ", " << numDCs << " DCs"; else cout << ", run forever";
+    if (numAgents > 1) cout << ", " << numAgents << " agents on " << numThreads << " threads";
     if (numInits > 0) cout << ", " << numInits << " extra init-soar/runs\n"; else cout << endl;
     cout.flush();
 
@@ -139,9 +219,19 @@ int main(int argc, char* argv[])
         init_commands.push_back("excise -c");
         init_commands.push_back("srand 3");
 
-        Run_PerformanceTest(numTrials, numDCs, &l_testStats, commands, numInits, init_commands);
+        if (numAgents > 1)
+        {
+            Run_MultiAgentPerformanceTest(numTrials, numDCs, numAgents, numThreads, &l_testStats, commands, numInits, init_commands);
+
+            string testName = string(agentname) + " x" + to_string(numAgents) + " (" + to_string(numThreads) + " threads)";
+            l_testStats.PrintResults(testName.c_str());
+        }
+        else
+        {
+            Run_PerformanceTest(numTrials, numDCs, &l_testStats, commands, numInits, init_commands);
 
-        l_testStats.PrintResults(agentname);
+            l_testStats.PrintResults(agentname);
+        }
     }
 
     return 0;
@@ -33,10 +33,13 @@ if [ $lTestSuite == "full" ] ; then
     nice -n -10 ./PerformanceTests fifteen96_learning 10 500
     nice -n -10 ./PerformanceTests count-test-5000 3
     nice -n -10 ./PerformanceTests count-test-5000_learning 3
+    nice -n -10 ./PerformanceTests wma-decay 3 2000
     nice -n -10 ./PerformanceTests mac-planning96 1 300 15
     nice -n -10 ./PerformanceTests mac-planning96_learning 4 165 64
     nice -n -10 ./PerformanceTests water-jug-lookahead96 15 10000
     nice -n -10 ./PerformanceTests water-jug-lookahead96_learning 2 102 100
+    nice -n -10 ./PerformanceTests count-test-5000 2 0 0 16 1
+    nice -n -10 ./PerformanceTests count-test-5000 2 0 0 16 4
   elif [ $lVersion == "9.4" ] ; then
     nice -n -10 ./PerformanceTests wait 3 1000000
     nice -n -10 ./PerformanceTests wait_learning 1 1000000 2
@@ -66,6 +69,7 @@ elif [ $lTestSuite == "fast" ] ; then
     nice -n -10 ./PerformanceTests fifteen96_learning 2 500
     nice -n -10 ./PerformanceTests count-test-5000 1
     nice -n -10 ./PerformanceTests count-test-5000_learning 1
+    nice -n -10 ./PerformanceTests wma-decay 1 1000
     nice -n -10 ./PerformanceTests mac-planning96 1 300 3
     nice -n -10 ./PerformanceTests mac-planning96_learning 2 165 32
     nice -n -10 ./PerformanceTests water-jug-lookahead96 3 10000
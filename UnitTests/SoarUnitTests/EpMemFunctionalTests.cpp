@@ -12,15 +12,73 @@
 #include <string>
 #include <list>
 #include <thread>
+#include <sstream>
 
 #include "SoarHelper.hpp"
 
 void EpMemFunctionalTests::tearDown(bool caught)
 {
-    SoarHelper::init_check_to_find_refcount_leaks(agent);
+    // re-running a test agent that calls (succeeded) would clear a failed assertion
+    if (!caught)
+    {
+        SoarHelper::init_check_to_find_refcount_leaks(agent);
+    }
     FunctionalTestHarness::tearDown(caught);
 }
 
+// what the testEpisodeQueries agent answers with every feature off
+const char* EpMemFunctionalTests::episodeQueryAnswers[] = { "57", "4", "52", "18", "50", "failure", "25", "40", "60", NULL };
+
+// the answer the testEpisodeQueries agent left for query n, or "" if none
+std::string EpMemFunctionalTests::episodeQueryAnswer(int n)
+{
+	std::stringstream raw(agent->ExecuteCommandLine("print s1"));
+	std::string state, token;
+
+	// print wraps long states, so compare it a token at a time
+	while (raw >> token)
+	{
+		state += " " + token;
+	}
+
+	std::string attr = " ^query-" + std::to_string(n) + " ";
+	size_t start = state.find(attr);
+	if (start == std::string::npos)
+	{
+		return "";
+	}
+	start += attr.size();
+
+	return state.substr(start, state.find_first_of(" )", start) - start);
+}
+
+void EpMemFunctionalTests::assertEpisodeQueryAnswers(const char** expected)
+{
+	for (int n = 1; expected[n - 1]; n++)
+	{
+		std::string answer = episodeQueryAnswer(n);
+		assertTrue_msg("query-" + std::to_string(n) + " answered '" + answer + "' instead of '" + expected[n - 1] + "'", answer == expected[n - 1]);
+	}
+}
+
+int64_t EpMemFunctionalTests::epmemStat(const char* name)
+{
+	return std::stoll(agent->ExecuteCommandLine((std::string("epmem --stats ") + name).c_str()));
+}
+
+std::string EpMemFunctionalTests::epmemSetting(const char* name)
+{
+	std::stringstream value(agent->ExecuteCommandLine((std::string("epmem --get ") + name).c_str()));
+	std::string token, last;
+
+	// "epmem --get" answers "<name> is <value>"
+	while (value >> token)
+	{
+		last = token;
+	}
+	return last;
+}
+
 void EpMemFunctionalTests::testCountEpMem()
 {
     //SoarHelper::start_log(agent, "testCountEpmem");
@@ -38,6 +96,139 @@ void EpMemFunctionalTests::testKB()
 	runTest("testKB", 246);
 }
 
+void EpMemFunctionalTests::testWriteBehind()
+{
+	runTestSetup("testEpisodeQueries");
+	agent->ExecuteCommandLine("epmem --set write-behind on");
+
+	// part way through storing, the writer thread can still hold episodes,
+	// so write-behind must stay on until the database is closed
+	agent->RunSelf(30);
+	agent->ExecuteCommandLine("epmem --set write-behind off");
+	assertTrue_msg("write-behind was switched off with the database open", epmemSetting("write-behind") == "on");
+
+	runTestExecute("testEpisodeQueries", episodeQueryDecisions);
+	assertEpisodeQueryAnswers(episodeQueryAnswers);
+
+	// every episode was stored, in order, before the queries ran
+	assertEquals(61, epmemStat("time"));
+	assertTrue_msg("episode 40 was not stored as recorded", std::string(agent->ExecuteCommandLine("epmem --print 40")).find("^counter 40 ^decade 4 ") != std::string::npos);
+}
+
+
+void EpMemFunctionalTests::testGraphMatchBacktrack()
+{
+	runTest("testGraphMatchBacktrack", 4);
+}
+
+void EpMemFunctionalTests::testQueryThreads()
+{
+	runTestSetup("testQueryThreads");
+	agent->ExecuteCommandLine("epmem --set query-threads 4");
+	runTestExecute("testQueryThreads", 5);
+
+	// the agent checks the retrieval is the one graph match finds on one
+	// thread; every thread must have had partials to complete
+	assertEquals(4, epmemStat("qry-threads"));
+}
+
+void EpMemFunctionalTests::testIntervalIndex()
+{
+	runTestSetup("testEpisodeQueries");
+	agent->ExecuteCommandLine("epmem --set interval-index on");
+	runTestExecute("testEpisodeQueries", episodeQueryDecisions);
+
+	// the index, kept up to date as episodes were stored, gives the same
+	// answers as the interval queries
+	assertEpisodeQueryAnswers(episodeQueryAnswers);
+	assertTrue_msg("last query read no intervals from the index", epmemStat("qry-index") > 0);
+}
+
+void EpMemFunctionalTests::testLogBackend()
+{
+	runTestSetup("testEpisodeQueries");
+	agent->ExecuteCommandLine("epmem --set backend log");
+
+	// the episodes stay in the log until something needs the database
+	agent->RunSelf(30);
+	assertEquals(0, epmemStat("log-flushes"));
+
+	runTestExecute("testEpisodeQueries", episodeQueryDecisions);
+	assertEpisodeQueryAnswers(episodeQueryAnswers);
+
+	// the first query stored them all in one batch, without the now rows
+	// of the counters that changed before it
+	assertEquals(1, epmemStat("log-flushes"));
+	assertTrue_msg("log did not supersede any writes", epmemStat("log-superseded") > 0);
+	assertEquals(61, epmemStat("time"));
+	assertTrue_msg("episode 40 was not stored as recorded", std::string(agent->ExecuteCommandLine("epmem --print 40")).find("^counter 40 ^decade 4 ") != std::string::npos);
+}
+
+void EpMemFunctionalTests::testSummaries()
+{
+	runTestSetup("testEpisodeQueries");
+	agent->ExecuteCommandLine("sp {elab*max (state <s> ^name episode-queries) --> (<s> ^max 600)}");
+	agent->ExecuteCommandLine("epmem --set summaries on");
+	agent->ExecuteCommandLine("epmem --set summary-block 16");
+	runTestExecute("testEpisodeQueries", 619);
+
+	// the same answers as with summaries off over 600 episodes
+	const char* answers[] = { "57", "4", "592", "18", "575", "failure", "25", "40", "600", NULL };
+	assertEpisodeQueryAnswers(answers);
+
+	// nothing before 57 matches both ^counter 57 and ^mod2 0, so the last
+	// query stops once the blocks left can only tie 600's partial match
+	assertTrue_msg("last query walked every summary block", epmemStat("qry-pruned") > 0);
+}
+
+void EpMemFunctionalTests::testRetention()
+{
+	runTestSetup("testEpisodeQueries");
+	agent->ExecuteCommandLine("sp {elab*max (state <s> ^name episode-queries) --> (<s> ^max 600)}");
+	agent->ExecuteCommandLine("epmem --set page-size 1k");
+	agent->ExecuteCommandLine("epmem --set retention on");
+	agent->ExecuteCommandLine("epmem --set retention-recent 100");
+	agent->ExecuteCommandLine("epmem --set retention-stride 20");
+	agent->ExecuteCommandLine("epmem --set retention-batch 50");
+	runTestExecute("testEpisodeQueries", 619);
+
+	// episodes 1-500 are compacted to every 20th, so queries that found
+	// 57, 4, 18 and 25 fall back to kept episodes (or fail), while 40 and
+	// the 100 most recent are still retrieved
+	const char* answers[] = { "failure", "failure", "592", "600", "575", "failure", "599", "40", "600", NULL };
+	assertEpisodeQueryAnswers(answers);
+
+	assertEquals(475, epmemStat("retention-dropped"));
+	assertTrue_msg("retention reclaimed no database pages", epmemStat("retention-reclaimed") > 0);
+	assertTrue_msg("dropped episode 57 can still be printed", std::string(agent->ExecuteCommandLine("epmem --print 57")).find("Invalid episode") != std::string::npos);
+	assertTrue_msg("kept episode 40 was not kept as recorded", std::string(agent->ExecuteCommandLine("epmem --print 40")).find("^counter 40 ^decade 4 ") != std::string::npos);
+}
+
+void EpMemFunctionalTests::testRetentionLogBackend()
+{
+	runTestSetup("testEpisodeQueries");
+	agent->ExecuteCommandLine("sp {elab*max (state <s> ^name episode-queries) --> (<s> ^max 600)}");
+	agent->ExecuteCommandLine("epmem --set backend log");
+	agent->ExecuteCommandLine("epmem --set write-behind on");
+	agent->ExecuteCommandLine("epmem --set retention on");
+	agent->ExecuteCommandLine("epmem --set retention-recent 100");
+	agent->ExecuteCommandLine("epmem --set retention-stride 20");
+	agent->ExecuteCommandLine("epmem --set retention-batch 50");
+
+	// before the queries, only compacting needs the database, and it
+	// waits for a whole batch: episodes 1-250 in five, not one a cycle
+	agent->RunSelf(400);
+	assertEquals(250, epmemStat("retention-through"));
+	assertEquals(5, epmemStat("log-flushes"));
+
+	// the same answers as with the default backend
+	runTestExecute("testEpisodeQueries", 619);
+	const char* answers[] = { "failure", "failure", "592", "600", "575", "failure", "599", "40", "600", NULL };
+	assertEpisodeQueryAnswers(answers);
+	assertEquals(475, epmemStat("retention-dropped"));
+	assertTrue_msg("kept episode 40 was not kept as recorded", std::string(agent->ExecuteCommandLine("epmem --print 40")).find("^counter 40 ^decade 4 ") != std::string::npos);
+}
+
 void EpMemFunctionalTests::testSingleStoreRetrieve()
 {
 	runTest("testSingleStoreRetrieve", 2);
@@ -40,25 +40,33 @@ public:
 	TEST(testEpmemUnit_12, -1)
 	TEST(testEpmemUnit_13, -1)
 	TEST(testEpMemYRemoval, -1)
+	TEST(testGraphMatchBacktrack, -1)
 	TEST(testHamilton, -1)
 	TEST(testHamiltonian, -1)
+	TEST(testIntervalIndex, -1)
 	TEST(testKB, -1)
+	TEST(testLogBackend, -1)
 	TEST(testMaxDoublePrecision_Irrational, -1)
 	TEST(testMaxDoublePrecisionEpMem, -1)
 	TEST(testMultiAgent, -1)
 	TEST(testNegativeEpisode, -1)
 	TEST(testNonExistingEpisode, -1)
 	TEST(testOddEven, -1)
+	TEST(testQueryThreads, -1)
 	TEST(testReadCSoarDB, -1)
+	TEST(testRetention, -1)
+	TEST(testRetentionLogBackend, -1)
 	TEST(testSimpleFloatEpMem, -1)
 	TEST(testSingleStoreRetrieve, -1)
+	TEST(testSummaries, -1)
 	TEST(testSVS, -1)
 	TEST(testSVSHard, -1)
 	TEST(testWMActivation_Balance0, -1)
 	TEST(testWMELength_FiveCycle, -1)
 	TEST(testWMELength_InfiniteCycle, -1)
 	TEST(testWMELength_MultiCycle, -1)
-	TEST(testWMELength_OneCycle, -1);
+	TEST(testWMELength_OneCycle, -1)
+	TEST(testWriteBehind, -1);
 	
 	void testAfterEpMem();
 	void testAllNegQueriesEpMem();
@@ -86,18 +94,25 @@ public:
 	void testEpmemUnit_14();
     void testEpMemSmemFactorizationCombinationTest();
 	void testEpMemYRemoval();
+	void testGraphMatchBacktrack();
 	void testHamilton();
 	void testHamiltonian();
+	void testIntervalIndex();
 	void testKB();
+	void testLogBackend();
 	void testMaxDoublePrecision_Irrational();
 	void testMaxDoublePrecisionEpMem();
 	void testMultiAgent();
 	void testNegativeEpisode();
 	void testNonExistingEpisode();
 	void testOddEven();
+	void testQueryThreads();
 	void testReadCSoarDB();
+	void testRetention();
+	void testRetentionLogBackend();
 	void testSimpleFloatEpMem();
 	void testSingleStoreRetrieve();
+	void testSummaries();
 	void testSVS();
 	void testSVSHard();
 	void testWMActivation_Balance0();
@@ -105,9 +120,18 @@ public:
 	void testWMELength_InfiniteCycle();
 	void testWMELength_MultiCycle();
 	void testWMELength_OneCycle();
+	void testWriteBehind();
 
     void after(bool caught) { tearDown(caught); }
 	void tearDown(bool caught);
+
+	// helpers for tests run on the testEpisodeQueries agent
+	static const int episodeQueryDecisions = 79;
+	static const char* episodeQueryAnswers[];
+	std::string episodeQueryAnswer(int n);
+	void assertEpisodeQueryAnswers(const char** expected);
+	int64_t epmemStat(const char* name);
+	std::string epmemSetting(const char* name);
 };
 
 #endif /* FunctionalTests_EpMem_cpp */
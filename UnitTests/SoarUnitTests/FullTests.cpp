@@ -1061,6 +1061,124 @@ void FullTests_Parent::test64BitReteNet()
     SoarHelper::init_check_to_find_refcount_leaks(agent);
 }
 
+void FullTests_Parent::testReteNetClone()
+{
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test.soarx") + "\"").c_str()) ;
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+
+    // Clone the net into a second agent, without going through a file
+    sml::Agent* pClone = m_pKernel->CreateAgent("rete-net-clone") ;
+    no_agent_assertTrue(pClone);
+    pClone->ExecuteCommandLine(("load rete-network --clone " + kAgentName).c_str()) ;
+    no_agent_assertTrue(pClone->GetLastCommandLineResult());
+    no_agent_assertTrue(pClone->IsProductionLoaded("apply*initialize-comprehension"));
+    no_agent_assertTrue(pClone->IsProductionLoaded("comprehend*propose*create-sm-query*no-schema"));
+
+    // Save the clone in the current format and load that back into the first agent
+    pClone->ExecuteCommandLine("save rete-network --save test-clone.soarx") ;
+    no_agent_assertTrue(pClone->GetLastCommandLineResult());
+    agent->ExecuteCommandLine("excise --all") ;
+    no_agent_assertTrue(!agent->IsProductionLoaded("apply*initialize-comprehension"));
+    agent->ExecuteCommandLine("load rete-network --load test-clone.soarx") ;
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    no_agent_assertTrue(agent->IsProductionLoaded("apply*initialize-comprehension"));
+    remove("test-clone.soarx");
+
+    pClone->ExecuteCommandLine("load rete-network --clone no-such-agent") ;
+    no_agent_assertTrue(!pClone->GetLastCommandLineResult());
+
+    no_agent_assertTrue(m_pKernel->DestroyAgent(pClone));
+    no_agent_assertTrue(agent->GetInputLink());
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void FullTests_Parent::testCreateAgentWithSharedRules()
+{
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test.soarx") + "\"").c_str()) ;
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+
+    no_agent_assertTrue(!m_pKernel->CreateAgent("shared-rules-bad", "no-such-agent"));
+
+    // The second clone is created from the first, so all three share one saved net
+    sml::Agent* pFirst = m_pKernel->CreateAgent("shared-rules-1", kAgentName.c_str()) ;
+    no_agent_assertTrue(pFirst);
+    sml::Agent* pSecond = m_pKernel->CreateAgent("shared-rules-2", "shared-rules-1") ;
+    no_agent_assertTrue(pSecond);
+    no_agent_assertTrue(pFirst->IsProductionLoaded("apply*initialize-comprehension"));
+    no_agent_assertTrue(pSecond->IsProductionLoaded("apply*initialize-comprehension"));
+    no_agent_assertTrue(pSecond->GetInputLink());
+
+    // Changing one agent's rules leaves the others alone
+    pFirst->ExecuteCommandLine("excise apply*initialize-comprehension") ;
+    no_agent_assertTrue(!pFirst->IsProductionLoaded("apply*initialize-comprehension"));
+    no_agent_assertTrue(agent->IsProductionLoaded("apply*initialize-comprehension"));
+    sml::Agent* pThird = m_pKernel->CreateAgent("shared-rules-3", "shared-rules-1") ;
+    no_agent_assertTrue(pThird);
+    no_agent_assertTrue(!pThird->IsProductionLoaded("apply*initialize-comprehension"));
+    no_agent_assertTrue(pThird->IsProductionLoaded("comprehend*propose*create-sm-query*no-schema"));
+
+    no_agent_assertTrue(m_pKernel->DestroyAgent(pFirst));
+    no_agent_assertTrue(m_pKernel->DestroyAgent(pSecond));
+    no_agent_assertTrue(m_pKernel->DestroyAgent(pThird));
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void FullTests_Parent::testCreateAgentFromAgentWithJustifications()
+{
+    // A result returned from the state no-change substate leaves a justification,
+    // and a net holding justifications can't be saved
+    agent->ExecuteCommandLine("sp {elaborate*result (state <s> ^superstate <ss>) (<ss> ^superstate nil) --> (<ss> ^result yes)}") ;
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    agent->RunSelf(2) ;
+    no_agent_assertTrue(agent->IsProductionLoaded("justify1"));
+
+    // so the clone fails instead of starting without any productions
+    int lNumAgents = m_pKernel->GetNumberAgents() ;
+    no_agent_assertTrue(!m_pKernel->CreateAgent("shared-rules-bad", kAgentName.c_str()));
+    no_agent_assertTrue(m_pKernel->HadError());
+    m_pKernel->UpdateAgentList() ;
+    no_agent_assertTrue(m_pKernel->GetNumberAgents() == lNumAgents);
+    no_agent_assertTrue(!m_pKernel->GetAgent("shared-rules-bad"));
+
+    // Once the justification is gone the agent can be cloned again
+    agent->InitSoar() ;
+    sml::Agent* pClone = m_pKernel->CreateAgent("shared-rules-good", kAgentName.c_str()) ;
+    no_agent_assertTrue(pClone);
+    no_agent_assertTrue(pClone->IsProductionLoaded("elaborate*result"));
+    no_agent_assertTrue(m_pKernel->DestroyAgent(pClone));
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void FullTests_Parent::testReteNetKeepsRules()
+{
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test.soarx") + "\"").c_str()) ;
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+
+    // A file that isn't there is caught before any rules are excised
+    agent->ExecuteCommandLine("debug rete-net no-such-file.soar") ;
+    no_agent_assertTrue(!agent->GetLastCommandLineResult());
+    no_agent_assertTrue(agent->IsProductionLoaded("apply*initialize-comprehension"));
+
+    // One that fails part way through sourcing is replaced by the old rules
+    FILE* pFile = fopen("test-bad-rules.soar", "w");
+    no_agent_assertTrue(pFile);
+    fputs("sp {good (state <s> ^superstate nil) --> (<s> ^good yes)}\nsp {bad (state <s> --> }\n", pFile);
+    fclose(pFile);
+    agent->ExecuteCommandLine("debug rete-net test-bad-rules.soar") ;
+    no_agent_assertTrue(!agent->GetLastCommandLineResult());
+    no_agent_assertTrue(agent->IsProductionLoaded("apply*initialize-comprehension"));
+    no_agent_assertTrue(!agent->IsProductionLoaded("good"));
+
+    // and load rete-network checks the file is a rete net before excising
+    agent->ExecuteCommandLine("load rete-network --load test-bad-rules.soar") ;
+    no_agent_assertTrue(!agent->GetLastCommandLineResult());
+    no_agent_assertTrue(agent->IsProductionLoaded("apply*initialize-comprehension"));
+    remove("test-bad-rules.soar");
+
+    no_agent_assertTrue(agent->GetInputLink());
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
 void FullTests_Parent::testOSupportCopyDestroy()
 {
     loadProductions(SoarHelper::GetResource("testOSupportCopyDestroy.soar"));
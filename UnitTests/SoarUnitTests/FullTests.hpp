@@ -65,6 +65,10 @@ public:
 	void testSimpleCopy();
 	void testSimpleReteNetLoader();
 	void test64BitReteNet();
+	void testReteNetClone();
+	void testReteNetKeepsRules();
+	void testCreateAgentWithSharedRules();
+	void testCreateAgentFromAgentWithJustifications();
 	void testOSupportCopyDestroy();
 	void testOSupportCopyDestroyCircularParent();
 	void testOSupportCopyDestroyCircular();
@@ -158,6 +162,18 @@ public:
 	TEST(test64BitReteNet, -1);
 	void test64BitReteNet() { this->FullTests_Parent::test64BitReteNet(); }
 	
+	TEST(testReteNetClone, -1);
+	void testReteNetClone() { this->FullTests_Parent::testReteNetClone(); }
+	
+	TEST(testReteNetKeepsRules, -1);
+	void testReteNetKeepsRules() { this->FullTests_Parent::testReteNetKeepsRules(); }
+	
+	TEST(testCreateAgentWithSharedRules, -1);
+	void testCreateAgentWithSharedRules() { this->FullTests_Parent::testCreateAgentWithSharedRules(); }
+	
+	TEST(testCreateAgentFromAgentWithJustifications, -1);
+	void testCreateAgentFromAgentWithJustifications() { this->FullTests_Parent::testCreateAgentFromAgentWithJustifications(); }
+	
 	TEST(testOSupportCopyDestroy, -1);
 	void testOSupportCopyDestroy() { this->FullTests_Parent::testOSupportCopyDestroy(); }
 	
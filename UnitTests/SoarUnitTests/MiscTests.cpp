@@ -18,6 +18,8 @@
 
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 
 #include "SoarHelper.hpp"
 #include "handlers.hpp"
@@ -354,6 +356,166 @@ void MiscTests::testPreferenceDeallocation()
 	SoarHelper::init_check_to_find_refcount_leaks(agent);
 }
 
+void MiscTests::testProductionProfile()
+{
+	agent->ExecuteCommandLine("sp {one (state <s> ^superstate nil ^item <i>) --> (<s> ^seen <i>)}");
+	agent->ExecuteCommandLine("add-wme S1 item 0");
+
+	// nothing is recorded until the profiler is turned on
+	sml::ClientAnalyzedXML off;
+	agent->ExecuteCommandLineXML("production profile", &off);
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(off.GetArgString(sml::sml_Names::kParamName) == NULL);
+
+	agent->ExecuteCommandLine("production profile --enable");
+	assertTrue(agent->GetLastCommandLineResult());
+	agent->ExecuteCommandLine("add-wme S1 item 1");
+	agent->ExecuteCommandLine("add-wme S1 item 2");
+	agent->ExecuteCommandLine("run 1");
+
+	// each new item right-activates the join and adds a match to the p-node
+	sml::ClientAnalyzedXML on;
+	agent->ExecuteCommandLineXML("production profile", &on);
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(on.GetArgString(sml::sml_Names::kParamName) != NULL);
+	assertTrue(std::string(on.GetArgString(sml::sml_Names::kParamName)) == "one");
+	assertEquals(on.GetArgFloat(sml::sml_Names::kParamProfileRightActivations, -1), 2);
+	assertEquals(on.GetArgFloat(sml::sml_Names::kParamProfileJoinCandidates, -1), 2);
+	assertEquals(on.GetArgFloat(sml::sml_Names::kParamProfileLeftActivations, -1), 2);
+	assertEquals(on.GetArgFloat(sml::sml_Names::kParamProfileTokens, -1), 2);
+	assertTrue(on.GetArgFloat(sml::sml_Names::kParamProfileTime, -1) >= 0);
+
+	// the table's fixed point format doesn't stick to later commands
+	agent->ExecuteCommandLine("production profile");
+	std::string timed = agent->ExecuteCommandLine("time echo hi");
+	assertTrue_msg(timed, timed.find("(0.0s)") == std::string::npos);
+
+	agent->ExecuteCommandLine("production profile --clear");
+	sml::ClientAnalyzedXML cleared;
+	agent->ExecuteCommandLineXML("production profile", &cleared);
+	assertTrue(cleared.GetArgString(sml::sml_Names::kParamName) == NULL);
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+static std::string read_timeline(sml::Agent* agent, const char* file)
+{
+	agent->ExecuteCommandLine((std::string("stats --timeline ") + file).c_str());
+	if (!agent->GetLastCommandLineResult())
+	{
+		return "";
+	}
+	std::ifstream in(file);
+	std::stringstream contents;
+	contents << in.rdbuf();
+	in.close();
+	remove(file);
+	return contents.str();
+}
+
+static size_t count_occurrences(const std::string& text, const std::string& what)
+{
+	size_t count = 0;
+	for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+	{
+		count++;
+	}
+	return count;
+}
+
+void MiscTests::testTimeline()
+{
+	agent->ExecuteCommandLine("sp {propose (state <s> ^superstate nil -^done) --> (<s> ^operator <o> +) (<o> ^name finish)}");
+	agent->ExecuteCommandLine("sp {apply (state <s> ^operator.name finish) --> (<s> ^done true)}");
+
+	// nothing is recorded until it is switched on
+	agent->ExecuteCommandLine("run 1");
+	std::string trace = read_timeline(agent, "timeline-test.json");
+	assertTrue_msg("stats --timeline failed", !trace.empty());
+	assertEquals(0, count_occurrences(trace, "\"ph\":\"B\""));
+
+	agent->ExecuteCommandLine("soar timeline on");
+	assertTrue(agent->GetLastCommandLineResult());
+	agent->ExecuteCommandLine("run 2");
+
+	trace = read_timeline(agent, "timeline-test.json");
+	assertTrue_msg("stats --timeline failed", !trace.empty());
+	assertTrue(trace.find("\"traceEvents\"") != std::string::npos);
+	assertTrue(trace.find("\"name\":\"propose\",\"cat\":\"phase\",\"ph\":\"B\"") != std::string::npos);
+	assertTrue(trace.find("\"name\":\"apply\",\"cat\":\"phase\",\"ph\":\"E\"") != std::string::npos);
+	assertTrue(trace.find("\"cat\":\"match\"") != std::string::npos);
+
+	// every phase that began has ended
+	size_t events = count_occurrences(trace, "\"ph\":\"B\"");
+	assertEquals(events, count_occurrences(trace, "\"ph\":\"E\""));
+
+	// nothing more is recorded while it is off
+	agent->ExecuteCommandLine("soar timeline off");
+	assertTrue(agent->GetLastCommandLineResult());
+	agent->ExecuteCommandLine("run 2");
+	trace = read_timeline(agent, "timeline-test.json");
+	assertEquals(events, count_occurrences(trace, "\"ph\":\"B\""));
+
+	agent->ExecuteCommandLine("stats --timeline");
+	assertFalse(agent->GetLastCommandLineResult());
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testDecisionLatency()
+{
+	agent->ExecuteCommandLine("sp {propose (state <s> ^superstate nil) --> (<s> ^operator <o> +) (<o> ^name wait)}");
+	agent->ExecuteCommandLine("soar slow-dc-time 1");
+	assertTrue(agent->GetLastCommandLineResult());
+	// only decisions whose output phase has finished are counted
+	agent->ExecuteCommandLine("soar stop-phase input");
+	agent->ExecuteCommandLine("run 20");
+
+	sml::ClientAnalyzedXML stats;
+	agent->ExecuteCommandLineXML("stats", &stats);
+	assertTrue(agent->GetLastCommandLineResult());
+	assertEquals(stats.GetArgInt(sml::sml_Names::kParamStatsDecisionTimeCount, -1), 20);
+	int p50 = stats.GetArgInt(sml::sml_Names::kParamStatsDecisionTimeP50USec, -1);
+	int p99 = stats.GetArgInt(sml::sml_Names::kParamStatsDecisionTimeP99USec, -1);
+	int max = stats.GetArgInt(sml::sml_Names::kParamStatsDecisionTimeMaxUSec, -1);
+	assertTrue(p50 >= 0 && p50 <= p99 && p99 <= max);
+	assertTrue(stats.GetArgInt(sml::sml_Names::kParamStatsMaxTimeUSecApplyPhase, -1) <= max);
+	assertTrue(stats.GetArgInt(sml::sml_Names::kParamStatsSlowDecisionCount, -1) > 0);
+
+	std::string percentiles = agent->ExecuteCommandLine("stats --percentiles");
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(percentiles.find("Slowest phase") != std::string::npos);
+
+	// the mean is printed in fixed point, to a tenth of a usec
+	size_t row = percentiles.find("Decision (wall)");
+	assertTrue(row != std::string::npos);
+	std::istringstream columns(percentiles.substr(row + 16));
+	std::string mean;
+	int rowP50 = -1, rowP90 = -1, rowP99 = -1, rowP999 = -1, rowMax = -1;
+	columns >> mean >> rowP50 >> rowP90 >> rowP99 >> rowP999 >> rowMax;
+	assertTrue_msg(mean, mean.size() >= 3 && mean.find_first_not_of("0123456789.") == std::string::npos && mean[mean.size() - 2] == '.');
+	assertTrue_msg(mean, atof(mean.c_str()) <= rowMax + 0.05);
+	assertEquals(rowMax, max);
+
+	// and the sections printed after it, and after the rete's table, keep
+	// the stats command's format
+	std::string system = agent->ExecuteCommandLine("stats --percentiles --rete --system");
+	size_t kernel = system.find("Kernel CPU Time:");
+	assertTrue(kernel != std::string::npos);
+	std::istringstream kernelTime(system.substr(kernel + 16));
+	std::string seconds;
+	kernelTime >> seconds;
+	assertTrue_msg(seconds, seconds.size() > 4 && seconds[seconds.size() - 4] == '.');
+
+	agent->ExecuteCommandLine("stats --reset");
+	sml::ClientAnalyzedXML reset;
+	agent->ExecuteCommandLineXML("stats", &reset);
+	assertEquals(reset.GetArgInt(sml::sml_Names::kParamStatsDecisionTimeCount, -1), 0);
+	assertEquals(reset.GetArgInt(sml::sml_Names::kParamStatsSlowDecisionCount, -1), 0);
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
 //void MiscTests::testSoarDebugger()
 //{
 //	bool result = agent->SpawnDebugger();
@@ -47,6 +47,12 @@ public:
 	void testSoarRand();
 	TEST(testPreferenceDeallocation, -1)
 	void testPreferenceDeallocation();
+	TEST(testProductionProfile, -1)
+	void testProductionProfile();
+	TEST(testTimeline, -1)
+	void testTimeline();
+	TEST(testDecisionLatency, -1)
+	void testDecisionLatency();
 	
 	TEST(testGDS_Failed_Justification_Crash, -1);
 	TEST(testIsupported_Smem_Chunk_Crash, -1);
@@ -15,6 +15,7 @@ const int MultiAgentTest::MAX_AGENTS = 100;
 void MultiAgentTest::setUp()
 {
 	updateEventHandler = user_data_struct(std::bind(&MultiAgentTest::MyUpdateEventHandler, this));
+	runThreads = 1;
 }
 
 void MultiAgentTest::tearDown(bool caught)
@@ -152,12 +153,111 @@ void MultiAgentTest::testTenAgents()
 	doTest();
 }
 
+void MultiAgentTest::testTenAgentsParallel()
+{
+	numberAgents = 10;
+	runThreads = 4;
+	doTest();
+}
+
 void MultiAgentTest::testMaxAgents()
 {
 	numberAgents = MAX_AGENTS-1;
 	doTest();
 }
 
+void MultiAgentTest::testSeededAgentsParallel()
+{
+	numberAgents = 8;
+	
+	std::vector< std::string > serialTraces;
+	runSeededAgents(serialTraces);
+	
+	runThreads = 4;
+	std::vector< std::string > parallelTraces;
+	runSeededAgents(parallelTraces);
+	
+	// Every agent has its own generator and the same seed, so each one makes
+	// the same picks and draws the same numbers, in whatever order the
+	// agents were stepped and on whichever thread.
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; agentCounter++)
+	{
+		no_agent_assertTrue_msg(serialTraces[agentCounter], serialTraces[agentCounter] == serialTraces[0]);
+		no_agent_assertTrue_msg(parallelTraces[agentCounter], parallelTraces[agentCounter] == serialTraces[0]);
+	}
+	
+	// And each agent's writes are whole, in order and its own.  The halt
+	// messages follow them.
+	std::istringstream lines(serialTraces[0]);
+	std::string line;
+	int count = 0;
+	while (std::getline(lines, line) && count < 20)
+	{
+		if (line.empty())
+		{
+			continue;
+		}
+		std::istringstream fields(line);
+		std::string word, choice;
+		int step = -1, value = -1;
+		fields >> word >> step >> choice >> value;
+		no_agent_assertTrue_msg(line, word == "pick" && step == count);
+		no_agent_assertTrue_msg(line, choice == "a" || choice == "b" || choice == "c");
+		no_agent_assertTrue_msg(line, value >= 0 && value <= 1000 && fields.eof());
+		++count;
+	}
+	no_agent_assertTrue_msg(serialTraces[0], count == 20);
+}
+
+void MultiAgentTest::runSeededAgents(std::vector< std::string >& traces)
+{
+	pKernel = sml::Kernel::CreateKernelInCurrentThread(true, sml::Kernel::kUseAnyPort);
+	no_agent_assertTrue_msg(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+	
+	if (runThreads > 1)
+	{
+		no_agent_assertTrue(pKernel->SetAgentRunThreads(runThreads));
+	}
+	
+	std::vector< std::stringstream* > trace;
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+	{
+		std::stringstream name;
+		name << "agent" << 1 + agentCounter;
+		
+		sml::Agent* agent = pKernel->CreateAgent(name.str().c_str()) ;
+		assertTrue(agent != NULL);
+		
+		assertTrue(agent->LoadProductions(SoarHelper::GetResource("testmultirand.soar").c_str()));
+		agent->ExecuteCommandLine("watch 0") ;
+		agent->ExecuteCommandLine("output agent-writes on") ;
+		agent->ExecuteCommandLine("srand 42") ;
+		assertTrue(agent->GetLastCommandLineResult());
+		
+		trace.push_back(new std::stringstream());
+		
+		auto lambda = [](sml::smlPrintEventId id, void* pUserData, sml::Agent* pAgent, char const* pMessage)
+		{
+			std::stringstream* pTrace = static_cast<std::stringstream*>(pUserData) ;
+			
+			(*pTrace) << pMessage;
+		};
+		
+		agent->RegisterForPrintEvent(sml::smlEVENT_PRINT, lambda, trace[agentCounter]);
+	}
+	
+	pKernel->RunAllAgentsForever() ;
+	
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; agentCounter++)
+	{
+		traces.push_back(trace[agentCounter]->str());
+		delete trace[agentCounter];
+	}
+	
+	pKernel->Shutdown() ;
+	delete pKernel ;
+}
+
 void MultiAgentTest::doTest()
 {
 	pKernel = sml::Kernel::CreateKernelInCurrentThread(true, sml::Kernel::kUseAnyPort);
@@ -166,6 +266,11 @@ void MultiAgentTest::doTest()
 	// We'll require commits, just so we're testing that path
 	pKernel->SetAutoCommit(false) ;
 	
+	if (runThreads > 1)
+	{
+		no_agent_assertTrue(pKernel->SetAgentRunThreads(runThreads));
+	}
+	
 	// Comment this in if you need to debug the messages going back and forth.
 	//pKernel->SetTraceCommunications(true) ;
 	
@@ -245,6 +350,14 @@ void MultiAgentTest::doTest()
 	
 	reportAgentStatus(pKernel, numberAgents, trace) ;
 	
+	// Every agent runs the same rules on the same input, so however they were
+	// scheduled they should all have reached the same point.
+	for (int agentCounter = 1 ; agentCounter < numberAgents ; agentCounter++)
+	{
+		sml::Agent* agent = agents[agentCounter];
+		assertTrue(agent->GetDecisionCycleCounter() == agents[0]->GetDecisionCycleCounter());
+	}
+	
 	for (std::vector< std::stringstream* >::iterator iter = trace.begin(); iter != trace.end(); ++iter)
 	{
 		delete *iter;
@@ -38,9 +38,15 @@ public:
 	TEST(testTenAgents, -1)
 	void testTenAgents();
 	
+	TEST(testTenAgentsParallel, -1)
+	void testTenAgentsParallel();
+	
 	TEST(testMaxAgents, -1)
 	void testMaxAgents();
 	
+	TEST(testSeededAgentsParallel, -1)
+	void testSeededAgentsParallel();
+	
 private:
 	struct user_data_struct
 	{
@@ -61,9 +67,11 @@ private:
 	void reportAgentStatus(sml::Kernel* pKernel, int numberAgents, std::vector< std::stringstream* >& trace);
 	void initAll(sml::Kernel* pKernel);
 	void UpdateInput(sml::Agent* agent, int value);
+	void runSeededAgents(std::vector< std::string >& traces);
 	
 	static const int MAX_AGENTS;
 	int numberAgents;
+	int runThreads;
 	sml::Kernel* pKernel;
 };
 
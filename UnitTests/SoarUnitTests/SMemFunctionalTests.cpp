@@ -273,7 +273,13 @@ void SMemFunctionalTests::testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Sta
 void SMemFunctionalTests::testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Naive()
 {
 	runTestSetup("testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Naive");
+	runActivationBaseLevelNaive();
+}
 
+// runs the agent, set up by the caller, and checks the activations it ends
+// with, which are the same however smem keeps and updates them
+void SMemFunctionalTests::runActivationBaseLevelNaive()
+{
 	agent->RunSelf(6);
 
 	assertTrue_msg("testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Naive functional test did not halt", halted);
@@ -317,6 +323,86 @@ void SMemFunctionalTests::testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Inc
     assertTrue_msg(std::string("Activation value ") + expected + std::string(" != " + result), result == expected);
 }
 
+void SMemFunctionalTests::testLtmCache()
+{
+	// a two-LTM cache, so that activations go through eviction and the
+	// pre-query write-back; it can't be changed once the agent's smem --add
+	// has opened the database
+	agent->ExecuteCommandLine("smem --set ltm-cache 2");
+	runTestSetup("testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Naive");
+	assertTrue(std::string(agent->ExecuteCommandLine("smem --get ltm-cache")).find("ltm-cache is 2") != std::string::npos);
+	runActivationBaseLevelNaive();
+
+    std::string result = agent->ExecuteCommandLine("smem --stats ltm-cache-hits");
+    assertTrue_msg("No LTM cache hits: " + result, result.size() > 0 && result.find_first_not_of("0 \n") != std::string::npos);
+}
+
+void SMemFunctionalTests::testBaseHistoryStore()
+{
+	// activation computed from the in-memory history store, with the
+	// naive updates batched
+	runTestSetup("testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Naive");
+	agent->ExecuteCommandLine("smem --set base-history-store on");
+	assertTrue(std::string(agent->ExecuteCommandLine("smem --get base-history-store")).find("base-history-store is on") != std::string::npos);
+	runActivationBaseLevelNaive();
+}
+
+void SMemFunctionalTests::testSpreadingActivation()
+{
+	// the query for a target should return the one the ltm in working memory
+	// spreads to, not the most recently stored one
+	runTestSetup("testSpreadingActivation");
+
+	agent->RunSelf(10);
+
+	assertTrue_msg("testSpreadingActivation functional test did not halt", halted);
+
+    std::string result = agent->ExecuteCommandLine("smem --stats spread-sources");
+    assertTrue_msg("No spreading sources: " + result, result.size() > 0 && result.find_first_not_of("0 \n") != std::string::npos);
+}
+
+void SMemFunctionalTests::testBulkImport()
+{
+	// the agent imports a small knowledge base and queries it
+	runTestSetup("testBulkImport");
+
+	agent->RunSelf(5);
+
+	assertTrue_msg("testBulkImport functional test did not halt", halted);
+
+    std::string result, expected;
+    // the duplicate edge in the file is stored once
+    result = agent->ExecuteCommandLine("smem --stats edges");
+    assertTrue_msg("Edges 9 != " + result, std::stoll(result) == 9);
+
+    // importing again adds nothing
+    result = agent->ExecuteCommandLine(("smem --import \"" + SoarHelper::GetResource("SMemFunctionalTests_testBulkImport.txt") + "\"").c_str());
+    assertTrue_msg("Re-import added edges: " + result, result.find("Imported 0 ") != std::string::npos);
+    result = agent->ExecuteCommandLine("print @4 -d 1");
+    expected = "(@4 ^name stone [+0.000])\n";
+    assertTrue_msg(std::string("Imported ltm ") + expected + std::string(" != " + result), result == expected);
+}
+
+void SMemFunctionalTests::testQueryIndex()
+{
+	// the second query must see the ltm the first one activated first
+	runTestSetup("testQueryIndex");
+
+	agent->RunSelf(5);
+
+	assertTrue_msg("testQueryIndex functional test did not halt", halted);
+
+    std::string result, expected;
+    result = agent->ExecuteCommandLine("print @2 -d 1");
+    expected = "(@2 ^kind bird ^name robin [+2.000])\n";
+    assertTrue_msg(std::string("Activation value ") + expected + std::string(" != " + result), result == expected);
+
+    // turning the index off answers the same query from the database
+    agent->ExecuteCommandLine("smem --set query-index off");
+    result = agent->ExecuteCommandLine("smem --query {(<x> ^kind bird ^name <n>)} 1");
+    assertTrue_msg("Database query disagrees: " + result, result.find("robin") != std::string::npos);
+}
+
 void SMemFunctionalTests::testDbBackupAndLoadTests()
 {
 	runTestSetup("testFactorization");
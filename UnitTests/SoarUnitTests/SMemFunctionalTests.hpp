@@ -121,6 +121,21 @@ public:
 	TEST(testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental, -1)
 	void testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental();
 	
+	TEST(testLtmCache, -1)
+	void testLtmCache();
+	
+	TEST(testBaseHistoryStore, -1)
+	void testBaseHistoryStore();
+	
+	TEST(testSpreadingActivation, -1)
+	void testSpreadingActivation();
+	
+	TEST(testBulkImport, -1)
+	void testBulkImport();
+	
+	TEST(testQueryIndex, -1)
+	void testQueryIndex();
+	
 	TEST(testDbBackupAndLoadTests, -1)
 	void testDbBackupAndLoadTests();
 	
@@ -129,6 +144,9 @@ public:
 
 	TEST(testMultiAgent, -1)
 	void testMultiAgent();
+
+	// helper for tests run on the ActivationBaseLevel_Naive agent
+	void runActivationBaseLevelNaive();
 };
 
 #endif /* SMemFunctionalTests_cpp */
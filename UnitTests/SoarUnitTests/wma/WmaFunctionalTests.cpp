@@ -18,3 +18,67 @@ void WmaFunctionalTests::testSimpleActivation()
 	assertTrue(result.find("S1 ^i-from-i true [1]") != std::string::npos);
 	assertFalse(result.find("S1 ^o-from-i2") != std::string::npos);
 }
+
+void WmaFunctionalTests::testForgettingQueue()
+{
+	runTestSetup("testForgettingQueue");
+	agent->ExecuteCommandLine("run 2");
+	
+	// find the timetag of the wme that will decay
+	std::string result = agent->ExecuteCommandLine("print -i s1");
+	size_t wme_p = result.find(": S1 ^fading true");
+	assertTrue(wme_p != std::string::npos);
+	size_t start_p = result.rfind('(', wme_p);
+	std::string history_cmd = "wm activation --history " + result.substr(start_p + 1, wme_p - start_p - 1);
+	
+	// three references at d1 stay above a threshold of -4 for
+	// ceil( ( 3 / e^-4 )^2 ) = 26829 cycles, so it goes on the queue
+	// twenty-six revolutions out
+	result = agent->ExecuteCommandLine(history_cmd.c_str());
+	assertTrue(result.find("considering WME for decay @ d26830") != std::string::npos);
+	
+	agent->ExecuteCommandLine("run 26825");
+	result = agent->ExecuteCommandLine(history_cmd.c_str());
+	assertTrue(result.find("considering WME for decay @ d26830") != std::string::npos);
+	assertEquals(std::string("0"), std::string(agent->ExecuteCommandLine("wm activation --stats forgotten-wmes")));
+	
+	agent->ExecuteCommandLine("run 5");
+	result = agent->ExecuteCommandLine(history_cmd.c_str());
+	assertTrue(result.find("considering WME for decay") == std::string::npos);
+	assertFalse(std::string(agent->ExecuteCommandLine("wm activation --stats forgotten-wmes")) == "0");
+}
+
+void WmaFunctionalTests::testFastMathForgetting()
+{
+	runTestSetup("testFastMathForgetting");
+	agent->ExecuteCommandLine("run 7");
+	
+	// find the timetag of the wme that will decay
+	std::string result = agent->ExecuteCommandLine("print -i s1");
+	size_t wme_p = result.find(": S1 ^fading true");
+	assertTrue(wme_p != std::string::npos);
+	size_t start_p = result.rfind('(', wme_p);
+	std::string history_cmd = "wm activation --history " + result.substr(start_p + 1, wme_p - start_p - 1);
+	
+	// activations are always summed in the default order
+	agent->ExecuteCommandLine("wm activation --set decay-fast-math off");
+	std::string exact = agent->ExecuteCommandLine("print -i s1");
+	agent->ExecuteCommandLine("wm activation --set decay-fast-math on");
+	assertEquals(exact, std::string(agent->ExecuteCommandLine("print -i s1")));
+	
+	// summed in the default order, the first cycle below threshold is
+	// d6610; the reordered search has to find the same cycle, and the
+	// check there has to agree (were it to find the wme still above, it
+	// would be queued again, later)
+	result = agent->ExecuteCommandLine(history_cmd.c_str());
+	assertTrue_msg(result, result.find("considering WME for decay @ d6610") != std::string::npos);
+	
+	agent->ExecuteCommandLine("run 6590");
+	for (int i = 0; (i < 30) && (std::string(agent->ExecuteCommandLine("wm activation --stats forgotten-wmes")) == "0"); i++)
+	{
+		result = agent->ExecuteCommandLine(history_cmd.c_str());
+		assertTrue_msg(result, result.find("considering WME for decay @ d6610") != std::string::npos);
+		agent->ExecuteCommandLine("run 1");
+	}
+	assertFalse(std::string(agent->ExecuteCommandLine("wm activation --stats forgotten-wmes")) == "0");
+}
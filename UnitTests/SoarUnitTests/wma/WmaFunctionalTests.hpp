@@ -18,6 +18,12 @@ public:
 	
 	TEST(testSimpleActivation, -1);
 	void testSimpleActivation();
+	
+	TEST(testForgettingQueue, -1);
+	void testForgettingQueue();
+	
+	TEST(testFastMathForgetting, -1);
+	void testFastMathForgetting();
 };
 
 #endif /* WmaFunctionalTests_cpp */